@@ -0,0 +1,180 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Benchmark of the bulk blob decoding kernels, comparing the field-at-a-time
+// decoders against the strided record kernels and the declarative record
+// layouts on large runs of beat grid markers and waveform points.
+// Compression is deliberately excluded, so that the figures reflect the cost
+// of unpacking alone.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <djinterop/engine/v2/beat_data_blob.hpp>
+#include <djinterop/engine/v2/overview_waveform_data_blob.hpp>
+
+#include "djinterop/engine/encode_decode_utils.hpp"
+#include "djinterop/engine/v2/blob_layouts.hpp"
+
+namespace
+{
+using clock_type = std::chrono::steady_clock;
+using djinterop::engine::v2::beat_grid_marker_blob;
+using djinterop::engine::v2::overview_waveform_point;
+
+template <typename F>
+void run(
+    const std::string& name, std::size_t bytes, int iterations, F&& f)
+{
+    // Accumulate a checksum, so that the work cannot be optimised away.
+    uint64_t checksum = 0;
+    auto start = clock_type::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        checksum += f();
+    }
+
+    auto elapsed = std::chrono::duration<double>(clock_type::now() - start);
+    auto gb_per_second = bytes * iterations / elapsed.count() / 1e9;
+    std::cout << std::left << std::setw(24) << name << std::right
+              << std::setw(10) << std::fixed << std::setprecision(2)
+              << gb_per_second << " GB/s  (checksum " << checksum << ")\n";
+}
+}  // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    using namespace djinterop::engine;
+
+    std::size_t count =
+        argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    constexpr int iterations = 20;
+
+    std::mt19937 rng{42};
+    std::vector<std::byte> markers(24 * count);
+    std::vector<std::byte> points(3 * count);
+    for (auto& b : markers)
+    {
+        b = static_cast<std::byte>(rng());
+    }
+    for (auto& b : points)
+    {
+        b = static_cast<std::byte>(rng());
+    }
+
+    std::vector<beat_grid_marker_blob> marker_out(count);
+    std::vector<overview_waveform_point> point_out(count);
+
+    std::cout << count << " records per run, " << iterations << " runs\n";
+
+    run("markers/per_field", markers.size(), iterations,
+        [&]
+        {
+            const std::byte* ptr = markers.data();
+            for (auto& m : marker_out)
+            {
+                std::tie(m.sample_offset, ptr) = decode_double_le(ptr);
+                std::tie(m.beat_number, ptr) = decode_int64_le(ptr);
+                std::tie(m.number_of_beats, ptr) = decode_int32_le(ptr);
+                std::tie(m.unknown_value_1, ptr) = decode_int32_le(ptr);
+            }
+            return static_cast<uint64_t>(marker_out[count / 2].beat_number);
+        });
+    run("markers/strided", markers.size(), iterations,
+        [&]
+        {
+            decode_strided<24>(
+                markers.data(), std::span{marker_out},
+                [](const std::byte* p, beat_grid_marker_blob& m)
+                {
+                    m.sample_offset = load_le<double>(p);
+                    m.beat_number = load_le<int64_t>(p + 8);
+                    m.number_of_beats = load_le<int32_t>(p + 16);
+                    m.unknown_value_1 = load_le<int32_t>(p + 20);
+                });
+            return static_cast<uint64_t>(marker_out[count / 2].beat_number);
+        });
+    run("markers/layout", markers.size(), iterations,
+        [&]
+        {
+            blob_layout::decode_records<
+                v2::layouts::beat_grid_marker_blob_layout>(
+                markers.data(), std::span{marker_out});
+            return static_cast<uint64_t>(marker_out[count / 2].beat_number);
+        });
+    run("points/per_field", points.size(), iterations,
+        [&]
+        {
+            const std::byte* ptr = points.data();
+            for (auto& e : point_out)
+            {
+                std::tie(e.low_value, ptr) = decode_uint8(ptr);
+                std::tie(e.mid_value, ptr) = decode_uint8(ptr);
+                std::tie(e.high_value, ptr) = decode_uint8(ptr);
+            }
+            return static_cast<uint64_t>(point_out[count / 2].mid_value);
+        });
+    run("points/strided", points.size(), iterations,
+        [&]
+        {
+            decode_strided<3>(
+                points.data(), std::span{point_out},
+                [](const std::byte* p, overview_waveform_point& e)
+                {
+                    e.low_value = load_le<uint8_t>(p);
+                    e.mid_value = load_le<uint8_t>(p + 1);
+                    e.high_value = load_le<uint8_t>(p + 2);
+                });
+            return static_cast<uint64_t>(point_out[count / 2].mid_value);
+        });
+
+    run("points/layout", points.size(), iterations,
+        [&]
+        {
+            blob_layout::decode_records<
+                v2::layouts::overview_waveform_point_layout>(
+                points.data(), std::span{point_out});
+            return static_cast<uint64_t>(point_out[count / 2].mid_value);
+        });
+
+    std::vector<int64_t> be_values(count);
+    run("int64_be/per_field", 8 * count, iterations,
+        [&]
+        {
+            const std::byte* ptr = markers.data();
+            for (auto& v : be_values)
+            {
+                std::tie(v, ptr) = decode_int64_be(ptr);
+            }
+            return static_cast<uint64_t>(be_values[count / 2]);
+        });
+    run("int64_be/array", 8 * count, iterations,
+        [&]
+        {
+            decode_array_be(markers.data(), std::span{be_values});
+            return static_cast<uint64_t>(be_values[count / 2]);
+        });
+
+    return 0;
+}
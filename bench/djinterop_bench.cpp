@@ -0,0 +1,945 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Benchmark suite for the library's hot paths.
+//
+// Microbenchmarks cover encoding and decoding of each performance data blob,
+// for both the v1 and v2+ formats.  Macrobenchmarks build a synthetic library
+// of each requested size for each schema family, and then time track creation,
+// snapshots, lookup by id, per-field getters, playlist maintenance, and
+// opening and verifying the library.  The reference libraries under
+// `testdata/ref` are also hydrated and verified.
+//
+// Results are written as JSON, so that runs may be compared across commits.
+//
+// When built as `djinterop_bench_allocations`, every allocation made is also
+// counted by replacing the global allocator, and the number of allocations and
+// bytes allocated per operation are reported alongside timings.  Counting adds
+// to the cost of every allocation, so timings from that build should not be
+// compared with those of the plain `djinterop_bench`.
+//
+// Usage: djinterop_bench [options]
+//
+//   --sizes N[,N...]     Library sizes for macrobenchmarks
+//                        (default 1000,10000,100000).
+//   --backends F[,F...]  Schema families to benchmark, from 1, 2, and 3
+//                        (default 1,2,3).
+//   --filter TEXT        Only run benchmarks whose name contains TEXT.
+//   --repetitions N      Timed repetitions of each benchmark (default 5).
+//   --seed N             Seed for generated data (default 42).
+//   --label TEXT         Free-form label recorded in the output, such as a
+//                        commit hash.
+//   --testdata DIR       Directory containing reference data.
+//   --output FILE        Write results to FILE instead of standard output.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <djinterop/djinterop.hpp>
+#include <djinterop/engine/synthetic_library.hpp>
+#include <djinterop/engine/v2/beat_data_blob.hpp>
+#include <djinterop/engine/v2/loops_blob.hpp>
+#include <djinterop/engine/v2/overview_waveform_data_blob.hpp>
+#include <djinterop/engine/v2/quick_cues_blob.hpp>
+#include <djinterop/engine/v2/track_data_blob.hpp>
+
+#include "djinterop/engine/v1/performance_data_format.hpp"
+
+#ifdef DJINTEROP_BENCH_COUNT_ALLOCATIONS
+#include "counting_allocator.hpp"
+#endif
+
+#define STRINGIFY(x) STRINGIFY_(x)
+#define STRINGIFY_(x) #x
+
+namespace
+{
+namespace e = djinterop::engine;
+namespace ev1 = djinterop::engine::v1;
+namespace ev2 = djinterop::engine::v2;
+namespace fs = std::filesystem;
+using clock_type = std::chrono::steady_clock;
+
+#ifdef DJINTEROP_BENCH_COUNT_ALLOCATIONS
+constexpr bool counts_allocations = true;
+using djinterop::test::allocation_counts;
+using djinterop::test::count_allocations;
+using djinterop::test::current_allocation_counts;
+#else
+constexpr bool counts_allocations = false;
+
+// Allocations are not counted in this build, and so are always reported as
+// zero.
+struct allocation_counts
+{
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+allocation_counts current_allocation_counts() noexcept
+{
+    return {};
+}
+
+template <typename Func>
+allocation_counts count_allocations(Func&& block)
+{
+    block();
+    return {};
+}
+#endif
+
+// Minimum duration of a single timed repetition of a microbenchmark.
+constexpr std::chrono::milliseconds min_micro_duration{50};
+
+// Maximum number of tracks sampled by lookup and getter macrobenchmarks.
+constexpr std::size_t max_sampled_tracks = 1000;
+
+struct options
+{
+    std::vector<std::size_t> sizes{1000, 10000, 100000};
+    std::vector<int> backends{1, 2, 3};
+    std::string filter;
+    int repetitions = 5;
+    uint32_t seed = 42;
+    std::string label;
+    std::string testdata = STRINGIFY(TESTDATA_DIR);
+    std::string output;
+};
+
+struct result
+{
+    std::string name;
+    std::string kind;
+    std::size_t operations;
+    std::size_t bytes_per_operation;
+    std::vector<double> ns_per_operation;
+    allocation_counts allocations{};
+};
+
+/// Time taken and allocations made by a timed run of a benchmark.
+struct measurement
+{
+    clock_type::duration elapsed;
+    allocation_counts allocations;
+};
+
+/// Sink for benchmark outputs, so that the work cannot be optimised away.
+volatile std::size_t sink;
+
+template <typename T>
+std::vector<T> parse_list(const std::string& text)
+{
+    std::vector<T> values;
+    std::istringstream stream{text};
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        values.push_back(static_cast<T>(std::stoull(item)));
+    }
+
+    return values;
+}
+
+options parse_options(int argc, char* argv[])
+{
+    options opts;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            throw std::invalid_argument{"Missing value for option " + arg};
+        }
+
+        std::string value = argv[++i];
+        if (arg == "--sizes")
+            opts.sizes = parse_list<std::size_t>(value);
+        else if (arg == "--backends")
+            opts.backends = parse_list<int>(value);
+        else if (arg == "--filter")
+            opts.filter = value;
+        else if (arg == "--repetitions")
+            opts.repetitions = std::max(1, std::stoi(value));
+        else if (arg == "--seed")
+            opts.seed = static_cast<uint32_t>(std::stoul(value));
+        else if (arg == "--label")
+            opts.label = value;
+        else if (arg == "--testdata")
+            opts.testdata = value;
+        else if (arg == "--output")
+            opts.output = value;
+        else
+            throw std::invalid_argument{"Unrecognised option " + arg};
+    }
+
+    return opts;
+}
+
+std::string json_escape(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        switch (c)
+        {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    std::ostringstream hex;
+                    hex << "\\u" << std::hex << std::setw(4)
+                        << std::setfill('0') << static_cast<int>(c);
+                    escaped += hex.str();
+                }
+                else
+                {
+                    escaped += c;
+                }
+        }
+    }
+
+    return escaped;
+}
+
+void write_json(
+    std::ostream& os, const options& opts, const std::vector<result>& results)
+{
+    os << std::setprecision(12);
+    os << "{\n";
+    os << "  \"label\": \"" << json_escape(opts.label) << "\",\n";
+    os << "  \"seed\": " << opts.seed << ",\n";
+    os << "  \"repetitions\": " << opts.repetitions << ",\n";
+    os << "  \"results\": [";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        auto&& r = results[i];
+        auto samples = r.ns_per_operation;
+        std::sort(samples.begin(), samples.end());
+        double total = 0;
+        for (auto sample : samples)
+        {
+            total += sample;
+        }
+
+        auto mean = total / samples.size();
+        auto median = samples[samples.size() / 2];
+        os << (i == 0 ? "\n" : ",\n");
+        os << "    {\"name\": \"" << json_escape(r.name) << "\", \"kind\": \""
+           << r.kind << "\", \"operations\": " << r.operations
+           << ", \"bytes_per_operation\": " << r.bytes_per_operation
+           << ", \"ns_per_operation\": {\"min\": " << samples.front()
+           << ", \"median\": " << median << ", \"mean\": " << mean
+           << ", \"max\": " << samples.back() << "}";
+        if (r.bytes_per_operation != 0)
+        {
+            os << ", \"mb_per_second\": "
+               << r.bytes_per_operation * 1e3 / median;
+        }
+
+        if constexpr (counts_allocations)
+        {
+            auto operations = static_cast<double>(
+                std::max<std::size_t>(r.operations, 1));
+            os << ", \"allocations_per_operation\": "
+               << r.allocations.allocations / operations
+               << ", \"allocated_bytes_per_operation\": "
+               << r.allocations.bytes / operations;
+        }
+
+        os << "}";
+    }
+
+    os << "\n  ]\n}\n";
+}
+
+/// A temporary directory, removed upon destruction.
+class temporary_directory
+{
+public:
+    explicit temporary_directory(uint32_t seed)
+    {
+        auto now = clock_type::now().time_since_epoch().count();
+        std::mt19937 rng{seed ^ static_cast<uint32_t>(now)};
+        path_ = fs::temp_directory_path() /
+                ("djinterop_bench_" + std::to_string(rng()));
+        fs::create_directories(path_);
+    }
+
+    ~temporary_directory()
+    {
+        std::error_code ec;
+        fs::remove_all(path_, ec);
+    }
+
+    temporary_directory(const temporary_directory&) = delete;
+    temporary_directory& operator=(const temporary_directory&) = delete;
+
+    [[nodiscard]] std::string path() const { return path_.string(); }
+
+private:
+    fs::path path_;
+};
+
+class runner
+{
+public:
+    explicit runner(const options& opts) : opts_{opts} {}
+
+    [[nodiscard]] bool selected(const std::string& name) const
+    {
+        return opts_.filter.empty() ||
+               name.find(opts_.filter) != std::string::npos;
+    }
+
+    /// Run a microbenchmark, repeating the operation enough times per
+    /// repetition to be measured reliably.
+    template <typename F>
+    void micro(const std::string& name, std::size_t bytes, F&& f)
+    {
+        if (!selected(name))
+            return;
+
+        std::size_t iterations = 1;
+        for (;;)
+        {
+            auto elapsed = time(iterations, f).elapsed;
+            if (elapsed >= min_micro_duration || iterations >= (1u << 30))
+                break;
+
+            iterations *= 2;
+        }
+
+        result r{name, "micro", iterations, bytes, {}};
+        for (int rep = 0; rep < opts_.repetitions; ++rep)
+        {
+            auto m = time(iterations, f);
+            r.ns_per_operation.push_back(
+                std::chrono::duration<double, std::nano>(m.elapsed).count() /
+                iterations);
+            r.allocations = m.allocations;
+        }
+
+        report(std::move(r));
+    }
+
+    /// Run a macrobenchmark, in which each call performs `operations`
+    /// operations.  If `repeatable` is false, the benchmark is run once.
+    template <typename F>
+    void macro(
+        const std::string& name, std::size_t operations, bool repeatable,
+        F&& f)
+    {
+        if (!selected(name))
+            return;
+
+        result r{name, "macro", operations, 0, {}};
+        auto reps = repeatable ? opts_.repetitions : 1;
+        for (int rep = 0; rep < reps; ++rep)
+        {
+            auto m = time(1, f);
+            r.ns_per_operation.push_back(
+                std::chrono::duration<double, std::nano>(m.elapsed).count() /
+                std::max<std::size_t>(operations, 1));
+            r.allocations = m.allocations;
+        }
+
+        report(std::move(r));
+    }
+
+    /// Record the result of a macrobenchmark timed by the caller.
+    void record(
+        const std::string& name, std::size_t operations, const measurement& m)
+    {
+        if (!selected(name))
+            return;
+
+        report(result{
+            name,
+            "macro",
+            operations,
+            0,
+            {std::chrono::duration<double, std::nano>(m.elapsed).count() /
+             std::max<std::size_t>(operations, 1)},
+            m.allocations});
+    }
+
+    [[nodiscard]] const std::vector<result>& results() const
+    {
+        return results_;
+    }
+
+private:
+    template <typename F>
+    static measurement time(std::size_t iterations, F& f)
+    {
+        measurement m{};
+        m.allocations = count_allocations(
+            [&]
+            {
+                auto start = clock_type::now();
+                for (std::size_t i = 0; i < iterations; ++i)
+                {
+                    sink = sink + static_cast<std::size_t>(f());
+                }
+
+                m.elapsed = clock_type::now() - start;
+            });
+        return m;
+    }
+
+    void report(result r)
+    {
+        std::cerr << std::left << std::setw(60) << r.name << std::right
+                  << std::setw(14) << std::fixed << std::setprecision(1)
+                  << r.ns_per_operation.front() << " ns/op";
+        if constexpr (counts_allocations)
+        {
+            auto operations =
+                static_cast<double>(std::max<std::size_t>(r.operations, 1));
+            std::cerr << std::setw(12)
+                      << r.allocations.allocations / operations
+                      << " allocs/op";
+        }
+
+        std::cerr << "\n";
+        results_.push_back(std::move(r));
+    }
+
+    const options& opts_;
+    std::vector<result> results_;
+};
+
+/// Generate a representative snapshot of a fully-analysed five-minute track.
+///
+/// The shape of the data mirrors what Engine DJ writes for a real track: a
+/// beatgrid from beat -4, eight hot cues, eight loops, and a waveform of the
+/// size expected by the given schema.
+djinterop::track_snapshot make_template_snapshot(e::engine_schema schema)
+{
+    using namespace std::string_literals;
+    djinterop::track_snapshot s;
+    s.album = "Album"s;
+    s.artist = "Artist"s;
+    s.average_loudness = 0.5;
+    s.bitrate = 320;
+    s.bpm = 123;
+    s.comment = "Comment"s;
+    s.composer = "Composer"s;
+    s.duration = std::chrono::milliseconds{300000};
+    s.file_bytes = 12000000;
+    s.genre = "House"s;
+    s.key = djinterop::musical_key::a_minor;
+    s.last_played_at = std::chrono::system_clock::time_point{
+        std::chrono::seconds{1616548524}};
+    s.main_cue = 1234.5;
+    s.publisher = "Publisher"s;
+    s.rating = 60;
+    s.relative_path = "../Music/track.mp3"s;
+    s.sample_count = 13230000;
+    s.sample_rate = 44100;
+    s.title = "Title"s;
+    s.track_number = 1;
+    s.year = 2021;
+
+    auto samples_per_beat = 44100 * 60 / *s.bpm;
+    s.beatgrid = e::normalize_beatgrid(
+        {{0, 0}, {512, 512 * samples_per_beat}},
+        static_cast<int64_t>(*s.sample_count));
+
+    for (int i = 0; i < 8; ++i)
+    {
+        auto offset = 32 * i * samples_per_beat;
+        s.hot_cues.push_back(djinterop::hot_cue{
+            "Cue " + std::to_string(i + 1), offset,
+            e::standard_pad_colors::pad_1});
+        s.loops.push_back(djinterop::loop{
+            "Loop " + std::to_string(i + 1), offset,
+            offset + 8 * samples_per_beat, e::standard_pad_colors::pad_2});
+    }
+
+    auto extents =
+        schema >= e::engine_schema::schema_2_18_0
+            ? e::calculate_overview_waveform_extents(
+                  *s.sample_count, *s.sample_rate)
+            : e::calculate_high_resolution_waveform_extents(
+                  *s.sample_count, *s.sample_rate);
+    s.waveform.reserve(extents.size);
+    for (unsigned long long i = 0; i < extents.size; ++i)
+    {
+        // A smooth envelope with some texture, which compresses in a similar
+        // way to a real waveform.
+        auto low = static_cast<uint8_t>(128 + 96 * ((i / 7) % 2) + i % 31);
+        auto mid = static_cast<uint8_t>(64 + (i * 13) % 97);
+        auto high = static_cast<uint8_t>(32 + (i * 29) % 61);
+        s.waveform.push_back({{low, 255}, {mid, 255}, {high, 255}});
+    }
+
+    return s;
+}
+
+void run_blob_benchmarks(runner& r)
+{
+    auto v1_snapshot = make_template_snapshot(e::latest_v1_schema);
+    auto v2_snapshot = make_template_snapshot(e::latest_v2_schema);
+    auto sample_rate = *v1_snapshot.sample_rate;
+    auto sample_count = *v1_snapshot.sample_count;
+
+    auto codec = [&r](const std::string& name, auto&& value)
+    {
+        using value_type = std::decay_t<decltype(value)>;
+        auto blob = value.to_blob();
+        r.micro(
+            "blob/v2/" + name + "/to_blob", blob.size(),
+            [&] { return value.to_blob().size(); });
+        r.micro(
+            "blob/v2/" + name + "/from_blob", blob.size(),
+            [&] { return value_type::from_blob(blob).extra_data.size() + 1; });
+    };
+
+    {
+        ev2::beat_data_blob blob{
+            sample_rate, static_cast<double>(sample_count), 1, {}, {}, {}};
+        for (auto&& marker : v2_snapshot.beatgrid)
+        {
+            blob.default_beat_grid.push_back(
+                {marker.sample_offset, marker.index, 0, 0});
+        }
+
+        blob.adjusted_beat_grid = blob.default_beat_grid;
+        codec("beat_data", blob);
+    }
+
+    {
+        ev2::quick_cues_blob blob{{}, 1234.5, true, 1234.5, {}};
+        for (auto&& cue : v2_snapshot.hot_cues)
+        {
+            blob.quick_cues.push_back(
+                {cue->label, cue->sample_offset, cue->color});
+        }
+
+        codec("quick_cues", blob);
+    }
+
+    {
+        ev2::loops_blob blob{};
+        for (auto&& l : v2_snapshot.loops)
+        {
+            blob.loops.push_back(
+                {l->label, l->start_sample_offset, l->end_sample_offset, 1, 1,
+                 l->color});
+        }
+
+        codec("loops", blob);
+    }
+
+    {
+        ev2::overview_waveform_data_blob blob{};
+        blob.samples_per_waveform_point =
+            e::calculate_overview_waveform_extents(sample_count, sample_rate)
+                .samples_per_entry;
+        for (auto&& entry : v2_snapshot.waveform)
+        {
+            blob.waveform_points.push_back(
+                {entry.low.value, entry.mid.value, entry.high.value});
+        }
+
+        blob.maximum_point = {255, 255, 255};
+        codec("overview_waveform_data", blob);
+    }
+
+    {
+        ev2::track_data_blob blob{
+            sample_rate, static_cast<int64_t>(sample_count), 1, 0.5, 0.5, 0.5,
+            {}};
+        codec("track_data", blob);
+    }
+
+    auto v1_codec = [&r](const std::string& name, auto&& value)
+    {
+        using value_type = std::decay_t<decltype(value)>;
+        auto blob = value.encode();
+        r.micro(
+            "blob/v1/" + name + "/encode", blob.size(),
+            [&] { return value.encode().size(); });
+        r.micro(
+            "blob/v1/" + name + "/decode", blob.size(),
+            [&] { return value_type::decode(blob) == value; });
+    };
+
+    v1_codec(
+        "beat_data",
+        ev1::beat_data{
+            sample_rate, static_cast<double>(sample_count),
+            v1_snapshot.beatgrid, v1_snapshot.beatgrid});
+    v1_codec(
+        "high_res_waveform_data",
+        ev1::high_res_waveform_data{
+            e::calculate_high_resolution_waveform_extents(
+                sample_count, sample_rate)
+                .samples_per_entry,
+            v1_snapshot.waveform});
+    v1_codec("loops_data", ev1::loops_data{v1_snapshot.loops});
+    {
+        // The v1 overview waveform is always a fixed-size summary.
+        std::vector<djinterop::waveform_entry> overview(
+            v1_snapshot.waveform.begin(), v1_snapshot.waveform.begin() + 1024);
+        v1_codec(
+            "overview_waveform_data",
+            ev1::overview_waveform_data{
+                e::calculate_overview_waveform_extents(
+                    sample_count, sample_rate)
+                    .samples_per_entry,
+                overview});
+    }
+    v1_codec(
+        "quick_cues_data",
+        ev1::quick_cues_data{v1_snapshot.hot_cues, 1234.5, 1234.5});
+    v1_codec(
+        "track_data",
+        ev1::track_data{
+            sample_rate, static_cast<int64_t>(sample_count), 0.5,
+            djinterop::musical_key::a_minor});
+}
+
+void run_library_benchmarks(
+    runner& r, const options& opts, int family, std::size_t size)
+{
+    auto schema = family == 1   ? e::latest_v1_schema
+                  : family == 2 ? e::latest_v2_schema
+                                : e::latest_v3_schema;
+    auto prefix =
+        "library/" + e::to_string(schema) + "/" + std::to_string(size) + "/";
+
+    // Building a large library is expensive, so skip it entirely if none of
+    // its benchmarks are selected.
+    static const std::vector<std::string> names{
+        "create_track",    "track_by_id",       "snapshot", "get/",
+        "tracks",          "query/",            "search/",  "features/",
+        "similar/",        "duplicates/",       "open",
+        "verify",          "playlist/append",   "playlist/readback"};
+    if (std::none_of(
+            names.begin(), names.end(),
+            [&](const std::string& name)
+            { return r.selected(prefix + name); }))
+    {
+        return;
+    }
+
+    std::mt19937 rng{opts.seed};
+    temporary_directory tmp{opts.seed};
+    auto db = e::create_database(tmp.path(), schema);
+    e::synthetic_track_generator generator{schema, opts.seed, size};
+
+    // Track creation is timed per call, so as to exclude the cost of
+    // generating each snapshot.
+    std::vector<djinterop::track> tracks;
+    tracks.reserve(size);
+    measurement create{};
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        auto snapshot = generator.next();
+        auto before = current_allocation_counts();
+        auto start = clock_type::now();
+        tracks.push_back(db.create_track(snapshot));
+        create.elapsed += clock_type::now() - start;
+        auto after = current_allocation_counts();
+        create.allocations.allocations +=
+            after.allocations - before.allocations;
+        create.allocations.bytes += after.bytes - before.bytes;
+    }
+
+    r.record(prefix + "create_track", size, create);
+
+    std::vector<int64_t> sampled_ids;
+    std::vector<djinterop::track> sampled_tracks;
+    for (std::size_t i = 0; i < std::min(size, max_sampled_tracks); ++i)
+    {
+        auto&& tr = tracks[rng() % tracks.size()];
+        sampled_ids.push_back(tr.id());
+        sampled_tracks.push_back(tr);
+    }
+
+    r.macro(
+        prefix + "track_by_id", sampled_ids.size(), true,
+        [&]
+        {
+            std::size_t found = 0;
+            for (auto id : sampled_ids)
+            {
+                found += db.track_by_id(id) ? 1 : 0;
+            }
+            return found;
+        });
+    r.macro(
+        prefix + "snapshot", sampled_tracks.size(), true,
+        [&]
+        {
+            std::size_t total = 0;
+            for (auto&& tr : sampled_tracks)
+            {
+                total += tr.snapshot().waveform.size();
+            }
+            return total;
+        });
+
+    auto getter = [&](const std::string& field, auto&& get)
+    {
+        r.macro(
+            prefix + "get/" + field, sampled_tracks.size(), true,
+            [&]
+            {
+                std::size_t total = 0;
+                for (auto&& tr : sampled_tracks)
+                {
+                    total += get(tr);
+                }
+                return total;
+            });
+    };
+
+    getter("title", [](auto&& tr) { return tr.title()->size(); });
+    getter("artist", [](auto&& tr) { return tr.artist()->size(); });
+    getter("bpm", [](auto&& tr) { return tr.bpm() ? 1 : 0; });
+    getter("key", [](auto&& tr) { return tr.key() ? 1 : 0; });
+    getter("duration", [](auto&& tr) { return tr.duration() ? 1 : 0; });
+    getter("beatgrid", [](auto&& tr) { return tr.beatgrid().size(); });
+    getter("hot_cue_at", [](auto&& tr) { return tr.hot_cue_at(3) ? 1 : 0; });
+    getter("hot_cues", [](auto&& tr) { return tr.hot_cues().size(); });
+    getter("loops", [](auto&& tr) { return tr.loops().size(); });
+    getter("waveform", [](auto&& tr) { return tr.waveform().size(); });
+
+    r.macro(
+        prefix + "tracks", size, true, [&] { return db.tracks().size(); });
+
+    // A typical smart crate: tracks of one genre within a tempo range, most
+    // recently added first.
+    auto genre = sampled_tracks.front().genre().value_or("House");
+    auto smart_crate = db.query()
+                           .bpm_between(120, 128)
+                           .genre(genre)
+                           .order_by(djinterop::track_order::date_added, true)
+                           .limit(100);
+    r.macro(
+        prefix + "query/ids", 1, true,
+        [&] { return smart_crate.ids().size(); });
+    r.macro(
+        prefix + "query/rows", 1, true,
+        [&] { return smart_crate.rows().size(); });
+
+    // Search-as-you-type for the title of a track.  The first search builds
+    // the full-text index, and then each keystroke extends the search text by
+    // one character.
+    auto search_text = sampled_tracks.front().title().value_or("Track");
+    r.macro(
+        prefix + "search/build", 1, false,
+        [&] { return db.search(search_text.substr(0, 1), 20).size(); });
+    r.macro(
+        prefix + "search/type", search_text.size(), true,
+        [&]
+        {
+            std::size_t total = 0;
+            for (std::size_t i = 1; i <= search_text.size(); ++i)
+            {
+                total += db.search(search_text.substr(0, i), 20).size();
+            }
+            return total;
+        });
+
+    // Harmonic mixing suggestions for a sample of tracks, against an index
+    // loaded once and then brought up to date after each edit.
+    r.macro(
+        prefix + "features/load", size, false,
+        [&] { return db.feature_index()->size(); });
+    r.macro(
+        prefix + "features/compatible", sampled_ids.size(), true,
+        [&]
+        {
+            auto index = db.feature_index();
+            std::size_t total = 0;
+            for (auto id : sampled_ids)
+            {
+                total += index->compatible_with(id).count();
+            }
+            return total;
+        });
+    r.macro(
+        prefix + "features/refresh", 1, true,
+        [&]
+        {
+            auto&& tr = sampled_tracks.front();
+            tr.set_bpm(tr.bpm().value_or(120) + 1);
+            return db.feature_index()->size();
+        });
+
+    // Similar-track suggestions, singly and as a batch, against an index
+    // built once and then brought up to date after each edit.
+    r.macro(
+        prefix + "similar/build", size, false,
+        [&] { return db.similar_tracks(sampled_tracks.front()).size(); });
+    r.macro(
+        prefix + "similar/nearest", sampled_tracks.size(), true,
+        [&]
+        {
+            std::size_t total = 0;
+            for (auto&& tr : sampled_tracks)
+            {
+                total += db.similar_tracks(tr).size();
+            }
+            return total;
+        });
+    r.macro(
+        prefix + "similar/batch", sampled_tracks.size(), true,
+        [&]
+        {
+            std::size_t total = 0;
+            for (auto&& ids : db.similar_tracks(sampled_tracks))
+            {
+                total += ids.size();
+            }
+            return total;
+        });
+    r.macro(
+        prefix + "similar/refresh", 1, true,
+        [&]
+        {
+            auto&& tr = sampled_tracks.front();
+            tr.set_bpm(tr.bpm().value_or(120) + 1);
+            return db.similar_tracks(tr).size();
+        });
+
+    // Duplicate detection over the whole library, by file and by metadata.
+    r.macro(
+        prefix + "duplicates/file", size, false,
+        [&] { return db.find_duplicates().size(); });
+    r.macro(
+        prefix + "duplicates/metadata", size, false,
+        [&]
+        {
+            djinterop::duplicate_policy policy;
+            policy.match_metadata = true;
+            return db.find_duplicates(policy).size();
+        });
+
+    auto playlist = db.create_root_playlist("Benchmark");
+    r.macro(
+        prefix + "playlist/append", size, false,
+        [&]
+        {
+            playlist.add_tracks_back(tracks.begin(), tracks.end());
+            return tracks.size();
+        });
+    r.macro(
+        prefix + "playlist/readback", size, true,
+        [&] { return playlist.tracks().size(); });
+
+    r.macro(
+        prefix + "open", 1, true,
+        [&] { return e::load_database(tmp.path()).uuid().size(); });
+    r.macro(
+        prefix + "verify", 1, true,
+        [&]
+        {
+            db.verify();
+            return 1;
+        });
+}
+
+void run_reference_benchmarks(runner& r, const options& opts)
+{
+    // One representative reference library per schema family.
+    const std::vector<std::pair<int, std::string>> ref_script_dirs{
+        {1, "ref/engine/sc5000/firmware-1.6.2"},
+        {2, "ref/engine/desktop/desktop-2.4.0"},
+        {3, "ref/engine/desktop/desktop-4.3.4"},
+    };
+
+    for (auto&& [family, dir] : ref_script_dirs)
+    {
+        if (std::find(opts.backends.begin(), opts.backends.end(), family) ==
+            opts.backends.end())
+        {
+            continue;
+        }
+
+        auto script_path = (fs::path{opts.testdata} / dir).string();
+        r.macro(
+            dir + "/create_and_verify", 1, true,
+            [&]
+            {
+                temporary_directory tmp{opts.seed};
+                auto db = e::create_database_from_scripts(
+                    tmp.path(), script_path);
+                db.verify();
+                return 1;
+            });
+    }
+}
+}  // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        auto opts = parse_options(argc, argv);
+        runner r{opts};
+
+        run_blob_benchmarks(r);
+        run_reference_benchmarks(r, opts);
+        for (auto family : opts.backends)
+        {
+            for (auto size : opts.sizes)
+            {
+                run_library_benchmarks(r, opts, family, size);
+            }
+        }
+
+        if (opts.output.empty())
+        {
+            write_json(std::cout, opts, r.results());
+        }
+        else
+        {
+            std::ofstream out{opts.output};
+            write_json(out, opts, r.results());
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "djinterop_bench: " << ex.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
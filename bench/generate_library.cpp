@@ -0,0 +1,135 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Generate a synthetic Engine library, for scale testing.
+//
+// Usage: djinterop_generate_library DIRECTORY [options]
+//
+//   --schema VERSION        Schema version, e.g. 2.21.2 (default latest).
+//   --tracks N              Number of tracks (default 1000).
+//   --playlists N           Number of playlists (default 100).
+//   --crates N              Number of crates, where distinct from playlists
+//                           (default 100).
+//   --depth N               Maximum depth of playlist and crate trees
+//                           (default 5).
+//   --mean-size N           Mean number of tracks per playlist or crate
+//                           (default 50).
+//   --seed N                Seed for generated data (default 1).
+//   --no-performance-data   Do not generate beatgrids, cues, loops, or
+//                           waveforms.
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <djinterop/engine/engine_schema.hpp>
+#include <djinterop/engine/synthetic_library.hpp>
+
+namespace
+{
+namespace e = djinterop::engine;
+
+e::engine_schema parse_schema(const std::string& text)
+{
+    for (auto&& schema : e::supported_schemas)
+    {
+        if (e::to_string(schema) == text)
+            return schema;
+    }
+
+    throw std::invalid_argument{"Unsupported schema version " + text};
+}
+
+std::size_t parse_count(const std::string& text)
+{
+    return static_cast<std::size_t>(std::stoull(text));
+}
+}  // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " DIRECTORY [options]\n";
+        return 2;
+    }
+
+    try
+    {
+        std::string directory = argv[1];
+        e::synthetic_library_options options;
+        for (int i = 2; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--no-performance-data")
+            {
+                options.performance_data = false;
+                continue;
+            }
+
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument{"Missing value for option " + arg};
+            }
+
+            std::string value = argv[++i];
+            if (arg == "--schema")
+                options.schema = parse_schema(value);
+            else if (arg == "--tracks")
+                options.track_count = parse_count(value);
+            else if (arg == "--playlists")
+                options.playlist_count = parse_count(value);
+            else if (arg == "--crates")
+                options.crate_count = parse_count(value);
+            else if (arg == "--depth")
+                options.max_depth = parse_count(value);
+            else if (arg == "--mean-size")
+                options.mean_container_size = parse_count(value);
+            else if (arg == "--seed")
+                options.seed = std::stoull(value);
+            else
+                throw std::invalid_argument{"Unrecognised option " + arg};
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        options.on_progress = [](const e::synthetic_library_progress& p)
+        {
+            std::cerr << "\rTracks " << p.tracks_done << "/" << p.tracks_total
+                      << ", playlists " << p.playlists_done << "/"
+                      << p.playlists_total << ", crates " << p.crates_done
+                      << "/" << p.crates_total << std::flush;
+        };
+
+        e::create_synthetic_library(directory, options);
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        std::cerr << "\nGenerated " << e::to_string(options.schema)
+                  << " library in " << directory << " in " << elapsed.count()
+                  << " s\n";
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "\ndjinterop_generate_library: " << ex.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
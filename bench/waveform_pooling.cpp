@@ -0,0 +1,142 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Benchmark of overview waveform generation from a high-resolution waveform,
+// comparing the original point-sampling approach against window pooling.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <djinterop/engine/engine.hpp>
+#include <djinterop/performance_data.hpp>
+
+#include "djinterop/util/waveform_pooling.hpp"
+
+namespace
+{
+using clock_type = std::chrono::steady_clock;
+
+std::vector<djinterop::waveform_entry> make_waveform(
+    std::size_t size, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> dist{0, 255};
+    std::vector<djinterop::waveform_entry> waveform;
+    waveform.reserve(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        waveform.push_back(djinterop::waveform_entry{
+            {static_cast<uint8_t>(dist(rng)), 255},
+            {static_cast<uint8_t>(dist(rng)), 255},
+            {static_cast<uint8_t>(dist(rng)), 255}});
+    }
+
+    return waveform;
+}
+
+/// The overview conversion as originally implemented, picking one input
+/// entry per output entry.
+std::vector<djinterop::waveform_entry> point_sample(
+    const std::vector<djinterop::waveform_entry>& w, std::size_t size)
+{
+    std::vector<djinterop::waveform_entry> result;
+    result.reserve(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        result.push_back(w[w.size() * (2 * i + 1) / (2 * size)]);
+    }
+
+    return result;
+}
+
+template <typename F>
+void run(
+    const std::string& name,
+    const std::vector<std::vector<djinterop::waveform_entry>>& waveforms,
+    std::size_t input_entries, F&& f)
+{
+    // Accumulate a checksum, so that the work cannot be optimised away.
+    uint64_t checksum = 0;
+    auto start = clock_type::now();
+    for (auto&& w : waveforms)
+    {
+        auto overview = f(w);
+        checksum += overview[overview.size() / 2].low.value;
+    }
+
+    auto elapsed = std::chrono::duration<double>(clock_type::now() - start);
+    auto per_track_us = elapsed.count() * 1e6 / waveforms.size();
+    auto entries_per_second = input_entries / elapsed.count();
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::setw(12) << std::fixed << std::setprecision(2)
+              << per_track_us << " us/track" << std::setw(14)
+              << std::setprecision(1) << entries_per_second / 1e6
+              << " M entries/s  (checksum " << checksum << ")\n";
+}
+}  // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    // Simulate importing a library of tracks of a typical length.
+    std::size_t track_count =
+        argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    constexpr unsigned long long sample_rate = 44100;
+    constexpr unsigned long long sample_count = sample_rate * 60 * 6;
+
+    auto high_res_extents =
+        djinterop::engine::calculate_high_resolution_waveform_extents(
+            sample_count, sample_rate);
+    auto overview_extents =
+        djinterop::engine::calculate_overview_waveform_extents(
+            sample_count, sample_rate);
+
+    std::mt19937 rng{42};
+    std::vector<std::vector<djinterop::waveform_entry>> waveforms;
+    waveforms.reserve(track_count);
+    for (std::size_t i = 0; i < track_count; ++i)
+    {
+        waveforms.push_back(make_waveform(high_res_extents.size, rng));
+    }
+
+    auto input_entries = track_count * high_res_extents.size;
+    auto size = overview_extents.size;
+    std::cout << track_count << " tracks, " << high_res_extents.size
+              << " high-resolution entries to " << size
+              << " overview entries per track\n";
+
+    run("point_sample", waveforms, input_entries,
+        [&](const auto& w) { return point_sample(w, size); });
+    run("max_pool", waveforms, input_entries,
+        [&](const auto& w)
+        {
+            return djinterop::util::pool_waveform(
+                w, size, djinterop::util::waveform_pooling::max);
+        });
+    run("rms_pool", waveforms, input_entries,
+        [&](const auto& w)
+        {
+            return djinterop::util::pool_waveform(
+                w, size, djinterop::util::waveform_pooling::rms);
+        });
+
+    return 0;
+}
@@ -0,0 +1,197 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_ANALYSIS_BEATGRID_INDEX_HPP
+#define DJINTEROP_ANALYSIS_BEATGRID_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/engine/v2/beat_data_blob.hpp>
+#include <djinterop/performance_data.hpp>
+
+namespace djinterop::analysis
+{
+/// The `beatgrid_index` class answers positional queries against a beatgrid.
+///
+/// A beatgrid is a list of markers, each of which fixes a beat number to a
+/// sample offset, with beats between consecutive markers assumed to occur at
+/// a constant tempo.  The index precomputes the tempo of each segment between
+/// markers, so that conversions between sample offsets and (fractional) beat
+/// numbers are a binary search followed by a linear interpolation.  Positions
+/// before the first marker or after the last marker are extrapolated using
+/// the tempo of the first or last segment respectively.
+///
+/// Each query also has a batch form, operating on a span of positions.  The
+/// batch forms reuse the segment found for the previous position where
+/// possible, and so are linear in the number of positions when the positions
+/// are sorted.
+class DJINTEROP_PUBLIC beatgrid_index
+{
+public:
+    /// Construct a beatgrid index from a list of beatgrid markers.
+    ///
+    /// \param markers Beatgrid markers, in ascending order of both beat index
+    ///                and sample offset.
+    /// \param beats_per_bar Number of beats in a bar, used to identify
+    ///                      downbeats.  Beat zero is always a downbeat.
+    /// \throws std::invalid_argument If there are fewer than two markers, the
+    ///                               markers are not strictly ascending, or
+    ///                               the number of beats per bar is not
+    ///                               positive.
+    explicit beatgrid_index(
+        std::span<const beatgrid_marker> markers, int beats_per_bar = 4);
+
+    /// Construct a beatgrid index from a beat grid in a beat data blob, such
+    /// as `engine::v2::beat_data_blob::adjusted_beat_grid`.
+    ///
+    /// \param markers Beat grid markers, in ascending order of both beat
+    ///                number and sample offset.
+    /// \param beats_per_bar Number of beats in a bar, used to identify
+    ///                      downbeats.  Beat zero is always a downbeat.
+    /// \throws std::invalid_argument If there are fewer than two markers, the
+    ///                               markers are not strictly ascending, or
+    ///                               the number of beats per bar is not
+    ///                               positive.
+    explicit beatgrid_index(
+        std::span<const engine::v2::beat_grid_marker_blob> markers,
+        int beats_per_bar = 4);
+
+    /// Construct a beatgrid index from a view over the beat grid of an
+    /// uncompressed beat data blob.
+    ///
+    /// \param markers View over beat grid markers.
+    /// \param beats_per_bar Number of beats in a bar, used to identify
+    ///                      downbeats.  Beat zero is always a downbeat.
+    /// \throws std::invalid_argument If there are fewer than two markers, the
+    ///                               markers are not strictly ascending, or
+    ///                               the number of beats per bar is not
+    ///                               positive.
+    explicit beatgrid_index(
+        const engine::v2::beat_grid_view& markers, int beats_per_bar = 4);
+
+    /// Get the number of markers in the beatgrid.
+    [[nodiscard]] std::size_t size() const noexcept { return beats_.size(); }
+
+    /// Get the number of beats in a bar.
+    [[nodiscard]] int beats_per_bar() const noexcept { return beats_per_bar_; }
+
+    /// Get the beat number at a given sample offset.
+    ///
+    /// \param sample_offset Sample offset within the track.
+    /// \return Returns the beat number, including the fractional position
+    ///         between the two surrounding beats.
+    [[nodiscard]] double beat_at(double sample_offset) const noexcept;
+
+    /// Get the sample offset of a given beat number.
+    ///
+    /// \param beat Beat number, which may be fractional.
+    /// \return Returns the sample offset of the beat.
+    [[nodiscard]] double sample_offset_of(double beat) const noexcept;
+
+    /// Get the number of samples per beat at a given sample offset.
+    ///
+    /// \param sample_offset Sample offset within the track.
+    /// \return Returns the number of samples per beat of the segment
+    ///         containing the sample offset.
+    [[nodiscard]] double samples_per_beat_at(
+        double sample_offset) const noexcept;
+
+    /// Get the sample offset of the downbeat nearest to a given sample offset.
+    ///
+    /// \param sample_offset Sample offset within the track.
+    /// \return Returns the sample offset of the nearest downbeat.
+    [[nodiscard]] double nearest_downbeat(double sample_offset) const noexcept;
+
+    /// Quantize a sample offset to the grid.
+    ///
+    /// \param sample_offset Sample offset within the track.
+    /// \param subdivisions Number of grid lines per beat, e.g. `1` to snap to
+    ///                     whole beats, or `4` to snap to sixteenth notes in
+    ///                     common time.
+    /// \return Returns the sample offset of the nearest grid line.
+    /// \throws std::invalid_argument If the number of subdivisions is not
+    ///                               positive.
+    [[nodiscard]] double quantize(
+        double sample_offset, int subdivisions = 1) const;
+
+    /// Get the beat numbers at a set of sample offsets.
+    ///
+    /// \param sample_offsets Sample offsets within the track.
+    /// \param beats Output span, of the same size as `sample_offsets`.
+    /// \throws std::invalid_argument If the spans differ in size.
+    void beats_at(
+        std::span<const double> sample_offsets, std::span<double> beats) const;
+
+    /// Get the sample offsets of a set of beat numbers.
+    ///
+    /// \param beats Beat numbers, which may be fractional.
+    /// \param sample_offsets Output span, of the same size as `beats`.
+    /// \throws std::invalid_argument If the spans differ in size.
+    void sample_offsets_of(
+        std::span<const double> beats, std::span<double> sample_offsets) const;
+
+    /// Get the sample offsets of the downbeats nearest to a set of sample
+    /// offsets.
+    ///
+    /// \param sample_offsets Sample offsets within the track.
+    /// \param downbeats Output span, of the same size as `sample_offsets`.
+    /// \throws std::invalid_argument If the spans differ in size.
+    void nearest_downbeats(
+        std::span<const double> sample_offsets,
+        std::span<double> downbeats) const;
+
+    /// Quantize a set of sample offsets to the grid.
+    ///
+    /// \param sample_offsets Sample offsets within the track.
+    /// \param quantized Output span, of the same size as `sample_offsets`.
+    ///                  It is permissible for this to be the same span as
+    ///                  `sample_offsets`, in order to quantize in place.
+    /// \param subdivisions Number of grid lines per beat.
+    /// \throws std::invalid_argument If the spans differ in size, or the
+    ///                               number of subdivisions is not positive.
+    void quantize(
+        std::span<const double> sample_offsets, std::span<double> quantized,
+        int subdivisions = 1) const;
+
+private:
+    void build(int beats_per_bar);
+    [[nodiscard]] std::size_t segment_by_sample(
+        double sample_offset) const noexcept;
+    [[nodiscard]] std::size_t segment_by_beat(double beat) const noexcept;
+    [[nodiscard]] std::size_t segment_by_sample(
+        double sample_offset, std::size_t hint) const noexcept;
+    [[nodiscard]] std::size_t segment_by_beat(
+        double beat, std::size_t hint) const noexcept;
+    [[nodiscard]] double beat_in(
+        std::size_t segment, double sample_offset) const noexcept;
+    [[nodiscard]] double sample_offset_in(
+        std::size_t segment, double beat) const noexcept;
+
+    std::vector<double> beats_;
+    std::vector<double> sample_offsets_;
+    std::vector<double> samples_per_beat_;
+    int beats_per_bar_ = 4;
+};
+
+}  // namespace djinterop::analysis
+
+#endif  // DJINTEROP_ANALYSIS_BEATGRID_INDEX_HPP
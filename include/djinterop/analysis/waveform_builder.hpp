@@ -0,0 +1,128 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_ANALYSIS_WAVEFORM_BUILDER_HPP
+#define DJINTEROP_ANALYSIS_WAVEFORM_BUILDER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/performance_data.hpp>
+
+namespace djinterop::analysis
+{
+/// The `waveform_builder` class generates a waveform from decoded PCM audio.
+///
+/// Audio is supplied incrementally, as blocks of interleaved samples, in
+/// either floating-point or 16-bit integer form.  The audio is mixed down to
+/// mono and split into low, mid, and high frequency bands, and the peak
+/// amplitude of each band is emitted once every `samples_per_entry()` frames.
+/// This matches the resolution expected for a high-resolution waveform, as
+/// described by `engine::calculate_high_resolution_waveform_extents()`, and
+/// so the waveform built from a complete track has exactly as many entries as
+/// those extents indicate.
+///
+/// Decoding of audio files is not performed by this library, and is the
+/// responsibility of the caller.
+class DJINTEROP_PUBLIC waveform_builder
+{
+public:
+    /// Construct a waveform builder.
+    ///
+    /// \param sample_rate Sample rate of the audio, in Hz.
+    /// \param channels Number of interleaved channels in the audio.
+    /// \throws std::invalid_argument If the sample rate is too low to yield a
+    ///                               waveform, or there are no channels.
+    waveform_builder(double sample_rate, unsigned int channels);
+
+    /// Move constructor.
+    waveform_builder(waveform_builder&& other) noexcept;
+
+    /// Destructor.
+    ~waveform_builder();
+
+    /// Move assignment operator.
+    waveform_builder& operator=(waveform_builder&& other) noexcept;
+
+    /// Append a block of interleaved floating-point samples, nominally in the
+    /// range `-1.0` to `1.0`.
+    ///
+    /// \param samples Pointer to `frame_count * channels` samples.
+    /// \param frame_count Number of frames in the block.
+    void append(const float* samples, std::size_t frame_count);
+
+    /// Append a block of interleaved 16-bit integer samples.
+    ///
+    /// \param samples Pointer to `frame_count * channels` samples.
+    /// \param frame_count Number of frames in the block.
+    void append(const int16_t* samples, std::size_t frame_count);
+
+    /// Get the number of frames of audio that each waveform entry represents.
+    [[nodiscard]] std::size_t samples_per_entry() const noexcept;
+
+    /// Get the total number of frames appended so far.
+    [[nodiscard]] unsigned long long sample_count() const noexcept;
+
+    /// Finish building the waveform.
+    ///
+    /// Any trailing partial entry is emitted, and the builder is reset so
+    /// that it may be reused for another track of the same format.
+    ///
+    /// \return Returns the waveform.
+    std::vector<waveform_entry> finish();
+
+private:
+    class impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+/// A track whose waveform is to be built by `build_waveforms()`.
+struct DJINTEROP_PUBLIC waveform_job
+{
+    /// Sample rate of the decoded audio, in Hz.
+    double sample_rate;
+
+    /// Number of interleaved channels in the decoded audio.
+    unsigned int channels;
+
+    /// Function that decodes the track, and appends all of its audio to the
+    /// supplied builder.
+    std::function<void(waveform_builder&)> decode;
+};
+
+/// Build the waveforms of several tracks in parallel.
+///
+/// Each job is run on one of a bounded number of worker threads, and so the
+/// decode function of each job must be safe to call concurrently with those
+/// of other jobs.  If any job throws, the remaining jobs are abandoned and
+/// the first exception is rethrown once all workers have stopped.
+///
+/// \param jobs Tracks to analyse.
+/// \param max_workers Maximum number of tracks to analyse at once, or zero
+///                    to use the number of hardware threads available.
+/// \return Returns one waveform per job, in the same order.
+std::vector<std::vector<waveform_entry>> DJINTEROP_PUBLIC build_waveforms(
+    const std::vector<waveform_job>& jobs, std::size_t max_workers = 0);
+
+}  // namespace djinterop::analysis
+
+#endif  // DJINTEROP_ANALYSIS_WAVEFORM_BUILDER_HPP
@@ -19,6 +19,7 @@
 #ifndef DJINTEROP_DATABASE_HPP
 #define DJINTEROP_DATABASE_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -27,6 +28,12 @@
 #include <vector>
 
 #include <djinterop/config.hpp>
+#include <djinterop/database_metrics.hpp>
+#include <djinterop/sql_observer.hpp>
+#include <djinterop/track_duplicates.hpp>
+#include <djinterop/track_feature_index.hpp>
+#include <djinterop/track_query.hpp>
+#include <djinterop/track_similarity_index.hpp>
 
 namespace djinterop
 {
@@ -95,11 +102,126 @@ public:
     /// snapshot.
     track create_track(const track_snapshot& snapshot);
 
+    /// Create new tracks in the database, given pre-populated track
+    /// snapshots.
+    ///
+    /// All of the tracks are created in a single transaction, which is much
+    /// faster than creating them one at a time.  If any track cannot be
+    /// created, then none are.
+    ///
+    /// \param snapshots Snapshots of the tracks to create.
+    /// \return Returns the created tracks, in the order of their snapshots.
+    std::vector<track> create_tracks(
+        const std::vector<track_snapshot>& snapshots);
+
     /// Returns the path directory of the database
     ///
     /// This is the same as the directory passed to the `database` constructor.
     std::string directory() const;
 
+    /// Returns a snapshot of the counters describing work done by the library
+    /// on this database.
+    ///
+    /// Statements, rows read and transactions are only counted while SQL
+    /// metrics are enabled with `set_metrics_enabled()`.
+    database_metrics metrics() const;
+
+    /// Begin a query over the tracks in the database.
+    ///
+    /// The returned query may be refined with filters, ordering, and a limit,
+    /// and is answered by a single SQL statement when run.
+    track_query query() const;
+
+    /// Search the text metadata of the tracks in the database.
+    ///
+    /// Every word of the search text must match the start of a word in the
+    /// title, artist, album, genre, or comment of a track, ignoring case and
+    /// diacritics.  The first search builds a full-text index, kept in a file
+    /// alongside the database where possible, which is then updated as tracks
+    /// change.  The database itself is not altered.
+    ///
+    /// If very many tracks match, as may happen for the first letter or two of
+    /// a search, then only the most recently added of them are ranked.
+    ///
+    /// \param text Text for which to search.
+    /// \param limit Maximum number of results.
+    /// \return Returns the ids of matching tracks, most relevant first.
+    /// \throws unsupported_operation If the SQLite library in use does not
+    ///         support full-text search.
+    std::vector<int64_t> search(
+        const std::string& text, std::size_t limit = 100) const;
+
+    /// Get an in-memory index of the musical features of the tracks in the
+    /// database, against which predicates can be evaluated quickly.
+    ///
+    /// The first call loads the features of every track.  Later calls return
+    /// the same index if nothing has changed, or else an index that has been
+    /// brought up to date incrementally where the database records which
+    /// tracks have changed.  An index that has been returned is never
+    /// modified, and so remains valid as a snapshot.
+    ///
+    /// \return Returns an index that is up to date with the database.
+    std::shared_ptr<const track_feature_index> feature_index() const;
+
+    /// Find the tracks in the database most similar to a given track, by
+    /// tempo, key, loudness, duration, and genre.
+    ///
+    /// See `track_similarity_index` for how similarity is measured.  The
+    /// first call builds an index over every track, which later calls bring
+    /// up to date incrementally.
+    ///
+    /// \param tr Track for which to find similar tracks.
+    /// \param k Maximum number of tracks to find.
+    /// \return Returns the ids of the most similar tracks, nearest first, not
+    ///         including the given track.  If the given track has no BPM, no
+    ///         tracks are returned.
+    /// \throws track_deleted If the track does not exist in the database.
+    std::vector<int64_t> similar_tracks(
+        const track& tr, std::size_t k = 10) const;
+
+    /// Find the tracks in the database most similar to each of a set of
+    /// tracks.
+    ///
+    /// Searches are spread across a number of worker threads.
+    ///
+    /// \param tracks Tracks for which to find similar tracks.
+    /// \param k Maximum number of tracks to find for each track.
+    /// \param max_workers Maximum number of worker threads, or zero to use
+    ///                    the number of hardware threads.
+    /// \return Returns, for each given track in turn, the ids of the most
+    ///         similar tracks, as per `similar_tracks()`.
+    /// \throws track_deleted If any track does not exist in the database.
+    std::vector<std::vector<int64_t>> similar_tracks(
+        const std::vector<track>& tracks, std::size_t k = 10,
+        std::size_t max_workers = 0) const;
+
+    /// Find groups of tracks in the database that are duplicates of one
+    /// another.
+    ///
+    /// The tracks are read in a single scan, and grouped by hashing the keys
+    /// enabled by the policy.  A survivor is suggested for each group, which
+    /// may be passed as is to `merge_duplicates()`.
+    ///
+    /// \param policy Policy determining which tracks are duplicates.
+    /// \return Returns the groups of duplicates, in order of their first
+    ///         track.
+    /// \throws std::invalid_argument If the duration tolerance is negative.
+    std::vector<duplicate_group> find_duplicates(
+        const duplicate_policy& policy = {}) const;
+
+    /// Merge groups of duplicate tracks into their survivors.
+    ///
+    /// Each duplicate is replaced by its survivor in every playlist and crate
+    /// that holds it, unless the survivor is already there, and is then
+    /// removed from the database.  All groups are merged in one transaction,
+    /// so that either all or none of them are merged.
+    ///
+    /// \param groups Groups of duplicates to merge.
+    /// \throws std::invalid_argument If the survivor of a group is not among
+    ///         its tracks, or a track appears in more than one group.
+    /// \throws track_deleted If a track does not exist in the database.
+    void merge_duplicates(const std::vector<duplicate_group>& groups) const;
+
     /// Returns the UUID of the database
     std::string uuid() const;
 
@@ -145,6 +267,25 @@ public:
     /// If no such playlist exists, then `std::nullopt` is returned.
     std::optional<playlist> root_playlist_by_name(const std::string& name) const;
 
+    /// Set an observer to be notified of every SQL statement run against the
+    /// database, or remove the current observer.
+    ///
+    /// Only one observer may be set at a time.  Statements are only timed and
+    /// reported while an observer is set.
+    ///
+    /// \param observer Observer to set, or `nullptr` to remove it.
+    void set_observer(std::shared_ptr<sql_observer> observer) const;
+
+    /// Enable or disable the counting of SQL statements, rows read and
+    /// transactions committed, as reported by `metrics()`.
+    ///
+    /// Counting needs a callback from SQLite for every statement and every
+    /// row, and so is disabled by default.  Counters keep their values while
+    /// counting is disabled.
+    ///
+    /// \param enabled Whether counting is enabled.
+    void set_metrics_enabled(bool enabled) const;
+
     /// Returns the track with the given id
     ///
     /// If no such track exists in the database, then `std::nullopt`
@@ -0,0 +1,118 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_DATABASE_METRICS_HPP
+#define DJINTEROP_DATABASE_METRICS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <djinterop/config.hpp>
+
+namespace djinterop
+{
+/// Enumeration of the kinds of performance data blob stored by Engine.
+enum class blob_type : size_t
+{
+    track_data,
+    beat_data,
+    quick_cues,
+    loops,
+    overview_waveform,
+    high_res_waveform,
+};
+
+/// Number of distinct values of `blob_type`.
+constexpr std::size_t blob_type_count = 6;
+
+/// The `blob_metrics` struct holds counters for the encoding and decoding of
+/// one kind of performance data blob.
+struct DJINTEROP_PUBLIC blob_metrics
+{
+    /// Number of blobs encoded.
+    uint64_t encoded = 0;
+
+    /// Number of blobs decoded.
+    uint64_t decoded = 0;
+
+    /// Total size of all blobs encoded or decoded, as stored.
+    uint64_t compressed_bytes = 0;
+
+    /// Total size of all blobs encoded or decoded, after decompression.
+    ///
+    /// This is equal to `compressed_bytes` for blobs that are not compressed.
+    uint64_t uncompressed_bytes = 0;
+
+    /// Total time spent encoding blobs, including compression.
+    std::chrono::nanoseconds encode_time{};
+
+    /// Total time spent decoding blobs, including decompression.
+    std::chrono::nanoseconds decode_time{};
+};
+
+/// The `database_metrics` struct holds a snapshot of counters describing the
+/// work done by the library.
+///
+/// SQL counters are specific to the database from which the snapshot was
+/// taken.  Rows written are counted from when the database was opened, and
+/// the other SQL counters only while SQL metrics are enabled on it.  Blob and
+/// zlib counters are always collected, and are process-wide, since blob codecs
+/// are not tied to any one database.
+struct DJINTEROP_PUBLIC database_metrics
+{
+    /// Number of distinct prepared statements that have been executed.
+    uint64_t statements_prepared = 0;
+
+    /// Number of statement executions, including re-executions of a
+    /// previously-prepared statement.
+    uint64_t statements_executed = 0;
+
+    /// Number of result rows read.
+    uint64_t rows_read = 0;
+
+    /// Number of rows inserted, updated or deleted.
+    uint64_t rows_written = 0;
+
+    /// Number of transactions committed, including implicit transactions
+    /// around individual statements.
+    uint64_t transactions_committed = 0;
+
+    /// Total time spent compressing data with zlib.
+    std::chrono::nanoseconds zlib_compress_time{};
+
+    /// Total time spent decompressing data with zlib.
+    std::chrono::nanoseconds zlib_uncompress_time{};
+
+    /// Counters for each kind of blob, indexed by `blob_type`.
+    std::array<blob_metrics, blob_type_count> blobs{};
+
+    /// Get the counters for a given kind of blob.
+    ///
+    /// \param type Kind of blob.
+    /// \return Returns the blob counters.
+    [[nodiscard]] const blob_metrics& blob(blob_type type) const noexcept
+    {
+        return blobs[static_cast<std::size_t>(type)];
+    }
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_DATABASE_METRICS_HPP
@@ -22,8 +22,11 @@
 #include <djinterop/config.hpp>
 
 #include <djinterop/album_art.hpp>
+#include <djinterop/analysis/beatgrid_index.hpp>
+#include <djinterop/analysis/waveform_builder.hpp>
 #include <djinterop/crate.hpp>
 #include <djinterop/database.hpp>
+#include <djinterop/database_metrics.hpp>
 #include <djinterop/engine/engine.hpp>
 #include <djinterop/exceptions.hpp>
 #include <djinterop/musical_key.hpp>
@@ -31,7 +34,12 @@
 #include <djinterop/performance_data.hpp>
 #include <djinterop/playlist.hpp>
 #include <djinterop/semantic_version.hpp>
+#include <djinterop/sql_observer.hpp>
 #include <djinterop/track.hpp>
+#include <djinterop/track_duplicates.hpp>
+#include <djinterop/track_feature_index.hpp>
+#include <djinterop/track_query.hpp>
+#include <djinterop/track_similarity_index.hpp>
 #include <djinterop/track_snapshot.hpp>
 
 #endif  // DJINTEROP_DJINTEROP_HPP
@@ -17,12 +17,22 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <djinterop/config.hpp>
 #include <djinterop/database.hpp>
+#include <djinterop/database_metrics.hpp>
 #include <djinterop/engine/engine_schema.hpp>
+#include <djinterop/engine/library_export.hpp>
+#include <djinterop/sql_observer.hpp>
+#include <djinterop/track_duplicates.hpp>
+#include <djinterop/track_feature_index.hpp>
+#include <djinterop/track_query.hpp>
+#include <djinterop/track_similarity_index.hpp>
 
 namespace djinterop::engine
 {
@@ -58,6 +68,139 @@ public:
     /// Get the unified database interface for this Engine library.
     [[nodiscard]] virtual djinterop::database database() const = 0;
 
+    /// Get a snapshot of the counters describing work done by the library on
+    /// this Engine library.
+    ///
+    /// Statements, rows read and transactions are only counted while SQL
+    /// metrics are enabled with `set_metrics_enabled()`.
+    ///
+    /// \return Returns the metrics snapshot.
+    [[nodiscard]] database_metrics metrics() const;
+
+    /// Set an observer to be notified of every SQL statement run against
+    /// this library, or remove the current observer.
+    ///
+    /// Only one observer may be set at a time.  Statements are only timed and
+    /// reported while an observer is set.
+    ///
+    /// \param observer Observer to set, or `nullptr` to remove it.
+    void set_observer(std::shared_ptr<sql_observer> observer);
+
+    /// Enable or disable the counting of SQL statements, rows read and
+    /// transactions committed, as reported by `metrics()`.
+    ///
+    /// Counting is disabled by default, since it needs a callback from SQLite
+    /// for every statement and every row.
+    ///
+    /// \param enabled Whether counting is enabled.
+    void set_metrics_enabled(bool enabled);
+
+    /// Find the tracks that match some criteria, using a single statement.
+    ///
+    /// \param criteria Criteria that tracks must match.
+    /// \return Returns the ids of matching tracks, in order.
+    [[nodiscard]] std::vector<int64_t> query_track_ids(
+        const track_query_criteria& criteria) const;
+
+    /// Find the tracks that match some criteria, using a single statement.
+    ///
+    /// \param criteria Criteria that tracks must match.
+    /// \return Returns a projection of each matching track, in order.
+    [[nodiscard]] std::vector<track_query_row> query_track_rows(
+        const track_query_criteria& criteria) const;
+
+    /// Search the text metadata of the tracks in this library.
+    ///
+    /// The full-text index used is kept in a file alongside the library
+    /// database, and is updated as tracks change.
+    ///
+    /// \param text Text for which to search.
+    /// \param limit Maximum number of results.
+    /// \return Returns the ids of matching tracks, most relevant first.
+    /// \throws unsupported_operation If the SQLite library in use does not
+    ///         support full-text search.
+    [[nodiscard]] std::vector<int64_t> search(
+        const std::string& text, std::size_t limit) const;
+
+    /// Get an in-memory index of the musical features of the tracks in this
+    /// library.
+    ///
+    /// The index is held alongside the library, and is updated incrementally
+    /// as tracks change.  An index that has been returned is never modified.
+    ///
+    /// \return Returns an index that is up to date with the library.
+    [[nodiscard]] std::shared_ptr<const track_feature_index> feature_index()
+        const;
+
+    /// Get an in-memory index of the similarity between the tracks in this
+    /// library.
+    ///
+    /// The index is held alongside the library, and is updated incrementally
+    /// as tracks change.  An index that has been returned is never modified.
+    ///
+    /// \return Returns an index that is up to date with the library.
+    [[nodiscard]] std::shared_ptr<const track_similarity_index>
+    similarity_index() const;
+
+    /// Find groups of tracks in this library that are duplicates of one
+    /// another, together with a suggested survivor for each group.
+    ///
+    /// \param policy Policy determining which tracks are duplicates.
+    /// \return Returns the groups of duplicates, in order of their first
+    ///         track.
+    [[nodiscard]] std::vector<duplicate_group> find_duplicates(
+        const duplicate_policy& policy) const;
+
+    /// Merge groups of duplicate tracks into their survivors, in a single
+    /// transaction.
+    ///
+    /// \param groups Groups of duplicates to merge.
+    void merge_duplicates(const std::vector<duplicate_group>& groups);
+
+    /// Create new tracks in this library, in a single transaction.
+    ///
+    /// \param snapshots Snapshots of the tracks to create.
+    /// \return Returns the created tracks, in the order of their snapshots.
+    std::vector<track> create_tracks(
+        const std::vector<track_snapshot>& snapshots);
+
+    /// Export a subset of this library into another Engine library.
+    ///
+    /// The given playlists are copied, along with all of their descendant
+    /// playlists, their ancestor playlists (without contents), and every track
+    /// that they contain.  Any additional tracks given are copied as well.
+    /// Track rows and performance data are copied verbatim, without decoding
+    /// or re-encoding any blobs, and ids are remapped for the target library.
+    /// Tracks and playlists that already exist in the target are re-used.
+    ///
+    /// All changes to the target library are made in a single transaction.
+    ///
+    /// \param target Library into which to export.
+    /// \param playlist_ids Ids of playlists to export.
+    /// \param track_ids Ids of additional tracks to export.
+    /// \return Returns the mapping of exported ids.
+    /// \throws unsupported_operation If the two libraries do not have
+    ///         compatible schemas.
+    library_export_result export_to(
+        base_engine_library& target, const std::vector<int64_t>& playlist_ids,
+        const std::vector<int64_t>& track_ids = {}) const;
+
+    /// Copy the audio files of tracks previously exported by `export_to()`.
+    ///
+    /// Track paths are resolved relative to the directory of each library.
+    /// Files already present in the target with the expected size are not
+    /// copied again.
+    ///
+    /// \param target Library into which tracks were exported.
+    /// \param export_result Result of the earlier call to `export_to()`.
+    /// \param options Options controlling the transfer.
+    /// \return Returns a report of the files transferred.
+    /// \throws unsupported_operation If either library is a temporary one.
+    file_transfer_report export_files_to(
+        const base_engine_library& target,
+        const library_export_result& export_result,
+        const file_transfer_options& options = {}) const;
+
 protected:
     static std::shared_ptr<engine_library_context> create(
         const std::string& directory, const engine_schema& schema);
@@ -20,7 +20,9 @@
 #define DJINTEROP_ENGINE_ENGINE_HPP
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -55,6 +57,43 @@ constexpr std::array<pad_color, 8> pads{pad_1, pad_2, pad_3, pad_4,
 
 constexpr const char* default_database_dir_name = "Engine Library";
 
+/// Progress of hydrating a database from an SQL script.
+struct DJINTEROP_PUBLIC script_progress
+{
+    /// Path of the script currently being executed.
+    std::string script_path;
+
+    /// Number of bytes of the script executed so far.
+    uint64_t bytes_done;
+
+    /// Total size of the script, in bytes.
+    uint64_t bytes_total;
+
+    /// Number of statements of the script executed so far.
+    uint64_t statements_executed;
+};
+
+/// Options controlling how SQL scripts are executed.
+struct DJINTEROP_PUBLIC script_options
+{
+    /// Number of statements to execute per transaction, or zero to execute
+    /// each script in a single transaction.
+    std::size_t statements_per_transaction = 0;
+
+    /// Callback invoked periodically as each script is executed.
+    std::function<void(const script_progress&)> on_progress;
+};
+
+/// Result of verifying a single database with `verify_databases()`.
+struct DJINTEROP_PUBLIC database_verification_result
+{
+    /// Whether the database was verified successfully.
+    bool verified;
+
+    /// Description of the problem found, if verification failed.
+    std::string error;
+};
+
 /// Creates a new, empty database in a directory using the version provided.
 ///
 /// By convention, the last part of the directory path is "Engine Library".  If
@@ -77,14 +116,21 @@ create_temporary_database(const engine_schema& schema = latest_schema);
 /// SQLite databases with the name "<dbname>.db".  These hydrated SQLite
 /// databases are then loaded into the returned `database` object.
 ///
+/// Each script is executed in a single transaction, or in batches of
+/// transactions as specified by `options`.  Statements may span multiple
+/// lines, and any transaction control statements in the script itself are
+/// subsumed by the transactions issued by this function.  If a statement
+/// fails, a `script_error` is thrown indicating its location in the script.
+///
 /// \param db_directory Directory in which to create database.
 /// \param script_directory Directory containing scripts.
 /// \param loaded_schema Output reference parameter indicating the version of
 ///                       the created database.
+/// \param options Options controlling how scripts are executed.
 /// \return Returns the created database.
 database DJINTEROP_PUBLIC create_database_from_scripts(
     const std::string& db_directory, const std::string& script_directory,
-    engine_schema& loaded_schema);
+    engine_schema& loaded_schema, const script_options& options = {});
 
 /// Creates a new database from a set of SQL scripts.
 ///
@@ -160,6 +206,18 @@ inline database DJINTEROP_PUBLIC load_database(const std::string& directory)
     return load_database(directory, unused);
 }
 
+/// Verifies several databases in parallel.
+///
+/// Each database is verified as per `database::verify()`, but any exception
+/// thrown is captured in the result for that database instead of propagating.
+///
+/// \param databases Databases to verify.
+/// \param max_workers Maximum number of databases to verify at once, or zero
+///                    to use the number of hardware threads available.
+/// \return Returns one result per database, in the same order.
+std::vector<database_verification_result> DJINTEROP_PUBLIC verify_databases(
+    const std::vector<database>& databases, std::size_t max_workers = 0);
+
 /// Normalizes a beat-grid, so that the beat indexes are in the form normally
 /// expected by Engine Prime.
 ///
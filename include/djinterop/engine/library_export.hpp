@@ -0,0 +1,118 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_ENGINE_LIBRARY_EXPORT_HPP
+#define DJINTEROP_ENGINE_LIBRARY_EXPORT_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <djinterop/config.hpp>
+
+namespace djinterop::engine
+{
+/// Outcome of exporting a subset of one Engine library to another.
+struct DJINTEROP_PUBLIC library_export_result
+{
+    /// Map of source track id to the id of the corresponding track in the
+    /// target library.
+    ///
+    /// Tracks that already existed in the target library (as identified by
+    /// their path or origin) map to the existing track id.
+    std::unordered_map<int64_t, int64_t> track_ids;
+
+    /// Map of source playlist id to the id of the corresponding playlist in
+    /// the target library.
+    std::unordered_map<int64_t, int64_t> playlist_ids;
+
+    /// Number of tracks newly inserted into the target library.
+    int64_t tracks_added = 0;
+
+    /// Number of playlists newly inserted into the target library.
+    int64_t playlists_added = 0;
+};
+
+/// Progress of an ongoing transfer of audio files.
+struct DJINTEROP_PUBLIC file_transfer_progress
+{
+    /// Number of files that have been fully processed, whether copied,
+    /// skipped, or failed.
+    int64_t files_done = 0;
+
+    /// Total number of files to process.
+    int64_t files_total = 0;
+
+    /// Number of bytes copied so far.
+    int64_t bytes_copied = 0;
+
+    /// Time elapsed since the transfer started.
+    std::chrono::steady_clock::duration elapsed{};
+
+    /// Average throughput since the transfer started, in bytes per second.
+    double bytes_per_second = 0;
+};
+
+/// Options controlling the transfer of audio files.
+struct DJINTEROP_PUBLIC file_transfer_options
+{
+    /// Maximum number of files to copy in parallel.
+    unsigned int max_workers = 4;
+
+    /// Path to a manifest file recording completed copies, or empty for none.
+    ///
+    /// If a transfer is interrupted, running it again with the same manifest
+    /// will skip the files that were already copied.
+    std::string manifest_path;
+
+    /// Optional callback to receive progress updates.
+    ///
+    /// The callback may be invoked from any worker thread, but invocations
+    /// are never concurrent.
+    std::function<void(const file_transfer_progress&)> on_progress;
+};
+
+/// Outcome of a transfer of audio files.
+struct DJINTEROP_PUBLIC file_transfer_report
+{
+    /// Number of files copied.
+    int64_t files_copied = 0;
+
+    /// Number of files skipped, as they were already present at the target.
+    int64_t files_skipped = 0;
+
+    /// Number of bytes copied.
+    int64_t bytes_copied = 0;
+
+    /// Total time taken by the transfer.
+    std::chrono::steady_clock::duration elapsed{};
+
+    /// Average throughput of the transfer, in bytes per second.
+    double bytes_per_second = 0;
+
+    /// Source paths of files that could not be copied, with the reason why.
+    std::vector<std::pair<std::string, std::string>> failures;
+};
+
+}  // namespace djinterop::engine
+
+#endif  // DJINTEROP_ENGINE_LIBRARY_EXPORT_HPP
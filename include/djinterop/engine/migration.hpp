@@ -0,0 +1,125 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_ENGINE_MIGRATION_HPP
+#define DJINTEROP_ENGINE_MIGRATION_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/database.hpp>
+#include <djinterop/engine/engine_schema.hpp>
+
+namespace djinterop::engine
+{
+/// Stages of a migration between Engine schemas.
+enum class migration_stage
+{
+    tracks,
+    crates,
+    playlists,
+    verification,
+};
+
+/// Progress of an ongoing migration.
+struct DJINTEROP_PUBLIC migration_progress
+{
+    /// Current stage of the migration.
+    migration_stage stage;
+
+    /// Number of items processed so far in the current stage.
+    int64_t done = 0;
+
+    /// Total number of items to process in the current stage.
+    int64_t total = 0;
+};
+
+/// Options controlling a migration between Engine schemas.
+struct DJINTEROP_PUBLIC migration_options
+{
+    /// Number of tracks to write to the target database per transaction.
+    int64_t batch_size = 1000;
+
+    /// Whether to read back and verify every migrated track afterwards.
+    bool verify = true;
+
+    /// Optional callback to receive progress updates.
+    std::function<void(const migration_progress&)> on_progress;
+};
+
+/// Outcome of a migration between Engine schemas.
+struct DJINTEROP_PUBLIC migration_report
+{
+    /// Schema of the newly-created target library.
+    engine_schema target_schema;
+
+    /// Number of tracks migrated.
+    int64_t tracks_migrated = 0;
+
+    /// Number of crates migrated.
+    int64_t crates_migrated = 0;
+
+    /// Number of playlists migrated.
+    int64_t playlists_migrated = 0;
+
+    /// Number of track memberships of crates and playlists migrated.
+    int64_t list_entries_migrated = 0;
+
+    /// Number of tracks that were verified after migration.
+    int64_t tracks_verified = 0;
+
+    /// Human-readable descriptions of any discrepancies found whilst
+    /// verifying the migrated library.
+    std::vector<std::string> verification_failures;
+
+    /// Human-readable descriptions of any source data that could not be
+    /// represented in the target schema.
+    std::vector<std::string> warnings;
+
+    /// Total time taken by the migration.
+    std::chrono::steady_clock::duration elapsed{};
+};
+
+/// Migrate the contents of an Engine library into a new library of a given
+/// schema.
+///
+/// Tracks (including their performance data), crates, and playlists are read
+/// one at a time from the source and written to the target in batched
+/// transactions.  Where the source stores high-resolution waveforms (schema
+/// 1.x), these are converted to the overview waveforms stored by later
+/// schemas.  Crates from a source in which crates and playlists are distinct
+/// are merged into playlists of the same name if the target does not
+/// distinguish the two.
+///
+/// \param source Database to migrate from.
+/// \param target_directory Directory in which to create the new library.
+/// \param target_schema Schema version of the new library.
+/// \param options Options controlling the migration.
+/// \return Returns a report of the migration.
+migration_report DJINTEROP_PUBLIC migrate_database(
+    const database& source, const std::string& target_directory,
+    const engine_schema& target_schema,
+    const migration_options& options = {});
+
+}  // namespace djinterop::engine
+
+#endif  // DJINTEROP_ENGINE_MIGRATION_HPP
@@ -0,0 +1,166 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_ENGINE_SYNTHETIC_LIBRARY_HPP
+#define DJINTEROP_ENGINE_SYNTHETIC_LIBRARY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <djinterop/config.hpp>
+#include <djinterop/database.hpp>
+#include <djinterop/engine/engine_schema.hpp>
+#include <djinterop/track_snapshot.hpp>
+
+namespace djinterop::engine
+{
+/// Progress of generating a synthetic library.
+struct DJINTEROP_PUBLIC synthetic_library_progress
+{
+    /// Number of tracks created so far.
+    std::size_t tracks_done = 0;
+
+    /// Total number of tracks to create.
+    std::size_t tracks_total = 0;
+
+    /// Number of playlists created and filled so far.
+    std::size_t playlists_done = 0;
+
+    /// Total number of playlists to create.
+    std::size_t playlists_total = 0;
+
+    /// Number of crates created and filled so far.
+    std::size_t crates_done = 0;
+
+    /// Total number of crates to create.
+    std::size_t crates_total = 0;
+};
+
+/// Options controlling the generation of a synthetic library.
+struct DJINTEROP_PUBLIC synthetic_library_options
+{
+    /// Schema of the library to generate.
+    engine_schema schema = latest_schema;
+
+    /// Seed from which all generated data is derived.  On a given platform,
+    /// the same seed and options always generate the same library.
+    uint64_t seed = 1;
+
+    /// Number of tracks to generate.
+    std::size_t track_count = 1000;
+
+    /// Whether to generate performance data for each track, namely a
+    /// beatgrid, hot cues, loops, and a waveform.
+    bool performance_data = true;
+
+    /// Number of playlists to generate.
+    std::size_t playlist_count = 100;
+
+    /// Number of crates to generate.
+    ///
+    /// Crates are only generated for databases in which crates are distinct
+    /// from playlists, and this option is otherwise ignored.
+    std::size_t crate_count = 100;
+
+    /// Maximum depth of the playlist and crate trees, where root playlists
+    /// and crates are at depth one.  Trees are flat for databases that do
+    /// not support nesting.
+    std::size_t max_depth = 5;
+
+    /// Mean number of tracks in each playlist or crate.
+    std::size_t mean_container_size = 50;
+
+    /// Optional callback to receive progress updates.
+    std::function<void(const synthetic_library_progress&)> on_progress;
+};
+
+/// The `synthetic_track_generator` class generates snapshots of plausible,
+/// fully-analysed tracks.
+///
+/// Metadata follows distributions typical of a DJ's library: a long tail of
+/// artists, albums, and labels, genre-dependent tempos, and a spread of
+/// durations, formats, and release years.  Performance data, if requested,
+/// comprises a beatgrid, up to eight hot cues and eight loops aligned to the
+/// beatgrid, and a waveform of the size expected by the target schema.
+///
+/// The sequence of snapshots is fully determined by the schema, seed, and
+/// library size.  Some values are derived using floating-point functions,
+/// such as `std::log`, whose results may differ slightly between platforms,
+/// and so the sequence is only guaranteed to be reproducible on the same
+/// platform.
+class DJINTEROP_PUBLIC synthetic_track_generator
+{
+public:
+    /// Construct a track generator.
+    ///
+    /// \param schema Schema for which tracks are generated.
+    /// \param seed Seed from which all generated data is derived.
+    /// \param library_size Expected number of tracks in the library, which
+    ///                     determines the size of the pools of artists,
+    ///                     albums, and labels.
+    /// \param performance_data Whether to generate performance data.
+    synthetic_track_generator(
+        engine_schema schema, uint64_t seed, std::size_t library_size,
+        bool performance_data = true);
+
+    /// Move constructor.
+    synthetic_track_generator(synthetic_track_generator&& other) noexcept;
+
+    /// Destructor.
+    ~synthetic_track_generator();
+
+    /// Move assignment operator.
+    synthetic_track_generator& operator=(
+        synthetic_track_generator&& other) noexcept;
+
+    /// Generate the next track.
+    ///
+    /// \return Returns a snapshot of the generated track.
+    track_snapshot next();
+
+private:
+    class impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+/// Populate a database with a synthetic library.
+///
+/// Tracks are generated by a `synthetic_track_generator`, after which trees
+/// of playlists (and crates, where distinct) are created and filled with
+/// randomly-chosen tracks.
+///
+/// \param db Database to populate.
+/// \param options Options controlling the generated library.  The schema
+///                option is used only to shape the generated waveforms.
+void DJINTEROP_PUBLIC populate_synthetic_library(
+    database& db, const synthetic_library_options& options);
+
+/// Create a new database in a directory, populated with a synthetic library.
+///
+/// \param directory Directory in which to create the database.
+/// \param options Options controlling the generated library.
+/// \return Returns the created database.
+database DJINTEROP_PUBLIC create_synthetic_library(
+    const std::string& directory, const synthetic_library_options& options);
+
+}  // namespace djinterop::engine
+
+#endif  // DJINTEROP_ENGINE_SYNTHETIC_LIBRARY_HPP
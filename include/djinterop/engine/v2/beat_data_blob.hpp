@@ -20,6 +20,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <ostream>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -160,4 +161,91 @@ struct DJINTEROP_PUBLIC beat_data_blob
         return os;
     }
 };
+
+/// Non-owning random-access view of the markers of one beat grid within
+/// uncompressed beat data.
+///
+/// Markers are decoded on access.
+class DJINTEROP_PUBLIC beat_grid_view
+{
+public:
+    /// Construct an empty view.
+    beat_grid_view() noexcept = default;
+
+    /// Construct a view over a run of encoded markers.
+    ///
+    /// \param markers Encoded markers, 24 bytes each.
+    explicit beat_grid_view(std::span<const std::byte> markers) noexcept :
+        markers_{markers}
+    {
+    }
+
+    /// Get the number of markers.
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return markers_.size() / 24;
+    }
+
+    /// Determine whether there are no markers.
+    [[nodiscard]] bool empty() const noexcept { return markers_.empty(); }
+
+    /// Decode the marker at the given index, without bounds checking.
+    [[nodiscard]] beat_grid_marker_blob operator[](std::size_t index) const;
+
+    /// Decode the marker at the given index.
+    ///
+    /// \throws std::out_of_range If the index is not less than `size()`.
+    [[nodiscard]] beat_grid_marker_blob at(std::size_t index) const;
+
+private:
+    std::span<const std::byte> markers_;
+};
+
+/// Non-owning view over uncompressed beat data.
+///
+/// Only the positions of the two beat grids are determined on construction,
+/// so that individual markers can be read without decoding the whole blob.
+/// The viewed data must outlive the view.
+class DJINTEROP_PUBLIC beat_data_view
+{
+public:
+    /// Construct a view over uncompressed beat data.
+    ///
+    /// \param data Uncompressed beat data, which may be empty.
+    /// \throws std::invalid_argument If the data is malformed.
+    explicit beat_data_view(std::span<const std::byte> data);
+
+    /// Uncompress a beat data blob, for use with this view.
+    ///
+    /// \param blob Binary blob, as stored in the database.
+    /// \return Returns the uncompressed data.
+    [[nodiscard]] static std::vector<std::byte> uncompress(
+        const std::vector<std::byte>& blob);
+
+    /// Sample rate, or zero if the data is empty.
+    [[nodiscard]] double sample_rate() const noexcept;
+
+    /// Number of samples, or zero if the data is empty.
+    [[nodiscard]] double samples() const noexcept;
+
+    /// Flag indicating whether the beat grid is set.
+    [[nodiscard]] uint8_t is_beatgrid_set() const noexcept;
+
+    /// Default beat grid.
+    [[nodiscard]] beat_grid_view default_beat_grid() const noexcept
+    {
+        return default_beat_grid_;
+    }
+
+    /// Adjusted beat grid.
+    [[nodiscard]] beat_grid_view adjusted_beat_grid() const noexcept
+    {
+        return adjusted_beat_grid_;
+    }
+
+private:
+    std::span<const std::byte> data_;
+    beat_grid_view default_beat_grid_;
+    beat_grid_view adjusted_beat_grid_;
+};
 }  // namespace djinterop::engine::v2
@@ -17,10 +17,13 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <ostream>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <djinterop/config.hpp>
@@ -135,4 +138,69 @@ struct DJINTEROP_PUBLIC loops_blob
         return os;
     }
 };
+
+/// Non-owning view of a single loop within loops data.
+struct DJINTEROP_PUBLIC loop_blob_view
+{
+    /// Label, referring into the viewed data.
+    std::string_view label;
+
+    /// Sample offset of the start of the loop within the track.
+    double start_sample_offset;
+
+    /// Sample offset of the end of the loop within the track.
+    double end_sample_offset;
+
+    /// Flag indicating whether the start of the loop is set.
+    uint8_t is_start_set;
+
+    /// Flag indicating whether the end of the loop is set.
+    uint8_t is_end_set;
+
+    /// Displayed colour of the loop.
+    pad_color color;
+};
+
+/// Non-owning random-access view over loops data.
+///
+/// Construction parses only a table of offsets to each loop, so that a single
+/// loop can be read without decoding any of the others.  Note that loops data
+/// is not compressed, so the view can be constructed directly over a blob as
+/// stored in the database.  The viewed data must outlive the view.
+class DJINTEROP_PUBLIC loops_view
+{
+public:
+    /// Construct a view over loops data.
+    ///
+    /// \param data Loops data, which may be empty.
+    /// \throws std::invalid_argument If the data is malformed.
+    explicit loops_view(std::span<const std::byte> data);
+
+    /// Get the number of loops.
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+    /// Decode the loop at the given index, without bounds checking.
+    [[nodiscard]] loop_blob_view operator[](std::size_t index) const;
+
+    /// Decode the loop at the given index.
+    ///
+    /// \throws std::out_of_range If the index is not less than `size()`.
+    [[nodiscard]] loop_blob_view at(std::size_t index) const;
+
+private:
+    std::size_t offset(std::size_t index) const noexcept
+    {
+        return index < inline_offsets_.size()
+                   ? inline_offsets_[index]
+                   : extra_offsets_[index - inline_offsets_.size()];
+    }
+
+    std::span<const std::byte> data_;
+    std::size_t size_ = 0;
+
+    // Offsets of the usual number of loops are held inline, so that
+    // constructing a view does not allocate.
+    std::array<uint32_t, MAX_LOOPS> inline_offsets_{};
+    std::vector<uint32_t> extra_offsets_;
+};
 }  // namespace djinterop::engine::v2
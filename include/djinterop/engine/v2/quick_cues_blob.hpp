@@ -17,9 +17,13 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <ostream>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <djinterop/config.hpp>
@@ -149,4 +153,76 @@ struct DJINTEROP_PUBLIC quick_cues_blob
         return os;
     }
 };
+
+/// Non-owning view of a single quick cue within uncompressed quick cues data.
+struct DJINTEROP_PUBLIC quick_cue_blob_view
+{
+    /// Label, referring into the viewed data.
+    std::string_view label;
+
+    /// Sample offset within the track, or `QUICK_CUE_SAMPLE_OFFSET_EMPTY`.
+    double sample_offset;
+
+    /// Displayed colour of the quick cue.
+    pad_color color;
+};
+
+/// Non-owning random-access view over uncompressed quick cues data.
+///
+/// Construction parses only a table of offsets to each quick cue, so that a
+/// single quick cue can be read without decoding any of the others.  The
+/// viewed data must outlive the view.
+class DJINTEROP_PUBLIC quick_cues_view
+{
+public:
+    /// Construct a view over uncompressed quick cues data.
+    ///
+    /// \param data Uncompressed quick cues data, which may be empty.
+    /// \throws std::invalid_argument If the data is malformed.
+    explicit quick_cues_view(std::span<const std::byte> data);
+
+    /// Uncompress a quick cues blob, for use with this view.
+    ///
+    /// \param blob Binary blob, as stored in the database.
+    /// \return Returns the uncompressed data.
+    [[nodiscard]] static std::vector<std::byte> uncompress(
+        const std::vector<std::byte>& blob);
+
+    /// Get the number of quick cues.
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+    /// Decode the quick cue at the given index, without bounds checking.
+    [[nodiscard]] quick_cue_blob_view operator[](std::size_t index) const;
+
+    /// Decode the quick cue at the given index.
+    ///
+    /// \throws std::out_of_range If the index is not less than `size()`.
+    [[nodiscard]] quick_cue_blob_view at(std::size_t index) const;
+
+    /// Adjusted main cue point, or zero if the data is empty.
+    [[nodiscard]] double adjusted_main_cue() const noexcept;
+
+    /// Flag indicating whether the main cue point has been adjusted.
+    [[nodiscard]] bool is_main_cue_adjusted() const noexcept;
+
+    /// Default main cue point, or zero if the data is empty.
+    [[nodiscard]] double default_main_cue() const noexcept;
+
+private:
+    std::size_t offset(std::size_t index) const noexcept
+    {
+        return index < inline_offsets_.size()
+                   ? inline_offsets_[index]
+                   : extra_offsets_[index - inline_offsets_.size()];
+    }
+
+    std::span<const std::byte> data_;
+    std::size_t size_ = 0;
+    std::size_t trailer_offset_ = 0;
+
+    // Offsets of the usual number of quick cues are held inline, so that
+    // constructing a view does not allocate.
+    std::array<uint32_t, MAX_QUICK_CUES> inline_offsets_{};
+    std::vector<uint32_t> extra_offsets_;
+};
 }  // namespace djinterop::engine::v2
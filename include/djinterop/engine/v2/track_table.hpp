@@ -713,18 +713,33 @@ public:
     /// Get the `beatData` column for a given track.
     beat_data_blob get_beat_data(int64_t id);
 
+    /// Get the `beatData` column for a given track, without decoding it.
+    ///
+    /// The result may be used to construct a non-owning view.
+    std::vector<std::byte> get_beat_data_blob(int64_t id);
+
     /// Set the `beatData` column for a given track.
     void set_beat_data(int64_t id, const beat_data_blob& beat_data);
 
     /// Get the `quickCues` column for a given track.
     quick_cues_blob get_quick_cues(int64_t id);
 
+    /// Get the `quickCues` column for a given track, without decoding it.
+    ///
+    /// The result may be used to construct a non-owning view.
+    std::vector<std::byte> get_quick_cues_blob(int64_t id);
+
     /// Set the `quickCues` column for a given track.
     void set_quick_cues(int64_t id, const quick_cues_blob& quick_cues);
 
     /// Get the `loops` column for a given track.
     loops_blob get_loops(int64_t id);
 
+    /// Get the `loops` column for a given track, without decoding it.
+    ///
+    /// The result may be used to construct a non-owning view.
+    std::vector<std::byte> get_loops_blob(int64_t id);
+
     /// Set the `loops` column for a given track.
     void set_loops(int64_t id, const loops_blob& loops);
 
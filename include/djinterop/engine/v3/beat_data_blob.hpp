@@ -37,4 +37,10 @@ using beat_grid_marker_blob = djinterop::engine::v2::beat_grid_marker_blob;
 /// Represents the beat data blob.
 using beat_data_blob = djinterop::engine::v2::beat_data_blob;
 
+/// Non-owning random-access view of the markers of one beat grid.
+using beat_grid_view = djinterop::engine::v2::beat_grid_view;
+
+/// Non-owning view over uncompressed beat data.
+using beat_data_view = djinterop::engine::v2::beat_data_view;
+
 }  // namespace djinterop::engine::v3
@@ -31,4 +31,10 @@ using loop_blob = djinterop::engine::v2::loop_blob;
 /// Represents the loops blob.
 using loops_blob = djinterop::engine::v2::loops_blob;
 
+/// Non-owning view of a single loop within loops data.
+using loop_blob_view = djinterop::engine::v2::loop_blob_view;
+
+/// Non-owning random-access view over loops data.
+using loops_view = djinterop::engine::v2::loops_view;
+
 }  // namespace djinterop::engine::v3
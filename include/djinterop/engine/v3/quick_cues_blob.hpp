@@ -35,4 +35,10 @@ using quick_cue_blob = djinterop::engine::v2::quick_cue_blob;
 /// Represents the quick cues blob.
 using quick_cues_blob = djinterop::engine::v2::quick_cues_blob;
 
+/// Non-owning view of a single quick cue within uncompressed quick cues data.
+using quick_cue_blob_view = djinterop::engine::v2::quick_cue_blob_view;
+
+/// Non-owning random-access view over uncompressed quick cues data.
+using quick_cues_view = djinterop::engine::v2::quick_cues_view;
+
 }  // namespace djinterop::engine::v3
@@ -73,6 +73,38 @@ public:
     }
 };
 
+/// The `script_error` exception is thrown when a statement in an SQL script
+/// cannot be parsed or executed.
+class DJINTEROP_PUBLIC script_error : public std::runtime_error
+{
+public:
+    /// Construct the exception for a statement at a given location.
+    script_error(
+        const std::string& what_arg, const std::string& script_path,
+        uint64_t offset, uint64_t line) noexcept :
+        runtime_error{what_arg},
+        script_path_{script_path}, offset_{offset}, line_{line}
+    {
+    }
+
+    /// Path of the script containing the failed statement.
+    [[nodiscard]] std::string script_path() const noexcept
+    {
+        return script_path_;
+    }
+
+    /// Byte offset of the start of the failed statement within the script.
+    [[nodiscard]] uint64_t offset() const noexcept { return offset_; }
+
+    /// One-based line number of the start of the failed statement.
+    [[nodiscard]] uint64_t line() const noexcept { return line_; }
+
+private:
+    std::string script_path_;
+    uint64_t offset_;
+    uint64_t line_;
+};
+
 /// The `crate_deleted` exception is thrown when an invalid `crate` object is
 /// used, i.e. one that does not exist in the database anymore.
 class DJINTEROP_PUBLIC crate_deleted : public std::runtime_error
@@ -0,0 +1,78 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_SQL_OBSERVER_HPP
+#define DJINTEROP_SQL_OBSERVER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+#include <djinterop/config.hpp>
+
+namespace djinterop
+{
+/// The `sql_statement_event` struct describes a single SQL statement that was
+/// run against a database on behalf of the library.
+///
+/// The string views held by an event are only valid for the duration of the
+/// call to `sql_observer::on_statement()` to which the event is passed.
+struct DJINTEROP_PUBLIC sql_statement_event
+{
+    /// Normalised text of the statement.
+    ///
+    /// Whitespace is collapsed and literal values are replaced by `?`, so that
+    /// repeated executions of the same query have identical text.
+    std::string_view sql;
+
+    /// Wall-clock time spent running the statement.
+    std::chrono::nanoseconds elapsed;
+
+    /// Number of result rows stepped through.
+    int64_t rows;
+
+    /// Name of the outermost public API operation that issued the statement,
+    /// such as `track::snapshot`, or empty if it was not issued by a call
+    /// through the unified database interface.
+    std::string_view operation;
+
+    /// Text of the statement as prepared, with literal values intact and any
+    /// parameters unbound.
+    std::string_view prepared_sql;
+};
+
+/// The `sql_observer` class is an interface for receiving notifications of
+/// SQL statements run by the library.
+///
+/// Notifications are delivered synchronously, on the thread that ran the
+/// statement, and so an observer should return promptly.  An observer must not
+/// call back into the library from which it receives notifications.
+class DJINTEROP_PUBLIC sql_observer
+{
+public:
+    virtual ~sql_observer() = default;
+
+    /// Called once for every statement that has finished running.
+    ///
+    /// \param event Details of the statement.
+    virtual void on_statement(const sql_statement_event& event) = 0;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_SQL_OBSERVER_HPP
@@ -0,0 +1,80 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_TRACK_DUPLICATES_HPP
+#define DJINTEROP_TRACK_DUPLICATES_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <djinterop/config.hpp>
+
+namespace djinterop
+{
+/// The `duplicate_policy` struct determines which tracks are considered to be
+/// duplicates of one another.
+///
+/// Two tracks are duplicates if they match on any of the enabled keys.  Since
+/// a track may match different tracks on different keys, duplicates are
+/// grouped transitively.
+struct DJINTEROP_PUBLIC duplicate_policy
+{
+    /// Match tracks with the same path.
+    ///
+    /// Paths are compared ignoring the case of ASCII letters and the direction
+    /// of separators, as on the FAT and exFAT file systems of removable
+    /// drives.
+    bool match_path = true;
+
+    /// Match tracks with exactly the same filename and file size.
+    ///
+    /// Tracks whose file size is not recorded are not matched in this way.
+    bool match_file_name_and_size = true;
+
+    /// Match tracks with the same artist and title, and a similar duration.
+    ///
+    /// Artist and title are compared ignoring case, punctuation, and
+    /// whitespace.  Tracks without a title or duration are not matched in this
+    /// way.
+    bool match_metadata = false;
+
+    /// Largest difference in duration for tracks to be matched by metadata.
+    std::chrono::milliseconds duration_tolerance{2000};
+};
+
+/// The `duplicate_group` struct holds a group of tracks that are duplicates of
+/// one another.
+struct DJINTEROP_PUBLIC duplicate_group
+{
+    /// Ids of the tracks in the group, in ascending order.
+    std::vector<int64_t> track_ids;
+
+    /// Id of the track that is suggested to be kept.
+    ///
+    /// Tracks with an analysed BPM are preferred, followed by those in the
+    /// most playlists and crates, followed by the earliest added.
+    int64_t survivor_id = 0;
+
+    friend bool operator==(
+        const duplicate_group& lhs, const duplicate_group& rhs) = default;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_TRACK_DUPLICATES_HPP
@@ -0,0 +1,293 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_TRACK_FEATURE_INDEX_HPP
+#define DJINTEROP_TRACK_FEATURE_INDEX_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/musical_key.hpp>
+
+namespace djinterop
+{
+/// The `track_features` struct holds the musical features of a track that are
+/// used to find tracks that mix well together.
+struct DJINTEROP_PUBLIC track_features
+{
+    /// Id of the track.
+    int64_t id = 0;
+
+    /// BPM, being the analysed BPM if the track has been analysed, or else its
+    /// tagged BPM.
+    std::optional<double> bpm;
+
+    /// Key.
+    std::optional<musical_key> key;
+
+    /// Average loudness, in the range (0, 1].
+    std::optional<double> average_loudness;
+
+    /// Duration.
+    std::optional<std::chrono::milliseconds> duration;
+
+    /// Genre.
+    std::optional<std::string> genre;
+
+    friend bool operator==(
+        const track_features& lhs, const track_features& rhs) = default;
+};
+
+/// The `track_feature_filter` struct holds a set of predicates on the features
+/// of a track.
+///
+/// Every predicate that is set must be satisfied by a track for it to match.
+/// A track that lacks a feature never satisfies a predicate on that feature.
+struct DJINTEROP_PUBLIC track_feature_filter
+{
+    /// Inclusive lower bound on BPM.
+    std::optional<double> min_bpm;
+
+    /// Inclusive upper bound on BPM.
+    std::optional<double> max_bpm;
+
+    /// Set of permitted keys.  If empty, no tracks match.
+    std::optional<std::vector<musical_key>> keys;
+
+    /// Inclusive lower bound on average loudness, in decibels relative to
+    /// full scale, i.e. `20 * log10(average_loudness)`.
+    std::optional<double> min_loudness_db;
+
+    /// Inclusive upper bound on average loudness, in decibels relative to
+    /// full scale.
+    std::optional<double> max_loudness_db;
+
+    /// Inclusive lower bound on duration.
+    std::optional<std::chrono::milliseconds> min_duration;
+
+    /// Inclusive upper bound on duration.
+    std::optional<std::chrono::milliseconds> max_duration;
+};
+
+/// The `track_bitset` class holds one bit for each row of a
+/// `track_feature_index`, indicating whether the track in that row matched
+/// some predicate.
+class DJINTEROP_PUBLIC track_bitset
+{
+public:
+    /// Construct an empty bitset.
+    track_bitset() noexcept = default;
+
+    /// Construct a bitset with every bit clear.
+    ///
+    /// \param size Number of bits.
+    explicit track_bitset(std::size_t size);
+
+    /// Get the number of bits.
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+    /// Test whether a bit is set.
+    [[nodiscard]] bool test(std::size_t pos) const noexcept
+    {
+        return (words_[pos / 64] >> (pos % 64)) & 1;
+    }
+
+    /// Set a bit.
+    void set(std::size_t pos) noexcept
+    {
+        words_[pos / 64] |= uint64_t{1} << (pos % 64);
+    }
+
+    /// Clear a bit.
+    void reset(std::size_t pos) noexcept
+    {
+        words_[pos / 64] &= ~(uint64_t{1} << (pos % 64));
+    }
+
+    /// Get the number of bits that are set.
+    [[nodiscard]] std::size_t count() const noexcept;
+
+    /// Test whether any bit is set.
+    [[nodiscard]] bool any() const noexcept;
+
+    /// Get the bits as 64-bit words, with bit `i` held in bit `i % 64` of word
+    /// `i / 64`.  Bits beyond the size of the bitset are always clear.
+    [[nodiscard]] const std::vector<uint64_t>& words() const noexcept
+    {
+        return words_;
+    }
+
+    /// Intersect this bitset with another of the same size.
+    ///
+    /// \throws std::invalid_argument If the bitsets differ in size.
+    track_bitset& operator&=(const track_bitset& other);
+
+    /// Unite this bitset with another of the same size.
+    ///
+    /// \throws std::invalid_argument If the bitsets differ in size.
+    track_bitset& operator|=(const track_bitset& other);
+
+    friend bool operator==(
+        const track_bitset& lhs, const track_bitset& rhs) = default;
+
+private:
+    friend class track_feature_index;
+
+    std::size_t size_ = 0;
+    std::vector<uint64_t> words_;
+};
+
+/// The `track_feature_index` class holds the features of a set of tracks in
+/// memory, laid out so that predicates can be evaluated against every track
+/// at once.
+///
+/// Each feature is held in its own column, at single precision, so that
+/// evaluating a predicate streams through contiguous memory using SIMD
+/// instructions where available.  Rows are kept in ascending order of track
+/// id, and the result of evaluating a predicate is a bitset with one bit per
+/// row.
+///
+/// An index for the tracks of a database is obtained from
+/// `database::feature_index()`.
+class DJINTEROP_PUBLIC track_feature_index
+{
+public:
+    /// Construct an empty index.
+    track_feature_index();
+
+    /// Construct an index over a set of tracks.
+    ///
+    /// \param tracks Features of each track.  If an id occurs more than once,
+    ///               the last features given for it are used.
+    explicit track_feature_index(const std::vector<track_features>& tracks);
+
+    /// Copy constructor.
+    track_feature_index(const track_feature_index& other);
+
+    /// Move constructor.
+    track_feature_index(track_feature_index&& other) noexcept;
+
+    /// Destructor.
+    ~track_feature_index();
+
+    /// Copy assignment operator.
+    track_feature_index& operator=(const track_feature_index& other);
+
+    /// Move assignment operator.
+    track_feature_index& operator=(track_feature_index&& other) noexcept;
+
+    /// Get the number of tracks in the index.
+    [[nodiscard]] std::size_t size() const noexcept;
+
+    /// Get the id of the track in a given row.
+    ///
+    /// \param row Row of the index.
+    /// \throws std::out_of_range If the row does not exist.
+    [[nodiscard]] int64_t id_at(std::size_t row) const;
+
+    /// Get the row holding a given track.
+    ///
+    /// \param id Id of the track.
+    /// \return Returns the row, or `std::nullopt` if the track is not in the
+    ///         index.
+    [[nodiscard]] std::optional<std::size_t> row_of(int64_t id) const noexcept;
+
+    /// Get the features of the track in a given row.
+    ///
+    /// The reference remains valid until the index is next modified.
+    ///
+    /// \param row Row of the index.
+    /// \throws std::out_of_range If the row does not exist.
+    [[nodiscard]] const track_features& features_at(std::size_t row) const;
+
+    /// Add a track to the index, or replace the features of a track already
+    /// in the index.
+    ///
+    /// \param features Features of the track.
+    void upsert(const track_features& features);
+
+    /// Remove a track from the index, if present.
+    ///
+    /// \param id Id of the track.
+    void remove(int64_t id);
+
+    /// Remove every track from the index other than a given set.
+    ///
+    /// \param ids Ids of the tracks to keep, in any order.
+    void retain_only(std::vector<int64_t> ids);
+
+    /// Find the tracks matching a filter.
+    ///
+    /// Bounds are rounded to single precision before being compared.
+    ///
+    /// \param filter Filter to evaluate.
+    /// \return Returns a bitset with the bit of each matching row set.
+    [[nodiscard]] track_bitset match(const track_feature_filter& filter) const;
+
+    /// Find the tracks that mix well with a given track.
+    ///
+    /// A track mixes well if its BPM is within a given fraction of the BPM of
+    /// the given track, its key is harmonically compatible, and its average
+    /// loudness is within a given number of decibels.  Any feature that the
+    /// given track lacks is not considered.  The given track itself is never
+    /// matched.
+    ///
+    /// \param id Id of the track.
+    /// \param bpm_tolerance Maximum difference in BPM, as a fraction of the
+    ///                      BPM of the given track.
+    /// \param loudness_tolerance_db Maximum difference in average loudness,
+    ///                              in decibels.
+    /// \return Returns a bitset with the bit of each matching row set.
+    /// \throws track_deleted If the track is not in the index.
+    [[nodiscard]] track_bitset compatible_with(
+        int64_t id, double bpm_tolerance = 0.03,
+        double loudness_tolerance_db = 2.0) const;
+
+    /// Get the ids of the tracks in the rows of a bitset.
+    ///
+    /// \param rows Bitset of rows, as returned by `match()`.
+    /// \return Returns the ids of the tracks, in ascending order.
+    /// \throws std::invalid_argument If the bitset is not the size of the
+    ///                               index.
+    [[nodiscard]] std::vector<int64_t> ids(const track_bitset& rows) const;
+
+private:
+    class impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+/// Get the keys that are harmonically compatible with a given key.
+///
+/// These are the key itself, its relative major or minor, and the keys either
+/// side of it on the circle of fifths, i.e. the neighbouring keys on the
+/// Camelot wheel.
+///
+/// \param key Key.
+/// \return Returns the four compatible keys, starting with the key itself.
+DJINTEROP_PUBLIC std::vector<musical_key> harmonically_compatible_keys(
+    musical_key key);
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_TRACK_FEATURE_INDEX_HPP
@@ -0,0 +1,222 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_TRACK_QUERY_HPP
+#define DJINTEROP_TRACK_QUERY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/musical_key.hpp>
+
+namespace djinterop
+{
+class database;
+class database_impl;
+
+/// Fields by which the results of a track query may be ordered.
+enum class track_order
+{
+    /// Order by track id.
+    id,
+
+    /// Order by the time at which tracks were added to the library.
+    ///
+    /// Databases that do not record this time order by track id instead,
+    /// which reflects the order in which tracks were created.
+    date_added,
+
+    /// Order by BPM.
+    bpm,
+
+    /// Order by title.
+    title,
+
+    /// Order by artist.
+    artist,
+
+    /// Order by release year.
+    year,
+
+    /// Order by rating.
+    rating,
+};
+
+/// The `track_query_criteria` struct holds the filters, ordering, and limit of
+/// a track query.
+///
+/// Every filter that is set must be satisfied by a track for it to be
+/// returned.
+struct DJINTEROP_PUBLIC track_query_criteria
+{
+    /// Inclusive lower bound on BPM.
+    std::optional<double> min_bpm;
+
+    /// Inclusive upper bound on BPM.
+    std::optional<double> max_bpm;
+
+    /// Set of permitted keys.
+    std::optional<std::vector<musical_key>> keys;
+
+    /// Exact genre.
+    std::optional<std::string> genre;
+
+    /// Exact artist.
+    std::optional<std::string> artist;
+
+    /// Inclusive lower bound on rating, from 0 to 100.
+    std::optional<int> min_rating;
+
+    /// Inclusive lower bound on release year.
+    std::optional<int> min_year;
+
+    /// Inclusive upper bound on release year.
+    std::optional<int> max_year;
+
+    /// Field by which results are ordered.  Ties are broken by track id.
+    track_order order = track_order::id;
+
+    /// Whether results are ordered in descending order.
+    bool descending = false;
+
+    /// Maximum number of results to return.
+    std::optional<std::size_t> limit;
+};
+
+/// The `track_query_row` struct holds a projection of a track returned by a
+/// track query.
+struct DJINTEROP_PUBLIC track_query_row
+{
+    int64_t id = 0;
+    std::optional<std::string> title;
+    std::optional<std::string> artist;
+    std::optional<std::string> genre;
+    std::optional<double> bpm;
+    std::optional<musical_key> key;
+    std::optional<int> rating;
+    std::optional<int> year;
+
+    friend bool operator==(
+        const track_query_row& lhs, const track_query_row& rhs) = default;
+};
+
+/// The `track_query` class builds a query over the tracks in a database.
+///
+/// A query is obtained from `database::query()`, refined by chaining calls to
+/// its filter and ordering methods, and then run with `ids()` or `rows()`.
+/// Each run is answered by a single SQL statement, so that filtering and
+/// ordering take place in the database rather than track by track:
+///
+///     auto ids = db.query()
+///                    .bpm_between(120, 128)
+///                    .genre("House")
+///                    .order_by(djinterop::track_order::date_added, true)
+///                    .limit(100)
+///                    .ids();
+///
+/// The BPM of a track is its analysed BPM if it has been analysed, or else
+/// its tagged BPM, in the same way as in a `track_snapshot`.
+class DJINTEROP_PUBLIC track_query
+{
+public:
+    /// Only match tracks whose BPM lies in a range.
+    ///
+    /// \param min_bpm Inclusive lower bound.
+    /// \param max_bpm Inclusive upper bound.
+    /// \return Returns a reference to this query.
+    /// \throws std::invalid_argument If the lower bound exceeds the upper.
+    track_query& bpm_between(double min_bpm, double max_bpm);
+
+    /// Only match tracks whose key is one of a set of keys.
+    ///
+    /// \param keys Set of permitted keys.  If empty, no tracks match.
+    /// \return Returns a reference to this query.
+    track_query& key_in(std::vector<musical_key> keys);
+
+    /// Only match tracks of a given genre.
+    ///
+    /// \param genre Genre, which must match exactly.
+    /// \return Returns a reference to this query.
+    track_query& genre(std::string genre);
+
+    /// Only match tracks by a given artist.
+    ///
+    /// \param artist Artist, which must match exactly.
+    /// \return Returns a reference to this query.
+    track_query& artist(std::string artist);
+
+    /// Only match tracks whose rating is at least a given value.
+    ///
+    /// \param min_rating Inclusive lower bound, from 0 to 100.
+    /// \return Returns a reference to this query.
+    track_query& rating_at_least(int min_rating);
+
+    /// Only match tracks whose release year lies in a range.
+    ///
+    /// \param min_year Inclusive lower bound.
+    /// \param max_year Inclusive upper bound.
+    /// \return Returns a reference to this query.
+    /// \throws std::invalid_argument If the lower bound exceeds the upper.
+    track_query& year_between(int min_year, int max_year);
+
+    /// Set the order in which results are returned.
+    ///
+    /// \param order Field by which results are ordered.
+    /// \param descending Whether to order results in descending order.
+    /// \return Returns a reference to this query.
+    track_query& order_by(track_order order, bool descending = false);
+
+    /// Limit the number of results returned.
+    ///
+    /// \param count Maximum number of results.
+    /// \return Returns a reference to this query.
+    track_query& limit(std::size_t count);
+
+    /// Get the criteria built up so far.
+    [[nodiscard]] const track_query_criteria& criteria() const noexcept
+    {
+        return criteria_;
+    }
+
+    /// Run the query, returning the ids of matching tracks.
+    ///
+    /// \return Returns the ids of matching tracks, in order.
+    [[nodiscard]] std::vector<int64_t> ids() const;
+
+    /// Run the query, returning a projection of each matching track.
+    ///
+    /// \return Returns a row for each matching track, in order.
+    [[nodiscard]] std::vector<track_query_row> rows() const;
+
+private:
+    friend class database;
+
+    explicit track_query(std::shared_ptr<database_impl> db);
+
+    std::shared_ptr<database_impl> db_;
+    track_query_criteria criteria_;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_TRACK_QUERY_HPP
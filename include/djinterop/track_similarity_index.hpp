@@ -0,0 +1,132 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifndef DJINTEROP_TRACK_SIMILARITY_INDEX_HPP
+#define DJINTEROP_TRACK_SIMILARITY_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <djinterop/config.hpp>
+#include <djinterop/track_feature_index.hpp>
+
+namespace djinterop
+{
+/// The `track_similarity_index` class finds the tracks whose musical features
+/// are most similar to those of a given track.
+///
+/// Each track is placed at a point in a space in which one unit of distance
+/// corresponds to roughly one of:
+///
+/// - a 6% difference in tempo, measured as a ratio of BPMs;
+/// - one step around the Camelot wheel, i.e. a fifth, with keys placed on a
+///   circle so that distance wraps around;
+/// - a change between major and minor mode;
+/// - a 3 dB difference in average loudness;
+/// - a doubling of duration, counted at half weight.
+///
+/// Tracks of differing genres, or without a genre, are a further unit apart.
+/// A track that lacks a key is placed at the centre of the circle of keys,
+/// and a track that lacks a loudness or duration is given a typical value for
+/// it.  Tracks without a BPM are not indexed.
+///
+/// Points are held in a k-d tree, built from a snapshot of a
+/// `track_feature_index`.  Later snapshots are applied incrementally, with
+/// new and edited tracks searched exhaustively alongside the tree until
+/// enough have accumulated to warrant rebuilding it.
+class DJINTEROP_PUBLIC track_similarity_index
+{
+public:
+    /// Construct a similarity index over a snapshot of track features.
+    ///
+    /// \param features Snapshot of track features.
+    explicit track_similarity_index(
+        std::shared_ptr<const track_feature_index> features);
+
+    /// Copy constructor.
+    track_similarity_index(const track_similarity_index& other);
+
+    /// Move constructor.
+    track_similarity_index(track_similarity_index&& other) noexcept;
+
+    /// Destructor.
+    ~track_similarity_index();
+
+    /// Copy assignment operator.
+    track_similarity_index& operator=(const track_similarity_index& other);
+
+    /// Move assignment operator.
+    track_similarity_index& operator=(track_similarity_index&& other) noexcept;
+
+    /// Get the snapshot of track features that the index reflects.
+    [[nodiscard]] const std::shared_ptr<const track_feature_index>& features()
+        const noexcept;
+
+    /// Get the number of tracks in the index.
+    [[nodiscard]] std::size_t size() const noexcept;
+
+    /// Bring the index up to date with a newer snapshot of the same tracks.
+    ///
+    /// Only the tracks that differ between the snapshots are re-indexed.
+    ///
+    /// \param features Snapshot of track features.
+    void update(std::shared_ptr<const track_feature_index> features);
+
+    /// Get the distance between two tracks.
+    ///
+    /// \param lhs_id Id of the first track.
+    /// \param rhs_id Id of the second track.
+    /// \return Returns the distance, or infinity if either track has no BPM.
+    /// \throws track_deleted If either track is not in the snapshot.
+    [[nodiscard]] double distance(int64_t lhs_id, int64_t rhs_id) const;
+
+    /// Find the tracks most similar to a given track.
+    ///
+    /// \param id Id of the track.
+    /// \param k Maximum number of tracks to find.
+    /// \return Returns the ids of the most similar tracks, nearest first, not
+    ///         including the given track.  If the given track has no BPM, no
+    ///         tracks are returned.
+    /// \throws track_deleted If the track is not in the snapshot.
+    [[nodiscard]] std::vector<int64_t> nearest(int64_t id, std::size_t k) const;
+
+    /// Find the tracks most similar to each of a set of tracks.
+    ///
+    /// Searches are spread across a number of worker threads.
+    ///
+    /// \param ids Ids of the tracks.
+    /// \param k Maximum number of tracks to find for each track.
+    /// \param max_workers Maximum number of worker threads, or zero to use
+    ///                    the number of hardware threads.
+    /// \return Returns, for each given track in turn, the result of
+    ///         `nearest()`.
+    /// \throws track_deleted If any track is not in the snapshot.
+    [[nodiscard]] std::vector<std::vector<int64_t>> nearest(
+        const std::vector<int64_t>& ids, std::size_t k,
+        std::size_t max_workers = 0) const;
+
+private:
+    class impl;
+    std::unique_ptr<impl> pimpl_;
+};
+
+}  // namespace djinterop
+
+#endif  // DJINTEROP_TRACK_SIMILARITY_INDEX_HPP
@@ -0,0 +1,278 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/analysis/beatgrid_index.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace djinterop::analysis
+{
+namespace
+{
+void check_sizes(std::size_t input_size, std::size_t output_size)
+{
+    if (input_size != output_size)
+    {
+        throw std::invalid_argument{
+            "Output span must be the same size as the input span"};
+    }
+}
+
+void check_subdivisions(int subdivisions)
+{
+    if (subdivisions <= 0)
+    {
+        throw std::invalid_argument{
+            "Number of subdivisions per beat must be positive"};
+    }
+}
+}  // anonymous namespace
+
+beatgrid_index::beatgrid_index(
+    std::span<const beatgrid_marker> markers, int beats_per_bar)
+{
+    beats_.reserve(markers.size());
+    sample_offsets_.reserve(markers.size());
+    for (auto&& marker : markers)
+    {
+        beats_.push_back(marker.index);
+        sample_offsets_.push_back(marker.sample_offset);
+    }
+
+    build(beats_per_bar);
+}
+
+beatgrid_index::beatgrid_index(
+    std::span<const engine::v2::beat_grid_marker_blob> markers,
+    int beats_per_bar)
+{
+    beats_.reserve(markers.size());
+    sample_offsets_.reserve(markers.size());
+    for (auto&& marker : markers)
+    {
+        beats_.push_back(static_cast<double>(marker.beat_number));
+        sample_offsets_.push_back(marker.sample_offset);
+    }
+
+    build(beats_per_bar);
+}
+
+beatgrid_index::beatgrid_index(
+    const engine::v2::beat_grid_view& markers, int beats_per_bar)
+{
+    beats_.reserve(markers.size());
+    sample_offsets_.reserve(markers.size());
+    for (std::size_t i = 0; i < markers.size(); ++i)
+    {
+        auto marker = markers[i];
+        beats_.push_back(static_cast<double>(marker.beat_number));
+        sample_offsets_.push_back(marker.sample_offset);
+    }
+
+    build(beats_per_bar);
+}
+
+void beatgrid_index::build(int beats_per_bar)
+{
+    if (beats_per_bar <= 0)
+    {
+        throw std::invalid_argument{"Number of beats per bar must be positive"};
+    }
+
+    if (beats_.size() < 2)
+    {
+        throw std::invalid_argument{
+            "Beatgrid must have at least two markers to be indexed"};
+    }
+
+    beats_per_bar_ = beats_per_bar;
+    samples_per_beat_.reserve(beats_.size() - 1);
+    for (std::size_t i = 1; i < beats_.size(); ++i)
+    {
+        auto beat_delta = beats_[i] - beats_[i - 1];
+        auto sample_delta = sample_offsets_[i] - sample_offsets_[i - 1];
+        if (!(beat_delta > 0) || !(sample_delta > 0) ||
+            !std::isfinite(sample_delta))
+        {
+            throw std::invalid_argument{
+                "Beatgrid markers must be strictly ascending in both beat "
+                "index and sample offset"};
+        }
+
+        samples_per_beat_.push_back(sample_delta / beat_delta);
+    }
+}
+
+std::size_t beatgrid_index::segment_by_sample(
+    double sample_offset) const noexcept
+{
+    // Segment `i` spans markers `i` and `i + 1`.  The first and last segments
+    // extend outwards indefinitely, and so only the interior markers need to
+    // be searched.
+    auto first = sample_offsets_.begin() + 1;
+    auto last = sample_offsets_.end() - 1;
+    return std::upper_bound(first, last, sample_offset) - first;
+}
+
+std::size_t beatgrid_index::segment_by_beat(double beat) const noexcept
+{
+    auto first = beats_.begin() + 1;
+    auto last = beats_.end() - 1;
+    return std::upper_bound(first, last, beat) - first;
+}
+
+std::size_t beatgrid_index::segment_by_sample(
+    double sample_offset, std::size_t hint) const noexcept
+{
+    auto last_segment = samples_per_beat_.size() - 1;
+    for (auto segment = hint; segment <= hint + 1 && segment <= last_segment;
+         ++segment)
+    {
+        if ((segment == 0 || sample_offset >= sample_offsets_[segment]) &&
+            (segment == last_segment ||
+             sample_offset < sample_offsets_[segment + 1]))
+        {
+            return segment;
+        }
+    }
+
+    return segment_by_sample(sample_offset);
+}
+
+std::size_t beatgrid_index::segment_by_beat(
+    double beat, std::size_t hint) const noexcept
+{
+    auto last_segment = samples_per_beat_.size() - 1;
+    for (auto segment = hint; segment <= hint + 1 && segment <= last_segment;
+         ++segment)
+    {
+        if ((segment == 0 || beat >= beats_[segment]) &&
+            (segment == last_segment || beat < beats_[segment + 1]))
+        {
+            return segment;
+        }
+    }
+
+    return segment_by_beat(beat);
+}
+
+double beatgrid_index::beat_in(
+    std::size_t segment, double sample_offset) const noexcept
+{
+    return beats_[segment] +
+           (sample_offset - sample_offsets_[segment]) /
+               samples_per_beat_[segment];
+}
+
+double beatgrid_index::sample_offset_in(
+    std::size_t segment, double beat) const noexcept
+{
+    return sample_offsets_[segment] +
+           (beat - beats_[segment]) * samples_per_beat_[segment];
+}
+
+double beatgrid_index::beat_at(double sample_offset) const noexcept
+{
+    return beat_in(segment_by_sample(sample_offset), sample_offset);
+}
+
+double beatgrid_index::sample_offset_of(double beat) const noexcept
+{
+    return sample_offset_in(segment_by_beat(beat), beat);
+}
+
+double beatgrid_index::samples_per_beat_at(double sample_offset) const noexcept
+{
+    return samples_per_beat_[segment_by_sample(sample_offset)];
+}
+
+double beatgrid_index::nearest_downbeat(double sample_offset) const noexcept
+{
+    auto beat = beat_at(sample_offset);
+    auto downbeat = std::round(beat / beats_per_bar_) * beats_per_bar_;
+    return sample_offset_of(downbeat);
+}
+
+double beatgrid_index::quantize(double sample_offset, int subdivisions) const
+{
+    check_subdivisions(subdivisions);
+    auto beat = beat_at(sample_offset);
+    auto snapped = std::round(beat * subdivisions) / subdivisions;
+    return sample_offset_of(snapped);
+}
+
+void beatgrid_index::beats_at(
+    std::span<const double> sample_offsets, std::span<double> beats) const
+{
+    check_sizes(sample_offsets.size(), beats.size());
+    std::size_t segment = 0;
+    for (std::size_t i = 0; i < sample_offsets.size(); ++i)
+    {
+        segment = segment_by_sample(sample_offsets[i], segment);
+        beats[i] = beat_in(segment, sample_offsets[i]);
+    }
+}
+
+void beatgrid_index::sample_offsets_of(
+    std::span<const double> beats, std::span<double> sample_offsets) const
+{
+    check_sizes(beats.size(), sample_offsets.size());
+    std::size_t segment = 0;
+    for (std::size_t i = 0; i < beats.size(); ++i)
+    {
+        segment = segment_by_beat(beats[i], segment);
+        sample_offsets[i] = sample_offset_in(segment, beats[i]);
+    }
+}
+
+void beatgrid_index::nearest_downbeats(
+    std::span<const double> sample_offsets, std::span<double> downbeats) const
+{
+    check_sizes(sample_offsets.size(), downbeats.size());
+    std::size_t sample_segment = 0;
+    std::size_t beat_segment = 0;
+    for (std::size_t i = 0; i < sample_offsets.size(); ++i)
+    {
+        sample_segment = segment_by_sample(sample_offsets[i], sample_segment);
+        auto beat = beat_in(sample_segment, sample_offsets[i]);
+        auto downbeat = std::round(beat / beats_per_bar_) * beats_per_bar_;
+        beat_segment = segment_by_beat(downbeat, beat_segment);
+        downbeats[i] = sample_offset_in(beat_segment, downbeat);
+    }
+}
+
+void beatgrid_index::quantize(
+    std::span<const double> sample_offsets, std::span<double> quantized,
+    int subdivisions) const
+{
+    check_sizes(sample_offsets.size(), quantized.size());
+    check_subdivisions(subdivisions);
+    std::size_t sample_segment = 0;
+    std::size_t beat_segment = 0;
+    for (std::size_t i = 0; i < sample_offsets.size(); ++i)
+    {
+        sample_segment = segment_by_sample(sample_offsets[i], sample_segment);
+        auto beat = beat_in(sample_segment, sample_offsets[i]);
+        auto snapped = std::round(beat * subdivisions) / subdivisions;
+        beat_segment = segment_by_beat(snapped, beat_segment);
+        quantized[i] = sample_offset_in(beat_segment, snapped);
+    }
+}
+
+}  // namespace djinterop::analysis
@@ -0,0 +1,393 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/analysis/waveform_builder.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+#include "../engine/track_utils.hpp"
+#include "../util/parallel_for.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DJINTEROP_ANALYSIS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DJINTEROP_ANALYSIS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace djinterop::analysis
+{
+namespace
+{
+// Crossover frequencies between the low, mid, and high bands.
+constexpr double low_crossover_hz = 200;
+constexpr double high_crossover_hz = 2500;
+
+// Added to the filter input to keep the filter state out of the denormal
+// range during silence, which would otherwise be very slow.  It is far below
+// the resolution of an 8-bit waveform.
+constexpr float anti_denormal = 1e-18f;
+
+/// Four lanes of single-precision floats, one per filter.
+struct vec4
+{
+#if defined(DJINTEROP_ANALYSIS_SSE2)
+    __m128 v;
+
+    static vec4 load(const float* p) { return {_mm_load_ps(p)}; }
+    static vec4 broadcast(float x) { return {_mm_set1_ps(x)}; }
+    void store(float* p) const { _mm_store_ps(p, v); }
+    friend vec4 operator+(vec4 a, vec4 b) { return {_mm_add_ps(a.v, b.v)}; }
+    friend vec4 operator-(vec4 a, vec4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+    friend vec4 operator*(vec4 a, vec4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+    friend vec4 max(vec4 a, vec4 b) { return {_mm_max_ps(a.v, b.v)}; }
+    friend vec4 abs(vec4 a)
+    {
+        return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)};
+    }
+#elif defined(DJINTEROP_ANALYSIS_NEON)
+    float32x4_t v;
+
+    static vec4 load(const float* p) { return {vld1q_f32(p)}; }
+    static vec4 broadcast(float x) { return {vdupq_n_f32(x)}; }
+    void store(float* p) const { vst1q_f32(p, v); }
+    friend vec4 operator+(vec4 a, vec4 b) { return {vaddq_f32(a.v, b.v)}; }
+    friend vec4 operator-(vec4 a, vec4 b) { return {vsubq_f32(a.v, b.v)}; }
+    friend vec4 operator*(vec4 a, vec4 b) { return {vmulq_f32(a.v, b.v)}; }
+    friend vec4 max(vec4 a, vec4 b) { return {vmaxq_f32(a.v, b.v)}; }
+    friend vec4 abs(vec4 a) { return {vabsq_f32(a.v)}; }
+#else
+    float v[4];
+
+    static vec4 load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+    static vec4 broadcast(float x) { return {{x, x, x, x}}; }
+    void store(float* p) const { std::copy(v, v + 4, p); }
+
+    template <typename F>
+    static vec4 apply(vec4 a, vec4 b, F f)
+    {
+        return {{f(a.v[0], b.v[0]), f(a.v[1], b.v[1]), f(a.v[2], b.v[2]),
+                 f(a.v[3], b.v[3])}};
+    }
+
+    friend vec4 operator+(vec4 a, vec4 b)
+    {
+        return apply(a, b, [](float x, float y) { return x + y; });
+    }
+    friend vec4 operator-(vec4 a, vec4 b)
+    {
+        return apply(a, b, [](float x, float y) { return x - y; });
+    }
+    friend vec4 operator*(vec4 a, vec4 b)
+    {
+        return apply(a, b, [](float x, float y) { return x * y; });
+    }
+    friend vec4 max(vec4 a, vec4 b)
+    {
+        return apply(a, b, [](float x, float y) { return std::max(x, y); });
+    }
+    friend vec4 abs(vec4 a)
+    {
+        return apply(a, a, [](float x, float) { return std::fabs(x); });
+    }
+#endif
+};
+
+/// Normalised biquad coefficients, per the RBJ audio EQ cookbook.
+struct biquad_coefficients
+{
+    float b0, b1, b2, a1, a2;
+};
+
+enum class biquad_type
+{
+    low_pass,
+    band_pass,
+    high_pass,
+};
+
+biquad_coefficients make_biquad(
+    biquad_type type, double frequency, double q, double sample_rate)
+{
+    // Keep the filter stable for low sample rates.
+    frequency = std::min(frequency, 0.45 * sample_rate);
+
+    auto w0 = 2 * std::numbers::pi * frequency / sample_rate;
+    auto cos_w0 = std::cos(w0);
+    auto alpha = std::sin(w0) / (2 * q);
+    auto a0 = 1 + alpha;
+
+    double b0, b1, b2;
+    switch (type)
+    {
+        case biquad_type::low_pass:
+            b0 = (1 - cos_w0) / 2;
+            b1 = 1 - cos_w0;
+            b2 = b0;
+            break;
+        case biquad_type::band_pass:
+            b0 = alpha;
+            b1 = 0;
+            b2 = -alpha;
+            break;
+        case biquad_type::high_pass:
+        default:
+            b0 = (1 + cos_w0) / 2;
+            b1 = -(1 + cos_w0);
+            b2 = b0;
+            break;
+    }
+
+    return biquad_coefficients{
+        static_cast<float>(b0 / a0), static_cast<float>(b1 / a0),
+        static_cast<float>(b2 / a0), static_cast<float>(-2 * cos_w0 / a0),
+        static_cast<float>((1 - alpha) / a0)};
+}
+
+uint8_t to_waveform_value(float peak)
+{
+    return static_cast<uint8_t>(
+        std::lround(std::clamp(peak, 0.0f, 1.0f) * 255.0f));
+}
+}  // anonymous namespace
+
+class waveform_builder::impl
+{
+public:
+    impl(double sample_rate, unsigned int channels) :
+        channels_{channels},
+        samples_per_entry_{static_cast<std::size_t>(
+            engine::util::waveform_quantisation_number(sample_rate))}
+    {
+        if (samples_per_entry_ == 0)
+        {
+            throw std::invalid_argument{
+                "Sample rate is too low to build a waveform"};
+        }
+
+        if (channels == 0)
+        {
+            throw std::invalid_argument{
+                "Audio must have at least one channel"};
+        }
+
+        // The low and high bands are second-order Butterworth filters, and
+        // the mid band is a band-pass filter spanning the two crossovers.  The
+        // fourth lane is unused.
+        auto butterworth_q = 1 / std::numbers::sqrt2;
+        auto mid_frequency = std::sqrt(low_crossover_hz * high_crossover_hz);
+        auto mid_q = mid_frequency / (high_crossover_hz - low_crossover_hz);
+        biquad_coefficients filters[] = {
+            make_biquad(
+                biquad_type::low_pass, low_crossover_hz, butterworth_q,
+                sample_rate),
+            make_biquad(
+                biquad_type::band_pass, mid_frequency, mid_q, sample_rate),
+            make_biquad(
+                biquad_type::high_pass, high_crossover_hz, butterworth_q,
+                sample_rate),
+            biquad_coefficients{0, 0, 0, 0, 0},
+        };
+
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            b0_[lane] = filters[lane].b0;
+            b1_[lane] = filters[lane].b1;
+            b2_[lane] = filters[lane].b2;
+            a1_[lane] = filters[lane].a1;
+            a2_[lane] = filters[lane].a2;
+        }
+
+        reset();
+    }
+
+    template <typename T>
+    void append(const T* samples, std::size_t frame_count, float scale)
+    {
+        // Mix down to mono, scaling to the nominal range [-1, 1].
+        mono_.resize(frame_count);
+        auto gain = scale / channels_;
+        for (std::size_t i = 0; i < frame_count; ++i)
+        {
+            float sum = 0;
+            for (unsigned int c = 0; c < channels_; ++c)
+            {
+                sum += static_cast<float>(samples[i * channels_ + c]);
+            }
+
+            mono_[i] = sum * gain + anti_denormal;
+        }
+
+        filter(mono_.data(), frame_count);
+        sample_count_ += frame_count;
+    }
+
+    std::size_t samples_per_entry() const noexcept
+    {
+        return samples_per_entry_;
+    }
+
+    unsigned long long sample_count() const noexcept { return sample_count_; }
+
+    std::vector<waveform_entry> finish()
+    {
+        if (frames_in_entry_ > 0)
+        {
+            emit_entry();
+        }
+
+        auto result = std::move(entries_);
+        reset();
+        return result;
+    }
+
+private:
+    void reset()
+    {
+        std::fill(std::begin(z1_), std::end(z1_), 0.0f);
+        std::fill(std::begin(z2_), std::end(z2_), 0.0f);
+        std::fill(std::begin(peak_), std::end(peak_), 0.0f);
+        entries_.clear();
+        frames_in_entry_ = 0;
+        sample_count_ = 0;
+    }
+
+    /// Run the filter bank over a block of mono samples.
+    ///
+    /// The three band filters are evaluated together in the lanes of a
+    /// vector register, as transposed direct form II biquads, tracking the
+    /// peak absolute output of each lane.
+    void filter(const float* mono, std::size_t count)
+    {
+        auto b0 = vec4::load(b0_);
+        auto b1 = vec4::load(b1_);
+        auto b2 = vec4::load(b2_);
+        auto a1 = vec4::load(a1_);
+        auto a2 = vec4::load(a2_);
+        auto z1 = vec4::load(z1_);
+        auto z2 = vec4::load(z2_);
+        auto peak = vec4::load(peak_);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto x = vec4::broadcast(mono[i]);
+            auto y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            peak = max(peak, abs(y));
+
+            if (++frames_in_entry_ == samples_per_entry_)
+            {
+                peak.store(peak_);
+                emit_entry();
+                peak = vec4::broadcast(0);
+            }
+        }
+
+        z1.store(z1_);
+        z2.store(z2_);
+        peak.store(peak_);
+    }
+
+    void emit_entry()
+    {
+        entries_.push_back(waveform_entry{
+            waveform_point{to_waveform_value(peak_[0])},
+            waveform_point{to_waveform_value(peak_[1])},
+            waveform_point{to_waveform_value(peak_[2])}});
+        std::fill(std::begin(peak_), std::end(peak_), 0.0f);
+        frames_in_entry_ = 0;
+    }
+
+    unsigned int channels_;
+    std::size_t samples_per_entry_;
+
+    alignas(16) float b0_[4];
+    alignas(16) float b1_[4];
+    alignas(16) float b2_[4];
+    alignas(16) float a1_[4];
+    alignas(16) float a2_[4];
+    alignas(16) float z1_[4];
+    alignas(16) float z2_[4];
+    alignas(16) float peak_[4];
+
+    std::vector<float> mono_;
+    std::vector<waveform_entry> entries_;
+    std::size_t frames_in_entry_ = 0;
+    unsigned long long sample_count_ = 0;
+};
+
+waveform_builder::waveform_builder(double sample_rate, unsigned int channels) :
+    pimpl_{std::make_unique<impl>(sample_rate, channels)}
+{
+}
+
+waveform_builder::waveform_builder(waveform_builder&& other) noexcept = default;
+
+waveform_builder::~waveform_builder() = default;
+
+waveform_builder& waveform_builder::operator=(
+    waveform_builder&& other) noexcept = default;
+
+void waveform_builder::append(const float* samples, std::size_t frame_count)
+{
+    pimpl_->append(samples, frame_count, 1.0f);
+}
+
+void waveform_builder::append(const int16_t* samples, std::size_t frame_count)
+{
+    pimpl_->append(samples, frame_count, 1.0f / 32768.0f);
+}
+
+std::size_t waveform_builder::samples_per_entry() const noexcept
+{
+    return pimpl_->samples_per_entry();
+}
+
+unsigned long long waveform_builder::sample_count() const noexcept
+{
+    return pimpl_->sample_count();
+}
+
+std::vector<waveform_entry> waveform_builder::finish()
+{
+    return pimpl_->finish();
+}
+
+std::vector<std::vector<waveform_entry>> build_waveforms(
+    const std::vector<waveform_job>& jobs, std::size_t max_workers)
+{
+    std::vector<std::vector<waveform_entry>> results(jobs.size());
+    util::parallel_for(
+        jobs.size(), max_workers,
+        [&](std::size_t i)
+        {
+            auto& job = jobs[i];
+            waveform_builder builder{job.sample_rate, job.channels};
+            job.decode(builder);
+            results[i] = builder.finish();
+        });
+
+    return results;
+}
+
+}  // namespace djinterop::analysis
@@ -21,6 +21,7 @@
 #include <djinterop/djinterop.hpp>
 
 #include "impl/crate_impl.hpp"
+#include "util/sql_trace.hpp"
 #include "djinterop/crate.hpp"
 
 namespace djinterop
@@ -33,86 +34,103 @@ crate& crate::operator=(const crate& other) noexcept = default;
 
 void crate::add_track(int64_t track_id) const
 {
+    util::api_operation operation{"crate::add_track"};
     pimpl_->add_track(track_id);
 }
 
 void crate::add_track(track tr) const
 {
+    util::api_operation operation{"crate::add_track"};
     pimpl_->add_track(tr);
 }
 
 std::vector<crate> crate::children() const
 {
+    util::api_operation operation{"crate::children"};
     return pimpl_->children();
 }
 
 void crate::clear_tracks() const
 {
+    util::api_operation operation{"crate::clear_tracks"};
     pimpl_->clear_tracks();
 }
 
 crate crate::create_sub_crate(const std::string& name)
 {
+    util::api_operation operation{"crate::create_sub_crate"};
     return pimpl_->create_sub_crate(name);
 }
 
 crate crate::create_sub_crate_after(const std::string& name, const crate& after)
 {
+    util::api_operation operation{"crate::create_sub_crate_after"};
     return pimpl_-> create_sub_crate_after(name, after);
 }
 
 database crate::db() const
 {
+    util::api_operation operation{"crate::db"};
     return pimpl_->db();
 }
 
 std::vector<crate> crate::descendants() const
 {
+    util::api_operation operation{"crate::descendants"};
     return pimpl_->descendants();
 }
 
 int64_t crate::id() const
 {
+    util::api_operation operation{"crate::id"};
     return pimpl_->id();
 }
 
 bool crate::is_valid() const
 {
+    util::api_operation operation{"crate::is_valid"};
     return pimpl_->is_valid();
 }
 
 std::string crate::name() const
 {
+    util::api_operation operation{"crate::name"};
     return pimpl_->name();
 }
 
 std::optional<crate> crate::parent() const
 {
+    util::api_operation operation{"crate::parent"};
     return pimpl_->parent();
 }
 
 void crate::remove_track(track tr) const
 {
+    util::api_operation operation{"crate::remove_track"};
     pimpl_->remove_track(tr);
 }
 
 void crate::set_name(std::string name) const
 {
+    util::api_operation operation{"crate::set_name"};
     pimpl_->set_name(name);
 }
 
 void crate::set_parent(std::optional<crate> parent) const
 {
+    util::api_operation operation{"crate::set_parent"};
     pimpl_->set_parent(parent);
 }
 
 std::optional<crate> crate::sub_crate_by_name(const std::string& name) const
 {
+    util::api_operation operation{"crate::sub_crate_by_name"};
     return pimpl_->sub_crate_by_name(name);
 }
 
 std::vector<track> crate::tracks() const
 {
+    util::api_operation operation{"crate::tracks"};
     return pimpl_->tracks();
 }
 
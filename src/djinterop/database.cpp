@@ -20,6 +20,7 @@
 #include <djinterop/djinterop.hpp>
 
 #include "impl/database_impl.hpp"
+#include "util/sql_trace.hpp"
 #include "djinterop/database.hpp"
 
 
@@ -38,104 +39,198 @@ bool database::supports_feature(const feature& feature) const noexcept
 
 std::optional<crate> database::crate_by_id(int64_t id) const
 {
+    util::api_operation operation{"database::crate_by_id"};
     return pimpl_->crate_by_id(id);
 }
 
 playlist database::create_root_playlist(const std::string& name)
 {
+    util::api_operation operation{"database::create_root_playlist"};
     return pimpl_->create_root_playlist(name);
 }
 
 playlist database::create_root_playlist_after(const std::string& name, const playlist& after)
 {
+    util::api_operation operation{"database::create_root_playlist_after"};
     return pimpl_->create_root_playlist_after(name, *after.pimpl_);
 }
 
 crate database::create_root_crate(const std::string& name)
 {
+    util::api_operation operation{"database::create_root_crate"};
     return pimpl_->create_root_crate(name);
 }
 
 crate database::create_root_crate_after(const std::string& name, const crate& after)
 {
+    util::api_operation operation{"database::create_root_crate_after"};
     return pimpl_->create_root_crate_after(name, after);
 }
 
 track database::create_track(const track_snapshot& snapshot)
 {
+    util::api_operation operation{"database::create_track"};
     return pimpl_->create_track(snapshot);
 }
 
+std::vector<track> database::create_tracks(
+    const std::vector<track_snapshot>& snapshots)
+{
+    util::api_operation operation{"database::create_tracks"};
+    return pimpl_->create_tracks(snapshots);
+}
+
 std::string database::directory() const
 {
+    util::api_operation operation{"database::directory"};
     return pimpl_->directory();
 }
 
 void database::verify() const
 {
+    util::api_operation operation{"database::verify"};
     pimpl_->verify();
 }
 
 void database::remove_crate(crate cr) const
 {
+    util::api_operation operation{"database::remove_crate"};
     pimpl_->remove_crate(cr);
 }
 
 void database::remove_playlist(playlist pl) const
 {
+    util::api_operation operation{"database::remove_playlist"};
     pimpl_->remove_playlist(*pl.pimpl_);
 }
 
 void database::remove_track(track tr) const
 {
+    util::api_operation operation{"database::remove_track"};
     pimpl_->remove_track(tr);
 }
 
 std::vector<crate> database::root_crates() const
 {
+    util::api_operation operation{"database::root_crates"};
     return pimpl_->root_crates();
 }
 
 std::optional<crate> database::root_crate_by_name(
     const std::string& name) const
 {
+    util::api_operation operation{"database::root_crate_by_name"};
     return pimpl_->root_crate_by_name(name);
 }
 
 std::vector<playlist> database::root_playlists() const
 {
+    util::api_operation operation{"database::root_playlists"};
     return pimpl_->root_playlists();
 }
 
 std::optional<playlist> database::root_playlist_by_name(
     const std::string& name) const
 {
+    util::api_operation operation{"database::root_playlist_by_name"};
     return pimpl_->root_playlist_by_name(name);
 }
 
+void database::set_observer(std::shared_ptr<sql_observer> observer) const
+{
+    pimpl_->set_observer(std::move(observer));
+}
+
+void database::set_metrics_enabled(bool enabled) const
+{
+    util::api_operation operation{"database::set_metrics_enabled"};
+    pimpl_->set_metrics_enabled(enabled);
+}
+
 std::optional<track> database::track_by_id(int64_t id) const
 {
+    util::api_operation operation{"database::track_by_id"};
     return pimpl_->track_by_id(id);
 }
 
 std::vector<track> database::tracks() const
 {
+    util::api_operation operation{"database::tracks"};
     return pimpl_->tracks();
 }
 
 std::vector<track> database::tracks_by_relative_path(
     const std::string& relative_path) const
 {
+    util::api_operation operation{"database::tracks_by_relative_path"};
     return pimpl_->tracks_by_relative_path(relative_path);
 }
 
+database_metrics database::metrics() const
+{
+    return pimpl_->metrics();
+}
+
+track_query database::query() const
+{
+    return track_query{pimpl_};
+}
+
+std::vector<int64_t> database::search(
+    const std::string& text, std::size_t limit) const
+{
+    util::api_operation operation{"database::search"};
+    return pimpl_->search(text, limit);
+}
+
+std::shared_ptr<const track_feature_index> database::feature_index() const
+{
+    util::api_operation operation{"database::feature_index"};
+    return pimpl_->feature_index();
+}
+
+std::vector<int64_t> database::similar_tracks(
+    const track& tr, std::size_t k) const
+{
+    util::api_operation operation{"database::similar_tracks"};
+    return pimpl_->similarity_index()->nearest(tr.id(), k);
+}
+
+std::vector<std::vector<int64_t>> database::similar_tracks(
+    const std::vector<track>& tracks, std::size_t k,
+    std::size_t max_workers) const
+{
+    util::api_operation operation{"database::similar_tracks"};
+    std::vector<int64_t> ids;
+    ids.reserve(tracks.size());
+    for (auto&& tr : tracks)
+        ids.push_back(tr.id());
+
+    return pimpl_->similarity_index()->nearest(ids, k, max_workers);
+}
+
+std::vector<duplicate_group> database::find_duplicates(
+    const duplicate_policy& policy) const
+{
+    util::api_operation operation{"database::find_duplicates"};
+    return pimpl_->find_duplicates(policy);
+}
+
+void database::merge_duplicates(const std::vector<duplicate_group>& groups) const
+{
+    util::api_operation operation{"database::merge_duplicates"};
+    pimpl_->merge_duplicates(groups);
+}
+
 std::string database::uuid() const
 {
+    util::api_operation operation{"database::uuid"};
     return pimpl_->uuid();
 }
 
 std::string database::version_name() const
 {
+    util::api_operation operation{"database::version_name"};
     return pimpl_->version_name();
 }
 
@@ -20,12 +20,20 @@
 #include <sqlite_modern_cpp.h>
 
 #include <djinterop/engine/engine.hpp>
+#include <djinterop/track.hpp>
+#include <djinterop/track_snapshot.hpp>
 #include <memory>
 #include <utility>
 
+#include "../util/metrics.hpp"
+#include "../util/sqlite_transaction.hpp"
 #include "engine_library_context.hpp"
 #include "engine_library_dir_utils.hpp"
 #include "schema/schema.hpp"
+#include "schema/schema_fingerprint.hpp"
+#include "schema/schema_image.hpp"
+#include "track_duplicates_sql.hpp"
+#include "track_query_sql.hpp"
 
 namespace djinterop::engine
 {
@@ -48,6 +56,16 @@ std::shared_ptr<engine_library_context> base_engine_library::load(
 std::shared_ptr<engine_library_context> base_engine_library::create(
     const std::string& directory, const engine_schema& schema)
 {
+    if (schema::is_schema_image_supported(schema))
+    {
+        // Write a copy of the pre-built empty schema directly to disk.
+        auto db = create_database2_sqlite_database(
+            directory, schema::get_schema_image(schema));
+        schema::stamp_new_identity(db);
+        return std::make_shared<engine_library_context>(
+            directory, true, schema, std::move(db));
+    }
+
     auto db = create_database2_sqlite_database(directory);
 
     auto schema_creator = schema::make_schema_creator_validator(schema);
@@ -62,6 +80,15 @@ std::shared_ptr<engine_library_context> base_engine_library::create_temporary(
 {
     auto db = create_temporary_database2_sqlite_database();
 
+    if (schema::is_schema_image_supported(schema))
+    {
+        // Load a copy of the pre-built empty schema into the new database.
+        schema::deserialize_schema_image(db, schema::get_schema_image(schema));
+        schema::stamp_new_identity(db);
+        return std::make_shared<engine_library_context>(
+            ":memory:", true, schema, std::move(db));
+    }
+
     // Create the desired schema on the new database.
     auto schema_creator = schema::make_schema_creator_validator(schema);
     schema_creator->create(db);
@@ -77,8 +104,7 @@ bool base_engine_library::exists(const std::string& directory)
 
 void base_engine_library::verify() const
 {
-    auto validator = schema::make_schema_creator_validator(context_->schema);
-    validator->verify(context_->db);
+    schema::verify_schema(context_->db, context_->schema);
 }
 
 std::string base_engine_library::directory() const
@@ -91,4 +117,83 @@ engine_schema base_engine_library::schema() const
     return context_->schema;
 }
 
+database_metrics base_engine_library::metrics() const
+{
+    database_metrics result;
+    context_->tracer.snapshot_metrics(result);
+    djinterop::util::snapshot_codec_metrics(result);
+    return result;
+}
+
+void base_engine_library::set_observer(std::shared_ptr<sql_observer> observer)
+{
+    context_->tracer.set_observer(std::move(observer));
+}
+
+void base_engine_library::set_metrics_enabled(bool enabled)
+{
+    context_->tracer.set_metrics_enabled(enabled);
+}
+
+std::vector<int64_t> base_engine_library::query_track_ids(
+    const track_query_criteria& criteria) const
+{
+    return engine::query_track_ids(
+        context_->db, criteria, track_query_layout::database2);
+}
+
+std::vector<track_query_row> base_engine_library::query_track_rows(
+    const track_query_criteria& criteria) const
+{
+    return engine::query_track_rows(
+        context_->db, criteria, track_query_layout::database2);
+}
+
+std::vector<int64_t> base_engine_library::search(
+    const std::string& text, std::size_t limit) const
+{
+    return context_->search.search(text, limit);
+}
+
+std::shared_ptr<const track_feature_index>
+base_engine_library::feature_index() const
+{
+    return context_->features.index();
+}
+
+std::shared_ptr<const track_similarity_index>
+base_engine_library::similarity_index() const
+{
+    return context_->similarity.index();
+}
+
+std::vector<duplicate_group> base_engine_library::find_duplicates(
+    const duplicate_policy& policy) const
+{
+    return find_duplicate_tracks(context_->db, context_->schema, policy);
+}
+
+void base_engine_library::merge_duplicates(
+    const std::vector<duplicate_group>& groups)
+{
+    merge_duplicate_tracks(context_->db, context_->schema, groups);
+}
+
+std::vector<track> base_engine_library::create_tracks(
+    const std::vector<track_snapshot>& snapshots)
+{
+    std::vector<track> results;
+    results.reserve(snapshots.size());
+
+    auto db = database();
+    util::sqlite_transaction trans{context_->db};
+    for (auto&& snapshot : snapshots)
+    {
+        results.push_back(db.create_track(snapshot));
+    }
+
+    trans.commit();
+    return results;
+}
+
 }  // namespace djinterop::engine
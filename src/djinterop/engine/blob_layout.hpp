@@ -0,0 +1,733 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "encode_decode_utils.hpp"
+
+// Declarative descriptions of the binary layout of Engine performance data
+// blobs.
+//
+// A blob layout is a `layout<T, Fields...>` naming the struct `T` it maps to
+// and the ordered fields that make up its serialised form.  From the layout,
+// the templates below derive the exact encoded size, the encoder, and a
+// bounds-checked decoder, without any per-format hand-written loops.  For
+// example:
+//
+//     using marker_layout = layout<
+//         marker, scalar<&marker::offset>, scalar<&marker::index>>;
+//     using grid_layout = layout<
+//         grid, scalar<&grid::rate, std::endian::big>,
+//         counted_array<&grid::markers, int64_t, std::endian::big,
+//                       marker_layout>,
+//         trailing_bytes<&grid::extra_data>>;
+//
+// Every field descriptor provides the following static members:
+//
+//   is_fixed    - true if the encoded size never depends on the value
+//   min_size    - the smallest possible encoded size, in bytes
+//   is_image    - true if the field is stored exactly as in memory
+//   size(obj)   - the encoded size of the field for a given object
+//   encode(obj, ptr) -> ptr
+//   decode(ptr, ctx, obj) -> ptr, checking bounds against the context
+//   encode_to(obj, sink) - encode via a `deflate_sink`, in bounded pieces
+//
+// Fixed-size fields additionally provide `decode_fixed(ptr, obj)`, which does
+// no bounds checking, so that runs of fixed-size records need only a single
+// bounds check for the whole run.
+namespace djinterop::engine::blob_layout
+{
+/// Bounds and naming information used while decoding a blob.
+struct decode_context
+{
+    /// One past the last byte of the blob being decoded.
+    const std::byte* end;
+
+    /// Human-readable name of the blob, used in error messages.
+    const char* name;
+
+    [[noreturn]] void fail(const char* problem) const
+    {
+        throw std::invalid_argument{std::string{name} + " " + problem};
+    }
+
+    void require(const std::byte* ptr, std::size_t length) const
+    {
+        if (static_cast<std::size_t>(end - ptr) < length)
+        {
+            fail("is truncated");
+        }
+    }
+};
+
+namespace detail
+{
+template <typename>
+struct member_pointer_traits;
+
+template <typename C, typename M>
+struct member_pointer_traits<M C::*>
+{
+    using class_type = C;
+    using member_type = M;
+};
+
+template <auto Member>
+using class_of_t =
+    typename member_pointer_traits<decltype(Member)>::class_type;
+
+template <auto Member>
+using member_of_t =
+    typename member_pointer_traits<decltype(Member)>::member_type;
+
+template <auto Member>
+std::ptrdiff_t offset_of(const class_of_t<Member>& probe) noexcept
+{
+    return reinterpret_cast<const std::byte*>(&(probe.*Member)) -
+           reinterpret_cast<const std::byte*>(&probe);
+}
+// Encode a field of bounded size through the sink's staging buffer.
+template <typename Field, typename C>
+void encode_staged(const C& obj, deflate_sink& sink)
+{
+    auto ptr = sink.reserve(Field::size(obj));
+    sink.commit(Field::encode(obj, ptr));
+}
+}  // namespace detail
+
+/// A single arithmetic value, stored with a given byte order and wire type.
+///
+/// \tparam Member Pointer to the data member.
+/// \tparam Order  Byte order of the value in the blob.
+/// \tparam Wire   Type of the value in the blob, if different to the member.
+template <
+    auto Member, std::endian Order = std::endian::little,
+    typename Wire = detail::member_of_t<Member> >
+struct scalar
+{
+    using class_type = detail::class_of_t<Member>;
+    using member_type = detail::member_of_t<Member>;
+
+    static constexpr bool is_fixed = true;
+    static constexpr std::size_t min_size = sizeof(Wire);
+    static constexpr bool is_image =
+        std::is_same_v<Wire, member_type> &&
+        (sizeof(Wire) == 1 || Order == std::endian::native);
+
+    static constexpr std::size_t size(const class_type&) noexcept
+    {
+        return min_size;
+    }
+
+    static std::byte* encode(const class_type& obj, std::byte* ptr) noexcept
+    {
+        engine::detail::store<Wire, Order>(
+            static_cast<Wire>(obj.*Member), ptr);
+        return ptr + sizeof(Wire);
+    }
+
+    static void encode_to(const class_type& obj, deflate_sink& sink)
+    {
+        detail::encode_staged<scalar>(obj, sink);
+    }
+
+    static const std::byte* decode_fixed(
+        const std::byte* ptr, class_type& obj) noexcept
+    {
+        obj.*Member = static_cast<member_type>(
+            engine::detail::load<Wire, Order>(ptr));
+        return ptr + sizeof(Wire);
+    }
+
+    static const std::byte* decode(
+        const std::byte* ptr, const decode_context& ctx, class_type& obj)
+    {
+        ctx.require(ptr, min_size);
+        return decode_fixed(ptr, obj);
+    }
+
+    static std::ptrdiff_t offset(const class_type& probe) noexcept
+    {
+        return detail::offset_of<Member>(probe);
+    }
+};
+
+/// An ordered sequence of fields making up the encoded form of `T`.
+template <typename T, typename... Fields>
+struct layout
+{
+    using value_type = T;
+
+    static constexpr bool is_fixed = (Fields::is_fixed && ...);
+    static constexpr std::size_t min_size = (std::size_t{0} + ... +
+                                             Fields::min_size);
+    static constexpr bool is_image = false;
+
+    static std::size_t size(const T& obj) noexcept
+    {
+        if constexpr (is_fixed)
+        {
+            return min_size;
+        }
+        else
+        {
+            return (std::size_t{0} + ... + Fields::size(obj));
+        }
+    }
+
+    static std::byte* encode(const T& obj, std::byte* ptr)
+    {
+        ((ptr = Fields::encode(obj, ptr)), ...);
+        return ptr;
+    }
+
+    static void encode_to(const T& obj, deflate_sink& sink)
+    {
+        if constexpr (is_fixed && min_size <= deflate_sink::staging_size)
+        {
+            detail::encode_staged<layout>(obj, sink);
+        }
+        else
+        {
+            (Fields::encode_to(obj, sink), ...);
+        }
+    }
+
+    static const std::byte* decode_fixed(const std::byte* ptr, T& obj) noexcept
+        requires is_fixed
+    {
+        ((ptr = Fields::decode_fixed(ptr, obj)), ...);
+        return ptr;
+    }
+
+    static const std::byte* decode(
+        const std::byte* ptr, const decode_context& ctx, T& obj)
+    {
+        if constexpr (is_fixed)
+        {
+            ctx.require(ptr, min_size);
+            return decode_fixed(ptr, obj);
+        }
+        else
+        {
+            ((ptr = Fields::decode(ptr, ctx, obj)), ...);
+            return ptr;
+        }
+    }
+
+    /// Determine whether an array of `T` in memory is byte-for-byte identical
+    /// to its encoded form, in which case it may be copied wholesale.
+    ///
+    /// The member offsets are computed from a probe object; the compiler
+    /// folds the whole check to a constant.
+    static bool is_memory_image() noexcept
+    {
+        if constexpr (
+            !(Fields::is_image && ...) || sizeof(T) != min_size ||
+            !std::is_trivially_copyable_v<T> ||
+            !std::is_default_constructible_v<T>)
+        {
+            return false;
+        }
+        else
+        {
+            T probe{};
+            std::ptrdiff_t expected = 0;
+            bool matches = true;
+            ((matches = matches && Fields::offset(probe) == expected,
+              expected += Fields::min_size),
+             ...);
+            return matches;
+        }
+    }
+};
+
+/// A sub-object, encoded in place with its own layout.
+template <auto Member, typename Layout>
+struct nested
+{
+    using class_type = detail::class_of_t<Member>;
+
+    static constexpr bool is_fixed = Layout::is_fixed;
+    static constexpr std::size_t min_size = Layout::min_size;
+    static constexpr bool is_image = false;
+
+    static std::size_t size(const class_type& obj) noexcept
+    {
+        return Layout::size(obj.*Member);
+    }
+
+    static std::byte* encode(const class_type& obj, std::byte* ptr)
+    {
+        return Layout::encode(obj.*Member, ptr);
+    }
+
+    static void encode_to(const class_type& obj, deflate_sink& sink)
+    {
+        Layout::encode_to(obj.*Member, sink);
+    }
+
+    static const std::byte* decode_fixed(
+        const std::byte* ptr, class_type& obj) noexcept
+        requires is_fixed
+    {
+        return Layout::decode_fixed(ptr, obj.*Member);
+    }
+
+    static const std::byte* decode(
+        const std::byte* ptr, const decode_context& ctx, class_type& obj)
+    {
+        return Layout::decode(ptr, ctx, obj.*Member);
+    }
+};
+
+/// A string, prefixed by its length.
+///
+/// Strings longer than the length type can represent are truncated.
+template <auto Member, typename Length = uint8_t>
+struct prefixed_string
+{
+    using class_type = detail::class_of_t<Member>;
+
+    static constexpr bool is_fixed = false;
+    static constexpr std::size_t min_size = sizeof(Length);
+    static constexpr bool is_image = false;
+
+    static std::size_t length(const class_type& obj) noexcept
+    {
+        constexpr auto max_length =
+            static_cast<std::size_t>(std::numeric_limits<Length>::max());
+        return std::min((obj.*Member).size(), max_length);
+    }
+
+    static std::size_t size(const class_type& obj) noexcept
+    {
+        return sizeof(Length) + length(obj);
+    }
+
+    static std::byte* encode(const class_type& obj, std::byte* ptr) noexcept
+    {
+        auto len = length(obj);
+        engine::detail::store<Length, std::endian::little>(
+            static_cast<Length>(len), ptr);
+        ptr += sizeof(Length);
+        std::memcpy(ptr, (obj.*Member).data(), len);
+        return ptr + len;
+    }
+
+    static void encode_to(const class_type& obj, deflate_sink& sink)
+    {
+        detail::encode_staged<prefixed_string>(obj, sink);
+    }
+
+    static const std::byte* decode(
+        const std::byte* ptr, const decode_context& ctx, class_type& obj)
+    {
+        ctx.require(ptr, sizeof(Length));
+        auto len = static_cast<std::size_t>(
+            engine::detail::load<Length, std::endian::little>(ptr));
+        ptr += sizeof(Length);
+        ctx.require(ptr, len);
+        (obj.*Member).assign(reinterpret_cast<const char*>(ptr), len);
+        return ptr + len;
+    }
+};
+
+/// Encode a run of records, one after another, using a record layout.
+template <typename Layout>
+std::byte* encode_records(
+    std::span<const typename Layout::value_type> records, std::byte* ptr)
+{
+    if constexpr (Layout::is_fixed)
+    {
+        if (Layout::is_memory_image())
+        {
+            std::memcpy(ptr, records.data(), records.size_bytes());
+            return ptr + records.size_bytes();
+        }
+
+        return encode_strided<Layout::min_size>(
+            records, ptr,
+            [](const typename Layout::value_type& record, std::byte* p)
+            { Layout::encode(record, p); });
+    }
+    else
+    {
+        for (auto&& record : records)
+        {
+            ptr = Layout::encode(record, ptr);
+        }
+
+        return ptr;
+    }
+}
+
+/// Decode a run of records using a fixed-size record layout.
+///
+/// The caller must ensure that enough data is available for all records.
+template <typename Layout>
+const std::byte* decode_records(
+    const std::byte* ptr, std::span<typename Layout::value_type> records)
+    requires Layout::is_fixed
+{
+    if (Layout::is_memory_image())
+    {
+        std::memcpy(records.data(), ptr, records.size_bytes());
+        return ptr + records.size_bytes();
+    }
+
+    return decode_strided<Layout::min_size>(
+        ptr, records,
+        [](const std::byte* p, typename Layout::value_type& record)
+        { Layout::decode_fixed(p, record); });
+}
+
+/// Encode a run of records through a deflate sink, in batches that fit the
+/// sink's staging buffer.
+template <typename Layout>
+void encode_records_to(
+    std::span<const typename Layout::value_type> records, deflate_sink& sink)
+{
+    if constexpr (
+        Layout::is_fixed && Layout::min_size <= deflate_sink::staging_size)
+    {
+        if (Layout::is_memory_image())
+        {
+            sink.write(
+                reinterpret_cast<const std::byte*>(records.data()),
+                records.size_bytes());
+            return;
+        }
+
+        constexpr auto batch_size =
+            deflate_sink::staging_size / Layout::min_size;
+        while (!records.empty())
+        {
+            auto batch = records.first(std::min(batch_size, records.size()));
+            auto ptr = sink.reserve(batch.size() * Layout::min_size);
+            sink.commit(encode_records<Layout>(batch, ptr));
+            records = records.subspan(batch.size());
+        }
+    }
+    else
+    {
+        for (auto&& record : records)
+        {
+            Layout::encode_to(record, sink);
+        }
+    }
+}
+
+/// The number of elements in a vector, stored ahead of the elements.
+///
+/// On decoding, the vector is resized to the stored count, after checking
+/// that the remaining data could hold that many elements.
+template <auto Member, typename Count, std::endian Order, typename Element>
+struct element_count
+{
+    using class_type = detail::class_of_t<Member>;
+
+    static_assert(Element::min_size > 0);
+
+    static constexpr bool is_fixed = true;
+    static constexpr std::size_t min_size = sizeof(Count);
+    static constexpr bool is_image = false;
+
+    static constexpr std::size_t size(const class_type&) noexcept
+    {
+        return min_size;
+    }
+
+    static std::byte* encode(const class_type& obj, std::byte* ptr) noexcept
+    {
+        engine::detail::store<Count, Order>(
+            static_cast<Count>((obj.*Member).size()), ptr);
+        return ptr + sizeof(Count);
+    }
+
+    static void encode_to(const class_type& obj, deflate_sink& sink)
+    {
+        detail::encode_staged<element_count>(obj, sink);
+    }
+
+    static const std::byte* decode(
+        const std::byte* ptr, const decode_context& ctx, class_type& obj)
+    {
+        ctx.require(ptr, min_size);
+        auto count = engine::detail::load<Count, Order>(ptr);
+        ptr += sizeof(Count);
+
+        if constexpr (std::is_signed_v<Count>)
+        {
+            if (count < 0)
+            {
+                ctx.fail("has a negative element count");
+            }
+        }
+
+        auto capacity =
+            static_cast<std::size_t>(ctx.end - ptr) / Element::min_size;
+        if (static_cast<std::make_unsigned_t<Count> >(count) > capacity)
+        {
+            ctx.fail("has an element count exceeding its length");
+        }
+
+        (obj.*Member).resize(static_cast<std::size_t>(count));
+        return ptr;
+    }
+};
+
+/// A repeat of an element count that has already been decoded.
+///
+/// Some formats store the element count twice; the two must agree.
+template <auto Member, typename Count, std::endian Order>
+struct repeated_element_count
+{
+    using class_type = detail::class_of_t<Member>;
+
+    static constexpr bool is_fixed = true;
+    static constexpr std::size_t min_size = sizeof(Count);
+    static constexpr bool is_image = false;
+
+    static constexpr std::size_t size(const class_type&) noexcept
+    {
+        return min_size;
+    }
+
+    static std::byte* encode(const class_type& obj, std::byte* ptr) noexcept
+    {
+        engine::detail::store<Count, Order>(
+            static_cast<Count>((obj.*Member).size()), ptr);
+        return ptr + sizeof(Count);
+    }
+
+    static void encode_to(const class_type& obj, deflate_sink& sink)
+    {
+        detail::encode_staged<repeated_element_count>(obj, sink);
+    }
+
+    static const std::byte* decode(
+        const std::byte* ptr, const decode_context& ctx, class_type& obj)
+    {
+        ctx.require(ptr, min_size);
+        auto count = engine::detail::load<Count, Order>(ptr);
+        if (static_cast<std::size_t>(count) != (obj.*Member).size())
+        {
+            ctx.fail("has conflicting length fields");
+        }
+
+        return ptr + sizeof(Count);
+    }
+};
+
+/// The elements of a vector whose size was given by an earlier
+/// `element_count` field.
+template <auto Member, typename Element>
+struct elements
+{
+    using class_type = detail::class_of_t<Member>;
+
+    static constexpr bool is_fixed = false;
+    static constexpr std::size_t min_size = 0;
+    static constexpr bool is_image = false;
+
+    static std::size_t size(const class_type& obj) noexcept
+    {
+        auto&& values = obj.*Member;
+        if constexpr (Element::is_fixed)
+        {
+            return values.size() * Element::min_size;
+        }
+        else
+        {
+            std::size_t total = 0;
+            for (auto&& value : values)
+            {
+                total += Element::size(value);
+            }
+
+            return total;
+        }
+    }
+
+    static std::byte* encode(const class_type& obj, std::byte* ptr)
+    {
+        return encode_records<Element>(std::span{obj.*Member}, ptr);
+    }
+
+    static void encode_to(const class_type& obj, deflate_sink& sink)
+    {
+        encode_records_to<Element>(std::span{obj.*Member}, sink);
+    }
+
+    static const std::byte* decode(
+        const std::byte* ptr, const decode_context& ctx, class_type& obj)
+    {
+        auto&& values = obj.*Member;
+        if constexpr (Element::is_fixed)
+        {
+            ctx.require(ptr, values.size() * Element::min_size);
+            return decode_records<Element>(ptr, std::span{values});
+        }
+        else
+        {
+            for (auto&& value : values)
+            {
+                ptr = Element::decode(ptr, ctx, value);
+            }
+
+            return ptr;
+        }
+    }
+};
+
+/// A vector of elements, immediately preceded by its element count.
+template <auto Member, typename Count, std::endian Order, typename Element>
+struct counted_array
+{
+    using class_type = detail::class_of_t<Member>;
+    using count_field = element_count<Member, Count, Order, Element>;
+    using elements_field = elements<Member, Element>;
+
+    static constexpr bool is_fixed = false;
+    static constexpr std::size_t min_size = count_field::min_size;
+    static constexpr bool is_image = false;
+
+    static std::size_t size(const class_type& obj) noexcept
+    {
+        return count_field::size(obj) + elements_field::size(obj);
+    }
+
+    static std::byte* encode(const class_type& obj, std::byte* ptr)
+    {
+        ptr = count_field::encode(obj, ptr);
+        return elements_field::encode(obj, ptr);
+    }
+
+    static void encode_to(const class_type& obj, deflate_sink& sink)
+    {
+        count_field::encode_to(obj, sink);
+        elements_field::encode_to(obj, sink);
+    }
+
+    static const std::byte* decode(
+        const std::byte* ptr, const decode_context& ctx, class_type& obj)
+    {
+        ptr = count_field::decode(ptr, ctx, obj);
+        return elements_field::decode(ptr, ctx, obj);
+    }
+};
+
+/// All remaining bytes of the blob, kept verbatim.
+///
+/// Must be the last field of the outermost layout.
+template <auto Member>
+struct trailing_bytes
+{
+    using class_type = detail::class_of_t<Member>;
+
+    static constexpr bool is_fixed = false;
+    static constexpr std::size_t min_size = 0;
+    static constexpr bool is_image = false;
+
+    static std::size_t size(const class_type& obj) noexcept
+    {
+        return (obj.*Member).size();
+    }
+
+    static std::byte* encode(const class_type& obj, std::byte* ptr) noexcept
+    {
+        return encode_extra(obj.*Member, ptr);
+    }
+
+    static void encode_to(const class_type& obj, deflate_sink& sink)
+    {
+        sink.write((obj.*Member).data(), (obj.*Member).size());
+    }
+
+    static const std::byte* decode(
+        const std::byte* ptr, const decode_context& ctx, class_type& obj)
+    {
+        std::tie(obj.*Member, ptr) = decode_extra(ptr, ctx.end);
+        return ptr;
+    }
+};
+
+/// Encode an object to a new buffer of exactly the right size.
+template <typename Layout>
+std::vector<std::byte> encode(const typename Layout::value_type& obj)
+{
+    std::vector<std::byte> result(Layout::size(obj));
+    [[maybe_unused]] auto ptr = Layout::encode(obj, result.data());
+    assert(ptr == result.data() + result.size());
+    return result;
+}
+
+/// Encode and compress an object, without materialising the uncompressed
+/// form in memory.
+template <typename Layout>
+std::vector<std::byte> encode_compressed(const typename Layout::value_type& obj)
+{
+    deflate_sink sink{Layout::size(obj)};
+    Layout::encode_to(obj, sink);
+    return sink.finish();
+}
+
+/// Decode an object from a buffer, which must be consumed exactly.
+///
+/// \param data Encoded data.
+/// \param name Human-readable name of the blob, used in error messages.
+/// \return Returns the decoded object.
+/// \throws std::invalid_argument If the data does not match the layout.
+template <typename Layout>
+typename Layout::value_type decode(
+    const std::vector<std::byte>& data, const char* name)
+{
+    const decode_context ctx{data.data() + data.size(), name};
+    if (data.size() < Layout::min_size)
+    {
+        ctx.fail(
+            ("has less than the minimum length of " +
+             std::to_string(Layout::min_size) + " bytes")
+                .c_str());
+    }
+
+    typename Layout::value_type result{};
+    auto ptr = Layout::decode(data.data(), ctx, result);
+    if (ptr != ctx.end)
+    {
+        ctx.fail("has too much data");
+    }
+
+    return result;
+}
+
+}  // namespace djinterop::engine::blob_layout
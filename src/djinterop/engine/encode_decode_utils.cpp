@@ -17,12 +17,15 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <stdexcept>
+#include <string>
 #include <system_error>
 #include <vector>
 
 #include <zlib.h>
 
+#include "../util/metrics.hpp"
 #include "encode_decode_utils.hpp"
 
 namespace djinterop::engine
@@ -47,6 +50,7 @@ std::vector<std::byte> zlib_uncompress(
         return uncompressed;  // Named RVO
     }
 
+    djinterop::util::stopwatch stopwatch;
     uncompressed.reserve(apparent_size);
 
     auto* ptr = &compressed[4];
@@ -109,72 +113,152 @@ std::vector<std::byte> zlib_uncompress(
             Z_DATA_ERROR, std::system_category(), "Error at end of inflation"};
     }
 
+    djinterop::util::record_zlib_uncompress(stopwatch.elapsed_ns());
     return uncompressed;  // Named RVO
 }
 
-// Compress a byte array using zlib
-std::vector<std::byte> zlib_compress(
-    const std::vector<std::byte>& uncompressed,
-    std::vector<std::byte> compressed)
+struct deflate_sink::impl
 {
-    // Put a placeholder four bytes to hold the uncompressed buffer size
-    compressed.resize(4);
-    encode_int32_be(
-        static_cast<int32_t>(uncompressed.size()), compressed.data());
-
-    // Compress
-    auto* ptr = &uncompressed[0];
-    auto* end = ptr + uncompressed.size();
-    const int chunk_size = 16384;
-    int ret, flush;
-    unsigned int have;
     z_stream strm;
-    std::byte out[chunk_size];
+    std::size_t uncompressed_size;
+    std::vector<std::byte> compressed;
+    bool finished = false;
+
+    // Grow the full output buffer geometrically, up to the worst-case
+    // compressed size.
+    void grow_output()
+    {
+        auto used = output_used();
+        auto bound =
+            4 + deflateBound(&strm, static_cast<uLong>(uncompressed_size));
+        auto new_size = std::max<std::size_t>(
+            used + 64, std::min<std::size_t>(used * 2, bound));
+        compressed.resize(new_size);
+        strm.next_out = reinterpret_cast<Bytef*>(compressed.data() + used);
+        strm.avail_out = static_cast<uInt>(new_size - used);
+    }
+
+    // Number of bytes of the output buffer that hold compressed data.
+    std::size_t output_used() const noexcept
+    {
+        return reinterpret_cast<const std::byte*>(strm.next_out) -
+               compressed.data();
+    }
+
+    void deflate_input(const std::byte* data, std::size_t length, int flush)
+    {
+        djinterop::util::stopwatch stopwatch;
+        strm.next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(data));
+        strm.avail_in = static_cast<uInt>(length);
+        int ret;
+        do
+        {
+            if (strm.avail_out == 0)
+            {
+                grow_output();
+            }
+
+            ret = deflate(&strm, flush);
+            if (ret == Z_STREAM_ERROR)
+            {
+                throw std::system_error{
+                    ret, std::system_category(),
+                    "Error calling deflate from zlib"};
+            }
+        } while (strm.avail_in != 0 ||
+                 (flush == Z_FINISH && ret != Z_STREAM_END));
+
+        djinterop::util::record_zlib_compress(stopwatch.elapsed_ns());
+    }
+};
 
-    // Allocate deflate state
+deflate_sink::deflate_sink(
+    std::size_t uncompressed_size, std::vector<std::byte> buffer) :
+    impl_{std::make_unique<impl>()}
+{
+    auto& strm = impl_->strm;
     strm.zalloc = Z_NULL;
     strm.zfree = Z_NULL;
     strm.opaque = Z_NULL;
-    ret = deflateInit(&strm, Z_DEFAULT_COMPRESSION);
+    auto ret = deflateInit(&strm, Z_DEFAULT_COMPRESSION);
     if (ret != Z_OK)
         throw std::system_error{
             ret, std::system_category(), "Error calling deflateInit from zlib"};
 
-    // Compress until end of input
-    do
+    // Put the uncompressed size in the first four bytes, and start with an
+    // output buffer large enough for typically-compressible data.
+    impl_->uncompressed_size = uncompressed_size;
+    impl_->compressed = std::move(buffer);
+    impl_->compressed.resize(4 + uncompressed_size / 4 + 64);
+    encode_int32_be(
+        static_cast<int32_t>(uncompressed_size), impl_->compressed.data());
+    strm.next_out = reinterpret_cast<Bytef*>(impl_->compressed.data() + 4);
+    strm.avail_out = static_cast<uInt>(impl_->compressed.size() - 4);
+}
+
+deflate_sink::~deflate_sink()
+{
+    if (!impl_->finished)
     {
-        strm.next_in = (Bytef*)ptr;
-        if (ptr + chunk_size < end)
-        {
-            strm.avail_in = chunk_size;
-            flush = Z_NO_FLUSH;
-        }
-        else
-        {
-            strm.avail_in = static_cast<uInt>(end - ptr);
-            flush = Z_FINISH;
-        }
-        ptr += strm.avail_in;
+        deflateEnd(&impl_->strm);
+    }
+}
 
-        // Run deflate() on input until output buffer not full, finish
-        // compression if all of source has been read in
-        do
-        {
-            strm.next_out = reinterpret_cast<Bytef*>(out);
-            strm.avail_out = chunk_size;
+void deflate_sink::write(const std::byte* data, std::size_t length)
+{
+    if (length == 0)
+    {
+        return;
+    }
 
-            deflate(&strm, flush); /* no bad return value */
+    if (length <= staging_size - used_)
+    {
+        std::memcpy(staging_.data() + used_, data, length);
+        used_ += length;
+        return;
+    }
 
-            have = chunk_size - strm.avail_out;
-            compressed.insert(compressed.end(), out, out + have);
-        } while (strm.avail_out == 0);
+    flush();
+    impl_->deflate_input(data, length, Z_NO_FLUSH);
+}
+
+void deflate_sink::flush()
+{
+    impl_->deflate_input(staging_.data(), used_, Z_NO_FLUSH);
+    used_ = 0;
+}
+
+std::vector<std::byte> deflate_sink::finish()
+{
+    impl_->deflate_input(staging_.data(), used_, Z_FINISH);
+    used_ = 0;
+
+    auto total_in = impl_->strm.total_in;
+    impl_->compressed.resize(impl_->output_used());
+    deflateEnd(&impl_->strm);
+    impl_->finished = true;
+
+    // The size in the header was fixed before encoding began, so the blob
+    // would be corrupt if the encoder wrote a different amount.
+    if (total_in != impl_->uncompressed_size)
+    {
+        throw std::runtime_error{
+            "Internal error in deflate_sink::finish(): wrote " +
+            std::to_string(total_in) + " bytes, but expected " +
+            std::to_string(impl_->uncompressed_size)};
+    }
 
-        // Done when last data in input processed
-    } while (flush != Z_FINISH);
+    return std::move(impl_->compressed);
+}
 
-    // Clean up and return
-    deflateEnd(&strm);
-    return compressed;
+// Compress a byte array using zlib
+std::vector<std::byte> zlib_compress(
+    const std::vector<std::byte>& uncompressed,
+    std::vector<std::byte> compressed)
+{
+    deflate_sink sink{uncompressed.size(), std::move(compressed)};
+    sink.write(uncompressed.data(), uncompressed.size());
+    return sink.finish();
 }
 
 }  // namespace djinterop::engine
@@ -17,10 +17,16 @@
 
 #pragma once
 
+#include <array>
+#include <bit>
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <memory>
+#include <span>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
 namespace djinterop::engine
@@ -35,6 +41,65 @@ std::vector<std::byte> zlib_compress(
     const std::vector<std::byte>& uncompressed,
     std::vector<std::byte> compressed = {});
 
+// Sink that deflates encoded data as it is written, producing a compressed
+// blob prefixed with the four-byte big-endian uncompressed size, in the same
+// format as `zlib_compress`.
+//
+// Encoders obtain space in a small fixed staging buffer with `reserve()`,
+// write encoded fields directly into it, and then `commit()` the end of what
+// they wrote.  Whenever the staging buffer fills, its contents are fed to
+// zlib, so the full uncompressed blob never exists in memory.  Large runs of
+// pre-encoded bytes can be passed straight to zlib with `write()`.
+class deflate_sink
+{
+public:
+    static constexpr std::size_t staging_size = 8192;
+
+    // Begin a compressed blob whose uncompressed size is known up front.
+    explicit deflate_sink(
+        std::size_t uncompressed_size, std::vector<std::byte> buffer = {});
+
+    ~deflate_sink();
+
+    deflate_sink(const deflate_sink&) = delete;
+    deflate_sink& operator=(const deflate_sink&) = delete;
+
+    // Obtain a pointer to at least `length` contiguous bytes of staging space.
+    std::byte* reserve(std::size_t length)
+    {
+        assert(length <= staging_size);
+        if (staging_size - used_ < length)
+        {
+            flush();
+        }
+
+        return staging_.data() + used_;
+    }
+
+    // Mark the staging space up to `end` as written.
+    void commit(const std::byte* end) noexcept
+    {
+        used_ = static_cast<std::size_t>(end - staging_.data());
+        assert(used_ <= staging_size);
+    }
+
+    // Write a run of already-encoded bytes.
+    void write(const std::byte* data, std::size_t length);
+
+    // Finish compression and return the compressed blob.  Throws
+    // `std::runtime_error` if the number of bytes written differs from the
+    // uncompressed size given on construction.
+    std::vector<std::byte> finish();
+
+private:
+    void flush();
+
+    struct impl;
+    std::unique_ptr<impl> impl_;
+    std::size_t used_ = 0;
+    std::array<std::byte, staging_size> staging_;
+};
+
 // Extract an int8_t from a raw value at ptr address
 inline std::pair<uint8_t, const std::byte*> decode_uint8(const std::byte* ptr)
 {
@@ -186,4 +251,230 @@ inline std::byte* encode_extra(
     return ptr + extra_data.size();
 }
 
+// Reverse the byte order of an unsigned integer.
+//
+// The shift-and-mask form is recognised by GCC, Clang and MSVC and lowered to
+// a single bswap/rev instruction, or to a byte shuffle when used in a loop.
+constexpr uint16_t byteswap(uint16_t value) noexcept
+{
+    return static_cast<uint16_t>((value << 8) | (value >> 8));
+}
+
+constexpr uint32_t byteswap(uint32_t value) noexcept
+{
+    return ((value & 0x000000FFu) << 24) | ((value & 0x0000FF00u) << 8) |
+           ((value & 0x00FF0000u) >> 8) | ((value & 0xFF000000u) >> 24);
+}
+
+constexpr uint64_t byteswap(uint64_t value) noexcept
+{
+    return (static_cast<uint64_t>(byteswap(static_cast<uint32_t>(value)))
+            << 32) |
+           byteswap(static_cast<uint32_t>(value >> 32));
+}
+
+namespace detail
+{
+// Unsigned integer type with the same width as T, used as the swap carrier.
+template <typename T>
+using swap_carrier_t = std::conditional_t<
+    sizeof(T) == 2, uint16_t,
+    std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t> >;
+
+template <typename T, std::endian Order>
+inline T load(const std::byte* ptr) noexcept
+{
+    static_assert(
+        std::is_trivially_copyable_v<T> &&
+        (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 ||
+         sizeof(T) == 8));
+    if constexpr (sizeof(T) == 1 || Order == std::endian::native)
+    {
+        T value;
+        std::memcpy(&value, ptr, sizeof(T));
+        return value;
+    }
+    else
+    {
+        swap_carrier_t<T> raw;
+        std::memcpy(&raw, ptr, sizeof(T));
+        raw = byteswap(raw);
+        T value;
+        std::memcpy(&value, &raw, sizeof(T));
+        return value;
+    }
+}
+
+template <typename T, std::endian Order>
+inline void store(T value, std::byte* ptr) noexcept
+{
+    static_assert(
+        std::is_trivially_copyable_v<T> &&
+        (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 ||
+         sizeof(T) == 8));
+    if constexpr (sizeof(T) == 1 || Order == std::endian::native)
+    {
+        std::memcpy(ptr, &value, sizeof(T));
+    }
+    else
+    {
+        swap_carrier_t<T> raw;
+        std::memcpy(&raw, &value, sizeof(T));
+        raw = byteswap(raw);
+        std::memcpy(ptr, &raw, sizeof(T));
+    }
+}
+
+template <typename T, std::endian Order>
+inline const std::byte* decode_array(const std::byte* ptr, std::span<T> out)
+{
+    if constexpr (sizeof(T) == 1 || Order == std::endian::native)
+    {
+        if (!out.empty())
+        {
+            std::memcpy(out.data(), ptr, out.size_bytes());
+        }
+    }
+    else
+    {
+        // Kept free of loop-carried dependencies so that it vectorises into a
+        // byte shuffle over the whole run.
+        for (std::size_t i = 0; i < out.size(); ++i)
+        {
+            out[i] = load<T, Order>(ptr + i * sizeof(T));
+        }
+    }
+
+    return ptr + out.size_bytes();
+}
+
+template <typename T, std::endian Order>
+inline std::byte* encode_array(std::span<const T> values, std::byte* ptr)
+{
+    if constexpr (sizeof(T) == 1 || Order == std::endian::native)
+    {
+        if (!values.empty())
+        {
+            std::memcpy(ptr, values.data(), values.size_bytes());
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            store<T, Order>(values[i], ptr + i * sizeof(T));
+        }
+    }
+
+    return ptr + values.size_bytes();
+}
+}  // namespace detail
+
+// Load a little-endian value of type T from ptr, without advancing.
+//
+// Unlike the decode_* functions above, these field accessors take no pointer
+// by reference and carry no dependency between calls, which allows the
+// compiler to vectorise loops that unpack many fixed-layout records.
+template <typename T>
+inline T load_le(const std::byte* ptr) noexcept
+{
+    return detail::load<T, std::endian::little>(ptr);
+}
+
+// Load a big-endian value of type T from ptr, without advancing.
+template <typename T>
+inline T load_be(const std::byte* ptr) noexcept
+{
+    return detail::load<T, std::endian::big>(ptr);
+}
+
+// Store a value of type T to ptr in little-endian order, without advancing.
+template <typename T>
+inline void store_le(T value, std::byte* ptr) noexcept
+{
+    detail::store<T, std::endian::little>(value, ptr);
+}
+
+// Store a value of type T to ptr in big-endian order, without advancing.
+template <typename T>
+inline void store_be(T value, std::byte* ptr) noexcept
+{
+    detail::store<T, std::endian::big>(value, ptr);
+}
+
+// Decode a run of raw bytes into an output span.
+inline const std::byte* decode_bytes(
+    const std::byte* ptr, std::span<uint8_t> out)
+{
+    return detail::decode_array<uint8_t, std::endian::native>(ptr, out);
+}
+
+// Encode a run of raw bytes verbatim.
+inline std::byte* encode_bytes(std::span<const uint8_t> values, std::byte* ptr)
+{
+    return detail::encode_array<uint8_t, std::endian::native>(values, ptr);
+}
+
+// Decode a contiguous run of little-endian values into an output span.
+//
+// On little-endian hosts this is a single memcpy.
+template <typename T>
+inline const std::byte* decode_array_le(const std::byte* ptr, std::span<T> out)
+{
+    return detail::decode_array<T, std::endian::little>(ptr, out);
+}
+
+// Decode a contiguous run of big-endian values into an output span.
+template <typename T>
+inline const std::byte* decode_array_be(const std::byte* ptr, std::span<T> out)
+{
+    return detail::decode_array<T, std::endian::big>(ptr, out);
+}
+
+// Encode a span of values as a contiguous little-endian run.
+template <typename T>
+inline std::byte* encode_array_le(std::span<const T> values, std::byte* ptr)
+{
+    return detail::encode_array<T, std::endian::little>(values, ptr);
+}
+
+// Encode a span of values as a contiguous big-endian run.
+template <typename T>
+inline std::byte* encode_array_be(std::span<const T> values, std::byte* ptr)
+{
+    return detail::encode_array<T, std::endian::big>(values, ptr);
+}
+
+// Unpack a run of fixed-size records, each `Stride` bytes long.
+//
+// The `unpack` function is called as `unpack(record_ptr, out[i])` and should
+// read fields at constant offsets from `record_ptr` using `load_le`/`load_be`,
+// so that the loop body contains no pointer bumping and can be vectorised.
+template <std::size_t Stride, typename T, typename Unpack>
+inline const std::byte* decode_strided(
+    const std::byte* ptr, std::span<T> out, Unpack&& unpack)
+{
+    for (std::size_t i = 0; i < out.size(); ++i)
+    {
+        unpack(ptr + i * Stride, out[i]);
+    }
+
+    return ptr + out.size() * Stride;
+}
+
+// Pack a run of fixed-size records, each `Stride` bytes long.
+//
+// The `pack` function is called as `pack(values[i], record_ptr)`.
+template <std::size_t Stride, typename T, typename Pack>
+inline std::byte* encode_strided(
+    std::span<const T> values, std::byte* ptr, Pack&& pack)
+{
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        pack(values[i], ptr + i * Stride);
+    }
+
+    return ptr + values.size() * Stride;
+}
+
 }  // namespace djinterop::engine
@@ -17,9 +17,8 @@
 
 #include <djinterop/engine/engine.hpp>
 
+#include <algorithm>
 #include <cmath>
-#include <fstream>
-#include <sstream>
 #include <stdexcept>
 #include <string>
 
@@ -27,6 +26,8 @@
 #include <djinterop/engine/v3/engine_library.hpp>
 
 #include "../util/filesystem.hpp"
+#include "../util/parallel_for.hpp"
+#include "../util/sqlite_script.hpp"
 #include "engine_library_context.hpp"
 #include "engine_library_dir_utils.hpp"
 #include "track_utils.hpp"
@@ -37,30 +38,11 @@ namespace djinterop::engine
 namespace
 {
 void hydrate_database(
-    const std::string& db_path, const std::string& script_path)
+    const std::string& db_path, const std::string& script_path,
+    const script_options& options)
 {
-    std::string stmt;
-
-    std::ifstream script{script_path};
-    sqlite::database m_db{db_path};
-    while (std::getline(script, stmt))
-    {
-        try
-        {
-            m_db << stmt;
-        }
-        catch (std::exception& e)
-        {
-            std::stringstream msg;
-            msg << "Error in script ";
-            msg << script_path;
-            msg << " whilst executing line \"";
-            msg << stmt;
-            msg << "\": ";
-            msg << e.what();
-            throw std::runtime_error{msg.str()};
-        }
-    }
+    sqlite::database db{db_path};
+    djinterop::util::execute_sqlite_script(db, script_path, options);
 }
 }  // anonymous namespace
 
@@ -103,7 +85,7 @@ database create_temporary_database(const engine_schema& schema)
 
 database create_database_from_scripts(
     const std::string& db_directory, const std::string& script_directory,
-    engine_schema& loaded_schema)
+    engine_schema& loaded_schema, const script_options& options)
 {
     if (!djinterop::util::path_exists(db_directory))
     {
@@ -126,12 +108,12 @@ database create_database_from_scripts(
 
     if (djinterop::util::path_exists(v1_m_db_sql_path))
     {
-        hydrate_database(v1_m_db_path, v1_m_db_sql_path);
+        hydrate_database(v1_m_db_path, v1_m_db_sql_path, options);
     }
 
     if (djinterop::util::path_exists(v1_p_db_sql_path))
     {
-        hydrate_database(v1_p_db_path, v1_p_db_sql_path);
+        hydrate_database(v1_p_db_path, v1_p_db_sql_path, options);
     }
 
     if (djinterop::util::path_exists(v2_m_db_sql_path))
@@ -139,7 +121,7 @@ database create_database_from_scripts(
         if (!djinterop::util::path_exists(database2_db_dir))
             djinterop::util::create_dir(database2_db_dir);
 
-        hydrate_database(v2_m_db_path, v2_m_db_sql_path);
+        hydrate_database(v2_m_db_path, v2_m_db_sql_path, options);
     }
 
     return load_database(db_directory, loaded_schema);
@@ -191,6 +173,7 @@ database load_database(
     // A Database2-type directory structure could be schema 2.x or higher.
     auto db = load_database2_sqlite_database(directory);
     const auto detected_schema = schema::detect_schema(db);
+    loaded_schema = detected_schema;
     auto context = std::make_shared<engine_library_context>(
         directory, true, detected_schema, db);
 
@@ -211,6 +194,31 @@ database load_database(
         to_string(detected_schema) + ", which is not supported"};
 }
 
+std::vector<database_verification_result> verify_databases(
+    const std::vector<database>& databases, std::size_t max_workers)
+{
+    std::vector<database_verification_result> results(databases.size());
+
+    // Each database has its own connection, so can be verified independently.
+    djinterop::util::parallel_for(
+        databases.size(), max_workers,
+        [&](std::size_t i)
+        {
+            try
+            {
+                databases[i].verify();
+                results[i].verified = true;
+            }
+            catch (const std::exception& e)
+            {
+                results[i].verified = false;
+                results[i].error = e.what();
+            }
+        });
+
+    return results;
+}
+
 std::vector<beatgrid_marker> normalize_beatgrid(
     std::vector<beatgrid_marker> beatgrid, int64_t sample_count)
 {
@@ -17,12 +17,19 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 
 #include <sqlite_modern_cpp.h>
 
 #include <djinterop/engine/engine_schema.hpp>
 
+#include "../util/sql_trace.hpp"
+#include "engine_library_dir_utils.hpp"
+#include "search_index.hpp"
+#include "track_feature_source.hpp"
+#include "track_similarity_source.hpp"
+
 namespace djinterop::engine
 {
 struct engine_library_context
@@ -31,7 +38,14 @@ struct engine_library_context
         std::string directory, bool is_database2, engine_schema schema,
         sqlite::database db) :
         directory{std::move(directory)}, is_database2{is_database2},
-        schema{schema}, db{std::move(db)}
+        schema{schema}, db{std::move(db)}, tracer{this->db.connection()},
+        search{
+            this->db, schema,
+            this->directory == ":memory:"
+                ? std::nullopt
+                : std::optional{
+                      make_database2_search_index_path(this->directory)}},
+        features{this->db, schema}, similarity{features}
     {
     }
 
@@ -53,6 +67,18 @@ struct engine_library_context
 
     /// The main SQLite database holding Engine data.
     sqlite::database db;
+
+    /// Tracer forwarding statements run on `db` to any registered observer.
+    djinterop::util::sql_tracer tracer;
+
+    /// Full-text index over tracks, kept in a file alongside the database.
+    search_index search;
+
+    /// Feature index over tracks, held in memory.
+    track_feature_source features;
+
+    /// Similarity index over tracks, held in memory.
+    track_similarity_source similarity;
 };
 
 }  // namespace djinterop::engine
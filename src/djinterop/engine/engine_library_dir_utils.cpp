@@ -17,6 +17,9 @@
 
 #include "engine_library_dir_utils.hpp"
 
+#include <fstream>
+#include <stdexcept>
+
 #include <djinterop/exceptions.hpp>
 
 #include "../util/filesystem.hpp"
@@ -44,6 +47,32 @@ std::string make_database2_m_db_path(const std::string& directory)
 {
     return directory + "/Database2/m.db";
 }
+
+std::string prepare_database2_db_path(const std::string& directory)
+{
+    // Ensure the target directory exists.
+    if (!djinterop::util::path_exists(directory))
+    {
+        djinterop::util::create_dir(directory);
+    }
+
+    auto db_dir_path = make_database2_db_dir_path(directory);
+    if (!djinterop::util::path_exists(db_dir_path))
+    {
+        djinterop::util::create_dir(db_dir_path);
+    }
+
+    // Target database must not exist.
+    auto db_path = make_database2_m_db_path(directory);
+    if (djinterop::util::path_exists(db_path))
+    {
+        throw database_inconsistency{
+            "Cannot create new Engine library, as the database file already "
+            "exists"};
+    }
+
+    return db_path;
+}
 }  // namespace
 
 bool detect_is_database2(const std::string& directory)
@@ -94,25 +123,24 @@ sqlite::database create_legacy_sqlite_database(const std::string& directory)
 
 sqlite::database create_database2_sqlite_database(const std::string& directory)
 {
-    // Ensure the target directory exists.
-    if (!djinterop::util::path_exists(directory))
-    {
-        djinterop::util::create_dir(directory);
-    }
+    return sqlite::database{prepare_database2_db_path(directory)};
+}
 
-    auto db_dir_path = make_database2_db_dir_path(directory);
-    if (!djinterop::util::path_exists(db_dir_path))
-    {
-        djinterop::util::create_dir(db_dir_path);
-    }
+sqlite::database create_database2_sqlite_database(
+    const std::string& directory, const std::vector<std::byte>& image)
+{
+    auto db_path = prepare_database2_db_path(directory);
 
-    // Target database must not exist.
-    auto db_path = make_database2_m_db_path(directory);
-    if (djinterop::util::path_exists(db_path))
     {
-        throw database_inconsistency{
-            "Cannot create new Engine library, as the database file already "
-            "exists"};
+        std::ofstream file{db_path, std::ios::binary};
+        file.write(
+            reinterpret_cast<const char*>(image.data()),
+            static_cast<std::streamsize>(image.size()));
+        if (!file)
+        {
+            throw std::runtime_error{
+                "Failed to write new Engine library database " + db_path};
+        }
     }
 
     return sqlite::database{db_path};
@@ -165,4 +193,9 @@ bool database2_database_exists(const std::string& directory)
     return djinterop::util::path_exists(make_database2_m_db_path(directory));
 }
 
+std::string make_database2_search_index_path(const std::string& directory)
+{
+    return directory + "/Database2/djinterop_search.db";
+}
+
 }  // namespace djinterop::engine
@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
 #include <sqlite_modern_cpp.h>
 
@@ -29,6 +31,9 @@ sqlite::database create_legacy_sqlite_database(const std::string& directory);
 
 sqlite::database create_database2_sqlite_database(const std::string& directory);
 
+sqlite::database create_database2_sqlite_database(
+    const std::string& directory, const std::vector<std::byte>& image);
+
 sqlite::database create_temporary_legacy_sqlite_database();
 
 sqlite::database create_temporary_database2_sqlite_database();
@@ -41,4 +46,6 @@ bool legacy_database_exists(const std::string& directory);
 
 bool database2_database_exists(const std::string& directory);
 
+std::string make_database2_search_index_path(const std::string& directory);
+
 }  // namespace djinterop::engine
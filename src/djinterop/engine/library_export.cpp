@@ -0,0 +1,715 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/engine/base_engine_library.hpp>
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <sqlite3.h>
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/exceptions.hpp>
+
+#include "../util/file_transfer.hpp"
+#include "../util/sqlite_transaction.hpp"
+#include "engine_library_context.hpp"
+
+namespace djinterop::engine
+{
+namespace
+{
+/// Special value for the `albumArtId` track column indicating no album art.
+constexpr int64_t ALBUM_ART_ID_NONE = 1;
+
+/// Directory of a temporary, in-memory library.
+const std::string temporary_directory = ":memory:";
+
+/// Thin RAII wrapper around a raw prepared SQLite statement.
+///
+/// The raw API is used so that column values can be transferred between
+/// databases verbatim via `sqlite3_value`, without conversion to and from any
+/// intermediate C++ type.
+class raw_statement
+{
+public:
+    raw_statement(sqlite::database& db, const std::string& sql) :
+        db_{db.connection()}, sql_{sql}
+    {
+        auto rc = sqlite3_prepare_v2(
+            db_.get(), sql_.c_str(), -1, &stmt_, nullptr);
+        if (rc != SQLITE_OK)
+        {
+            sqlite::errors::throw_sqlite_error(
+                rc, sql_, sqlite3_errmsg(db_.get()));
+        }
+    }
+
+    raw_statement(const raw_statement&) = delete;
+    raw_statement& operator=(const raw_statement&) = delete;
+
+    ~raw_statement() { sqlite3_finalize(stmt_); }
+
+    void bind(int index, int64_t value)
+    {
+        check(sqlite3_bind_int64(stmt_, index, value));
+    }
+
+    void bind(int index, const std::string& value)
+    {
+        check(sqlite3_bind_text(
+            stmt_, index, value.data(), static_cast<int>(value.size()),
+            SQLITE_TRANSIENT));
+    }
+
+    void bind(int index, sqlite3_value* value)
+    {
+        check(sqlite3_bind_value(stmt_, index, value));
+    }
+
+    /// Step the statement, returning `true` if a row is available.
+    bool step()
+    {
+        auto rc = sqlite3_step(stmt_);
+        if (rc == SQLITE_ROW)
+            return true;
+
+        if (rc != SQLITE_DONE)
+            check(rc);
+
+        return false;
+    }
+
+    /// Step a statement that is not expected to return any rows, and reset it.
+    void execute()
+    {
+        step();
+        reset();
+    }
+
+    void reset()
+    {
+        sqlite3_reset(stmt_);
+        sqlite3_clear_bindings(stmt_);
+    }
+
+    [[nodiscard]] sqlite3_value* column(int index) const
+    {
+        return sqlite3_column_value(stmt_, index);
+    }
+
+    [[nodiscard]] bool is_null(int index) const
+    {
+        return sqlite3_column_type(stmt_, index) == SQLITE_NULL;
+    }
+
+    [[nodiscard]] int64_t column_int64(int index) const
+    {
+        return sqlite3_column_int64(stmt_, index);
+    }
+
+    [[nodiscard]] int64_t last_insert_rowid() const
+    {
+        return sqlite3_last_insert_rowid(db_.get());
+    }
+
+private:
+    void check(int rc)
+    {
+        if (rc != SQLITE_OK)
+        {
+            sqlite::errors::throw_sqlite_error(
+                rc, sql_, sqlite3_errmsg(db_.get()));
+        }
+    }
+
+    std::shared_ptr<sqlite3> db_;
+    std::string sql_;
+    sqlite3_stmt* stmt_ = nullptr;
+};
+
+int engine_major_version(const engine_schema& schema)
+{
+    if (schema >= engine_schema::schema_3_0_0)
+        return 3;
+
+    if (schema >= engine_schema::schema_2_18_0)
+        return 2;
+
+    return 1;
+}
+
+std::vector<std::string> get_column_names(
+    sqlite::database& db, const std::string& table_name)
+{
+    std::vector<std::string> results;
+    db << "PRAGMA table_info('" + table_name + "')" >>
+        [&]([[maybe_unused]] int col_id, const std::string& col_name,
+            [[maybe_unused]] const std::string& col_type,
+            [[maybe_unused]] int nullable,
+            [[maybe_unused]] const std::string& default_value,
+            [[maybe_unused]] int part_of_pk) { results.push_back(col_name); };
+
+    return results;
+}
+
+bool is_table(sqlite::database& db, const std::string& name)
+{
+    int64_t count = 0;
+    db << "SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND "
+          "name = ?"
+       << name >>
+        count;
+    return count > 0;
+}
+
+/// Get the columns present in a table in both the source and target databases,
+/// in source column order, excluding a given key column.
+std::vector<std::string> get_common_column_names(
+    sqlite::database& source_db, sqlite::database& target_db,
+    const std::string& table_name, const std::string& key_column)
+{
+    auto target_columns_vec = get_column_names(target_db, table_name);
+    std::unordered_set<std::string> target_columns{
+        target_columns_vec.begin(), target_columns_vec.end()};
+
+    std::vector<std::string> results;
+    for (auto&& column : get_column_names(source_db, table_name))
+    {
+        if (column != key_column && target_columns.count(column) > 0)
+            results.push_back(column);
+    }
+
+    return results;
+}
+
+std::string join_columns(
+    const std::vector<std::string>& columns, const std::string& suffix = "")
+{
+    std::string result;
+    for (auto&& column : columns)
+    {
+        if (!result.empty())
+            result += ", ";
+
+        result += "[" + column + "]" + suffix;
+    }
+
+    return result;
+}
+
+std::string placeholders(size_t count)
+{
+    std::string result;
+    for (size_t i = 0; i < count; ++i)
+        result += i == 0 ? "?" : ", ?";
+
+    return result;
+}
+
+std::optional<int> find_column(
+    const std::vector<std::string>& columns, const std::string& name)
+{
+    for (size_t i = 0; i < columns.size(); ++i)
+    {
+        if (columns[i] == name)
+            return static_cast<int>(i);
+    }
+
+    return std::nullopt;
+}
+
+/// Order a set of ids according to a "next id" linked list.
+std::list<int64_t> sort_by_next_id(
+    const std::unordered_map<int64_t, int64_t>& next_id_to_id_map)
+{
+    std::list<int64_t> results;
+    auto curr = next_id_to_id_map.find(0);
+    while (curr != next_id_to_id_map.end() &&
+           results.size() < next_id_to_id_map.size())
+    {
+        auto id = curr->second;
+        results.push_front(id);
+        curr = next_id_to_id_map.find(id);
+    }
+
+    return results;
+}
+
+std::string resolve_track_path(
+    const std::string& directory, const std::string& path)
+{
+    if (!path.empty() && path.front() == '/')
+        return path;
+
+    return directory + "/" + path;
+}
+
+class library_exporter
+{
+public:
+    library_exporter(
+        engine_library_context& source, engine_library_context& target) :
+        source_{source},
+        target_{target},
+        track_columns_{get_common_column_names(
+            source.db, target.db, "Track", "id")},
+        performance_data_columns_{
+            is_table(target.db, "PerformanceData")
+                ? get_common_column_names(
+                      source.db, target.db, "PerformanceData", "trackId")
+                : std::vector<std::string>{}},
+        path_index_{find_column(track_columns_, "path")},
+        origin_uuid_index_{find_column(track_columns_, "originDatabaseUuid")},
+        origin_id_index_{find_column(track_columns_, "originTrackId")},
+        album_art_id_index_{find_column(track_columns_, "albumArtId")},
+        select_track_{
+            source.db, "SELECT " + join_columns(track_columns_) +
+                           " FROM Track WHERE id = ?"},
+        insert_track_{
+            target.db, "INSERT INTO Track (" + join_columns(track_columns_) +
+                           ") VALUES (" +
+                           placeholders(track_columns_.size()) + ")"},
+        find_track_by_path_{target.db, "SELECT id FROM Track WHERE path = ?"},
+        find_track_by_origin_{
+            target.db,
+            "SELECT id FROM Track WHERE originDatabaseUuid = ? AND "
+            "originTrackId = ?"},
+        select_album_art_{
+            source.db, "SELECT hash, albumArt FROM AlbumArt WHERE id = ?"},
+        find_album_art_{target.db, "SELECT id FROM AlbumArt WHERE hash = ?"},
+        insert_album_art_{
+            target.db, "INSERT INTO AlbumArt (hash, albumArt) VALUES (?, ?)"},
+        select_playlist_{
+            source.db,
+            "SELECT title, parentListId, isPersisted, lastEditTime, "
+            "isExplicitlyExported FROM Playlist WHERE id = ?"},
+        find_playlist_{
+            target.db,
+            "SELECT id FROM Playlist WHERE parentListId = ? AND title = ?"},
+        insert_playlist_{
+            target.db,
+            "INSERT INTO Playlist (title, parentListId, isPersisted, "
+            "nextListId, lastEditTime, isExplicitlyExported) "
+            "VALUES (?, ?, ?, 0, ?, ?)"},
+        insert_entity_{
+            target.db,
+            "INSERT INTO PlaylistEntity (listId, trackId, databaseUuid, "
+            "nextEntityId, membershipReference) VALUES (?, ?, ?, 0, ?)"},
+        update_entity_next_{
+            target.db, "UPDATE PlaylistEntity SET nextEntityId = ? WHERE id = ?"}
+    {
+        if (!performance_data_columns_.empty())
+        {
+            select_performance_data_.emplace(
+                source.db, "SELECT " + join_columns(performance_data_columns_) +
+                               " FROM PerformanceData WHERE trackId = ?");
+            update_performance_data_.emplace(
+                target.db, "UPDATE PerformanceData SET " +
+                               join_columns(performance_data_columns_, " = ?") +
+                               " WHERE trackId = ?");
+        }
+
+        target.db << "SELECT uuid FROM Information" >> target_uuid_;
+    }
+
+    /// Export a playlist, its ancestors, its descendants, and all their tracks.
+    void export_playlist(int64_t source_id)
+    {
+        auto target_id = ensure_playlist(source_id);
+        export_entities(source_id, target_id);
+
+        std::unordered_map<int64_t, int64_t> next_list_id_to_id_map;
+        source_.db << "SELECT id, nextListId FROM Playlist WHERE "
+                      "parentListId = ?"
+                   << source_id >>
+            [&](int64_t id, int64_t next_list_id)
+        { next_list_id_to_id_map[next_list_id] = id; };
+
+        for (auto&& child_id : sort_by_next_id(next_list_id_to_id_map))
+            export_playlist(child_id);
+    }
+
+    /// Export a single track, returning its id in the target library.
+    int64_t export_track(int64_t source_id)
+    {
+        auto iter = result_.track_ids.find(source_id);
+        if (iter != result_.track_ids.end())
+            return iter->second;
+
+        select_track_.bind(1, source_id);
+        if (!select_track_.step())
+        {
+            select_track_.reset();
+            throw track_deleted{source_id};
+        }
+
+        auto existing_id = find_existing_track();
+        if (existing_id)
+        {
+            select_track_.reset();
+            result_.track_ids[source_id] = *existing_id;
+            return *existing_id;
+        }
+
+        for (size_t i = 0; i < track_columns_.size(); ++i)
+        {
+            auto index = static_cast<int>(i);
+            if (album_art_id_index_ == index && !select_track_.is_null(index))
+            {
+                insert_track_.bind(
+                    index + 1,
+                    export_album_art(select_track_.column_int64(index)));
+            }
+            else
+            {
+                insert_track_.bind(index + 1, select_track_.column(index));
+            }
+        }
+
+        insert_track_.execute();
+        select_track_.reset();
+
+        auto target_id = insert_track_.last_insert_rowid();
+        export_performance_data(source_id, target_id);
+
+        result_.track_ids[source_id] = target_id;
+        ++result_.tracks_added;
+        return target_id;
+    }
+
+    library_export_result release_result() { return std::move(result_); }
+
+private:
+    std::optional<int64_t> find_existing_track()
+    {
+        std::optional<int64_t> result;
+        if (path_index_ && !select_track_.is_null(*path_index_))
+        {
+            find_track_by_path_.bind(1, select_track_.column(*path_index_));
+            if (find_track_by_path_.step())
+                result = find_track_by_path_.column_int64(0);
+
+            find_track_by_path_.reset();
+        }
+
+        if (!result && origin_uuid_index_ && origin_id_index_ &&
+            !select_track_.is_null(*origin_uuid_index_) &&
+            !select_track_.is_null(*origin_id_index_))
+        {
+            find_track_by_origin_.bind(
+                1, select_track_.column(*origin_uuid_index_));
+            find_track_by_origin_.bind(
+                2, select_track_.column(*origin_id_index_));
+            if (find_track_by_origin_.step())
+                result = find_track_by_origin_.column_int64(0);
+
+            find_track_by_origin_.reset();
+        }
+
+        return result;
+    }
+
+    int64_t export_album_art(int64_t source_id)
+    {
+        if (source_id == ALBUM_ART_ID_NONE)
+            return source_id;
+
+        auto iter = album_art_ids_.find(source_id);
+        if (iter != album_art_ids_.end())
+            return iter->second;
+
+        // Album art ids that do not refer to a real row are passed through.
+        auto target_id = source_id;
+        select_album_art_.bind(1, source_id);
+        if (select_album_art_.step())
+        {
+            std::optional<int64_t> existing_id;
+            if (!select_album_art_.is_null(0))
+            {
+                find_album_art_.bind(1, select_album_art_.column(0));
+                if (find_album_art_.step())
+                    existing_id = find_album_art_.column_int64(0);
+
+                find_album_art_.reset();
+            }
+
+            if (existing_id)
+            {
+                target_id = *existing_id;
+            }
+            else
+            {
+                insert_album_art_.bind(1, select_album_art_.column(0));
+                insert_album_art_.bind(2, select_album_art_.column(1));
+                insert_album_art_.execute();
+                target_id = insert_album_art_.last_insert_rowid();
+            }
+        }
+
+        select_album_art_.reset();
+        album_art_ids_[source_id] = target_id;
+        return target_id;
+    }
+
+    void export_performance_data(int64_t source_id, int64_t target_id)
+    {
+        if (!select_performance_data_)
+            return;
+
+        // A trigger in the target creates an empty performance data row upon
+        // insertion of a track, and so it only needs to be updated here.
+        auto& select = *select_performance_data_;
+        auto& update = *update_performance_data_;
+        select.bind(1, source_id);
+        if (select.step())
+        {
+            auto count = static_cast<int>(performance_data_columns_.size());
+            for (int i = 0; i < count; ++i)
+                update.bind(i + 1, select.column(i));
+
+            update.bind(count + 1, target_id);
+            update.execute();
+        }
+
+        select.reset();
+    }
+
+    int64_t ensure_playlist(int64_t source_id)
+    {
+        auto iter = result_.playlist_ids.find(source_id);
+        if (iter != result_.playlist_ids.end())
+            return iter->second;
+
+        select_playlist_.bind(1, source_id);
+        if (!select_playlist_.step())
+        {
+            select_playlist_.reset();
+            throw playlist_deleted{source_id};
+        }
+
+        auto source_parent_id = select_playlist_.column_int64(1);
+        select_playlist_.reset();
+
+        // Parents must be resolved before the playlist's own row is read, as
+        // resolving them re-uses the same statement.
+        auto target_parent_id =
+            source_parent_id == 0 ? 0 : ensure_playlist(source_parent_id);
+
+        select_playlist_.bind(1, source_id);
+        select_playlist_.step();
+
+        std::optional<int64_t> target_id;
+        find_playlist_.bind(1, target_parent_id);
+        find_playlist_.bind(2, select_playlist_.column(0));
+        if (find_playlist_.step())
+            target_id = find_playlist_.column_int64(0);
+
+        find_playlist_.reset();
+
+        if (!target_id)
+        {
+            insert_playlist_.bind(1, select_playlist_.column(0));
+            insert_playlist_.bind(2, target_parent_id);
+            insert_playlist_.bind(3, select_playlist_.column(2));
+            insert_playlist_.bind(4, select_playlist_.column(3));
+            insert_playlist_.bind(5, select_playlist_.column(4));
+            insert_playlist_.execute();
+            target_id = insert_playlist_.last_insert_rowid();
+            ++result_.playlists_added;
+        }
+
+        select_playlist_.reset();
+        result_.playlist_ids[source_id] = *target_id;
+        return *target_id;
+    }
+
+    void export_entities(int64_t source_list_id, int64_t target_list_id)
+    {
+        std::unordered_map<int64_t, int64_t> next_entity_id_to_id_map;
+        std::unordered_map<int64_t, std::pair<int64_t, int64_t>> entities;
+        source_.db << "SELECT id, trackId, nextEntityId, membershipReference "
+                      "FROM PlaylistEntity WHERE listId = ?"
+                   << source_list_id >>
+            [&](int64_t id, int64_t track_id, int64_t next_entity_id,
+                int64_t membership_reference)
+        {
+            next_entity_id_to_id_map[next_entity_id] = id;
+            entities[id] = {track_id, membership_reference};
+        };
+
+        std::unordered_set<int64_t> existing_track_ids;
+        std::optional<int64_t> tail_id;
+        target_.db << "SELECT id, trackId, nextEntityId FROM PlaylistEntity "
+                      "WHERE listId = ?"
+                   << target_list_id >>
+            [&](int64_t id, int64_t track_id, int64_t next_entity_id)
+        {
+            existing_track_ids.insert(track_id);
+            if (next_entity_id == 0)
+                tail_id = id;
+        };
+
+        for (auto&& entity_id : sort_by_next_id(next_entity_id_to_id_map))
+        {
+            auto [source_track_id, membership_reference] = entities[entity_id];
+            auto target_track_id = export_track(source_track_id);
+            if (!existing_track_ids.insert(target_track_id).second)
+                continue;
+
+            insert_entity_.bind(1, target_list_id);
+            insert_entity_.bind(2, target_track_id);
+            insert_entity_.bind(3, target_uuid_);
+            insert_entity_.bind(4, membership_reference);
+            insert_entity_.execute();
+            auto new_id = insert_entity_.last_insert_rowid();
+
+            if (tail_id)
+            {
+                update_entity_next_.bind(1, new_id);
+                update_entity_next_.bind(2, *tail_id);
+                update_entity_next_.execute();
+            }
+
+            tail_id = new_id;
+        }
+    }
+
+    engine_library_context& source_;
+    engine_library_context& target_;
+    const std::vector<std::string> track_columns_;
+    const std::vector<std::string> performance_data_columns_;
+    const std::optional<int> path_index_;
+    const std::optional<int> origin_uuid_index_;
+    const std::optional<int> origin_id_index_;
+    const std::optional<int> album_art_id_index_;
+    std::string target_uuid_;
+
+    raw_statement select_track_;
+    raw_statement insert_track_;
+    raw_statement find_track_by_path_;
+    raw_statement find_track_by_origin_;
+    raw_statement select_album_art_;
+    raw_statement find_album_art_;
+    raw_statement insert_album_art_;
+    raw_statement select_playlist_;
+    raw_statement find_playlist_;
+    raw_statement insert_playlist_;
+    raw_statement insert_entity_;
+    raw_statement update_entity_next_;
+    std::optional<raw_statement> select_performance_data_;
+    std::optional<raw_statement> update_performance_data_;
+
+    std::unordered_map<int64_t, int64_t> album_art_ids_;
+    library_export_result result_;
+};
+
+}  // namespace
+
+library_export_result base_engine_library::export_to(
+    base_engine_library& target, const std::vector<int64_t>& playlist_ids,
+    const std::vector<int64_t>& track_ids) const
+{
+    if (context_ == target.context_)
+    {
+        throw unsupported_operation{
+            "Cannot export an Engine library into itself"};
+    }
+
+    const auto source_major = engine_major_version(context_->schema);
+    const auto target_major = engine_major_version(target.context_->schema);
+    if (source_major == 1 || source_major != target_major)
+    {
+        throw unsupported_operation{
+            "Cannot export from an Engine library with schema " +
+            to_string(context_->schema) + " to one with schema " +
+            to_string(target.context_->schema)};
+    }
+
+    util::sqlite_transaction trans{target.context_->db};
+
+    library_export_result result;
+    {
+        library_exporter exporter{*context_, *target.context_};
+        for (auto&& id : playlist_ids)
+            exporter.export_playlist(id);
+
+        for (auto&& id : track_ids)
+            exporter.export_track(id);
+
+        result = exporter.release_result();
+    }
+
+    trans.commit();
+    return result;
+}
+
+file_transfer_report base_engine_library::export_files_to(
+    const base_engine_library& target,
+    const library_export_result& export_result,
+    const file_transfer_options& options) const
+{
+    if (context_->directory == temporary_directory ||
+        target.context_->directory == temporary_directory)
+    {
+        throw unsupported_operation{
+            "Cannot transfer files for a temporary Engine library"};
+    }
+
+    std::vector<util::file_transfer_item> items;
+    std::unordered_set<std::string> target_paths;
+    items.reserve(export_result.track_ids.size());
+    for (auto&& [source_id, target_id] : export_result.track_ids)
+    {
+        std::optional<std::string> source_path;
+        std::optional<int64_t> file_bytes;
+        context_->db << "SELECT path, fileBytes FROM Track WHERE id = ?"
+                     << source_id >>
+            [&](std::optional<std::string> path,
+                std::optional<int64_t> bytes)
+        {
+            source_path = std::move(path);
+            file_bytes = bytes;
+        };
+
+        std::optional<std::string> target_path;
+        target.context_->db << "SELECT path FROM Track WHERE id = ?"
+                            << target_id >>
+            [&](std::optional<std::string> path)
+        { target_path = std::move(path); };
+
+        if (!source_path || !target_path)
+            continue;
+
+        auto item = util::file_transfer_item{
+            resolve_track_path(context_->directory, *source_path),
+            resolve_track_path(target.context_->directory, *target_path),
+            file_bytes};
+        if (target_paths.insert(item.target_path).second)
+            items.push_back(std::move(item));
+    }
+
+    return util::transfer_files(items, options);
+}
+
+}  // namespace djinterop::engine
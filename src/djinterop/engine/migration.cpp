@@ -0,0 +1,388 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/engine/migration.hpp>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <djinterop/crate.hpp>
+#include <djinterop/playlist.hpp>
+#include <djinterop/track.hpp>
+#include <djinterop/track_snapshot.hpp>
+#include <djinterop/engine/v2/engine_library.hpp>
+#include <djinterop/engine/v3/engine_library.hpp>
+
+#include "../util/sqlite_transaction.hpp"
+#include "engine_library_context.hpp"
+#include "engine_library_dir_utils.hpp"
+#include "schema/schema.hpp"
+#include "v1/engine_database_impl.hpp"
+#include "v1/engine_storage.hpp"
+
+namespace djinterop::engine
+{
+namespace
+{
+/// A newly-created library into which data is being migrated.
+struct migration_target
+{
+    /// Connection to the target database, used to batch writes.
+    sqlite::database db;
+
+    /// Unified interface to the target database.
+    djinterop::database database;
+};
+
+migration_target create_migration_target(
+    const std::string& directory, const engine_schema& schema)
+{
+    if (schema >= engine_schema::schema_2_18_0)
+    {
+        auto db = create_database2_sqlite_database(directory);
+        auto schema_creator = schema::make_schema_creator_validator(schema);
+        schema_creator->create(db);
+
+        auto context = std::make_shared<engine_library_context>(
+            directory, true, schema, db);
+        auto database = schema >= engine_schema::schema_3_0_0
+                            ? v3::engine_library{context}.database()
+                            : v2::engine_library{context}.database();
+        return migration_target{std::move(db), std::move(database)};
+    }
+
+    auto storage = v1::engine_storage::create(directory, schema);
+    return migration_target{
+        storage->db,
+        djinterop::database{
+            std::make_shared<v1::engine_database_impl>(storage)}};
+}
+
+/// Summary of a migrated track, retained so that it can be verified later
+/// without needing to read the source track again.
+struct track_digest
+{
+    int64_t source_id;
+    int64_t target_id;
+    std::optional<std::string> relative_path;
+    std::optional<unsigned long long> sample_count;
+    std::optional<double> sample_rate;
+    size_t beatgrid_size;
+    size_t hot_cue_count;
+    size_t loop_count;
+    bool has_waveform;
+};
+
+template <typename T>
+size_t count_present(const std::vector<std::optional<T>>& items)
+{
+    size_t count = 0;
+    for (auto&& item : items)
+    {
+        if (item)
+            ++count;
+    }
+
+    return count;
+}
+
+track_digest make_track_digest(
+    int64_t source_id, int64_t target_id, const track_snapshot& snapshot)
+{
+    return track_digest{
+        source_id,
+        target_id,
+        snapshot.relative_path,
+        snapshot.sample_count,
+        snapshot.sample_rate,
+        snapshot.beatgrid.size(),
+        count_present(snapshot.hot_cues),
+        count_present(snapshot.loops),
+        !snapshot.waveform.empty()};
+}
+
+class migrator
+{
+public:
+    migrator(
+        const djinterop::database& source, migration_target target,
+        const migration_options& options) :
+        source_{source}, target_{std::move(target)}, options_{options}
+    {
+    }
+
+    void migrate_tracks()
+    {
+        auto tracks = source_.tracks();
+        const auto total = static_cast<int64_t>(tracks.size());
+        const auto batch_size = std::max<int64_t>(options_.batch_size, 1);
+        digests_.reserve(tracks.size());
+
+        int64_t done = 0;
+        while (done < total)
+        {
+            util::sqlite_transaction trans{target_.db};
+            auto batch_end = std::min(done + batch_size, total);
+            for (; done < batch_end; ++done)
+            {
+                auto& source_track = tracks[static_cast<size_t>(done)];
+                auto snapshot = source_track.snapshot();
+                auto target_track = target_.database.create_track(snapshot);
+                digests_.push_back(make_track_digest(
+                    source_track.id(), target_track.id(), snapshot));
+                track_map_.emplace(source_track.id(), std::move(target_track));
+            }
+
+            trans.commit();
+            report_progress(migration_stage::tracks, done, total);
+        }
+
+        report_.tracks_migrated = total;
+    }
+
+    void migrate_lists()
+    {
+        // If the source does not distinguish between crates and playlists,
+        // the same lists would be visited twice, and so only playlists are
+        // migrated.
+        const auto source_distinct = source_.supports_feature(
+            feature::playlists_and_crates_are_distinct);
+        util::sqlite_transaction trans{target_.db};
+        if (source_distinct)
+        {
+            auto roots = source_.root_crates();
+            auto total = static_cast<int64_t>(roots.size());
+            int64_t done = 0;
+            for (auto&& root : roots)
+            {
+                migrate_crate(root, std::nullopt);
+                report_progress(migration_stage::crates, ++done, total);
+            }
+        }
+
+        auto roots = source_.root_playlists();
+        auto total = static_cast<int64_t>(roots.size());
+        int64_t done = 0;
+        for (auto&& root : roots)
+        {
+            migrate_playlist(root, std::nullopt);
+            report_progress(migration_stage::playlists, ++done, total);
+        }
+
+        trans.commit();
+    }
+
+    void verify()
+    {
+        const auto total = static_cast<int64_t>(digests_.size());
+        int64_t done = 0;
+        for (auto&& expected : digests_)
+        {
+            auto target_track = target_.database.track_by_id(expected.target_id);
+            if (!target_track)
+            {
+                fail(expected, "is missing from the target");
+                continue;
+            }
+
+            auto actual = make_track_digest(
+                expected.source_id, expected.target_id,
+                target_track->snapshot());
+            if (actual.relative_path != expected.relative_path)
+                fail(expected, "has a different relative path");
+
+            if (actual.sample_count != expected.sample_count ||
+                actual.sample_rate != expected.sample_rate)
+            {
+                fail(expected, "has a different sample count or rate");
+            }
+
+            if (actual.beatgrid_size != expected.beatgrid_size)
+                fail(expected, "has a different number of beatgrid markers");
+
+            if (actual.hot_cue_count != expected.hot_cue_count)
+                fail(expected, "has a different number of hot cues");
+
+            if (actual.loop_count != expected.loop_count)
+                fail(expected, "has a different number of loops");
+
+            if (actual.has_waveform != expected.has_waveform)
+                fail(expected, "has a missing or unexpected waveform");
+
+            ++report_.tracks_verified;
+            if (++done % 1000 == 0 || done == total)
+                report_progress(migration_stage::verification, done, total);
+        }
+    }
+
+    migration_report release_report() { return std::move(report_); }
+
+private:
+    void report_progress(migration_stage stage, int64_t done, int64_t total)
+    {
+        if (options_.on_progress)
+            options_.on_progress(migration_progress{stage, done, total});
+    }
+
+    void fail(const track_digest& digest, const std::string& message)
+    {
+        report_.verification_failures.push_back(
+            "Track " + std::to_string(digest.source_id) + " (migrated as " +
+            std::to_string(digest.target_id) + ") " + message);
+    }
+
+    /// Get the list of target tracks to which the given source tracks map.
+    std::vector<djinterop::track> map_tracks(
+        const std::vector<djinterop::track>& source_tracks) const
+    {
+        std::vector<djinterop::track> results;
+        results.reserve(source_tracks.size());
+        for (auto&& source_track : source_tracks)
+        {
+            auto iter = track_map_.find(source_track.id());
+            if (iter != track_map_.end())
+                results.push_back(iter->second);
+        }
+
+        return results;
+    }
+
+    static std::unordered_set<int64_t> get_track_ids(
+        const std::vector<djinterop::track>& tracks)
+    {
+        std::unordered_set<int64_t> results;
+        for (auto&& tr : tracks)
+            results.insert(tr.id());
+
+        return results;
+    }
+
+    void migrate_crate(
+        const djinterop::crate& source_crate,
+        const std::optional<djinterop::crate>& target_parent)
+    {
+        auto name = source_crate.name();
+        auto existing = target_parent ? target_parent->sub_crate_by_name(name)
+                                      : target_.database.root_crate_by_name(name);
+        auto target_crate =
+            existing ? *existing
+            : target_parent
+                ? djinterop::crate{*target_parent}.create_sub_crate(name)
+                : target_.database.create_root_crate(name);
+        if (!existing)
+            ++report_.crates_migrated;
+
+        auto existing_ids = get_track_ids(target_crate.tracks());
+        for (auto&& tr : map_tracks(source_crate.tracks()))
+        {
+            if (existing_ids.insert(tr.id()).second)
+            {
+                target_crate.add_track(tr);
+                ++report_.list_entries_migrated;
+            }
+        }
+
+        for (auto&& child : source_crate.children())
+            migrate_crate(child, target_crate);
+    }
+
+    void migrate_playlist(
+        const djinterop::playlist& source_playlist,
+        const std::optional<djinterop::playlist>& target_parent)
+    {
+        auto name = source_playlist.name();
+        auto existing = target_parent
+                            ? target_parent->sub_playlist_by_name(name)
+                            : target_.database.root_playlist_by_name(name);
+        auto target_playlist =
+            existing ? *existing
+            : target_parent
+                ? djinterop::playlist{*target_parent}.create_sub_playlist(name)
+                : target_.database.create_root_playlist(name);
+        if (!existing)
+            ++report_.playlists_migrated;
+
+        // Duplicate entries are only retained if the target supports them.
+        const auto allow_duplicates = target_.database.supports_feature(
+            feature::playlists_support_duplicate_tracks);
+        auto existing_ids = get_track_ids(target_playlist.tracks());
+        for (auto&& tr : map_tracks(source_playlist.tracks()))
+        {
+            if (existing_ids.insert(tr.id()).second || allow_duplicates)
+            {
+                target_playlist.add_track_back(tr);
+                ++report_.list_entries_migrated;
+            }
+        }
+
+        if (!source_.supports_feature(feature::supports_nested_playlists))
+            return;
+
+        auto children = source_playlist.children();
+        if (children.empty())
+            return;
+
+        if (!target_.database.supports_feature(
+                feature::supports_nested_playlists))
+        {
+            report_.warnings.push_back(
+                "Sub-playlists of playlist '" + name +
+                "' were not migrated, as the target schema does not support "
+                "nested playlists");
+            return;
+        }
+
+        for (auto&& child : children)
+            migrate_playlist(child, target_playlist);
+    }
+
+    const djinterop::database& source_;
+    migration_target target_;
+    const migration_options& options_;
+    std::unordered_map<int64_t, djinterop::track> track_map_;
+    std::vector<track_digest> digests_;
+    migration_report report_;
+};
+
+}  // namespace
+
+migration_report migrate_database(
+    const database& source, const std::string& target_directory,
+    const engine_schema& target_schema, const migration_options& options)
+{
+    const auto start = std::chrono::steady_clock::now();
+    migrator m{
+        source, create_migration_target(target_directory, target_schema),
+        options};
+
+    m.migrate_tracks();
+    m.migrate_lists();
+    if (options.verify)
+        m.verify();
+
+    auto report = m.release_report();
+    report.target_schema = target_schema;
+    report.elapsed = std::chrono::steady_clock::now() - start;
+    return report;
+}
+
+}  // namespace djinterop::engine
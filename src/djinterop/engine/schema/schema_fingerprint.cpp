@@ -0,0 +1,232 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "schema_fingerprint.hpp"
+
+#include <cctype>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../engine_library_dir_utils.hpp"
+#include "schema.hpp"
+
+namespace djinterop::engine::schema
+{
+namespace
+{
+// Table-valued pragma functions are needed to fingerprint in a single query.
+constexpr int min_fingerprint_sqlite_version = 3016000;
+
+constexpr uint64_t fnv_offset_basis = 14695981039346656037ull;
+constexpr uint64_t fnv_prime = 1099511628211ull;
+
+std::mutex expected_fingerprints_mutex;
+std::map<engine_schema, uint64_t> expected_fingerprints;
+
+struct statement_deleter
+{
+    void operator()(sqlite3_stmt* stmt) const { sqlite3_finalize(stmt); }
+};
+
+class fingerprint_hasher
+{
+public:
+    void add(const unsigned char* data, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            hash_ = (hash_ ^ data[i]) * fnv_prime;
+        }
+
+        // Separate successive fields, so that ("ab", "c") != ("a", "bc").
+        hash_ = (hash_ ^ 0xFF) * fnv_prime;
+    }
+
+    void add(const std::string& str)
+    {
+        add(reinterpret_cast<const unsigned char*>(str.data()), str.size());
+    }
+
+    [[nodiscard]] uint64_t value() const { return hash_; }
+
+private:
+    uint64_t hash_ = fnv_offset_basis;
+};
+
+bool is_sql_punctuation(char c)
+{
+    return c == '(' || c == ')' || c == ',' || c == ';';
+}
+
+/// Normalise SQL by collapsing runs of whitespace, and removing any whitespace
+/// adjacent to punctuation.
+std::string normalize_sql(const unsigned char* sql)
+{
+    std::string result;
+    bool pending_space = false;
+    for (auto* iter = sql; *iter != '\0'; ++iter)
+    {
+        auto c = static_cast<char>(*iter);
+        if (std::isspace(*iter))
+        {
+            pending_space = true;
+            continue;
+        }
+
+        if (pending_space && !result.empty() &&
+            !is_sql_punctuation(result.back()) && !is_sql_punctuation(c))
+        {
+            result += ' ';
+        }
+
+        pending_space = false;
+        result += c;
+    }
+
+    return result;
+}
+
+std::vector<std::string> get_db_schema_names(const engine_schema& schema)
+{
+    if (schema >= engine_schema::schema_2_18_0)
+    {
+        return {"main"};
+    }
+
+    return {"music", "perfdata"};
+}
+
+void add_db_schema_fingerprint(
+    fingerprint_hasher& hasher, sqlite::database& db,
+    const std::string& db_schema_name)
+{
+    auto sql =
+        "SELECT m.type, m.name, m.tbl_name, m.sql, p.cid, p.name, p.type, "
+        "p.\"notnull\", p.dflt_value, p.pk FROM " +
+        db_schema_name +
+        ".sqlite_master AS m LEFT JOIN pragma_table_info(m.name, '" +
+        db_schema_name +
+        "') AS p ON m.type = 'table' WHERE m.name NOT LIKE 'sqlite\\_%' "
+        "ESCAPE '\\' ORDER BY m.type, m.name, p.cid";
+
+    auto connection = db.connection();
+    sqlite3_stmt* raw_stmt = nullptr;
+    auto rc = sqlite3_prepare_v2(
+        connection.get(), sql.c_str(), -1, &raw_stmt, nullptr);
+    std::unique_ptr<sqlite3_stmt, statement_deleter> stmt{raw_stmt};
+    if (rc != SQLITE_OK)
+    {
+        sqlite::errors::throw_sqlite_error(
+            rc, sql, sqlite3_errmsg(connection.get()));
+    }
+
+    // The same object appears once for every column it has, but only the
+    // first occurrence needs its SQL hashed.
+    std::string last_object;
+    while ((rc = sqlite3_step(stmt.get())) == SQLITE_ROW)
+    {
+        auto column_count = sqlite3_column_count(stmt.get());
+        for (auto i = 0; i < column_count; ++i)
+        {
+            auto* text = sqlite3_column_text(stmt.get(), i);
+            if (i == 3)
+            {
+                std::string object{reinterpret_cast<const char*>(
+                    sqlite3_column_text(stmt.get(), 1))};
+                if (object == last_object)
+                    continue;
+
+                last_object = object;
+                hasher.add(text == nullptr ? "" : normalize_sql(text));
+            }
+            else if (text == nullptr)
+            {
+                hasher.add(nullptr, 0);
+            }
+            else
+            {
+                hasher.add(
+                    text, static_cast<std::size_t>(
+                              sqlite3_column_bytes(stmt.get(), i)));
+            }
+        }
+    }
+
+    if (rc != SQLITE_DONE)
+    {
+        sqlite::errors::throw_sqlite_error(
+            rc, sql, sqlite3_errmsg(connection.get()));
+    }
+}
+
+bool is_fingerprint_supported()
+{
+    return sqlite3_libversion_number() >= min_fingerprint_sqlite_version;
+}
+}  // namespace
+
+uint64_t compute_schema_fingerprint(
+    sqlite::database& db, const engine_schema& schema)
+{
+    fingerprint_hasher hasher;
+    for (auto&& db_schema_name : get_db_schema_names(schema))
+    {
+        add_db_schema_fingerprint(hasher, db, db_schema_name);
+    }
+
+    return hasher.value();
+}
+
+uint64_t get_expected_schema_fingerprint(const engine_schema& schema)
+{
+    // Note that the lock is also held whilst the schema is created, as schema
+    // creation is not thread-safe.
+    std::lock_guard<std::mutex> lock{expected_fingerprints_mutex};
+    auto iter = expected_fingerprints.find(schema);
+    if (iter != expected_fingerprints.end())
+    {
+        return iter->second;
+    }
+
+    auto db = schema >= engine_schema::schema_2_18_0
+                  ? create_temporary_database2_sqlite_database()
+                  : create_temporary_legacy_sqlite_database();
+    auto schema_creator = make_schema_creator_validator(schema);
+    schema_creator->create(db);
+
+    auto fingerprint = compute_schema_fingerprint(db, schema);
+    expected_fingerprints.emplace(schema, fingerprint);
+    return fingerprint;
+}
+
+void verify_schema(sqlite::database& db, const engine_schema& schema)
+{
+    if (is_fingerprint_supported() &&
+        compute_schema_fingerprint(db, schema) ==
+            get_expected_schema_fingerprint(schema))
+    {
+        return;
+    }
+
+    auto validator = make_schema_creator_validator(schema);
+    validator->verify(db);
+}
+
+}  // namespace djinterop::engine::schema
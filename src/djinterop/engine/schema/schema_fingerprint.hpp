@@ -0,0 +1,63 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/engine/engine_schema.hpp>
+
+namespace djinterop::engine::schema
+{
+/// Compute a structural fingerprint of a database.
+///
+/// The fingerprint is a hash of the normalised SQL of every object in
+/// `sqlite_master`, together with the `PRAGMA table_info` output of every
+/// table, gathered in a single query per attached database.  It is insensitive
+/// to the data in the database, and to insignificant whitespace in its SQL.
+///
+/// \param db Database.
+/// \param schema Schema that the database is expected to have, which
+///               determines the attached databases that are fingerprinted.
+/// \return Returns the fingerprint.
+uint64_t compute_schema_fingerprint(
+    sqlite::database& db, const engine_schema& schema);
+
+/// Get the fingerprint of a database created with the given schema.
+///
+/// The fingerprint is computed on first use by creating the schema in a
+/// temporary database, and is cached for the lifetime of the process.
+///
+/// \param schema Schema.
+/// \return Returns the expected fingerprint.
+uint64_t get_expected_schema_fingerprint(const engine_schema& schema);
+
+/// Verify that a database matches a given schema.
+///
+/// The fingerprint of the database is compared against that expected for the
+/// schema.  Only if they differ is the detailed, entry-by-entry verification
+/// performed, which will identify the inconsistency (or pass, if the
+/// difference is not significant).
+///
+/// \param db Database.
+/// \param schema Schema that the database is expected to have.
+/// \throws database_inconsistency If the database does not match the schema.
+void verify_schema(sqlite::database& db, const engine_schema& schema);
+
+}  // namespace djinterop::engine::schema
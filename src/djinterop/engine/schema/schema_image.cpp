@@ -0,0 +1,128 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "schema_image.hpp"
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+#include <djinterop/exceptions.hpp>
+
+#include "../../util/random.hpp"
+#include "schema.hpp"
+
+namespace djinterop::engine::schema
+{
+namespace
+{
+std::mutex schema_images_mutex;
+std::map<engine_schema, std::vector<std::byte>> schema_images;
+
+std::vector<std::byte> build_schema_image(const engine_schema& schema)
+{
+#if DJINTEROP_SCHEMA_IMAGES
+    sqlite::database db{":memory:"};
+    auto schema_creator = make_schema_creator_validator(schema);
+    schema_creator->create(db);
+
+    sqlite3_int64 size = 0;
+    auto* data = sqlite3_serialize(db.connection().get(), "main", &size, 0);
+    if (data == nullptr)
+    {
+        throw std::bad_alloc{};
+    }
+
+    std::vector<std::byte> image(static_cast<std::size_t>(size));
+    std::memcpy(image.data(), data, image.size());
+    sqlite3_free(data);
+    return image;
+#else
+    throw unsupported_operation{
+        "Schema images are not supported by this build of SQLite"};
+#endif
+}
+}  // namespace
+
+bool is_schema_image_supported(const engine_schema& schema)
+{
+    return DJINTEROP_SCHEMA_IMAGES && schema >= engine_schema::schema_2_18_0;
+}
+
+const std::vector<std::byte>& get_schema_image(const engine_schema& schema)
+{
+    if (!is_schema_image_supported(schema))
+    {
+        throw unsupported_operation{
+            "No schema image is available for schema " + to_string(schema)};
+    }
+
+    std::lock_guard<std::mutex> lock{schema_images_mutex};
+    auto iter = schema_images.find(schema);
+    if (iter == schema_images.end())
+    {
+        // Entries are never removed, so references to them remain valid.
+        iter = schema_images.emplace(schema, build_schema_image(schema)).first;
+    }
+
+    return iter->second;
+}
+
+void deserialize_schema_image(
+    sqlite::database& db, const std::vector<std::byte>& image)
+{
+#if DJINTEROP_SCHEMA_IMAGES
+    // SQLite takes ownership of the buffer, which must be allocated by SQLite
+    // so that it can be resized as the database grows.
+    auto size = static_cast<sqlite3_int64>(image.size());
+    auto* data = static_cast<unsigned char*>(sqlite3_malloc64(image.size()));
+    if (data == nullptr)
+    {
+        throw std::bad_alloc{};
+    }
+
+    std::memcpy(data, image.data(), image.size());
+    auto connection = db.connection();
+    auto rc = sqlite3_deserialize(
+        connection.get(), "main", data, size, size,
+        SQLITE_DESERIALIZE_FREEONCLOSE | SQLITE_DESERIALIZE_RESIZEABLE);
+    if (rc != SQLITE_OK)
+    {
+        // On failure, SQLite has already freed the buffer.
+        sqlite::errors::throw_sqlite_error(
+            rc, "sqlite3_deserialize", sqlite3_errmsg(connection.get()));
+    }
+#else
+    (void)db;
+    (void)image;
+    throw unsupported_operation{
+        "Schema images are not supported by this build of SQLite"};
+#endif
+}
+
+void stamp_new_identity(sqlite::database& db)
+{
+    auto uuid_str = djinterop::util::generate_random_uuid();
+    auto current_played_indicator_fake_value =
+        djinterop::util::generate_random_int64();
+
+    db << "UPDATE Information SET uuid = ?, currentPlayedIndiciator = ?"
+       << uuid_str << current_played_indicator_fake_value;
+}
+
+}  // namespace djinterop::engine::schema
@@ -0,0 +1,72 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <sqlite3.h>
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/engine/engine_schema.hpp>
+
+// Serialized schema images need `sqlite3_serialize()`, which is always present
+// from SQLite 3.36 onwards, and optionally present in earlier versions.
+#if SQLITE_VERSION_NUMBER >= 3036000 || defined(SQLITE_ENABLE_DESERIALIZE)
+#define DJINTEROP_SCHEMA_IMAGES 1
+#else
+#define DJINTEROP_SCHEMA_IMAGES 0
+#endif
+
+namespace djinterop::engine::schema
+{
+/// Check whether pre-built schema images can be used for a given schema.
+///
+/// Only Database2 schemas, whose libraries consist of a single database file,
+/// are held as images.
+///
+/// \param schema Schema.
+/// \return Returns `true` if the schema can be created from an image.
+bool is_schema_image_supported(const engine_schema& schema);
+
+/// Get a serialized SQLite image of an empty database of the given schema.
+///
+/// The image is built using the schema creator on first use, and is cached
+/// for the lifetime of the process.  The image carries the `Information` row
+/// that was generated when it was built, and so any database created from it
+/// must have a new identity stamped using `stamp_new_identity()`.
+///
+/// \param schema Schema.
+/// \return Returns a reference to the cached image.
+const std::vector<std::byte>& get_schema_image(const engine_schema& schema);
+
+/// Load a serialized SQLite image into the main schema of a database
+/// connection, replacing its current contents.
+///
+/// \param db Database connection, typically to `:memory:`.
+/// \param image Serialized image.
+void deserialize_schema_image(
+    sqlite::database& db, const std::vector<std::byte>& image);
+
+/// Give a database created from a schema image its own identity, by writing a
+/// new UUID and played indicator to the `Information` table.
+///
+/// \param db Database.
+void stamp_new_identity(sqlite::database& db);
+
+}  // namespace djinterop::engine::schema
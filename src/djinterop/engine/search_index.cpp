@@ -0,0 +1,282 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "search_index.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <djinterop/exceptions.hpp>
+
+#include "../util/sqlite_transaction.hpp"
+#include "metadata_types.hpp"
+
+namespace djinterop::engine
+{
+/// State of an index, as recorded in its sidecar database.
+struct search_index::index_state
+{
+    int64_t version;
+    std::string library_uuid;
+    track_change_checkpoint checkpoint;
+};
+
+namespace
+{
+/// Version of the layout of the sidecar database.  Indices of any other
+/// version are rebuilt.
+constexpr int64_t format_version = 1;
+
+/// Relative weights of the title, artist, album, genre, and comment columns
+/// when ranking search results.
+constexpr const char* rank_function = "bm25(10.0, 8.0, 4.0, 2.0, 1.0)";
+
+/// Maximum number of matching tracks that are ranked by relevance.
+///
+/// Ranking costs a couple of microseconds per match, so the short prefixes
+/// typed at the start of a search, which can match a large fraction of the
+/// library, would otherwise take far longer than later keystrokes.
+constexpr int64_t max_ranked_matches = 2000;
+
+bool is_word_byte(unsigned char byte)
+{
+    // Bytes of multi-byte UTF-8 sequences are left for the tokenizer.
+    return (byte >= '0' && byte <= '9') || (byte >= 'A' && byte <= 'Z') ||
+           (byte >= 'a' && byte <= 'z') || byte >= 0x80;
+}
+
+/// Make an FTS5 query matching every word of some search text as a prefix.
+///
+/// Words are split in the same way as the `unicode61` tokenizer does for ASCII
+/// text, and are quoted so that no character of the text can be interpreted
+/// as FTS5 query syntax.
+std::string make_match_expression(const std::string& text)
+{
+    std::string expression;
+    std::string word;
+    auto add_word = [&]
+    {
+        if (word.empty())
+            return;
+
+        if (!expression.empty())
+            expression += ' ';
+
+        expression += '"' + word + "\"*";
+        word.clear();
+    };
+
+    for (auto c : text)
+    {
+        if (is_word_byte(static_cast<unsigned char>(c)))
+            word += c;
+        else
+            add_word();
+    }
+
+    add_word();
+    return expression;
+}
+
+std::string legacy_text_join(const char* alias, metadata_str_type type)
+{
+    return std::string{" LEFT JOIN music.MetaData AS "} + alias + " ON " +
+           alias + ".id = t.id AND " + alias +
+           ".type = " + std::to_string(static_cast<int>(type));
+}
+
+/// SQL to select the id and text metadata of every track in a library.
+std::string make_source_sql(bool legacy)
+{
+    if (!legacy)
+        return "SELECT id, title, artist, album, genre, comment FROM main.Track";
+
+    // Some legacy schemas have a trigger that leaves a row with a NULL path
+    // behind when a track is deleted.
+    return "SELECT t.id, title.text, artist.text, album.text, genre.text, "
+           "comment.text FROM music.Track AS t" +
+           legacy_text_join("title", metadata_str_type::title) +
+           legacy_text_join("artist", metadata_str_type::artist) +
+           legacy_text_join("album", metadata_str_type::album) +
+           legacy_text_join("genre", metadata_str_type::genre) +
+           legacy_text_join("comment", metadata_str_type::comment) +
+           " WHERE t.path IS NOT NULL";
+}
+
+}  // anonymous namespace
+
+search_index::search_index(
+    sqlite::database& db, engine_schema schema,
+    std::optional<std::string> path) :
+    db_{db}, feed_{db, schema}, path_{std::move(path)}
+{
+}
+
+std::vector<int64_t> search_index::search(
+    const std::string& text, std::size_t limit)
+{
+    std::vector<int64_t> results;
+    auto expression = make_match_expression(text);
+    if (expression.empty() || limit == 0)
+        return results;
+
+    refresh();
+
+    // If there are too many matches to rank, the most recently added tracks
+    // are ranked.  FTS5 yields matches in order of id, so this is cheap.
+    db_ << "SELECT rowid FROM (SELECT rowid, rank AS relevance "
+           "FROM djinterop_search.track_text WHERE track_text MATCH ? "
+           "ORDER BY rowid DESC LIMIT ?) ORDER BY relevance LIMIT ?"
+        << expression << max_ranked_matches
+        << static_cast<int64_t>(std::min<uint64_t>(
+               limit,
+               static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))) >>
+        [&](int64_t id) { results.push_back(id); };
+    return results;
+}
+
+void search_index::refresh()
+{
+    attach();
+
+    // A library for which the connection counters have not moved need not be
+    // examined any further.
+    auto stamp = feed_.stamp();
+    if (stamp_ == stamp)
+        return;
+
+    djinterop::util::sqlite_transaction trans{db_};
+
+    std::optional<index_state> state;
+    db_ << "SELECT version, library_uuid, max_track_id, last_change_id, "
+           "last_edit_time FROM djinterop_search.state" >>
+        [&](int64_t version, std::string library_uuid, int64_t max_track_id,
+            int64_t last_change_id, int64_t last_edit_time)
+    {
+        state = index_state{
+            version,
+            std::move(library_uuid),
+            {max_track_id, last_change_id, last_edit_time}};
+    };
+
+    auto library_uuid = feed_.library_uuid();
+    auto checkpoint = feed_.checkpoint();
+
+    // Legacy libraries have no record of which tracks have changed.  An index
+    // built for a different library, or for a library since replaced by an
+    // older copy, cannot be updated incrementally either.
+    if (feed_.is_legacy() || !state || state->version != format_version ||
+        state->library_uuid != library_uuid ||
+        state->checkpoint.max_track_id > checkpoint.max_track_id)
+    {
+        rebuild();
+    }
+    else
+    {
+        update(*state);
+    }
+
+    save_state(library_uuid, checkpoint);
+    trans.commit();
+
+    // The data version is unaffected by writes made through this connection.
+    stamp_ = stamp;
+    stamp_->total_changes = sqlite3_total_changes(db_.connection().get());
+}
+
+void search_index::attach()
+{
+    if (attached_)
+        return;
+
+    if (!sqlite3_compileoption_used("ENABLE_FTS5"))
+    {
+        throw unsupported_operation{
+            "Full-text search requires a SQLite library with FTS5 support"};
+    }
+
+    db_ << "ATTACH ? AS djinterop_search" << path_.value_or(":memory:");
+    db_ << "CREATE TABLE IF NOT EXISTS djinterop_search.state ("
+           "id INTEGER PRIMARY KEY CHECK (id = 1), version INTEGER NOT NULL, "
+           "library_uuid TEXT NOT NULL, max_track_id INTEGER NOT NULL, "
+           "last_change_id INTEGER NOT NULL, last_edit_time INTEGER NOT NULL)";
+    attached_ = true;
+}
+
+void search_index::rebuild()
+{
+    db_ << "DROP TABLE IF EXISTS djinterop_search.track_text";
+    db_ << "CREATE VIRTUAL TABLE djinterop_search.track_text USING fts5("
+           "title, artist, album, genre, comment, "
+           "tokenize = 'unicode61 remove_diacritics 2', prefix = '1 2 3')";
+    db_ << "INSERT INTO djinterop_search.track_text (track_text, rank) "
+           "VALUES ('rank', ?)"
+        << rank_function;
+
+    // Index every track in a single pass, then merge the index into a single
+    // b-tree for the fastest possible queries.
+    db_ << "INSERT INTO djinterop_search.track_text "
+           "(rowid, title, artist, album, genre, comment) " +
+               make_source_sql(feed_.is_legacy());
+    db_ << "INSERT INTO djinterop_search.track_text (track_text) "
+           "VALUES ('optimize')";
+}
+
+void search_index::update(const index_state& state)
+{
+    auto changed_sql = feed_.changed_tracks_sql();
+    auto since = feed_.changed_tracks_parameter(state.checkpoint);
+
+    db_ << "DELETE FROM djinterop_search.track_text WHERE rowid IN (" +
+               changed_sql + ")"
+        << since;
+    db_ << "INSERT INTO djinterop_search.track_text "
+           "(rowid, title, artist, album, genre, comment) " +
+               make_source_sql(false) + " WHERE id > ? OR id IN (" +
+               changed_sql + ")"
+        << state.checkpoint.max_track_id << since;
+
+    // Every track is indexed, so there are more rows in the index than tracks
+    // in the library only if tracks have been removed.  The index is counted
+    // using its `docsize` shadow table, which has one small row per track.
+    bool has_removed_tracks = false;
+    db_ << "SELECT (SELECT COUNT(*) FROM djinterop_search.track_text_docsize) "
+           "> (SELECT COUNT(*) FROM main.Track)" >>
+        has_removed_tracks;
+    if (has_removed_tracks)
+    {
+        db_ << "DELETE FROM djinterop_search.track_text "
+               "WHERE rowid NOT IN (SELECT id FROM main.Track)";
+    }
+}
+
+void search_index::save_state(
+    const std::string& library_uuid, const track_change_checkpoint& checkpoint)
+{
+    db_ << "INSERT OR REPLACE INTO djinterop_search.state (id, version, "
+           "library_uuid, max_track_id, last_change_id, last_edit_time) "
+           "VALUES (1, ?, ?, ?, ?, ?)"
+        << format_version << library_uuid << checkpoint.max_track_id
+        << checkpoint.last_change_id << checkpoint.last_edit_time;
+}
+
+}  // namespace djinterop::engine
@@ -0,0 +1,97 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/engine/engine_schema.hpp>
+
+#include "track_change_feed.hpp"
+
+namespace djinterop::engine
+{
+/// Full-text index over the text metadata of the tracks in an Engine library.
+///
+/// The index is an FTS5 table held in a sidecar SQLite database, which is
+/// attached to the connection of the library on first use, so that the Engine
+/// schema itself is never altered.  The index is brought up to date before
+/// every search.  Later libraries are updated incrementally from the
+/// `ChangeLog` table or the `lastEditTime` column of the `Track` table,
+/// according to schema version.  Legacy libraries have no such record of
+/// changes, and so are indexed in memory and re-indexed after any write.
+class search_index
+{
+public:
+    /// Construct an index for an Engine library.
+    ///
+    /// No work is done until the index is first used.
+    ///
+    /// \param db Connection to the Engine library.
+    /// \param schema Schema version of the Engine library.
+    /// \param path Path of the sidecar database file, or `std::nullopt` to
+    ///             hold the index in memory.
+    search_index(
+        sqlite::database& db, engine_schema schema,
+        std::optional<std::string> path);
+
+    /// Find the tracks whose text metadata matches some search text.
+    ///
+    /// Every word of the text must match the start of a word in the title,
+    /// artist, album, genre, or comment of a track.  Matching ignores case
+    /// and diacritics.  Matches are ranked by relevance, unless there are so
+    /// many that only the most recently added are ranked.
+    ///
+    /// \param text Text for which to search.
+    /// \param limit Maximum number of results.
+    /// \return Returns the ids of matching tracks, most relevant first.
+    /// \throws unsupported_operation If the SQLite library does not support
+    ///         FTS5.
+    std::vector<int64_t> search(const std::string& text, std::size_t limit);
+
+    /// Bring the index up to date with the library.
+    ///
+    /// \throws unsupported_operation If the SQLite library does not support
+    ///         FTS5.
+    void refresh();
+
+private:
+    struct index_state;
+
+    void attach();
+    void rebuild();
+    void update(const index_state& state);
+    void save_state(
+        const std::string& library_uuid,
+        const track_change_checkpoint& checkpoint);
+
+    sqlite::database& db_;
+    track_change_feed feed_;
+    std::optional<std::string> path_;
+    bool attached_ = false;
+
+    // Counters of the connection when the index was last refreshed.
+    std::optional<connection_stamp> stamp_;
+};
+
+}  // namespace djinterop::engine
@@ -0,0 +1,670 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/engine/synthetic_library.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <optional>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <djinterop/analysis/beatgrid_index.hpp>
+#include <djinterop/crate.hpp>
+#include <djinterop/engine/engine.hpp>
+#include <djinterop/playlist.hpp>
+#include <djinterop/track.hpp>
+
+namespace djinterop::engine
+{
+namespace
+{
+/// Number of tracks created in each transaction.
+constexpr std::size_t track_batch_size = 1000;
+
+/// Source of random numbers.
+///
+/// Only the raw output of the Mersenne Twister engine is used, as its
+/// sequence is fully specified by the standard, unlike those of the standard
+/// distributions.
+class random_source
+{
+public:
+    explicit random_source(uint64_t seed) : rng_{seed} {}
+
+    /// Uniform real number in the range [0, 1).
+    double real() { return static_cast<double>(rng_() >> 11) * 0x1.0p-53; }
+
+    /// Uniform real number in the range [lo, hi).
+    double real(double lo, double hi) { return lo + (hi - lo) * real(); }
+
+    /// Uniform integer in the range [0, n).
+    std::size_t below(std::size_t n)
+    {
+        return n == 0 ? 0
+                      : std::min(n - 1, static_cast<std::size_t>(real() * n));
+    }
+
+    /// Index into a pool of size `n`, skewed such that lower indices are
+    /// chosen far more often, as for the popularity of artists.
+    std::size_t skewed(std::size_t n)
+    {
+        auto u = real();
+        return n == 0 ? 0
+                      : std::min(
+                            n - 1, static_cast<std::size_t>(n * u * u * u));
+    }
+
+    bool chance(double p) { return real() < p; }
+
+    double normal(double mean, double sd)
+    {
+        auto u1 = 1 - real();
+        auto u2 = real();
+        return mean + sd * std::sqrt(-2 * std::log(u1)) *
+                          std::cos(2 * std::numbers::pi * u2);
+    }
+
+    /// Integer with a geometric distribution of the given mean.
+    std::size_t geometric(double mean)
+    {
+        return static_cast<std::size_t>(-mean * std::log(1 - real()));
+    }
+
+    template <typename T, std::size_t N>
+    const T& pick(const std::array<T, N>& values)
+    {
+        return values[below(N)];
+    }
+
+private:
+    std::mt19937_64 rng_;
+};
+
+/// Mix an integer into a well-distributed hash, for stable derivation of
+/// names from pool indices.
+uint64_t mix(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+struct genre_profile
+{
+    const char* name;
+    double weight;
+    double bpm_mean;
+    double bpm_sd;
+};
+
+constexpr std::array genres{
+    genre_profile{"House", 22, 124, 2.5},
+    genre_profile{"Tech House", 14, 126, 2},
+    genre_profile{"Techno", 14, 132, 5},
+    genre_profile{"Deep House", 9, 121, 3},
+    genre_profile{"Drum & Bass", 7, 174, 1.5},
+    genre_profile{"Trance", 6, 138, 3},
+    genre_profile{"Disco", 6, 118, 6},
+    genre_profile{"Hip-Hop", 7, 94, 10},
+    genre_profile{"Pop", 6, 112, 14},
+    genre_profile{"Breaks", 4, 130, 4},
+    genre_profile{"Dubstep", 3, 140, 1},
+    genre_profile{"Ambient", 2, 90, 20},
+};
+
+constexpr std::array<const char*, 32> first_names{
+    "Alex",   "Sam",    "Jordan", "Robin",   "Kai",    "Noor",  "Marta",
+    "Leon",   "Yuki",   "Tomas",  "Amara",   "Felix",  "Ines",  "Omar",
+    "Priya",  "Lars",   "Chloe",  "Dmitri",  "Elena",  "Hugo",  "Joon",
+    "Lucia",  "Mateo",  "Nadia",  "Oscar",   "Rosa",   "Sven",  "Tariq",
+    "Vera",   "Wren",   "Zane",   "Anouk"};
+
+constexpr std::array<const char*, 32> last_names{
+    "Berg",    "Costa",   "Dubois",  "Eriksen", "Fischer", "Garcia",
+    "Haddad",  "Ivanova", "Jansen",  "Kowalski", "Larsen", "Moreau",
+    "Nakamura", "Okafor", "Petrov",  "Quinn",   "Rossi",   "Sato",
+    "Tanaka",  "Urban",   "Varga",   "Weber",   "Xu",      "Young",
+    "Zimmer",  "Adler",   "Blake",   "Carver",  "Drake",   "Ellis",
+    "Frost",   "Grant"};
+
+constexpr std::array<const char*, 48> words{
+    "Midnight", "Signal",  "Echo",    "Pulse",   "Horizon", "Velvet",
+    "Gravity",  "Neon",    "Shadow",  "Motion",  "Summer",  "Static",
+    "Ritual",   "Orbit",   "Fever",   "Glass",   "Rhythm",  "Desire",
+    "Tide",     "Circuit", "Bloom",   "Dust",    "Mirage",  "Heat",
+    "Frequency", "Voyage", "Spiral",  "Haze",    "Ember",   "Lunar",
+    "Prism",    "Drift",   "Machine", "Paradise", "Thunder", "Silk",
+    "Ghost",    "Crystal", "Falling", "Rise",    "Wave",    "Control",
+    "Harmony",  "Island",  "Journey", "Kingdom", "Light",   "Memory"};
+
+constexpr std::array<const char*, 6> label_suffixes{
+    "Records", "Recordings", "Music", "Audio", "Trax", "Sounds"};
+
+constexpr std::array<const char*, 12> container_names{
+    "Warm Up",   "Peak Time", "Closing",   "Favourites",
+    "New In",    "Classics",  "Gig",       "Radio Show",
+    "Afterhours", "Sunday",   "Vinyl Rips", "To Sort"};
+
+constexpr std::array<const char*, 8> cue_labels{
+    "Intro", "Verse", "Build", "Drop", "Break", "Vocal", "Bridge", "Outro"};
+
+constexpr std::array<pad_color, 8> slot_colors{
+    standard_pad_colors::pad_1, standard_pad_colors::pad_2,
+    standard_pad_colors::pad_3, standard_pad_colors::pad_4,
+    standard_pad_colors::pad_5, standard_pad_colors::pad_6,
+    standard_pad_colors::pad_7, standard_pad_colors::pad_8};
+
+constexpr std::array<int, 4> loop_lengths{4, 8, 16, 32};
+
+// Fixed reference time, so that generated play times do not depend on when
+// the library is generated.
+constexpr std::chrono::seconds reference_time{1704067200};  // 2024-01-01
+
+std::string pool_name(uint64_t salt, std::size_t index)
+{
+    auto h = mix(salt ^ mix(index));
+    std::string name = words[h % words.size()];
+    if ((h >> 8) % 3 != 0)
+    {
+        name += " ";
+        name += words[(h >> 16) % words.size()];
+    }
+
+    return name;
+}
+
+std::string artist_name(uint64_t seed, std::size_t index)
+{
+    auto h = mix(seed ^ mix(index));
+    if (h % 4 == 0)
+    {
+        // Group or alias, rather than a person's name.
+        std::string name = "The ";
+        name += pool_name(seed ^ 0xA1, index);
+        name += "s";
+        return name;
+    }
+
+    std::string name = first_names[index % first_names.size()];
+    name += " ";
+    name += last_names[(index / first_names.size()) % last_names.size()];
+    auto generation = index / (first_names.size() * last_names.size());
+    if (generation > 0)
+    {
+        name += " ";
+        name += std::to_string(generation + 1);
+    }
+
+    return name;
+}
+
+std::string title_case_words(random_source& rng, std::size_t count)
+{
+    std::string title;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+            title += " ";
+        title += rng.pick(words);
+    }
+
+    return title;
+}
+
+const genre_profile& pick_genre(random_source& rng)
+{
+    double total = 0;
+    for (auto&& genre : genres)
+    {
+        total += genre.weight;
+    }
+
+    auto target = rng.real() * total;
+    for (auto&& genre : genres)
+    {
+        if (target < genre.weight)
+            return genre;
+
+        target -= genre.weight;
+    }
+
+    return genres.back();
+}
+
+/// Generate a waveform as a random walk for each band, quieter at the start
+/// and end of the track, as for a typical intro and outro.
+std::vector<waveform_entry> make_waveform(
+    random_source& rng, std::size_t size, bool with_opacity)
+{
+    std::vector<waveform_entry> waveform;
+    waveform.reserve(size);
+    std::array<double, 3> levels{160, 120, 80};
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        auto position = static_cast<double>(i) / size;
+        auto envelope = std::min({1.0, position * 10, (1 - position) * 10});
+        std::array<uint8_t, 3> values{};
+        for (std::size_t band = 0; band < 3; ++band)
+        {
+            levels[band] =
+                std::clamp(levels[band] + rng.real(-12, 12), 16.0, 255.0);
+            values[band] = static_cast<uint8_t>(
+                std::max(8.0, levels[band] * (0.3 + 0.7 * envelope)));
+        }
+
+        uint8_t opacity = with_opacity ? 255 : 0;
+        waveform.push_back(
+            {{values[0], opacity},
+             {values[1], opacity},
+             {values[2], opacity}});
+    }
+
+    return waveform;
+}
+
+/// Sample a number of distinct tracks.
+std::vector<track> sample_tracks(
+    random_source& rng, const std::vector<track>& tracks, std::size_t count)
+{
+    count = std::min(count, tracks.size());
+    std::vector<track> sampled;
+    sampled.reserve(count);
+    std::unordered_set<std::size_t> chosen;
+    while (sampled.size() < count)
+    {
+        auto index = rng.below(tracks.size());
+        if (chosen.insert(index).second)
+        {
+            sampled.push_back(tracks[index]);
+        }
+    }
+
+    return sampled;
+}
+
+/// Generate a tree of containers, being playlists or crates.
+template <typename Container, typename CreateRoot, typename CreateChild,
+          typename Fill>
+void generate_tree(
+    random_source& rng, std::size_t count, bool nested, std::size_t max_depth,
+    CreateRoot&& create_root, CreateChild&& create_child, Fill&& fill)
+{
+    std::vector<std::pair<Container, std::size_t>> nodes;
+    nodes.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto name = std::string{rng.pick(container_names)} + " " +
+                    std::to_string(i + 1);
+        if (rng.chance(0.3))
+        {
+            name = std::string{pick_genre(rng).name} + " " + name;
+        }
+
+        // Most containers are placed under an existing one, so as to build
+        // deep trees, but some always start new trees.
+        std::optional<std::size_t> parent;
+        if (nested && !nodes.empty() && rng.chance(0.7))
+        {
+            auto candidate = nodes.size() - 1 - rng.skewed(nodes.size());
+            if (nodes[candidate].second < max_depth)
+            {
+                parent = candidate;
+            }
+        }
+
+        if (parent)
+        {
+            auto depth = nodes[*parent].second + 1;
+            nodes.emplace_back(create_child(nodes[*parent].first, name), depth);
+        }
+        else
+        {
+            nodes.emplace_back(create_root(name), 1);
+        }
+
+        fill(nodes.back().first);
+    }
+}
+}  // anonymous namespace
+
+class synthetic_track_generator::impl
+{
+public:
+    impl(
+        engine_schema schema, uint64_t seed, std::size_t library_size,
+        bool performance_data) :
+        schema_{schema},
+        seed_{seed},
+        performance_data_{performance_data},
+        rng_{mix(seed)},
+        artist_count_{std::max<std::size_t>(1, library_size / 6)},
+        label_count_{std::max<std::size_t>(1, library_size / 40)}
+    {
+    }
+
+    track_snapshot next();
+
+private:
+    void add_performance_data(track_snapshot& s, double bpm);
+
+    engine_schema schema_;
+    uint64_t seed_;
+    bool performance_data_;
+    random_source rng_;
+    std::size_t artist_count_;
+    std::size_t label_count_;
+    std::size_t tracks_generated_ = 0;
+};
+
+track_snapshot synthetic_track_generator::impl::next()
+{
+    using namespace std::chrono;
+
+    auto index = tracks_generated_++;
+    auto&& genre = pick_genre(rng_);
+    auto artist_index = rng_.skewed(artist_count_);
+    auto artist = artist_name(seed_, artist_index);
+
+    track_snapshot s;
+    s.artist = artist;
+    s.album = pool_name(seed_ ^ 0xA2, artist_index * 8 + rng_.below(6));
+    s.genre = genre.name;
+    s.track_number = static_cast<int>(1 + rng_.below(12));
+
+    auto title = title_case_words(rng_, 1 + rng_.below(3));
+    auto mix_kind = rng_.real();
+    if (mix_kind < 0.4)
+    {
+        title += " (Original Mix)";
+    }
+    else if (mix_kind < 0.6)
+    {
+        title += " (Extended Mix)";
+    }
+    else if (mix_kind < 0.75)
+    {
+        title += " (";
+        title += artist_name(seed_, rng_.skewed(artist_count_));
+        title += " Remix)";
+    }
+
+    s.title = title;
+
+    if (rng_.chance(0.75))
+    {
+        auto label = pool_name(seed_ ^ 0xA3, rng_.skewed(label_count_));
+        s.publisher = label + " " + rng_.pick(label_suffixes);
+    }
+
+    if (rng_.chance(0.2))
+    {
+        s.composer = artist_name(seed_, rng_.skewed(artist_count_));
+    }
+
+    if (rng_.chance(0.3))
+    {
+        s.comment = "Purchased ";
+        *s.comment += std::to_string(2010 + rng_.below(15));
+    }
+
+    auto sample_rate = rng_.chance(0.85) ? 44100.0 : 48000.0;
+    auto length = std::clamp(rng_.normal(330, 90), 90.0, 900.0);
+    auto sample_count =
+        static_cast<unsigned long long>(std::llround(length * sample_rate));
+    s.sample_rate = sample_rate;
+    s.sample_count = sample_count;
+    s.duration = milliseconds{std::llround(length * 1000)};
+
+    auto is_lossless = rng_.chance(0.15);
+    auto bitrate = is_lossless             ? 1411
+                   : rng_.chance(0.7)      ? 320
+                   : rng_.chance(0.5)      ? 256
+                                           : 192;
+    s.bitrate = bitrate;
+    s.file_bytes = static_cast<unsigned long long>(bitrate * 125.0 * length);
+
+    auto bpm = std::clamp(
+        std::round(rng_.normal(genre.bpm_mean, genre.bpm_sd) * 100) / 100,
+        60.0, 200.0);
+    s.bpm = bpm;
+    if (rng_.chance(0.95))
+    {
+        s.key = static_cast<musical_key>(rng_.below(24));
+    }
+
+    s.average_loudness = rng_.real(0.4, 0.9);
+    if (!rng_.chance(0.55))
+    {
+        s.rating = static_cast<int>(1 + rng_.below(5)) * 20;
+    }
+
+    auto years_ago = static_cast<int>(50 * rng_.real() * rng_.real());
+    s.year = 2024 - years_ago;
+    if (rng_.chance(0.5))
+    {
+        auto played_ago =
+            seconds{static_cast<long long>(rng_.real() * 2 * 365 * 86400)};
+        s.last_played_at =
+            system_clock::time_point{reference_time - played_ago};
+    }
+
+    std::string path = "../Music/" + artist + "/" + *s.album + "/";
+    auto number = std::to_string(index + 1);
+    path += std::string(std::max<std::size_t>(6, number.size()) -
+                            number.size(), '0') +
+            number + " - " + title + (is_lossless ? ".flac" : ".mp3");
+    s.relative_path = path;
+
+    if (performance_data_)
+    {
+        add_performance_data(s, bpm);
+    }
+
+    return s;
+}
+
+void synthetic_track_generator::impl::add_performance_data(
+    track_snapshot& s, double bpm)
+{
+    auto sample_rate = *s.sample_rate;
+    auto sample_count = *s.sample_count;
+    auto samples_per_beat = sample_rate * 60 / bpm;
+    auto first_beat = rng_.real() * samples_per_beat;
+    auto beats = static_cast<int>(
+        (static_cast<double>(sample_count) - first_beat) / samples_per_beat);
+    s.beatgrid = normalize_beatgrid(
+        {{0, first_beat}, {beats, first_beat + beats * samples_per_beat}},
+        static_cast<int64_t>(sample_count));
+    s.main_cue = first_beat;
+
+    // Cues and loops are placed on downbeats, away from the very end of the
+    // track.
+    analysis::beatgrid_index grid{s.beatgrid};
+    auto usable_samples = 0.9 * static_cast<double>(sample_count);
+    auto random_downbeat = [&]
+    {
+        return std::max(
+            first_beat, grid.nearest_downbeat(rng_.real() * usable_samples));
+    };
+
+    std::vector<double> cue_offsets;
+    for (std::size_t i = 0; i < slot_colors.size(); ++i)
+    {
+        cue_offsets.push_back(random_downbeat());
+    }
+
+    std::sort(cue_offsets.begin(), cue_offsets.end());
+    s.hot_cues.resize(slot_colors.size());
+    for (std::size_t i = 0; i < slot_colors.size(); ++i)
+    {
+        if (rng_.chance(0.65))
+        {
+            std::string label = "Cue ";
+            label += std::to_string(i + 1);
+            if (rng_.chance(0.5))
+            {
+                label = cue_labels[i];
+            }
+
+            s.hot_cues[i] = hot_cue{label, cue_offsets[i], slot_colors[i]};
+        }
+    }
+
+    s.loops.resize(slot_colors.size());
+    for (std::size_t i = 0; i < slot_colors.size(); ++i)
+    {
+        if (rng_.chance(0.35))
+        {
+            auto start = random_downbeat();
+            auto length = rng_.pick(loop_lengths);
+            auto end = grid.sample_offset_of(grid.beat_at(start) + length);
+            std::string label = "Loop ";
+            label += std::to_string(i + 1);
+            if (rng_.chance(0.5))
+            {
+                label = std::to_string(length);
+                label += " Beat Loop";
+            }
+
+            s.loops[i] = loop{label, start, end, slot_colors[i]};
+        }
+    }
+
+    auto is_v1 = schema_ < engine_schema::schema_2_18_0;
+    auto extents =
+        is_v1 ? calculate_high_resolution_waveform_extents(
+                    sample_count, sample_rate)
+              : calculate_overview_waveform_extents(sample_count, sample_rate);
+    s.waveform = make_waveform(rng_, extents.size, is_v1);
+}
+
+synthetic_track_generator::synthetic_track_generator(
+    engine_schema schema, uint64_t seed, std::size_t library_size,
+    bool performance_data) :
+    pimpl_{std::make_unique<impl>(
+        schema, seed, library_size, performance_data)}
+{
+}
+
+synthetic_track_generator::synthetic_track_generator(
+    synthetic_track_generator&& other) noexcept = default;
+
+synthetic_track_generator::~synthetic_track_generator() = default;
+
+synthetic_track_generator& synthetic_track_generator::operator=(
+    synthetic_track_generator&& other) noexcept = default;
+
+track_snapshot synthetic_track_generator::next()
+{
+    return pimpl_->next();
+}
+
+void populate_synthetic_library(
+    database& db, const synthetic_library_options& options)
+{
+    auto crates_distinct =
+        db.supports_feature(feature::playlists_and_crates_are_distinct);
+    synthetic_library_progress progress;
+    progress.tracks_total = options.track_count;
+    progress.playlists_total = options.playlist_count;
+    progress.crates_total = crates_distinct ? options.crate_count : 0;
+
+    auto report = [&]
+    {
+        if (options.on_progress)
+            options.on_progress(progress);
+    };
+
+    synthetic_track_generator generator{
+        options.schema, options.seed, options.track_count,
+        options.performance_data};
+    std::vector<track> tracks;
+    tracks.reserve(options.track_count);
+    std::vector<track_snapshot> batch;
+    while (tracks.size() < options.track_count)
+    {
+        // Tracks are created in batches, so that each transaction commit,
+        // and the journal sync that comes with it, is shared by many tracks.
+        batch.clear();
+        auto batch_size = std::min(
+            track_batch_size, options.track_count - tracks.size());
+        for (std::size_t i = 0; i < batch_size; ++i)
+        {
+            batch.push_back(generator.next());
+        }
+
+        auto created = db.create_tracks(batch);
+        tracks.insert(tracks.end(), created.begin(), created.end());
+        progress.tracks_done = tracks.size();
+        report();
+    }
+
+    random_source rng{mix(options.seed ^ 0xC0)};
+    auto max_depth = std::max<std::size_t>(1, options.max_depth);
+    auto mean_size = static_cast<double>(options.mean_container_size);
+
+    generate_tree<playlist>(
+        rng, options.playlist_count,
+        db.supports_feature(feature::supports_nested_playlists), max_depth,
+        [&](const std::string& name) { return db.create_root_playlist(name); },
+        [](playlist& parent, const std::string& name)
+        { return parent.create_sub_playlist(name); },
+        [&](playlist& pl)
+        {
+            auto sampled = sample_tracks(rng, tracks, rng.geometric(mean_size));
+            pl.add_tracks_back(sampled.begin(), sampled.end());
+            ++progress.playlists_done;
+            report();
+        });
+
+    if (!crates_distinct)
+    {
+        return;
+    }
+
+    generate_tree<crate>(
+        rng, options.crate_count,
+        db.supports_feature(feature::supports_nested_crates), max_depth,
+        [&](const std::string& name) { return db.create_root_crate(name); },
+        [](crate& parent, const std::string& name)
+        { return parent.create_sub_crate(name); },
+        [&](crate& cr)
+        {
+            auto sampled = sample_tracks(rng, tracks, rng.geometric(mean_size));
+            cr.add_tracks(sampled.begin(), sampled.end());
+            ++progress.crates_done;
+            report();
+        });
+}
+
+database create_synthetic_library(
+    const std::string& directory, const synthetic_library_options& options)
+{
+    auto db = create_database(directory, options.schema);
+    populate_synthetic_library(db, options);
+    return db;
+}
+
+}  // namespace djinterop::engine
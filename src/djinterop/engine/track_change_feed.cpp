@@ -0,0 +1,117 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "track_change_feed.hpp"
+
+namespace djinterop::engine
+{
+track_change_feed::track_change_feed(
+    sqlite::database& db, engine_schema schema) :
+    db_{db}, schema_{schema}
+{
+}
+
+bool track_change_feed::is_legacy() const
+{
+    return schema_ < engine_schema::schema_2_18_0;
+}
+
+connection_stamp track_change_feed::stamp() const
+{
+    connection_stamp result;
+    result.total_changes = sqlite3_total_changes(db_.connection().get());
+    db_ << (is_legacy() ? "PRAGMA music.data_version"
+                        : "PRAGMA main.data_version") >>
+        result.data_version;
+    if (is_legacy())
+    {
+        db_ << "PRAGMA perfdata.data_version" >> result.perfdata_data_version;
+    }
+
+    return result;
+}
+
+track_change_checkpoint track_change_feed::checkpoint() const
+{
+    track_change_checkpoint result;
+    db_ << (is_legacy() ? "SELECT IFNULL(MAX(id), 0) FROM music.Track"
+                        : "SELECT IFNULL(MAX(id), 0) FROM main.Track") >>
+        result.max_track_id;
+
+    if (schema_ >= engine_schema::schema_2_20_3)
+    {
+        // A track stamped with a time in the future must not hide edits made
+        // to other tracks in the meantime.
+        db_ << "SELECT MIN(IFNULL(MAX(lastEditTime), 0), "
+               "CAST(strftime('%s') AS INTEGER)) FROM main.Track" >>
+            result.last_edit_time;
+    }
+    else if (!is_legacy())
+    {
+        db_ << "SELECT IFNULL(MAX(id), 0) FROM main.ChangeLog" >>
+            result.last_change_id;
+    }
+
+    return result;
+}
+
+std::string track_change_feed::changed_tracks_sql() const
+{
+    // Stamps have a resolution of one second, so tracks stamped in the same
+    // second as the checkpoint are included in case they were edited after
+    // it was taken.
+    if (schema_ >= engine_schema::schema_2_20_3)
+        return "SELECT id FROM main.Track WHERE lastEditTime >= ?";
+
+    if (!is_legacy())
+        return "SELECT trackId FROM main.ChangeLog WHERE id > ?";
+
+    // Any track may have changed.
+    return "SELECT id FROM music.Track WHERE ? IS NOT NULL";
+}
+
+int64_t track_change_feed::changed_tracks_parameter(
+    const track_change_checkpoint& since) const
+{
+    if (schema_ >= engine_schema::schema_2_20_3)
+        return since.last_edit_time;
+
+    if (!is_legacy())
+        return since.last_change_id;
+
+    return 0;
+}
+
+std::string track_change_feed::library_uuid() const
+{
+    std::string result;
+    db_ << (is_legacy() ? "SELECT uuid FROM music.Information"
+                        : "SELECT uuid FROM main.Information") >>
+        result;
+    return result;
+}
+
+int64_t track_change_feed::track_count() const
+{
+    int64_t result = 0;
+    db_ << (is_legacy() ? "SELECT COUNT(*) FROM music.Track"
+                        : "SELECT COUNT(*) FROM main.Track") >>
+        result;
+    return result;
+}
+
+}  // namespace djinterop::engine
@@ -0,0 +1,110 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/engine/engine_schema.hpp>
+
+namespace djinterop::engine
+{
+/// Counters of a SQLite connection, at least one of which changes whenever a
+/// database may have been written, whether through that connection or not.
+struct connection_stamp
+{
+    /// Rows changed through the connection, as per `sqlite3_total_changes()`.
+    int total_changes = 0;
+
+    /// Data version of the database, which changes when another connection
+    /// commits a write to it.
+    int64_t data_version = 0;
+
+    /// Data version of the attached performance data database, for legacy
+    /// schemas that keep track features apart from the tracks.
+    int64_t perfdata_data_version = 0;
+
+    friend bool operator==(
+        const connection_stamp& lhs, const connection_stamp& rhs) = default;
+};
+
+/// Position in the record of changes made to the tracks of a library.
+struct track_change_checkpoint
+{
+    /// Highest track id allocated.  Track ids are never re-used.
+    int64_t max_track_id = 0;
+
+    /// Highest id in the `ChangeLog` table, for schemas that log changes.
+    int64_t last_change_id = 0;
+
+    /// Latest `lastEditTime` of any track, for schemas that stamp changes.
+    int64_t last_edit_time = 0;
+};
+
+/// The `track_change_feed` class reads the record that an Engine library
+/// keeps of which tracks have changed, so that data derived from tracks can
+/// be updated incrementally.
+///
+/// Later schemas log the id of each edited track in the `ChangeLog` table
+/// (2.18.0 to 2.20.2), or stamp each edited track with `lastEditTime` (2.20.3
+/// onwards).  Together with new track ids, this identifies every track created
+/// or edited since a checkpoint.  Legacy libraries keep no such record.
+class track_change_feed
+{
+public:
+    /// Construct a change feed for an Engine library.
+    ///
+    /// \param db Connection to the Engine library.
+    /// \param schema Schema version of the Engine library.
+    track_change_feed(sqlite::database& db, engine_schema schema);
+
+    /// Whether the library has no record of changed tracks.
+    [[nodiscard]] bool is_legacy() const;
+
+    /// Get the counters of the connection to the library.
+    [[nodiscard]] connection_stamp stamp() const;
+
+    /// Get the current position in the record of changes.
+    [[nodiscard]] track_change_checkpoint checkpoint() const;
+
+    /// Get a query selecting the ids of tracks edited since a checkpoint,
+    /// which takes the value of `changed_tracks_parameter()` as its sole
+    /// parameter.  Tracks created since the checkpoint are not necessarily
+    /// selected.  For legacy libraries, every track is selected.
+    [[nodiscard]] std::string changed_tracks_sql() const;
+
+    /// Get the parameter of the query given by `changed_tracks_sql()`.
+    ///
+    /// \param since Checkpoint since which to select edited tracks.
+    [[nodiscard]] int64_t changed_tracks_parameter(
+        const track_change_checkpoint& since) const;
+
+    /// Get the UUID of the library.
+    [[nodiscard]] std::string library_uuid() const;
+
+    /// Get the number of tracks in the library.
+    [[nodiscard]] int64_t track_count() const;
+
+private:
+    sqlite::database& db_;
+    engine_schema schema_;
+};
+
+}  // namespace djinterop::engine
@@ -0,0 +1,460 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <djinterop/exceptions.hpp>
+
+#include "../util/sqlite_transaction.hpp"
+#include "metadata_types.hpp"
+#include "track_duplicates_sql.hpp"
+
+namespace djinterop::engine
+{
+namespace
+{
+bool is_legacy(engine_schema schema)
+{
+    return schema < engine_schema::schema_2_18_0;
+}
+
+/// SQL to select the id, path, filename, file size, artist, title, length,
+/// and analysed BPM of tracks, in order of id.
+std::string make_select_sql(engine_schema schema)
+{
+    if (!is_legacy(schema))
+    {
+        return "SELECT id, path, filename, fileBytes, artist, title, length, "
+               "bpmAnalyzed FROM Track ORDER BY id";
+    }
+
+    // Legacy libraries hold text metadata separately, may lack a record of
+    // file size, and may have rows left behind by deleted tracks, which have
+    // a NULL path.
+    return std::string{"SELECT t.id, t.path, t.filename, "} +
+           (schema >= engine_schema::schema_1_15_0 ? "t.fileBytes" : "NULL") +
+           ", artist.text, title.text, t.length, t.bpmAnalyzed "
+           "FROM music.Track AS t "
+           "LEFT JOIN music.MetaData AS artist ON artist.id = t.id "
+           "AND artist.type = " +
+           std::to_string(static_cast<int>(metadata_str_type::artist)) +
+           " LEFT JOIN music.MetaData AS title ON title.id = t.id "
+           "AND title.type = " +
+           std::to_string(static_cast<int>(metadata_str_type::title)) +
+           " WHERE t.path IS NOT NULL ORDER BY t.id";
+}
+
+/// SQL to count the playlist or crate memberships of each track.
+std::string make_membership_sql(engine_schema schema)
+{
+    if (!is_legacy(schema))
+        return "SELECT trackId, COUNT(*) FROM PlaylistEntity GROUP BY trackId";
+
+    return "SELECT trackId, COUNT(*) FROM (SELECT trackId FROM "
+           "music.CrateTrackList UNION ALL SELECT trackId FROM "
+           "music.PlaylistTrackList) GROUP BY trackId";
+}
+
+/// Reduce text to its lower-case letters and digits, so that differences in
+/// case, punctuation, and whitespace are ignored.  Characters outside ASCII
+/// are kept as they are.
+std::string normalise(std::string_view text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (auto c : text)
+    {
+        auto u = static_cast<unsigned char>(c);
+        if (u >= 'A' && u <= 'Z')
+            result.push_back(static_cast<char>(u - 'A' + 'a'));
+        else if ((u >= 'a' && u <= 'z') || (u >= '0' && u <= '9') || u >= 0x80)
+            result.push_back(c);
+    }
+
+    return result;
+}
+
+/// Fold a path so that paths that differ only in the case of ASCII letters or
+/// the direction of separators are equal.
+std::string fold_path(std::string path)
+{
+    for (auto& c : path)
+    {
+        if (c >= 'A' && c <= 'Z')
+            c = static_cast<char>(c - 'A' + 'a');
+        else if (c == '\\')
+            c = '/';
+    }
+
+    return path;
+}
+
+/// Disjoint sets of rows, each represented by its lowest row.
+class disjoint_sets
+{
+public:
+    std::size_t add()
+    {
+        parents_.push_back(static_cast<uint32_t>(parents_.size()));
+        return parents_.size() - 1;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return parents_.size(); }
+
+    std::size_t find(std::size_t row)
+    {
+        while (parents_[row] != row)
+        {
+            parents_[row] = parents_[parents_[row]];
+            row = parents_[row];
+        }
+
+        return row;
+    }
+
+    void unite(std::size_t lhs, std::size_t rhs)
+    {
+        lhs = find(lhs);
+        rhs = find(rhs);
+        if (lhs < rhs)
+            parents_[rhs] = static_cast<uint32_t>(lhs);
+        else if (rhs < lhs)
+            parents_[lhs] = static_cast<uint32_t>(rhs);
+    }
+
+private:
+    std::vector<uint32_t> parents_;
+};
+
+/// Track matched by metadata, with its bucket of identical artist and title.
+struct metadata_entry
+{
+    uint32_t bucket;
+    int64_t length;
+    uint32_t row;
+};
+
+/// Table of list memberships, in which duplicates are to be replaced.
+struct membership_table
+{
+    /// Name of the table, qualified by its schema if need be.
+    std::string name;
+
+    /// Condition under which rows `o` and `e` belong to the same list.
+    std::string same_list;
+
+    /// Condition on the rows of the table to which merging is restricted.
+    std::string filter = "1";
+
+    /// Whether the table records the id of each track in its origin
+    /// database, which is the same as its id for tracks that originated
+    /// here.
+    bool has_origin_id = false;
+};
+
+/// Replace duplicates with their survivors in a table of list memberships,
+/// given the duplicates in `temp.djinterop_duplicate`.
+void merge_memberships(sqlite::database& db, const membership_table& table)
+{
+    // A duplicate is removed from a list if the list holds its survivor, or
+    // an earlier duplicate of the same survivor.
+    db << "DELETE FROM " + table.name + " WHERE " + table.filter +
+              " AND rowid IN (SELECT e.rowid FROM " + table.name +
+              " AS e JOIN temp.djinterop_duplicate AS d "
+              "ON d.trackId = e.trackId WHERE EXISTS (SELECT 1 FROM " +
+              table.name +
+              " AS o LEFT JOIN temp.djinterop_duplicate AS od "
+              "ON od.trackId = o.trackId WHERE " +
+              table.same_list +
+              " AND (o.trackId = d.survivorId OR (o.rowid < e.rowid AND "
+              "od.survivorId = d.survivorId))))";
+
+    // Columns of the table being updated are referred to without its schema.
+    auto unqualified = table.name.substr(table.name.find('.') + 1);
+    auto survivor = "(SELECT survivorId FROM temp.djinterop_duplicate AS d "
+                    "WHERE d.trackId = " +
+                    unqualified + ".trackId)";
+    auto origin_assignment =
+        table.has_origin_id
+            ? "trackIdInOriginDatabase = CASE WHEN trackIdInOriginDatabase "
+              "= trackId THEN " +
+                  survivor + " ELSE trackIdInOriginDatabase END, "
+            : std::string{};
+    db << "UPDATE " + table.name + " SET " + origin_assignment +
+              "trackId = " + survivor + " WHERE " + table.filter +
+              " AND trackId IN (SELECT trackId FROM "
+              "temp.djinterop_duplicate)";
+}
+
+}  // anonymous namespace
+
+std::vector<duplicate_group> find_duplicate_tracks(
+    sqlite::database& db, engine_schema schema,
+    const duplicate_policy& policy)
+{
+    if (policy.duration_tolerance.count() < 0)
+    {
+        throw std::invalid_argument{"Duration tolerance must not be negative"};
+    }
+
+    std::vector<int64_t> ids;
+    std::vector<bool> analysed;
+    disjoint_sets sets;
+    std::unordered_map<std::string, uint32_t> by_path;
+    std::unordered_map<std::string, uint32_t> by_file;
+    std::unordered_map<std::string, uint32_t> by_metadata;
+    std::vector<metadata_entry> metadata_entries;
+
+    // Each key maps to the first row seen with it, with which later rows are
+    // united.
+    auto match = [&](std::unordered_map<std::string, uint32_t>& rows,
+                     std::string key, std::size_t row)
+    {
+        auto [iter, inserted] =
+            rows.try_emplace(std::move(key), static_cast<uint32_t>(row));
+        if (!inserted)
+            sets.unite(iter->second, row);
+    };
+
+    db << make_select_sql(schema) >>
+        [&](int64_t id, std::optional<std::string> path,
+            std::optional<std::string> filename,
+            std::optional<int64_t> file_bytes,
+            std::optional<std::string> artist,
+            std::optional<std::string> title, std::optional<int64_t> length,
+            std::optional<double> bpm_analyzed)
+    {
+        auto row = sets.add();
+        ids.push_back(id);
+        analysed.push_back(bpm_analyzed && *bpm_analyzed > 0);
+
+        if (policy.match_path && path && !path->empty())
+            match(by_path, fold_path(std::move(*path)), row);
+
+        if (policy.match_file_name_and_size && filename &&
+            !filename->empty() && file_bytes && *file_bytes > 0)
+        {
+            filename->push_back('\0');
+            filename->append(std::to_string(*file_bytes));
+            match(by_file, std::move(*filename), row);
+        }
+
+        // Length is held in seconds, and zero means unknown.
+        if (policy.match_metadata && title && length && *length > 0)
+        {
+            auto key = normalise(*title);
+            if (!key.empty())
+            {
+                key.push_back('\0');
+                key.append(normalise(artist.value_or("")));
+                auto [iter, inserted] = by_metadata.try_emplace(
+                    std::move(key), static_cast<uint32_t>(by_metadata.size()));
+                metadata_entries.push_back(
+                    {iter->second, *length * 1000, static_cast<uint32_t>(row)});
+            }
+        }
+    };
+
+    // Within each bucket of identical artist and title, tracks are matched
+    // with their neighbours in order of duration.
+    std::sort(
+        metadata_entries.begin(), metadata_entries.end(),
+        [](const metadata_entry& lhs, const metadata_entry& rhs) {
+            return std::tie(lhs.bucket, lhs.length) <
+                   std::tie(rhs.bucket, rhs.length);
+        });
+    for (std::size_t i = 1; i < metadata_entries.size(); ++i)
+    {
+        auto& previous = metadata_entries[i - 1];
+        auto& current = metadata_entries[i];
+        if (previous.bucket == current.bucket &&
+            current.length - previous.length <=
+                policy.duration_tolerance.count())
+        {
+            sets.unite(previous.row, current.row);
+        }
+    }
+
+    // Rows are in order of id, and each set is represented by its lowest row,
+    // so groups are formed in order of their first track.
+    std::vector<uint32_t> set_sizes(sets.size());
+    for (std::size_t row = 0; row < sets.size(); ++row)
+        ++set_sizes[sets.find(row)];
+
+    std::vector<std::vector<uint32_t>> group_rows;
+    std::vector<std::size_t> group_of_set(sets.size());
+    for (std::size_t row = 0; row < sets.size(); ++row)
+    {
+        auto set = sets.find(row);
+        if (set_sizes[set] < 2)
+            continue;
+
+        if (set == row)
+        {
+            group_of_set[set] = group_rows.size();
+            group_rows.emplace_back();
+            group_rows.back().reserve(set_sizes[set]);
+        }
+
+        group_rows[group_of_set[set]].push_back(static_cast<uint32_t>(row));
+    }
+
+    std::vector<duplicate_group> groups;
+    if (group_rows.empty())
+        return groups;
+
+    std::unordered_map<int64_t, int64_t> memberships;
+    db << make_membership_sql(schema) >>
+        [&](int64_t track_id, int64_t count)
+    { memberships[track_id] = count; };
+
+    auto rank = [&](uint32_t row)
+    {
+        auto iter = memberships.find(ids[row]);
+        return std::pair{
+            static_cast<bool>(analysed[row]),
+            iter != memberships.end() ? iter->second : 0};
+    };
+
+    groups.reserve(group_rows.size());
+    for (auto&& rows : group_rows)
+    {
+        // Rows are in ascending order, so ties go to the earliest added.
+        auto& group = groups.emplace_back();
+        auto best = rows.front();
+        for (auto row : rows)
+        {
+            group.track_ids.push_back(ids[row]);
+            if (rank(best) < rank(row))
+                best = row;
+        }
+
+        group.survivor_id = ids[best];
+    }
+
+    return groups;
+}
+
+void merge_duplicate_tracks(
+    sqlite::database& db, engine_schema schema,
+    const std::vector<duplicate_group>& groups)
+{
+    std::unordered_set<int64_t> seen;
+    for (auto&& group : groups)
+    {
+        if (std::find(
+                group.track_ids.begin(), group.track_ids.end(),
+                group.survivor_id) == group.track_ids.end())
+        {
+            throw std::invalid_argument{
+                "The survivor of a duplicate group must be one of its tracks"};
+        }
+
+        for (auto id : group.track_ids)
+        {
+            if (!seen.insert(id).second)
+            {
+                throw std::invalid_argument{
+                    "A track must not appear in more than one duplicate "
+                    "group"};
+            }
+        }
+    }
+
+    // The duplicates are held in a temporary table, so that memberships can
+    // be merged by a handful of statements regardless of how many there are.
+    // The table is created within the transaction, and so does not outlive it
+    // even on failure.
+    util::sqlite_transaction trans{db};
+    db << "DROP TABLE IF EXISTS temp.djinterop_duplicate";
+    db << "CREATE TEMP TABLE djinterop_duplicate (trackId INTEGER PRIMARY "
+          "KEY, survivorId INTEGER NOT NULL)";
+    {
+        auto insert = db << "INSERT INTO temp.djinterop_duplicate (trackId, "
+                            "survivorId) VALUES (?, ?)";
+
+        // The statement must not be run on destruction if nothing is bound.
+        insert.used(true);
+        for (auto&& group : groups)
+        {
+            for (auto id : group.track_ids)
+            {
+                if (id == group.survivor_id)
+                    continue;
+
+                insert << id << group.survivor_id;
+                insert++;
+            }
+        }
+    }
+
+    auto legacy = is_legacy(schema);
+    std::optional<int64_t> missing_id;
+    db << std::string{"SELECT d.id FROM (SELECT trackId AS id FROM "
+                      "temp.djinterop_duplicate UNION SELECT survivorId FROM "
+                      "temp.djinterop_duplicate) AS d WHERE NOT EXISTS "
+                      "(SELECT 1 FROM "} +
+              (legacy ? "music.Track" : "Track") +
+              " AS t WHERE t.id = d.id) LIMIT 1" >>
+        [&](int64_t id) { missing_id = id; };
+    if (missing_id)
+    {
+        throw track_deleted{*missing_id};
+    }
+
+    if (legacy && schema >= engine_schema::schema_1_9_1)
+    {
+        // Crates and playlists are views over a single table of lists, which
+        // cannot be updated through the views.  History and prepare lists
+        // are left alone.
+        merge_memberships(
+            db, {"music.ListTrackList",
+                 "o.listId = e.listId AND o.listType = e.listType",
+                 "listType IN (1, 4)", true});
+    }
+    else if (legacy)
+    {
+        merge_memberships(
+            db, {"music.CrateTrackList", "o.crateId = e.crateId"});
+        merge_memberships(
+            db, {"music.PlaylistTrackList", "o.playlistId = e.playlistId", "1",
+                 true});
+    }
+    else
+    {
+        merge_memberships(db, {"PlaylistEntity", "o.listId = e.listId"});
+    }
+
+    // All other references to the tracks should automatically be cleared by
+    // "ON DELETE CASCADE".
+    db << std::string{"DELETE FROM "} + (legacy ? "music.Track" : "Track") +
+              " WHERE id IN (SELECT trackId FROM temp.djinterop_duplicate)";
+    db << "DROP TABLE temp.djinterop_duplicate";
+    trans.commit();
+}
+
+}  // namespace djinterop::engine
@@ -0,0 +1,61 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/engine/engine_schema.hpp>
+#include <djinterop/track_duplicates.hpp>
+
+namespace djinterop::engine
+{
+/// Find groups of duplicate tracks in an Engine library.
+///
+/// The library is read in a single scan of its tracks, together with a count
+/// of the playlist or crate memberships of each track, and tracks are grouped
+/// by hashing the keys enabled by the policy.
+///
+/// \param db Connection to the Engine library.
+/// \param schema Schema version of the Engine library.
+/// \param policy Policy determining which tracks are duplicates.
+/// \return Returns the groups of duplicates, in order of their first track.
+std::vector<duplicate_group> find_duplicate_tracks(
+    sqlite::database& db, engine_schema schema,
+    const duplicate_policy& policy);
+
+/// Merge groups of duplicate tracks in an Engine library into their survivors.
+///
+/// Each duplicate is replaced by its survivor in every playlist or crate that
+/// holds it, and is then removed.  If a list already holds the survivor, the
+/// duplicate is simply removed from it.  If a list holds several duplicates
+/// but not the survivor, the first of them to have been added is replaced,
+/// and the others are removed.  All groups are merged in one transaction.
+///
+/// \param db Connection to the Engine library.
+/// \param schema Schema version of the Engine library.
+/// \param groups Groups of duplicates to merge.
+/// \throws std::invalid_argument If the survivor of a group is not among its
+///         tracks, or a track appears in more than one group.
+/// \throws track_deleted If a track does not exist.
+void merge_duplicate_tracks(
+    sqlite::database& db, engine_schema schema,
+    const std::vector<duplicate_group>& groups);
+
+}  // namespace djinterop::engine
@@ -0,0 +1,229 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "track_feature_source.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../util/sqlite_transaction.hpp"
+#include "metadata_types.hpp"
+#include "v1/performance_data_format.hpp"
+#include "v2/convert_track.hpp"
+
+namespace djinterop::engine
+{
+namespace
+{
+bool has_performance_data_table(engine_schema schema)
+{
+    return schema >= engine_schema::schema_3_0_0;
+}
+
+/// SQL to select the id, BPM fields, key, length, genre, and track data of
+/// tracks.
+std::string make_select_sql(engine_schema schema)
+{
+    // Legacy libraries hold the key in the track data, and may have rows left
+    // behind by deleted tracks, which have a NULL path.
+    if (schema < engine_schema::schema_2_18_0)
+    {
+        return "SELECT t.id, t.bpmAnalyzed, t.bpm, NULL, t.length, "
+               "genre.text, pd.trackData FROM music.Track AS t "
+               "LEFT JOIN music.MetaData AS genre ON genre.id = t.id "
+               "AND genre.type = " +
+               std::to_string(static_cast<int>(metadata_str_type::genre)) +
+               " LEFT JOIN perfdata.PerformanceData AS pd ON pd.id = t.id "
+               "WHERE t.path IS NOT NULL";
+    }
+
+    if (!has_performance_data_table(schema))
+    {
+        return "SELECT t.id, t.bpmAnalyzed, t.bpm, t.key, t.length, "
+               "t.genre, t.trackData FROM main.Track AS t";
+    }
+
+    return "SELECT t.id, t.bpmAnalyzed, t.bpm, t.key, t.length, t.genre, "
+           "p.trackData FROM main.Track AS t "
+           "LEFT JOIN main.PerformanceData AS p ON p.trackId = t.id";
+}
+
+std::size_t hash_blob(const std::vector<std::byte>& blob) noexcept
+{
+    return std::hash<std::string_view>{}(std::string_view{
+        reinterpret_cast<const char*>(blob.data()), blob.size()});
+}
+
+track_features make_features(
+    bool legacy, int64_t id, std::optional<double> bpm_analyzed,
+    std::optional<int64_t> bpm, std::optional<int32_t> key,
+    std::optional<int64_t> length, std::optional<std::string> genre,
+    const std::vector<std::byte>& track_data)
+{
+    track_features result;
+    result.id = id;
+    result.genre = std::move(genre);
+    result.bpm = v2::convert::read::bpm(bpm_analyzed, bpm);
+    if (legacy)
+    {
+        if (!track_data.empty())
+        {
+            auto decoded = v1::track_data::decode(track_data);
+            result.key = decoded.key;
+            result.average_loudness = decoded.average_loudness;
+        }
+
+        if (length)
+            result.duration = std::chrono::milliseconds{*length * 1000};
+    }
+    else
+    {
+        result.key = v2::convert::read::key(key);
+        result.average_loudness = v2::convert::read::average_loudness(
+            v2::track_data_blob::from_blob(track_data));
+        result.duration = v2::convert::read::duration(length.value_or(0));
+    }
+
+    return result;
+}
+
+}  // anonymous namespace
+
+track_feature_source::track_feature_source(
+    sqlite::database& db, engine_schema schema) :
+    db_{db}, schema_{schema}, feed_{db, schema}
+{
+}
+
+std::shared_ptr<const track_feature_index> track_feature_source::index()
+{
+    // A library for which the connection counters have not moved need not be
+    // examined any further.
+    auto stamp = feed_.stamp();
+    if (index_ && stamp_ == stamp)
+        return index_;
+
+    djinterop::util::sqlite_transaction trans{db_};
+
+    auto library_uuid = feed_.library_uuid();
+    auto checkpoint = feed_.checkpoint();
+    if (!index_ || feed_.is_legacy() || library_uuid != library_uuid_ ||
+        checkpoint_.max_track_id > checkpoint.max_track_id)
+    {
+        load_all();
+    }
+    else
+    {
+        load_changes(checkpoint_);
+    }
+
+    trans.commit();
+
+    // Nothing is written in bringing the index up to date, and so the stamp
+    // taken beforehand remains valid.
+    stamp_ = stamp;
+    library_uuid_ = std::move(library_uuid);
+    checkpoint_ = checkpoint;
+    return index_;
+}
+
+void track_feature_source::load_all()
+{
+    auto legacy = feed_.is_legacy();
+    std::vector<track_features> tracks;
+    blob_hashes_.clear();
+    db_ << make_select_sql(schema_) >>
+        [&](int64_t id, std::optional<double> bpm_analyzed,
+            std::optional<int64_t> bpm, std::optional<int32_t> key,
+            std::optional<int64_t> length, std::optional<std::string> genre,
+            const std::vector<std::byte>& track_data)
+    {
+        tracks.push_back(make_features(
+            legacy, id, bpm_analyzed, bpm, key, length, std::move(genre),
+            track_data));
+        if (has_performance_data_table(schema_))
+            blob_hashes_[id] = hash_blob(track_data);
+    };
+
+    index_ = std::make_shared<track_feature_index>(tracks);
+}
+
+void track_feature_source::load_changes(const track_change_checkpoint& since)
+{
+    // An index still held by a caller must not change under them.
+    if (index_.use_count() > 1)
+        index_ = std::make_shared<track_feature_index>(*index_);
+
+    auto upsert = [&](int64_t id, std::optional<double> bpm_analyzed,
+                      std::optional<int64_t> bpm, std::optional<int32_t> key,
+                      std::optional<int64_t> length,
+                      std::optional<std::string> genre,
+                      const std::vector<std::byte>& track_data)
+    {
+        index_->upsert(make_features(
+            false, id, bpm_analyzed, bpm, key, length, std::move(genre),
+            track_data));
+        if (has_performance_data_table(schema_))
+            blob_hashes_[id] = hash_blob(track_data);
+    };
+
+    auto select_sql = make_select_sql(schema_);
+    db_ << select_sql + " WHERE t.id > ? OR t.id IN (" +
+               feed_.changed_tracks_sql() + ")"
+        << since.max_track_id << feed_.changed_tracks_parameter(since) >>
+        upsert;
+
+    // Edits to the `PerformanceData` table are not recorded as changes to the
+    // track, and so are found by comparing each track data blob with the one
+    // from which the index was last loaded.
+    if (has_performance_data_table(schema_))
+    {
+        std::vector<int64_t> edited_ids;
+        db_ << "SELECT trackId, trackData FROM main.PerformanceData" >>
+            [&](int64_t id, const std::vector<std::byte>& track_data)
+        {
+            auto iter = blob_hashes_.find(id);
+            if (iter != blob_hashes_.end() &&
+                iter->second != hash_blob(track_data))
+            {
+                edited_ids.push_back(id);
+            }
+        };
+
+        for (auto id : edited_ids)
+            db_ << select_sql + " WHERE t.id = ?" << id >> upsert;
+    }
+
+    // Every track is indexed, so there are more rows in the index than tracks
+    // in the library only if tracks have been removed.
+    if (static_cast<int64_t>(index_->size()) > feed_.track_count())
+    {
+        std::vector<int64_t> ids;
+        db_ << "SELECT id FROM main.Track" >>
+            [&](int64_t id) { ids.push_back(id); };
+        index_->retain_only(std::move(ids));
+        std::erase_if(
+            blob_hashes_, [&](const auto& entry)
+            { return !index_->row_of(entry.first); });
+    }
+}
+
+}  // namespace djinterop::engine
@@ -0,0 +1,76 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/engine/engine_schema.hpp>
+#include <djinterop/track_feature_index.hpp>
+
+#include "track_change_feed.hpp"
+
+namespace djinterop::engine
+{
+/// The `track_feature_source` class maintains a `track_feature_index` over the
+/// tracks of an Engine library.
+///
+/// The index is loaded in full on first use, and is thereafter brought up to
+/// date incrementally using the library's record of changed tracks.  Legacy
+/// libraries have no such record, and so are re-loaded after any write.
+///
+/// Each index handed out is an immutable snapshot.  An index that is no longer
+/// held by any caller is updated in place, and otherwise is copied first.
+class track_feature_source
+{
+public:
+    /// Construct a feature source for an Engine library.
+    ///
+    /// No work is done until the index is first requested.
+    ///
+    /// \param db Connection to the Engine library.
+    /// \param schema Schema version of the Engine library.
+    track_feature_source(sqlite::database& db, engine_schema schema);
+
+    /// Get an index that is up to date with the library.
+    [[nodiscard]] std::shared_ptr<const track_feature_index> index();
+
+private:
+    void load_all();
+    void load_changes(const track_change_checkpoint& since);
+
+    sqlite::database& db_;
+    engine_schema schema_;
+    track_change_feed feed_;
+    std::shared_ptr<track_feature_index> index_;
+
+    // State of the library when the index was last brought up to date.
+    std::optional<connection_stamp> stamp_;
+    std::string library_uuid_;
+    track_change_checkpoint checkpoint_;
+
+    // Hash of the track data blob of each track, for schemas that hold it in
+    // the `PerformanceData` table.
+    std::unordered_map<int64_t, std::size_t> blob_hashes_;
+};
+
+}  // namespace djinterop::engine
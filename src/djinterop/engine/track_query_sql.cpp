@@ -0,0 +1,373 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "metadata_types.hpp"
+#include "track_query_sql.hpp"
+
+namespace djinterop::engine
+{
+namespace
+{
+/// Track fields held in the `MetaData` and `MetaDataInteger` tables of legacy
+/// databases.
+enum class meta_field
+{
+    title,
+    artist,
+    genre,
+    key,
+    rating,
+};
+
+/// Builder of the expressions referring to each track field, which joins
+/// metadata tables as needed for legacy databases.
+class column_resolver
+{
+public:
+    explicit column_resolver(track_query_layout layout) : layout_{layout} {}
+
+    [[nodiscard]] bool legacy() const
+    {
+        return layout_ == track_query_layout::legacy;
+    }
+
+    [[nodiscard]] std::string id() const { return legacy() ? "t.id" : "id"; }
+
+    /// The BPM of a track is its analysed BPM, or else its tagged BPM.
+    [[nodiscard]] std::string bpm() const
+    {
+        return legacy() ? "COALESCE(t.bpmAnalyzed, t.bpm)"
+                        : "COALESCE(bpmAnalyzed, bpm)";
+    }
+
+    [[nodiscard]] std::string year() const
+    {
+        return legacy() ? "t.year" : "year";
+    }
+
+    /// Legacy databases do not record when a track was added, but track ids
+    /// are allocated in order of creation.
+    [[nodiscard]] std::string date_added() const
+    {
+        return legacy() ? "t.id" : "dateAdded";
+    }
+
+    std::string meta(meta_field field)
+    {
+        if (!legacy())
+        {
+            switch (field)
+            {
+                case meta_field::title: return "title";
+                case meta_field::artist: return "artist";
+                case meta_field::genre: return "genre";
+                case meta_field::key: return "key";
+                case meta_field::rating: return "rating";
+            }
+        }
+
+        joins_.insert(field);
+        auto [alias, is_integer] = legacy_alias(field);
+        return std::string{alias} + (is_integer ? ".value" : ".text");
+    }
+
+    [[nodiscard]] std::string from() const
+    {
+        if (!legacy())
+            return "Track";
+
+        std::string from = "Track AS t";
+        for (auto&& field : joins_)
+        {
+            auto [alias, is_integer] = legacy_alias(field);
+            from += is_integer ? " LEFT JOIN MetaDataInteger AS "
+                               : " LEFT JOIN MetaData AS ";
+            from += alias;
+            from += " ON ";
+            from += alias;
+            from += ".id = t.id AND ";
+            from += alias;
+            from += ".type = " + std::to_string(legacy_type(field));
+        }
+
+        return from;
+    }
+
+private:
+    static std::pair<const char*, bool> legacy_alias(meta_field field)
+    {
+        switch (field)
+        {
+            case meta_field::title: return {"md_title", false};
+            case meta_field::artist: return {"md_artist", false};
+            case meta_field::genre: return {"md_genre", false};
+            case meta_field::key: return {"mdi_key", true};
+            case meta_field::rating: return {"mdi_rating", true};
+        }
+
+        return {"", false};
+    }
+
+    static int legacy_type(meta_field field)
+    {
+        switch (field)
+        {
+            case meta_field::title:
+                return static_cast<int>(metadata_str_type::title);
+            case meta_field::artist:
+                return static_cast<int>(metadata_str_type::artist);
+            case meta_field::genre:
+                return static_cast<int>(metadata_str_type::genre);
+            case meta_field::key:
+                return static_cast<int>(metadata_int_type::musical_key);
+            case meta_field::rating:
+                return static_cast<int>(metadata_int_type::rating);
+        }
+
+        return 0;
+    }
+
+    track_query_layout layout_;
+    std::set<meta_field> joins_;
+};
+
+std::string order_expression(column_resolver& columns, track_order order)
+{
+    switch (order)
+    {
+        case track_order::id: return columns.id();
+        case track_order::date_added: return columns.date_added();
+        case track_order::bpm: return columns.bpm();
+        case track_order::title: return columns.meta(meta_field::title);
+        case track_order::artist: return columns.meta(meta_field::artist);
+        case track_order::year: return columns.year();
+        case track_order::rating: return columns.meta(meta_field::rating);
+    }
+
+    return columns.id();
+}
+
+template <typename Callback>
+void run_query(
+    sqlite::database& db, const compiled_track_query& query,
+    Callback&& callback)
+{
+    auto binder = db << query.sql;
+    for (auto&& parameter : query.parameters)
+    {
+        std::visit([&](const auto& value) { binder << value; }, parameter);
+    }
+
+    binder >> std::forward<Callback>(callback);
+}
+
+}  // anonymous namespace
+
+compiled_track_query compile_track_query(
+    const track_query_criteria& criteria, track_query_layout layout,
+    bool project)
+{
+    column_resolver columns{layout};
+    compiled_track_query query;
+    std::vector<std::string> conditions;
+
+    if (columns.legacy())
+    {
+        // Some legacy schemas have a trigger that leaves a row with a NULL
+        // path behind when a track is deleted.
+        conditions.emplace_back("t.path IS NOT NULL");
+    }
+
+    if (criteria.min_bpm || criteria.max_bpm)
+    {
+        auto min_bpm = criteria.min_bpm.value_or(0);
+        auto max_bpm =
+            criteria.max_bpm.value_or(std::numeric_limits<double>::max());
+        if (!columns.legacy() && min_bpm >= 0 &&
+            max_bpm <= std::numeric_limits<int32_t>::max())
+        {
+            // Later schemas index the analysed BPM rounded to the nearest
+            // integer.  The condition is split into analysed and unanalysed
+            // cases, each of which can be answered from that index, and a
+            // range on the rounded BPM is added.  Rounding is monotonic, so
+            // no matching track is lost.
+            conditions.emplace_back(
+                "((CAST(bpmAnalyzed + 0.5 AS int) BETWEEN ? AND ? AND "
+                "bpmAnalyzed BETWEEN ? AND ?) OR "
+                "(CAST(bpmAnalyzed + 0.5 AS int) IS NULL AND "
+                "bpm BETWEEN ? AND ?))");
+            query.parameters.emplace_back(
+                static_cast<int64_t>(std::floor(min_bpm + 0.5)));
+            query.parameters.emplace_back(
+                static_cast<int64_t>(std::floor(max_bpm + 0.5)));
+            query.parameters.emplace_back(min_bpm);
+            query.parameters.emplace_back(max_bpm);
+            query.parameters.emplace_back(min_bpm);
+            query.parameters.emplace_back(max_bpm);
+        }
+        else
+        {
+            conditions.push_back(columns.bpm() + " BETWEEN ? AND ?");
+            query.parameters.emplace_back(min_bpm);
+            query.parameters.emplace_back(max_bpm);
+        }
+    }
+
+    if (criteria.keys)
+    {
+        if (criteria.keys->empty())
+        {
+            conditions.emplace_back("0");
+        }
+        else
+        {
+            std::string condition = columns.meta(meta_field::key) + " IN (";
+            for (std::size_t i = 0; i < criteria.keys->size(); ++i)
+            {
+                condition += i == 0 ? "?" : ", ?";
+                query.parameters.emplace_back(
+                    static_cast<int64_t>((*criteria.keys)[i]));
+            }
+
+            conditions.push_back(condition + ")");
+        }
+    }
+
+    if (criteria.genre)
+    {
+        conditions.push_back(columns.meta(meta_field::genre) + " = ?");
+        query.parameters.emplace_back(*criteria.genre);
+    }
+
+    if (criteria.artist)
+    {
+        conditions.push_back(columns.meta(meta_field::artist) + " = ?");
+        query.parameters.emplace_back(*criteria.artist);
+    }
+
+    if (criteria.min_rating)
+    {
+        conditions.push_back(columns.meta(meta_field::rating) + " >= ?");
+        query.parameters.emplace_back(
+            static_cast<int64_t>(*criteria.min_rating));
+    }
+
+    if (criteria.min_year || criteria.max_year)
+    {
+        conditions.push_back(columns.year() + " BETWEEN ? AND ?");
+        query.parameters.emplace_back(static_cast<int64_t>(
+            criteria.min_year.value_or(std::numeric_limits<int>::min())));
+        query.parameters.emplace_back(static_cast<int64_t>(
+            criteria.max_year.value_or(std::numeric_limits<int>::max())));
+    }
+
+    auto direction = criteria.descending ? " DESC" : "";
+    auto order_by = order_expression(columns, criteria.order) + direction;
+    if (criteria.order != track_order::id)
+    {
+        order_by += ", " + columns.id() + direction;
+    }
+
+    std::string select = columns.id();
+    if (project)
+    {
+        if (columns.legacy())
+        {
+            select += ", " + columns.meta(meta_field::title) + ", " +
+                      columns.meta(meta_field::artist) + ", " +
+                      columns.meta(meta_field::genre) + ", " + columns.bpm() +
+                      ", " + columns.meta(meta_field::key) + ", " +
+                      columns.meta(meta_field::rating) + ", " + columns.year();
+        }
+        else
+        {
+            // A rating of zero means that the track is unrated.
+            select += ", title, artist, genre, " + columns.bpm() +
+                      ", key, NULLIF(rating, 0), year";
+        }
+    }
+
+    query.sql = "SELECT " + select + " FROM " + columns.from();
+    for (std::size_t i = 0; i < conditions.size(); ++i)
+    {
+        query.sql += (i == 0 ? " WHERE " : " AND ") + conditions[i];
+    }
+
+    query.sql += " ORDER BY " + order_by;
+    if (criteria.limit)
+    {
+        query.sql += " LIMIT ?";
+        query.parameters.emplace_back(static_cast<int64_t>(std::min<uint64_t>(
+            *criteria.limit,
+            static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))));
+    }
+
+    return query;
+}
+
+std::vector<int64_t> query_track_ids(
+    sqlite::database& db, const track_query_criteria& criteria,
+    track_query_layout layout)
+{
+    std::vector<int64_t> results;
+    run_query(
+        db, compile_track_query(criteria, layout, false),
+        [&](int64_t id) { results.push_back(id); });
+    return results;
+}
+
+std::vector<track_query_row> query_track_rows(
+    sqlite::database& db, const track_query_criteria& criteria,
+    track_query_layout layout)
+{
+    std::vector<track_query_row> results;
+    run_query(
+        db, compile_track_query(criteria, layout, true),
+        [&](int64_t id, std::optional<std::string> title,
+            std::optional<std::string> artist,
+            std::optional<std::string> genre, std::optional<double> bpm,
+            std::optional<int64_t> key, std::optional<int64_t> rating,
+            std::optional<int64_t> year)
+        {
+            auto& row = results.emplace_back();
+            row.id = id;
+            row.title = std::move(title);
+            row.artist = std::move(artist);
+            row.genre = std::move(genre);
+            row.bpm = bpm;
+            if (key)
+                row.key = static_cast<musical_key>(*key);
+            if (rating)
+                row.rating = static_cast<int>(*rating);
+            if (year)
+                row.year = static_cast<int>(*year);
+        });
+    return results;
+}
+
+}  // namespace djinterop::engine
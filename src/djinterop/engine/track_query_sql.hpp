@@ -0,0 +1,71 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/track_query.hpp>
+
+namespace djinterop::engine
+{
+/// Layouts of track data for which track queries may be compiled.
+enum class track_query_layout
+{
+    /// Legacy (1.x) databases, in which most metadata is held in the
+    /// `MetaData` and `MetaDataInteger` tables.
+    legacy,
+
+    /// Database2 (2.x and 3.x) databases, in which all metadata is held in
+    /// the `Track` table.
+    database2,
+};
+
+/// A track query compiled to a single parameterised SQL statement.
+struct compiled_track_query
+{
+    std::string sql;
+    std::vector<std::variant<int64_t, double, std::string>> parameters;
+};
+
+/// Compile track query criteria to SQL.
+///
+/// \param criteria Criteria of the query.
+/// \param layout Layout of the database against which the query will be run.
+/// \param project Whether to select the columns of a `track_query_row`, or
+///                only the track id.
+/// \return Returns the compiled query.
+compiled_track_query compile_track_query(
+    const track_query_criteria& criteria, track_query_layout layout,
+    bool project);
+
+/// Run a track query, returning the ids of matching tracks.
+std::vector<int64_t> query_track_ids(
+    sqlite::database& db, const track_query_criteria& criteria,
+    track_query_layout layout);
+
+/// Run a track query, returning a projection of each matching track.
+std::vector<track_query_row> query_track_rows(
+    sqlite::database& db, const track_query_criteria& criteria,
+    track_query_layout layout);
+
+}  // namespace djinterop::engine
@@ -0,0 +1,49 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "track_similarity_source.hpp"
+
+#include <utility>
+
+namespace djinterop::engine
+{
+track_similarity_source::track_similarity_source(
+    track_feature_source& features) :
+    features_{features}
+{
+}
+
+std::shared_ptr<const track_similarity_index> track_similarity_source::index()
+{
+    auto features = features_.index();
+    if (!index_)
+    {
+        index_ = std::make_shared<track_similarity_index>(std::move(features));
+        return index_;
+    }
+
+    if (index_->features() == features)
+        return index_;
+
+    if (index_.use_count() > 1)
+        index_ = std::make_shared<track_similarity_index>(*index_);
+
+    index_->update(std::move(features));
+    return index_;
+}
+
+}  // namespace djinterop::engine
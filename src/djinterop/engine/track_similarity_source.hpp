@@ -0,0 +1,53 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <djinterop/track_similarity_index.hpp>
+
+#include "track_feature_source.hpp"
+
+namespace djinterop::engine
+{
+/// The `track_similarity_source` class maintains a `track_similarity_index`
+/// over the tracks of an Engine library.
+///
+/// The index is built on first use from the library's feature index, and is
+/// thereafter updated with whichever tracks differ between successive feature
+/// snapshots.  As with features, each index handed out is an immutable
+/// snapshot.
+class track_similarity_source
+{
+public:
+    /// Construct a similarity source drawing on a feature source.
+    ///
+    /// No work is done until the index is first requested.
+    ///
+    /// \param features Source of track features.
+    explicit track_similarity_source(track_feature_source& features);
+
+    /// Get an index that is up to date with the library.
+    [[nodiscard]] std::shared_ptr<const track_similarity_index> index();
+
+private:
+    track_feature_source& features_;
+    std::shared_ptr<track_similarity_index> index_;
+};
+
+}  // namespace djinterop::engine
@@ -17,9 +17,14 @@
 #include "engine_database_impl.hpp"
 
 #include <djinterop/playlist.hpp>
+#include <djinterop/track_snapshot.hpp>
 
+#include "../../util/metrics.hpp"
 #include "../../util/sqlite_transaction.hpp"
 #include "../schema/schema.hpp"
+#include "../schema/schema_fingerprint.hpp"
+#include "../track_duplicates_sql.hpp"
+#include "../track_query_sql.hpp"
 #include "engine_crate_impl.hpp"
 #include "engine_playlist_impl.hpp"
 #include "engine_storage.hpp"
@@ -177,16 +182,83 @@ track engine_database_impl::create_track(const track_snapshot& snapshot)
     return djinterop::engine::v1::create_track(storage_, snapshot);
 }
 
+std::vector<track> engine_database_impl::create_tracks(
+    const std::vector<track_snapshot>& snapshots)
+{
+    std::vector<track> results;
+    results.reserve(snapshots.size());
+
+    djinterop::util::sqlite_transaction trans{storage_->db};
+    for (auto&& snapshot : snapshots)
+    {
+        results.push_back(
+            djinterop::engine::v1::create_track(storage_, snapshot));
+    }
+
+    trans.commit();
+    return results;
+}
+
 std::string engine_database_impl::directory()
 {
     return storage_->directory;
 }
 
+database_metrics engine_database_impl::metrics()
+{
+    database_metrics result;
+    storage_->tracer.snapshot_metrics(result);
+    djinterop::util::snapshot_codec_metrics(result);
+    return result;
+}
+
+std::vector<int64_t> engine_database_impl::query_track_ids(
+    const track_query_criteria& criteria)
+{
+    return engine::query_track_ids(
+        storage_->db, criteria, track_query_layout::legacy);
+}
+
+std::vector<track_query_row> engine_database_impl::query_track_rows(
+    const track_query_criteria& criteria)
+{
+    return engine::query_track_rows(
+        storage_->db, criteria, track_query_layout::legacy);
+}
+
+std::vector<int64_t> engine_database_impl::search(
+    const std::string& text, std::size_t limit)
+{
+    return storage_->search.search(text, limit);
+}
+
+std::shared_ptr<const track_feature_index>
+engine_database_impl::feature_index()
+{
+    return storage_->features.index();
+}
+
+std::shared_ptr<const track_similarity_index>
+engine_database_impl::similarity_index()
+{
+    return storage_->similarity.index();
+}
+
+std::vector<duplicate_group> engine_database_impl::find_duplicates(
+    const duplicate_policy& policy)
+{
+    return engine::find_duplicate_tracks(storage_->db, storage_->schema, policy);
+}
+
+void engine_database_impl::merge_duplicates(
+    const std::vector<duplicate_group>& groups)
+{
+    engine::merge_duplicate_tracks(storage_->db, storage_->schema, groups);
+}
+
 void engine_database_impl::verify()
 {
-    auto schema_creator_validator =
-        schema::make_schema_creator_validator(storage_->schema);
-    schema_creator_validator->verify(storage_->db);
+    schema::verify_schema(storage_->db, storage_->schema);
 }
 
 void engine_database_impl::remove_crate(crate cr)
@@ -264,6 +336,17 @@ std::optional<playlist> engine_database_impl::root_playlist_by_name(
     return result;
 }
 
+void engine_database_impl::set_observer(
+    std::shared_ptr<sql_observer> observer)
+{
+    storage_->tracer.set_observer(std::move(observer));
+}
+
+void engine_database_impl::set_metrics_enabled(bool enabled)
+{
+    storage_->tracer.set_metrics_enabled(enabled);
+}
+
 std::optional<track> engine_database_impl::track_by_id(int64_t id)
 {
     std::optional<track> tr;
@@ -36,7 +36,9 @@ engine_storage::engine_storage(
     const std::string& directory, const engine_schema& schema,
     sqlite::database db) :
     directory{directory},
-    db{std::move(db)}, schema{schema}
+    db{std::move(db)}, schema{schema}, tracer{this->db.connection()},
+    search{this->db, schema, std::nullopt}, features{this->db, schema},
+    similarity{features}
 {
 }
 
@@ -29,8 +29,12 @@
 #include <djinterop/engine/engine_schema.hpp>
 #include <djinterop/exceptions.hpp>
 
+#include "../../util/sql_trace.hpp"
 #include "../metadata_types.hpp"
 #include "../schema/schema.hpp"
+#include "../search_index.hpp"
+#include "../track_feature_source.hpp"
+#include "../track_similarity_source.hpp"
 #include "performance_data_format.hpp"
 
 namespace djinterop::engine::v1
@@ -357,6 +361,18 @@ public:
     /// Pointer to the schema creator/validator.
     const std::unique_ptr<schema::schema_creator_validator>
         schema_creator_validator;
+
+    /// Tracer forwarding statements run on `db` to any registered observer.
+    djinterop::util::sql_tracer tracer;
+
+    /// Full-text index over tracks, held in memory.
+    search_index search;
+
+    /// Feature index over tracks, held in memory.
+    track_feature_source features;
+
+    /// Similarity index over tracks, held in memory.
+    track_similarity_source similarity;
 };
 
 }  // namespace djinterop::engine::v1
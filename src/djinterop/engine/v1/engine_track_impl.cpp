@@ -28,6 +28,7 @@
 #include "../../util/convert.hpp"
 #include "../../util/filesystem.hpp"
 #include "../../util/sqlite_transaction.hpp"
+#include "../../util/waveform_pooling.hpp"
 #include "../track_utils.hpp"
 #include "engine_crate_impl.hpp"
 #include "engine_database_impl.hpp"
@@ -223,18 +224,10 @@ overview_waveform_data to_overview_waveform_data(
 
     auto extents =
         util::calculate_overview_waveform_extents(*sample_count, *sample_rate);
-    std::vector<waveform_entry> overview_waveform;
-    if (!waveform.empty())
-    {
-        // Calculate an overview waveform automatically.
-        overview_waveform.reserve(extents.size);
-        for (unsigned long long i = 0; i < extents.size; ++i)
-        {
-            auto entry = waveform
-                [waveform.size() * (2 * i + 1) / (2 * extents.size)];
-            overview_waveform.push_back(entry);
-        }
-    }
+    // Calculate an overview waveform automatically, pooling the per-band
+    // maximum over each window so that transients are not lost.
+    auto overview_waveform =
+        djinterop::util::pool_waveform(waveform, extents.size);
 
     return overview_waveform_data{extents.samples_per_entry, overview_waveform};
 }
@@ -1083,13 +1076,8 @@ void engine_track_impl::set_waveform(std::vector<waveform_entry> waveform)
             sample_count, sample_rate);
         overview_waveform_d.samples_per_entry =
             overview_extents.samples_per_entry;
-        overview_waveform_d.waveform.reserve(overview_extents.size);
-        for (unsigned long long i = 0; i < overview_extents.size; ++i)
-        {
-            auto entry = waveform
-                [waveform.size() * (2 * i + 1) / (2 * overview_extents.size)];
-            overview_waveform_d.waveform.push_back(entry);
-        }
+        overview_waveform_d.waveform =
+            djinterop::util::pool_waveform(waveform, overview_extents.size);
 
         // Make the assumption that the client has respected the required number
         // of samples per entry when constructing the waveform.
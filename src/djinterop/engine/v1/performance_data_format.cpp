@@ -18,11 +18,15 @@
 #include <iomanip>
 #include <numeric>
 #include <optional>
+#include <span>
+#include <utility>
 #include <vector>
 
 #include <djinterop/musical_key.hpp>
 
 #include "../../util/convert.hpp"
+#include "../../util/metrics.hpp"
+#include "../blob_layout.hpp"
 #include "../encode_decode_utils.hpp"
 #include "performance_data_format.hpp"
 
@@ -30,6 +34,43 @@ namespace djinterop::engine::v1
 {
 namespace
 {
+namespace bl = blob_layout;
+
+using waveform_value_layout =
+    bl::layout<waveform_point, bl::scalar<&waveform_point::value> >;
+using waveform_opacity_layout =
+    bl::layout<waveform_point, bl::scalar<&waveform_point::opacity> >;
+
+/// High-resolution waveform entries store values, then opacities.
+using high_res_waveform_entry_layout = bl::layout<
+    waveform_entry, bl::nested<&waveform_entry::low, waveform_value_layout>,
+    bl::nested<&waveform_entry::mid, waveform_value_layout>,
+    bl::nested<&waveform_entry::high, waveform_value_layout>,
+    bl::nested<&waveform_entry::low, waveform_opacity_layout>,
+    bl::nested<&waveform_entry::mid, waveform_opacity_layout>,
+    bl::nested<&waveform_entry::high, waveform_opacity_layout> >;
+
+/// Overview waveform entries store values only.
+using overview_waveform_entry_layout = bl::layout<
+    waveform_entry, bl::nested<&waveform_entry::low, waveform_value_layout>,
+    bl::nested<&waveform_entry::mid, waveform_value_layout>,
+    bl::nested<&waveform_entry::high, waveform_value_layout> >;
+
+/// Beat grid marker as stored in beat data.
+struct beatgrid_marker_record
+{
+    double sample_offset = 0;
+    int64_t index = 0;
+    int32_t beats_until_next_marker = 0;
+    int32_t unknown_value_1 = 0;
+};
+
+using beatgrid_marker_record_layout = bl::layout<
+    beatgrid_marker_record, bl::scalar<&beatgrid_marker_record::sample_offset>,
+    bl::scalar<&beatgrid_marker_record::index>,
+    bl::scalar<&beatgrid_marker_record::beats_until_next_marker>,
+    bl::scalar<&beatgrid_marker_record::unknown_value_1> >;
+
 template <typename T, typename U>
 std::optional<std::decay_t<T> > prohibit(const U& sentinel, T&& data)
 {
@@ -43,20 +84,21 @@ std::optional<std::decay_t<T> > prohibit(const U& sentinel, T&& data)
 std::byte* encode_beatgrid(const std::vector<beatgrid_marker>& beatgrid, std::byte* ptr)
 {
     using vec_size_t = std::vector<beatgrid_marker>::size_type;
-    ptr = encode_int64_be(beatgrid.size(), ptr);
+    std::vector<beatgrid_marker_record> records(beatgrid.size());
     for (vec_size_t i = 0; i < beatgrid.size(); ++i)
     {
-        ptr = encode_double_le(beatgrid[i].sample_offset, ptr);
-        ptr = encode_int64_le(beatgrid[i].index, ptr);
-        int32_t diff = 0;
+        records[i].sample_offset = beatgrid[i].sample_offset;
+        records[i].index = beatgrid[i].index;
         if (i < beatgrid.size() - 1)
         {
-            diff = beatgrid[i + 1].index - beatgrid[i].index;
+            records[i].beats_until_next_marker =
+                beatgrid[i + 1].index - beatgrid[i].index;
         }
-        ptr = encode_int32_le(diff, ptr);
-        ptr = encode_int32_le(0, ptr);  // unknown field
     }
-    return ptr;
+
+    ptr = encode_int64_be(beatgrid.size(), ptr);
+    return bl::encode_records<beatgrid_marker_record_layout>(
+        std::span{records}, ptr);
 }
 
 std::pair<std::vector<beatgrid_marker>, const std::byte*> decode_beatgrid(
@@ -82,42 +124,44 @@ std::pair<std::vector<beatgrid_marker>, const std::byte*> decode_beatgrid(
     {
         throw std::invalid_argument{"Beat data grid is missing data"};
     }
-    std::vector<beatgrid_marker> result(count);
-    int32_t beats_until_next_marker = 0;
-    using vec_size_t = std::vector<beatgrid_marker>::size_type;
-    for (vec_size_t i = 0; i < result.size(); ++i)
+
+    // Unpack all markers first, and validate them as a separate pass.
+    std::vector<beatgrid_marker_record> records(count);
+    ptr = bl::decode_records<beatgrid_marker_record_layout>(
+        ptr, std::span{records});
+
+    using vec_size_t = std::vector<beatgrid_marker_record>::size_type;
+    for (vec_size_t i = 1; i < records.size(); ++i)
     {
-        std::tie(result[i].sample_offset, ptr) = decode_double_le(ptr);
-        int64_t index;
-        std::tie(index, ptr) = decode_int64_le(ptr);
-        result[i].index = static_cast<int>(index);
-        if (i != 0)
+        if (records[i].index <= records[i - 1].index)
         {
-            if (result[i].index <= result[i - 1].index)
-            {
-                throw std::invalid_argument{
-                    "Beat data grid has unsorted indices"};
-            }
-            if (result[i].sample_offset <= result[i - 1].sample_offset)
-            {
-                throw std::invalid_argument{
-                    "Beat data grid has unsorted sample offsets"};
-            }
-            if (result[i].index - result[i - 1].index !=
-                beats_until_next_marker)
-            {
-                throw std::invalid_argument{
-                    "Beat data grid has conflicting markers"};
-            }
+            throw std::invalid_argument{"Beat data grid has unsorted indices"};
+        }
+        if (records[i].sample_offset <= records[i - 1].sample_offset)
+        {
+            throw std::invalid_argument{
+                "Beat data grid has unsorted sample offsets"};
+        }
+        if (records[i].index - records[i - 1].index !=
+            records[i - 1].beats_until_next_marker)
+        {
+            throw std::invalid_argument{
+                "Beat data grid has conflicting markers"};
         }
-        std::tie(beats_until_next_marker, ptr) = decode_int32_le(ptr);
-        std::tie(std::ignore, ptr) = decode_int32_le(ptr);  // unknown field
     }
-    if (beats_until_next_marker != 0)
+    if (records.back().beats_until_next_marker != 0)
     {
         throw std::invalid_argument{
             "Beat data grid promised non-existent marker"};
     }
+
+    std::vector<beatgrid_marker> result(count);
+    for (vec_size_t i = 0; i < records.size(); ++i)
+    {
+        result[i].index = static_cast<int>(records[i].index);
+        result[i].sample_offset = records[i].sample_offset;
+    }
+
     return {std::move(result), ptr};
 }
 
@@ -126,6 +170,7 @@ std::pair<std::vector<beatgrid_marker>, const std::byte*> decode_beatgrid(
 // Encode beat data into a byte array
 std::vector<std::byte> beat_data::encode() const
 {
+    djinterop::util::blob_encode_timer timer{blob_type::beat_data};
     std::vector<std::byte> uncompressed(
         33 + 24 * (default_beatgrid.size() + adjusted_beatgrid.size()));
     auto ptr = uncompressed.data();
@@ -143,12 +188,14 @@ std::vector<std::byte> beat_data::encode() const
         // TODO (haslersn): This shouldn't be possible to happen. How to handle?
     }
 
-    return zlib_compress(uncompressed);
+    return timer.record(zlib_compress(uncompressed));
 }
 
 // Extract beat data from a byte array
 beat_data beat_data::decode(const std::vector<std::byte>& compressed_data)
 {
+    djinterop::util::blob_decode_timer timer{
+        blob_type::beat_data, compressed_data};
     const auto raw_data = zlib_uncompress(compressed_data);
     auto ptr = raw_data.data();
     const auto end = ptr + raw_data.size();
@@ -213,58 +260,46 @@ beat_data beat_data::decode(const std::vector<std::byte>& compressed_data)
 // Encode high-resolution waveform data into a byte array
 std::vector<std::byte> high_res_waveform_data::encode() const
 {
-    std::vector<std::byte> uncompressed(30 + 6 * waveform.size());
-    auto ptr = uncompressed.data();
-    const auto end = ptr + uncompressed.size();
+    djinterop::util::blob_encode_timer timer{blob_type::high_res_waveform};
+    // Entries are deflated as they are encoded, so that the uncompressed form
+    // of a potentially large waveform is never held in memory.
+    deflate_sink sink{30 + 6 * waveform.size()};
 
+    auto ptr = sink.reserve(24);
     ptr = encode_int64_be(waveform.size(), ptr);
     ptr = encode_int64_be(waveform.size(), ptr);
     ptr = encode_double_be(samples_per_entry, ptr);
+    sink.commit(ptr);
 
-    uint8_t max_low = 0;
-    uint8_t max_mid = 0;
-    uint8_t max_high = 0;
-    uint8_t max_low_opc = 0;
-    uint8_t max_mid_opc = 0;
-    uint8_t max_high_opc = 0;
+    // Encode the maximum values across all entries at the end
+    waveform_entry max_entry{{0, 0}, {0, 0}, {0, 0}};
     for (auto& entry : waveform)
     {
-        max_low = std::max(max_low, entry.low.value);
-        max_mid = std::max(max_mid, entry.mid.value);
-        max_high = std::max(max_high, entry.high.value);
-        max_low_opc = std::max(max_low_opc, entry.low.opacity);
-        max_mid_opc = std::max(max_mid_opc, entry.mid.opacity);
-        max_high_opc = std::max(max_high_opc, entry.high.opacity);
-        ptr = encode_uint8(entry.low.value, ptr);
-        ptr = encode_uint8(entry.mid.value, ptr);
-        ptr = encode_uint8(entry.high.value, ptr);
-        ptr = encode_uint8(entry.low.opacity, ptr);
-        ptr = encode_uint8(entry.mid.opacity, ptr);
-        ptr = encode_uint8(entry.high.opacity, ptr);
-    }
-
-    // Encode the maximum values across all entries
-    ptr = encode_uint8(max_low, ptr);
-    ptr = encode_uint8(max_mid, ptr);
-    ptr = encode_uint8(max_high, ptr);
-    ptr = encode_uint8(max_low_opc, ptr);
-    ptr = encode_uint8(max_mid_opc, ptr);
-    ptr = encode_uint8(max_high_opc, ptr);
-
-    if (ptr != end)
-    {
-        throw std::runtime_error{
-            "Internal error in high_res_waveform_data::encode()"};
-        // TODO (haslersn): This shouldn't be possible to happen. How to handle?
+        max_entry.low.value = std::max(max_entry.low.value, entry.low.value);
+        max_entry.mid.value = std::max(max_entry.mid.value, entry.mid.value);
+        max_entry.high.value = std::max(max_entry.high.value, entry.high.value);
+        max_entry.low.opacity =
+            std::max(max_entry.low.opacity, entry.low.opacity);
+        max_entry.mid.opacity =
+            std::max(max_entry.mid.opacity, entry.mid.opacity);
+        max_entry.high.opacity =
+            std::max(max_entry.high.opacity, entry.high.opacity);
     }
 
-    return zlib_compress(uncompressed);
+    bl::encode_records_to<high_res_waveform_entry_layout>(
+        std::span{waveform}, sink);
+    bl::encode_records_to<high_res_waveform_entry_layout>(
+        std::span{&max_entry, 1}, sink);
+
+    return timer.record(sink.finish());
 }
 
 // Extract high-resolution waveform from a byte array
 high_res_waveform_data high_res_waveform_data::decode(
     const std::vector<std::byte>& compressed_data)
 {
+    djinterop::util::blob_decode_timer timer{
+        blob_type::high_res_waveform, compressed_data};
     const auto raw_data = zlib_uncompress(compressed_data);
     auto ptr = raw_data.data();
     const auto end = ptr + raw_data.size();
@@ -297,15 +332,8 @@ high_res_waveform_data high_res_waveform_data::decode(
 
     result.waveform.resize(num_entries_1);
 
-    for (auto& entry : result.waveform)
-    {
-        std::tie(entry.low.value, ptr) = decode_uint8(ptr);
-        std::tie(entry.mid.value, ptr) = decode_uint8(ptr);
-        std::tie(entry.high.value, ptr) = decode_uint8(ptr);
-        std::tie(entry.low.opacity, ptr) = decode_uint8(ptr);
-        std::tie(entry.mid.opacity, ptr) = decode_uint8(ptr);
-        std::tie(entry.high.opacity, ptr) = decode_uint8(ptr);
-    }
+    ptr = bl::decode_records<high_res_waveform_entry_layout>(
+        ptr, std::span{result.waveform});
 
     // Ignore additional entry at the end
     ptr += 6;
@@ -323,6 +351,7 @@ high_res_waveform_data high_res_waveform_data::decode(
 // Encode loops into a byte array
 std::vector<std::byte> loops_data::encode() const
 {
+    djinterop::util::blob_encode_timer timer{blob_type::loops, false};
     auto total_label_length = std::accumulate(
         loops.begin(), loops.end(), int64_t{0},
         [](int64_t x, const std::optional<loop>& loop) {
@@ -377,12 +406,13 @@ std::vector<std::byte> loops_data::encode() const
     }
 
     // Note that 'loops' is not compressed
-    return uncompressed;
+    return timer.record(std::move(uncompressed));
 }
 
 // Extract loops from a byte array
 loops_data loops_data::decode(const std::vector<std::byte>& raw_data)
 {
+    djinterop::util::blob_decode_timer timer{blob_type::loops, raw_data, false};
     // Note that loops are not compressed, unlike all the other fields
     auto ptr = raw_data.data();
     const auto end = ptr + raw_data.size();
@@ -443,47 +473,38 @@ loops_data loops_data::decode(const std::vector<std::byte>& raw_data)
 // Encode overview waveform data into a byte array
 std::vector<std::byte> overview_waveform_data::encode() const
 {
-    std::vector<std::byte> uncompressed(27 + 3 * waveform.size());
-    auto ptr = uncompressed.data();
-    const auto end = ptr + uncompressed.size();
+    djinterop::util::blob_encode_timer timer{blob_type::overview_waveform};
+    deflate_sink sink{27 + 3 * waveform.size()};
 
-    // Encode
+    auto ptr = sink.reserve(24);
     ptr = encode_int64_be(waveform.size(), ptr);
     ptr = encode_int64_be(waveform.size(), ptr);
     ptr = encode_double_be(samples_per_entry, ptr);
+    sink.commit(ptr);
 
-    uint8_t max_low = 0;
-    uint8_t max_mid = 0;
-    uint8_t max_high = 0;
+    // Encode the maximum values across all entries at the end
+    waveform_entry max_entry{{0, 0}, {0, 0}, {0, 0}};
     for (auto& entry : waveform)
     {
-        max_low = std::max(max_low, entry.low.value);
-        max_mid = std::max(max_mid, entry.mid.value);
-        max_high = std::max(max_high, entry.high.value);
-        ptr = encode_uint8(entry.low.value, ptr);
-        ptr = encode_uint8(entry.mid.value, ptr);
-        ptr = encode_uint8(entry.high.value, ptr);
+        max_entry.low.value = std::max(max_entry.low.value, entry.low.value);
+        max_entry.mid.value = std::max(max_entry.mid.value, entry.mid.value);
+        max_entry.high.value = std::max(max_entry.high.value, entry.high.value);
     }
 
-    // Encode the maximum values across all entries
-    ptr = encode_uint8(max_low, ptr);
-    ptr = encode_uint8(max_mid, ptr);
-    ptr = encode_uint8(max_high, ptr);
-
-    if (ptr != end)
-    {
-        throw std::runtime_error{
-            "Internal error in overview_waveform_data::encode()"};
-        // TODO (haslersn): This shouldn't be possible to happen. How to handle?
-    }
+    bl::encode_records_to<overview_waveform_entry_layout>(
+        std::span{waveform}, sink);
+    bl::encode_records_to<overview_waveform_entry_layout>(
+        std::span{&max_entry, 1}, sink);
 
-    return zlib_compress(uncompressed);
+    return timer.record(sink.finish());
 }
 
 // Extract overview waveform from a byte array
 overview_waveform_data overview_waveform_data::decode(
     const std::vector<std::byte>& compressed_data)
 {
+    djinterop::util::blob_decode_timer timer{
+        blob_type::overview_waveform, compressed_data};
     const auto raw_data = zlib_uncompress(compressed_data);
     auto ptr = raw_data.data();
     const auto end = ptr + raw_data.size();
@@ -516,12 +537,8 @@ overview_waveform_data overview_waveform_data::decode(
 
     result.waveform.resize(num_entries_1);
 
-    for (auto& entry : result.waveform)
-    {
-        std::tie(entry.low.value, ptr) = decode_uint8(ptr);
-        std::tie(entry.mid.value, ptr) = decode_uint8(ptr);
-        std::tie(entry.high.value, ptr) = decode_uint8(ptr);
-    }
+    ptr = bl::decode_records<overview_waveform_entry_layout>(
+        ptr, std::span{result.waveform});
 
     // Ignore additional entry at the end
     ptr += 3;
@@ -539,6 +556,7 @@ overview_waveform_data overview_waveform_data::decode(
 // Encode quick cues data into a byte array
 std::vector<std::byte> quick_cues_data::encode() const
 {
+    djinterop::util::blob_encode_timer timer{blob_type::quick_cues};
     auto total_label_length = std::accumulate(
         hot_cues.begin(), hot_cues.end(), int64_t{0},
         [](int64_t x, const std::optional<hot_cue>& hot_cue) {
@@ -593,13 +611,15 @@ std::vector<std::byte> quick_cues_data::encode() const
         // TODO (haslersn): This shouldn't be possible to happen. How to handle?
     }
 
-    return zlib_compress(uncompressed);
+    return timer.record(zlib_compress(uncompressed));
 }
 
 // Extract quick cues data from a byte array
 quick_cues_data quick_cues_data::decode(
     const std::vector<std::byte>& compressed_data)
 {
+    djinterop::util::blob_decode_timer timer{
+        blob_type::quick_cues, compressed_data};
     const auto raw_data = zlib_uncompress(compressed_data);
     auto ptr = raw_data.data();
     const auto end = ptr + raw_data.size();
@@ -670,6 +690,7 @@ quick_cues_data quick_cues_data::decode(
 // Encode track data into a byte array
 std::vector<std::byte> track_data::encode() const
 {
+    djinterop::util::blob_encode_timer timer{blob_type::track_data};
     std::vector<std::byte> uncompressed(28);  // Track data has fixed size
     auto ptr = uncompressed.data();
     const auto end = ptr + uncompressed.size();
@@ -685,12 +706,14 @@ std::vector<std::byte> track_data::encode() const
         // TODO (haslersn): This shouldn't be possible to happen. How to handle?
     }
 
-    return zlib_compress(uncompressed);
+    return timer.record(zlib_compress(uncompressed));
 }
 
 // Extract track data from a byte array
 track_data track_data::decode(const std::vector<std::byte>& compressed_track_data)
 {
+    djinterop::util::blob_decode_timer timer{
+        blob_type::track_data, compressed_track_data};
     const auto raw_data = zlib_uncompress(compressed_track_data);
     auto ptr = raw_data.data();
     const auto end = ptr + raw_data.size();
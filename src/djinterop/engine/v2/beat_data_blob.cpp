@@ -17,73 +17,19 @@
 
 #include <djinterop/engine/v2/beat_data_blob.hpp>
 
-#include <cassert>
 #include <stdexcept>
 
+#include "../../util/metrics.hpp"
 #include "../encode_decode_utils.hpp"
+#include "blob_layouts.hpp"
 
 namespace djinterop::engine::v2
 {
-namespace
-{
-std::byte* encode_beatgrid(
-    const std::vector<beat_grid_marker_blob>& beat_grid, std::byte* ptr)
-{
-    ptr = encode_int64_be(static_cast<int64_t>(beat_grid.size()), ptr);
-    for (auto&& marker : beat_grid)
-    {
-        ptr = encode_double_le(marker.sample_offset, ptr);
-        ptr = encode_int64_le(marker.beat_number, ptr);
-        ptr = encode_int32_le(marker.number_of_beats, ptr);
-        ptr = encode_int32_le(marker.unknown_value_1, ptr);
-    }
-
-    return ptr;
-}
-
-std::pair<std::vector<beat_grid_marker_blob>, const std::byte*> decode_beatgrid(
-    const std::byte* ptr, const std::byte* end)
-{
-    int64_t count;
-    std::tie(count, ptr) = decode_int64_be(ptr);
-    std::vector<beat_grid_marker_blob> result;
-
-    if (end - ptr < 24 * count)
-    {
-        throw std::invalid_argument{"Beat data grid is missing data"};
-    }
-
-    for (auto i = 0; i < count; ++i)
-    {
-        beat_grid_marker_blob marker;
-        std::tie(marker.sample_offset, ptr) = decode_double_le(ptr);
-        std::tie(marker.beat_number, ptr) = decode_int64_le(ptr);
-        std::tie(marker.number_of_beats, ptr) = decode_int32_le(ptr);
-        std::tie(marker.unknown_value_1, ptr) = decode_int32_le(ptr);
-        result.push_back(marker);
-    }
-
-    return {std::move(result), ptr};
-}
-}  // anonymous namespace
-
 std::vector<std::byte> beat_data_blob::to_blob() const
 {
-    std::vector<std::byte> uncompressed(
-        33 + 24 * (default_beat_grid.size() + adjusted_beat_grid.size()) +
-        extra_data.size());
-    auto ptr = uncompressed.data();
-    [[maybe_unused]] const auto end = ptr + uncompressed.size();
-
-    ptr = encode_double_be(sample_rate, ptr);
-    ptr = encode_double_be(samples, ptr);
-    ptr = encode_uint8(is_beatgrid_set, ptr);
-    ptr = encode_beatgrid(default_beat_grid, ptr);
-    ptr = encode_beatgrid(adjusted_beat_grid, ptr);
-    ptr = encode_extra(extra_data, ptr);
-    assert(ptr == end);
-
-    return zlib_compress(uncompressed);
+    djinterop::util::blob_encode_timer timer{blob_type::beat_data};
+    using layout = layouts::beat_data_blob_layout;
+    return timer.record(blob_layout::encode_compressed<layout>(*this));
 }
 
 beat_data_blob beat_data_blob::from_blob(const std::vector<std::byte>& blob)
@@ -100,28 +46,86 @@ beat_data_blob beat_data_blob::from_blob(const std::vector<std::byte>& blob)
         };
     }
 
-    const auto raw_data = zlib_uncompress(blob);
-    auto ptr = raw_data.data();
-    const auto end = ptr + raw_data.size();
+    djinterop::util::blob_decode_timer timer{blob_type::beat_data, blob};
+    return blob_layout::decode<layouts::beat_data_blob_layout>(
+        zlib_uncompress(blob), "Beat data");
+}
+
+beat_grid_marker_blob beat_grid_view::operator[](std::size_t index) const
+{
+    auto ptr = markers_.data() + 24 * index;
+    return beat_grid_marker_blob{
+        load_le<double>(ptr), load_le<int64_t>(ptr + 8),
+        load_le<int32_t>(ptr + 16), load_le<int32_t>(ptr + 20)};
+}
 
-    if (raw_data.size() < 33)
+beat_grid_marker_blob beat_grid_view::at(std::size_t index) const
+{
+    if (index >= size())
+    {
+        throw std::out_of_range{"Beat grid marker index is out of range"};
+    }
+
+    return (*this)[index];
+}
+
+beat_data_view::beat_data_view(std::span<const std::byte> data) : data_{data}
+{
+    if (data.empty())
+    {
+        return;
+    }
+
+    if (data.size() < layouts::beat_data_blob_layout::min_size)
     {
         throw std::invalid_argument{
             "Beat data has less than the minimum length of 33 bytes"};
     }
 
-    beat_data_blob result;
+    // Locate each beat grid from its count, checking it fits in the data.
+    auto locate = [&data](std::size_t offset)
+    {
+        auto count = load_be<int64_t>(data.data() + offset);
+        auto available = (data.size() - offset - 8) / 24;
+        if (count < 0 || static_cast<uint64_t>(count) > available)
+        {
+            throw std::invalid_argument{"Beat data grid is missing data"};
+        }
+
+        return data.subspan(offset + 8, 24 * static_cast<std::size_t>(count));
+    };
+
+    auto default_markers = locate(17);
+    default_beat_grid_ = beat_grid_view{default_markers};
+
+    auto adjusted_offset = 17 + 8 + default_markers.size();
+    if (data.size() - adjusted_offset < 8)
+    {
+        throw std::invalid_argument{"Beat data grid is missing data"};
+    }
+
+    adjusted_beat_grid_ = beat_grid_view{locate(adjusted_offset)};
+}
 
-    std::tie(result.sample_rate, ptr) = decode_double_be(ptr);
-    std::tie(result.samples, ptr) = decode_double_be(ptr);
-    std::tie(result.is_beatgrid_set, ptr) = decode_uint8(ptr);
-    std::tie(result.default_beat_grid, ptr) = decode_beatgrid(ptr, end);
-    std::tie(result.adjusted_beat_grid, ptr) = decode_beatgrid(ptr, end);
+std::vector<std::byte> beat_data_view::uncompress(
+    const std::vector<std::byte>& blob)
+{
+    return zlib_uncompress(blob);
+}
 
-    std::tie(result.extra_data, ptr) = decode_extra(ptr, end);
+double beat_data_view::sample_rate() const noexcept
+{
+    return data_.empty() ? 0 : load_be<double>(data_.data());
+}
 
-    assert(ptr == end);
+double beat_data_view::samples() const noexcept
+{
+    return data_.empty() ? 0 : load_be<double>(data_.data() + 8);
+}
 
-    return result;
+uint8_t beat_data_view::is_beatgrid_set() const noexcept
+{
+    return data_.empty() ? 0 : load_le<uint8_t>(data_.data() + 16);
 }
+
 }  // namespace djinterop::engine::v2
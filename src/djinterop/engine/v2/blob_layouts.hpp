@@ -0,0 +1,127 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+#include <djinterop/engine/v2/beat_data_blob.hpp>
+#include <djinterop/engine/v2/loops_blob.hpp>
+#include <djinterop/engine/v2/overview_waveform_data_blob.hpp>
+#include <djinterop/engine/v2/quick_cues_blob.hpp>
+#include <djinterop/engine/v2/track_data_blob.hpp>
+#include <djinterop/pad_color.hpp>
+
+#include "../blob_layout.hpp"
+
+// Binary layouts of the performance data blobs used by Engine Library
+// schemas 2.x and later.
+namespace djinterop::engine::v2::layouts
+{
+namespace bl = blob_layout;
+constexpr auto big = std::endian::big;
+constexpr auto little = std::endian::little;
+
+/// Pad colours are stored as ARGB.
+using pad_color_layout = bl::layout<
+    pad_color, bl::scalar<&pad_color::a>, bl::scalar<&pad_color::r>,
+    bl::scalar<&pad_color::g>, bl::scalar<&pad_color::b> >;
+
+using beat_grid_marker_blob_layout = bl::layout<
+    beat_grid_marker_blob, bl::scalar<&beat_grid_marker_blob::sample_offset>,
+    bl::scalar<&beat_grid_marker_blob::beat_number>,
+    bl::scalar<&beat_grid_marker_blob::number_of_beats>,
+    bl::scalar<&beat_grid_marker_blob::unknown_value_1> >;
+
+using beat_data_blob_layout = bl::layout<
+    beat_data_blob, bl::scalar<&beat_data_blob::sample_rate, big>,
+    bl::scalar<&beat_data_blob::samples, big>,
+    bl::scalar<&beat_data_blob::is_beatgrid_set>,
+    bl::counted_array<
+        &beat_data_blob::default_beat_grid, int64_t, big,
+        beat_grid_marker_blob_layout>,
+    bl::counted_array<
+        &beat_data_blob::adjusted_beat_grid, int64_t, big,
+        beat_grid_marker_blob_layout>,
+    bl::trailing_bytes<&beat_data_blob::extra_data> >;
+
+using loop_blob_layout = bl::layout<
+    loop_blob, bl::prefixed_string<&loop_blob::label>,
+    bl::scalar<&loop_blob::start_sample_offset>,
+    bl::scalar<&loop_blob::end_sample_offset>,
+    bl::scalar<&loop_blob::is_start_set>, bl::scalar<&loop_blob::is_end_set>,
+    bl::nested<&loop_blob::color, pad_color_layout> >;
+
+using loops_blob_layout = bl::layout<
+    loops_blob,
+    bl::counted_array<&loops_blob::loops, int64_t, little, loop_blob_layout>,
+    bl::trailing_bytes<&loops_blob::extra_data> >;
+
+using overview_waveform_point_layout = bl::layout<
+    overview_waveform_point, bl::scalar<&overview_waveform_point::low_value>,
+    bl::scalar<&overview_waveform_point::mid_value>,
+    bl::scalar<&overview_waveform_point::high_value> >;
+
+/// The number of waveform points is stored twice.
+using overview_waveform_data_blob_layout = bl::layout<
+    overview_waveform_data_blob,
+    bl::element_count<
+        &overview_waveform_data_blob::waveform_points, int64_t, big,
+        overview_waveform_point_layout>,
+    bl::repeated_element_count<
+        &overview_waveform_data_blob::waveform_points, int64_t, big>,
+    bl::scalar<&overview_waveform_data_blob::samples_per_waveform_point, big>,
+    bl::elements<
+        &overview_waveform_data_blob::waveform_points,
+        overview_waveform_point_layout>,
+    bl::nested<
+        &overview_waveform_data_blob::maximum_point,
+        overview_waveform_point_layout>,
+    bl::trailing_bytes<&overview_waveform_data_blob::extra_data> >;
+
+using quick_cue_blob_layout = bl::layout<
+    quick_cue_blob, bl::prefixed_string<&quick_cue_blob::label>,
+    bl::scalar<&quick_cue_blob::sample_offset, big>,
+    bl::nested<&quick_cue_blob::color, pad_color_layout> >;
+
+using quick_cues_blob_layout = bl::layout<
+    quick_cues_blob,
+    bl::counted_array<
+        &quick_cues_blob::quick_cues, int64_t, big, quick_cue_blob_layout>,
+    bl::scalar<&quick_cues_blob::adjusted_main_cue, big>,
+    bl::scalar<&quick_cues_blob::is_main_cue_adjusted, little, uint8_t>,
+    bl::scalar<&quick_cues_blob::default_main_cue, big>,
+    bl::trailing_bytes<&quick_cues_blob::extra_data> >;
+
+using track_data_blob_layout = bl::layout<
+    track_data_blob, bl::scalar<&track_data_blob::sample_rate, big>,
+    bl::scalar<&track_data_blob::samples, big>,
+    bl::scalar<&track_data_blob::key, big>,
+    bl::scalar<&track_data_blob::average_loudness_low, big>,
+    bl::scalar<&track_data_blob::average_loudness_mid, big>,
+    bl::scalar<&track_data_blob::average_loudness_high, big>,
+    bl::trailing_bytes<&track_data_blob::extra_data> >;
+
+static_assert(beat_data_blob_layout::min_size == 33);
+static_assert(loops_blob_layout::min_size == 8);
+static_assert(overview_waveform_data_blob_layout::min_size == 27);
+static_assert(quick_cues_blob_layout::min_size == 25);
+static_assert(track_data_blob_layout::min_size == 44);
+static_assert(beat_grid_marker_blob_layout::is_fixed);
+
+}  // namespace djinterop::engine::v2::layouts
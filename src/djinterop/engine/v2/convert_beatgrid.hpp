@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -46,6 +47,19 @@ inline std::vector<djinterop::beatgrid_marker> beatgrid_markers(
 
     return converted;
 }
+
+inline std::vector<djinterop::beatgrid_marker> beatgrid_markers(
+    const beat_grid_view& beat_grid)
+{
+    std::vector<djinterop::beatgrid_marker> converted;
+    converted.reserve(beat_grid.size());
+    for (std::size_t i = 0; i < beat_grid.size(); ++i)
+    {
+        converted.push_back(beatgrid_marker(beat_grid[i]));
+    }
+
+    return converted;
+}
 }  // namespace read
 
 namespace write
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include <djinterop/engine/v2/quick_cues_blob.hpp>
@@ -36,6 +37,16 @@ inline std::optional<djinterop::hot_cue> hot_cue(
                      quick_cue.color});
 }
 
+inline std::optional<djinterop::hot_cue> hot_cue(
+    const quick_cue_blob_view& quick_cue)
+{
+    return quick_cue.sample_offset == QUICK_CUE_SAMPLE_OFFSET_EMPTY
+               ? std::nullopt
+               : std::make_optional(djinterop::hot_cue{
+                     std::string{quick_cue.label}, quick_cue.sample_offset,
+                     quick_cue.color});
+}
+
 inline std::vector<std::optional<djinterop::hot_cue>> hot_cues(
     const quick_cues_blob& quick_cues)
 {
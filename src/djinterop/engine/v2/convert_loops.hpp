@@ -18,6 +18,7 @@
 #pragma once
 
 #include <optional>
+#include <string>
 
 #include <djinterop/engine/v2/loops_blob.hpp>
 #include <djinterop/performance_data.hpp>
@@ -35,6 +36,15 @@ inline std::optional<djinterop::loop> loop(const loop_blob& l)
                : std::nullopt;
 }
 
+inline std::optional<djinterop::loop> loop(const loop_blob_view& l)
+{
+    return (l.is_start_set || l.is_end_set)
+               ? std::make_optional(djinterop::loop{
+                     std::string{l.label}, l.start_sample_offset,
+                     l.end_sample_offset, l.color})
+               : std::nullopt;
+}
+
 inline std::vector<std::optional<djinterop::loop>> loops(
     const loops_blob& loops)
 {
@@ -23,6 +23,8 @@
 
 #include <djinterop/engine/v2/overview_waveform_data_blob.hpp>
 #include <djinterop/performance_data.hpp>
+
+#include "../../util/waveform_pooling.hpp"
 #include "../track_utils.hpp"
 
 namespace djinterop::engine::v2::convert
@@ -82,27 +84,17 @@ inline overview_waveform_data_blob waveform(
     overview_waveform_data_blob result;
     result.samples_per_waveform_point = extents.samples_per_entry;
 
-    uint8_t max_low = 0;
-    uint8_t max_mid = 0;
-    uint8_t max_high = 0;
-
-    // Convert waveform to required number of entries for an overview waveform.
-    if (!w.empty())
-    {
-        result.waveform_points.reserve(extents.size);
-        for (unsigned long long i = 0; i < extents.size; ++i)
-        {
-            auto entry = w[w.size() * (2 * i + 1) / 2048];
-
-            max_low = std::max(max_low, entry.low.value);
-            max_mid = std::max(max_mid, entry.mid.value);
-            max_high = std::max(max_high, entry.high.value);
+    // Each overview point is the per-band maximum over the corresponding
+    // window of the input waveform, so that transients are not lost.
+    auto pooled = djinterop::util::pool_waveform(w, extents.size);
+    auto maximum =
+        djinterop::util::max_pool_waveform(pooled.data(), pooled.size());
 
-            result.waveform_points.push_back(waveform_entry(entry));
-        }
-    }
+    result.waveform_points.reserve(pooled.size());
+    for (auto&& entry : pooled)
+        result.waveform_points.push_back(waveform_entry(entry));
 
-    result.maximum_point = overview_waveform_point{max_low, max_mid, max_high};
+    result.maximum_point = waveform_entry(maximum);
     return result;
 }
 }  // namespace write
@@ -17,51 +17,22 @@
 
 #include <djinterop/engine/v2/loops_blob.hpp>
 
-#include <cassert>
-#include <numeric>
-#include <optional>
+#include <cstddef>
 #include <stdexcept>
+#include <string_view>
 
+#include "../../util/metrics.hpp"
 #include "../encode_decode_utils.hpp"
+#include "blob_layouts.hpp"
 
 namespace djinterop::engine::v2
 {
 std::vector<std::byte> loops_blob::to_blob() const
 {
-    auto total_label_length = std::accumulate(
-        loops.begin(), loops.end(), int64_t{0},
-        [](int64_t x, const std::optional<loop_blob>& loop)
-        { return x + (loop ? loop->label.length() : 0); });
-
-    std::vector<std::byte> uncompressed(
-        8 + (23 * loops.size()) + total_label_length + extra_data.size());
-    auto ptr = uncompressed.data();
-    [[maybe_unused]] const auto end = ptr + uncompressed.size();
-
-    ptr = encode_int64_le(static_cast<int64_t>(loops.size()), ptr);
-
-    for (auto& loop : loops)
-    {
-        ptr = encode_uint8(static_cast<uint8_t>(loop.label.length()), ptr);
-        for (auto& chr : loop.label)
-        {
-            ptr = encode_uint8(static_cast<uint8_t>(chr), ptr);
-        }
-        ptr = encode_double_le(loop.start_sample_offset, ptr);
-        ptr = encode_double_le(loop.end_sample_offset, ptr);
-        ptr = encode_uint8(loop.is_start_set, ptr);
-        ptr = encode_uint8(loop.is_end_set, ptr);
-        ptr = encode_uint8(loop.color.a, ptr);
-        ptr = encode_uint8(loop.color.r, ptr);
-        ptr = encode_uint8(loop.color.g, ptr);
-        ptr = encode_uint8(loop.color.b, ptr);
-    }
-
-    ptr = encode_extra(extra_data, ptr);
-    assert(ptr == end);
-
     // Note that the loops blob is not compressed.
-    return uncompressed;
+    djinterop::util::blob_encode_timer timer{blob_type::loops, false};
+    return timer.record(
+        blob_layout::encode<layouts::loops_blob_layout>(*this));
 }
 
 loops_blob loops_blob::from_blob(const std::vector<std::byte>& blob)
@@ -75,53 +46,86 @@ loops_blob loops_blob::from_blob(const std::vector<std::byte>& blob)
     }
 
     // Note that loops are not compressed, unlike all the other fields.
-    auto ptr = blob.data();
-    const auto end = ptr + blob.size();
+    djinterop::util::blob_decode_timer timer{blob_type::loops, blob, false};
+    return blob_layout::decode<layouts::loops_blob_layout>(
+        blob, "Loops data");
+}
+
+loops_view::loops_view(std::span<const std::byte> data) : data_{data}
+{
+    if (data.empty())
+    {
+        return;
+    }
 
-    if (blob.size() < 8)
+    if (data.size() < layouts::loops_blob_layout::min_size)
     {
         throw std::invalid_argument{
             "Loops data has less than the minimum length of 8 bytes"};
     }
 
-    int64_t num_loops;
-    std::tie(num_loops, ptr) = decode_int64_le(ptr);
+    // Each loop is a length-prefixed label followed by 22 bytes.
+    auto count = load_le<int64_t>(data.data());
+    if (count < 0 || static_cast<uint64_t>(count) > (data.size() - 8) / 23)
+    {
+        throw std::invalid_argument{"Loop data has loop with missing data"};
+    }
 
-    loops_blob result;
-    result.loops.reserve(num_loops);
-    for (auto i = 0; i < num_loops; ++i)
+    size_ = static_cast<std::size_t>(count);
+    if (size_ > inline_offsets_.size())
     {
-        loop_blob loop;
+        extra_offsets_.resize(size_ - inline_offsets_.size());
+    }
 
-        uint8_t label_length;
-        std::tie(label_length, ptr) = decode_uint8(ptr);
-        if (end - ptr < 22 + label_length)
+    std::size_t offset = 8;
+    for (std::size_t i = 0; i < size_; ++i)
+    {
+        if (offset >= data.size())
         {
-            throw std::invalid_argument{"Loop data has loop with missing data"};
+            throw std::invalid_argument{
+                "Loop data has loop with missing data"};
         }
 
-        if (label_length > 0)
+        auto label_length = std::to_integer<std::size_t>(data[offset]);
+        if (data.size() - offset < 23 + label_length)
         {
-            loop.label.assign(reinterpret_cast<const char*>(ptr), label_length);
-            ptr += label_length;
+            throw std::invalid_argument{
+                "Loop data has loop with missing data"};
         }
 
-        std::tie(loop.start_sample_offset, ptr) = decode_double_le(ptr);
-        std::tie(loop.end_sample_offset, ptr) = decode_double_le(ptr);
-        std::tie(loop.is_start_set, ptr) = decode_uint8(ptr);
-        std::tie(loop.is_end_set, ptr) = decode_uint8(ptr);
-        std::tie(loop.color.a, ptr) = decode_uint8(ptr);
-        std::tie(loop.color.r, ptr) = decode_uint8(ptr);
-        std::tie(loop.color.g, ptr) = decode_uint8(ptr);
-        std::tie(loop.color.b, ptr) = decode_uint8(ptr);
-
-        result.loops.push_back(loop);
+        auto& slot = i < inline_offsets_.size()
+                         ? inline_offsets_[i]
+                         : extra_offsets_[i - inline_offsets_.size()];
+        slot = static_cast<uint32_t>(offset);
+        offset += 23 + label_length;
     }
+}
 
-    std::tie(result.extra_data, ptr) = decode_extra(ptr, end);
-    assert(ptr == end);
+loop_blob_view loops_view::operator[](std::size_t index) const
+{
+    auto ptr = data_.data() + offset(index);
+    auto label_length = std::to_integer<std::size_t>(*ptr++);
+    std::string_view label{reinterpret_cast<const char*>(ptr), label_length};
+    ptr += label_length;
+    return loop_blob_view{
+        label,
+        load_le<double>(ptr),
+        load_le<double>(ptr + 8),
+        load_le<uint8_t>(ptr + 16),
+        load_le<uint8_t>(ptr + 17),
+        pad_color{
+            load_le<uint8_t>(ptr + 19), load_le<uint8_t>(ptr + 20),
+            load_le<uint8_t>(ptr + 21), load_le<uint8_t>(ptr + 18)}};
+}
+
+loop_blob_view loops_view::at(std::size_t index) const
+{
+    if (index >= size_)
+    {
+        throw std::out_of_range{"Loop index is out of range"};
+    }
 
-    return result;
+    return (*this)[index];
 }
 
 }  // namespace djinterop::engine::v2
@@ -17,50 +17,21 @@
 
 #include <djinterop/engine/v2/quick_cues_blob.hpp>
 
-#include <cassert>
-#include <numeric>
+#include <cstddef>
 #include <stdexcept>
+#include <string_view>
 
+#include "../../util/metrics.hpp"
 #include "../encode_decode_utils.hpp"
+#include "blob_layouts.hpp"
 
 namespace djinterop::engine::v2
 {
 std::vector<std::byte> quick_cues_blob::to_blob() const
 {
-    // Work out total length of all cue labels in order to size the buffer.
-    auto total_label_length = std::accumulate(
-        quick_cues.begin(), quick_cues.end(), int64_t{0},
-        [](int64_t x, const quick_cue_blob& quick_cue)
-        { return x + quick_cue.label.length(); });
-
-    std::vector<std::byte> uncompressed(
-        25 + (13 * quick_cues.size()) + total_label_length + extra_data.size());
-    auto ptr = uncompressed.data();
-    [[maybe_unused]] const auto end = ptr + uncompressed.size();
-
-    ptr = encode_int64_be(static_cast<int64_t>(quick_cues.size()), ptr);
-
-    for (auto& quick_cue : quick_cues)
-    {
-        ptr = encode_uint8(static_cast<uint8_t>(quick_cue.label.length()), ptr);
-        for (auto& chr : quick_cue.label)
-        {
-            ptr = encode_uint8(static_cast<uint8_t>(chr), ptr);
-        }
-        ptr = encode_double_be(quick_cue.sample_offset, ptr);
-        ptr = encode_uint8(quick_cue.color.a, ptr);
-        ptr = encode_uint8(quick_cue.color.r, ptr);
-        ptr = encode_uint8(quick_cue.color.g, ptr);
-        ptr = encode_uint8(quick_cue.color.b, ptr);
-    }
-
-    ptr = encode_double_be(adjusted_main_cue, ptr);
-    ptr = encode_uint8(is_main_cue_adjusted, ptr);
-    ptr = encode_double_be(default_main_cue, ptr);
-    ptr = encode_extra(extra_data, ptr);
-    assert(ptr == end);
-
-    return zlib_compress(uncompressed);
+    djinterop::util::blob_encode_timer timer{blob_type::quick_cues};
+    using layout = layouts::quick_cues_blob_layout;
+    return timer.record(blob_layout::encode_compressed<layout>(*this));
 }
 
 quick_cues_blob quick_cues_blob::from_blob(const std::vector<std::byte>& blob)
@@ -76,56 +47,106 @@ quick_cues_blob quick_cues_blob::from_blob(const std::vector<std::byte>& blob)
         };
     }
 
-    const auto uncompressed = zlib_uncompress(blob);
-    auto ptr = uncompressed.data();
-    const auto end = ptr + uncompressed.size();
+    djinterop::util::blob_decode_timer timer{blob_type::quick_cues, blob};
+    return blob_layout::decode<layouts::quick_cues_blob_layout>(
+        zlib_uncompress(blob), "Quick cues data");
+}
+
+quick_cues_view::quick_cues_view(std::span<const std::byte> data) :
+    data_{data}
+{
+    if (data.empty())
+    {
+        return;
+    }
 
-    if (uncompressed.size() < 25)
+    if (data.size() < layouts::quick_cues_blob_layout::min_size)
     {
         throw std::invalid_argument{
             "Quick cues data has less than the minimum length of 25 bytes"};
     }
 
-    int64_t num_hot_cues;
-    std::tie(num_hot_cues, ptr) = decode_int64_be(ptr);
+    // Each quick cue is a length-prefixed label followed by 12 bytes, and the
+    // quick cues are followed by 17 bytes of main cue information.
+    auto count = load_be<int64_t>(data.data());
+    auto end = data.size() - 17;
+    if (count < 0 || static_cast<uint64_t>(count) > (end - 8) / 13)
+    {
+        throw std::invalid_argument{
+            "Quick cues data has quick cue with missing data"};
+    }
 
-    quick_cues_blob result;
-    result.quick_cues.reserve(num_hot_cues);
-    for (auto i = 0; i < num_hot_cues; ++i)
+    size_ = static_cast<std::size_t>(count);
+    if (size_ > inline_offsets_.size())
     {
-        quick_cue_blob quick_cue;
+        extra_offsets_.resize(size_ - inline_offsets_.size());
+    }
 
-        uint8_t label_length;
-        std::tie(label_length, ptr) = decode_uint8(ptr);
-        if (end - ptr < 29 + label_length)  // 12 (here) + 17 (after the loop)
+    std::size_t offset = 8;
+    for (std::size_t i = 0; i < size_; ++i)
+    {
+        auto label_length = std::to_integer<std::size_t>(data[offset]);
+        if (end - offset < 13 + label_length)
         {
             throw std::invalid_argument{
                 "Quick cues data has quick cue with missing data"};
         }
 
-        if (label_length > 0)
-        {
-            quick_cue.label.assign(
-                reinterpret_cast<const char*>(ptr), label_length);
-            ptr += label_length;
-        }
+        auto& slot = i < inline_offsets_.size()
+                         ? inline_offsets_[i]
+                         : extra_offsets_[i - inline_offsets_.size()];
+        slot = static_cast<uint32_t>(offset);
+        offset += 13 + label_length;
+    }
+
+    trailer_offset_ = offset;
+}
+
+std::vector<std::byte> quick_cues_view::uncompress(
+    const std::vector<std::byte>& blob)
+{
+    return zlib_uncompress(blob);
+}
 
-        std::tie(quick_cue.sample_offset, ptr) = decode_double_be(ptr);
-        std::tie(quick_cue.color.a, ptr) = decode_uint8(ptr);
-        std::tie(quick_cue.color.r, ptr) = decode_uint8(ptr);
-        std::tie(quick_cue.color.g, ptr) = decode_uint8(ptr);
-        std::tie(quick_cue.color.b, ptr) = decode_uint8(ptr);
+quick_cue_blob_view quick_cues_view::operator[](std::size_t index) const
+{
+    auto ptr = data_.data() + offset(index);
+    auto label_length = std::to_integer<std::size_t>(*ptr++);
+    std::string_view label{reinterpret_cast<const char*>(ptr), label_length};
+    ptr += label_length;
+    return quick_cue_blob_view{
+        label, load_be<double>(ptr),
+        pad_color{
+            load_le<uint8_t>(ptr + 9), load_le<uint8_t>(ptr + 10),
+            load_le<uint8_t>(ptr + 11), load_le<uint8_t>(ptr + 8)}};
+}
 
-        result.quick_cues.push_back(quick_cue);
+quick_cue_blob_view quick_cues_view::at(std::size_t index) const
+{
+    if (index >= size_)
+    {
+        throw std::out_of_range{"Quick cue index is out of range"};
     }
 
-    std::tie(result.adjusted_main_cue, ptr) = decode_double_be(ptr);
-    std::tie(result.is_main_cue_adjusted, ptr) = decode_uint8(ptr);
-    std::tie(result.default_main_cue, ptr) = decode_double_be(ptr);
-    std::tie(result.extra_data, ptr) = decode_extra(ptr, end);
-    assert(ptr == end);
+    return (*this)[index];
+}
+
+double quick_cues_view::adjusted_main_cue() const noexcept
+{
+    return data_.empty() ? 0 : load_be<double>(data_.data() + trailer_offset_);
+}
 
-    return result;
+bool quick_cues_view::is_main_cue_adjusted() const noexcept
+{
+    return !data_.empty() &&
+           load_le<uint8_t>(data_.data() + trailer_offset_ + 8) != 0;
+}
+
+double quick_cues_view::default_main_cue() const noexcept
+{
+    return data_.empty()
+               ? 0
+               : load_be<double>(data_.data() + trailer_offset_ + 9);
 }
 
 }  // namespace djinterop::engine::v2
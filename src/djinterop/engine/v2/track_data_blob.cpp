@@ -17,30 +17,17 @@
 
 #include <djinterop/engine/v2/track_data_blob.hpp>
 
-#include <cassert>
-#include <stdexcept>
-#include <tuple>
-
+#include "../../util/metrics.hpp"
 #include "../encode_decode_utils.hpp"
+#include "blob_layouts.hpp"
 
 namespace djinterop::engine::v2
 {
 std::vector<std::byte> track_data_blob::to_blob() const
 {
-    std::vector<std::byte> uncompressed(44 + extra_data.size());
-    auto ptr = uncompressed.data();
-    [[maybe_unused]] const auto end = ptr + uncompressed.size();
-
-    ptr = encode_double_be(sample_rate, ptr);
-    ptr = encode_int64_be(samples, ptr);
-    ptr = encode_int32_be(key, ptr);
-    ptr = encode_double_be(average_loudness_low, ptr);
-    ptr = encode_double_be(average_loudness_mid, ptr);
-    ptr = encode_double_be(average_loudness_high, ptr);
-    ptr = encode_extra(extra_data, ptr);
-    assert(ptr == end);
-
-    return zlib_compress(uncompressed);
+    djinterop::util::blob_encode_timer timer{blob_type::track_data};
+    using layout = layouts::track_data_blob_layout;
+    return timer.record(blob_layout::encode_compressed<layout>(*this));
 }
 
 track_data_blob track_data_blob::from_blob(const std::vector<std::byte>& blob)
@@ -58,28 +45,9 @@ track_data_blob track_data_blob::from_blob(const std::vector<std::byte>& blob)
         };
     }
 
-    const auto uncompressed = zlib_uncompress(blob);
-    auto ptr = uncompressed.data();
-    const auto end = ptr + uncompressed.size();
-
-    if (uncompressed.size() != 44)
-    {
-        throw std::invalid_argument{
-            "Track data blob doesn't have expected decompressed length of 28 "
-            "bytes"};
-    }
-
-    track_data_blob result{};
-    std::tie(result.sample_rate, ptr) = decode_double_be(ptr);
-    std::tie(result.samples, ptr) = decode_int64_be(ptr);
-    std::tie(result.key, ptr) = decode_int32_be(ptr);
-    std::tie(result.average_loudness_low, ptr) = decode_double_be(ptr);
-    std::tie(result.average_loudness_mid, ptr) = decode_double_be(ptr);
-    std::tie(result.average_loudness_high, ptr) = decode_double_be(ptr);
-    std::tie(result.extra_data, ptr) = decode_extra(ptr, end);
-    assert(ptr == end);
-
-    return result;
+    djinterop::util::blob_decode_timer timer{blob_type::track_data, blob};
+    return blob_layout::decode<layouts::track_data_blob_layout>(
+        zlib_uncompress(blob), "Track data");
 }
 
 }  // namespace djinterop::engine::v2
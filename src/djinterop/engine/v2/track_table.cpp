@@ -1323,6 +1323,11 @@ beat_data_blob track_table::get_beat_data(int64_t id)
         get_column<std::vector<std::byte>>(context_->db, id, "beatData"));
 }
 
+std::vector<std::byte> track_table::get_beat_data_blob(int64_t id)
+{
+    return get_column<std::vector<std::byte>>(context_->db, id, "beatData");
+}
+
 void track_table::set_beat_data(int64_t id, const beat_data_blob& beat_data)
 {
     set_column<std::vector<std::byte>>(
@@ -1335,6 +1340,11 @@ quick_cues_blob track_table::get_quick_cues(int64_t id)
         get_column<std::vector<std::byte>>(context_->db, id, "quickCues"));
 }
 
+std::vector<std::byte> track_table::get_quick_cues_blob(int64_t id)
+{
+    return get_column<std::vector<std::byte>>(context_->db, id, "quickCues");
+}
+
 void track_table::set_quick_cues(int64_t id, const quick_cues_blob& quick_cues)
 {
     set_column<std::vector<std::byte>>(
@@ -1347,6 +1357,11 @@ loops_blob track_table::get_loops(int64_t id)
         get_column<std::vector<std::byte>>(context_->db, id, "loops"));
 }
 
+std::vector<std::byte> track_table::get_loops_blob(int64_t id)
+{
+    return get_column<std::vector<std::byte>>(context_->db, id, "loops");
+}
+
 void track_table::set_loops(int64_t id, const loops_blob& loops)
 {
     set_column<std::vector<std::byte>>(
@@ -39,6 +39,12 @@ inline std::vector<djinterop::beatgrid_marker> beatgrid_markers(
 {
     return v2::convert::read::beatgrid_markers(beat_grid);
 }
+
+inline std::vector<djinterop::beatgrid_marker> beatgrid_markers(
+    const beat_grid_view& beat_grid)
+{
+    return v2::convert::read::beatgrid_markers(beat_grid);
+}
 }  // namespace read
 
 namespace write
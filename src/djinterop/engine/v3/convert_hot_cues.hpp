@@ -33,6 +33,12 @@ inline std::optional<hot_cue> hot_cue(const quick_cue_blob& quick_cue)
     return v2::convert::read::hot_cue(quick_cue);
 }
 
+inline std::optional<djinterop::hot_cue> hot_cue(
+    const quick_cue_blob_view& quick_cue)
+{
+    return v2::convert::read::hot_cue(quick_cue);
+}
+
 inline std::vector<std::optional<djinterop::hot_cue>> hot_cues(
     const quick_cues_blob& quick_cues)
 {
@@ -33,6 +33,11 @@ inline std::optional<loop> loop(const loop_blob& l)
     return v2::convert::read::loop(l);
 }
 
+inline std::optional<djinterop::loop> loop(const loop_blob_view& l)
+{
+    return v2::convert::read::loop(l);
+}
+
 inline std::vector<std::optional<djinterop::loop>> loops(
     const loops_blob& loops)
 {
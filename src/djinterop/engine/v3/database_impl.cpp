@@ -163,11 +163,61 @@ track database_impl::create_track(const track_snapshot& snapshot)
     return djinterop::engine::v3::create_track(library_, snapshot);
 }
 
+std::vector<track> database_impl::create_tracks(
+    const std::vector<track_snapshot>& snapshots)
+{
+    return library_->create_tracks(snapshots);
+}
+
 std::string database_impl::directory()
 {
     return library_->directory();
 }
 
+database_metrics database_impl::metrics()
+{
+    return library_->metrics();
+}
+
+std::vector<int64_t> database_impl::query_track_ids(
+    const track_query_criteria& criteria)
+{
+    return library_->query_track_ids(criteria);
+}
+
+std::vector<track_query_row> database_impl::query_track_rows(
+    const track_query_criteria& criteria)
+{
+    return library_->query_track_rows(criteria);
+}
+
+std::vector<int64_t> database_impl::search(
+    const std::string& text, std::size_t limit)
+{
+    return library_->search(text, limit);
+}
+
+std::shared_ptr<const track_feature_index> database_impl::feature_index()
+{
+    return library_->feature_index();
+}
+
+std::shared_ptr<const track_similarity_index> database_impl::similarity_index()
+{
+    return library_->similarity_index();
+}
+
+std::vector<duplicate_group> database_impl::find_duplicates(
+    const duplicate_policy& policy)
+{
+    return library_->find_duplicates(policy);
+}
+
+void database_impl::merge_duplicates(const std::vector<duplicate_group>& groups)
+{
+    library_->merge_duplicates(groups);
+}
+
 void database_impl::verify()
 {
     library_->verify();
@@ -242,6 +292,16 @@ std::optional<playlist> database_impl::root_playlist_by_name(
     return std::make_optional<playlist>(playlist{impl});
 }
 
+void database_impl::set_observer(std::shared_ptr<sql_observer> observer)
+{
+    library_->set_observer(std::move(observer));
+}
+
+void database_impl::set_metrics_enabled(bool enabled)
+{
+    library_->set_metrics_enabled(enabled);
+}
+
 std::optional<track> database_impl::track_by_id(int64_t id)
 {
     if (library_->track().exists(id))
@@ -41,7 +41,21 @@ public:
         const std::string& name,
         const djinterop::playlist_impl& after_base) override;
     track create_track(const track_snapshot& snapshot) override;
+    std::vector<track> create_tracks(
+        const std::vector<track_snapshot>& snapshots) override;
     std::string directory() override;
+    database_metrics metrics() override;
+    std::vector<int64_t> query_track_ids(
+        const track_query_criteria& criteria) override;
+    std::vector<track_query_row> query_track_rows(
+        const track_query_criteria& criteria) override;
+    std::vector<int64_t> search(
+        const std::string& text, std::size_t limit) override;
+    std::shared_ptr<const track_feature_index> feature_index() override;
+    std::shared_ptr<const track_similarity_index> similarity_index() override;
+    std::vector<duplicate_group> find_duplicates(
+        const duplicate_policy& policy) override;
+    void merge_duplicates(const std::vector<duplicate_group>& groups) override;
     void verify() override;
     void remove_crate(djinterop::crate cr) override;
     void remove_playlist(const djinterop::playlist_impl& pl_base) override;
@@ -52,6 +66,8 @@ public:
     std::vector<playlist> root_playlists() override;
     std::optional<djinterop::playlist> root_playlist_by_name(
         const std::string& name) override;
+    void set_observer(std::shared_ptr<sql_observer> observer) override;
+    void set_metrics_enabled(bool enabled) override;
     std::optional<djinterop::track> track_by_id(int64_t id) override;
     std::vector<djinterop::track> tracks() override;
     std::vector<djinterop::track> tracks_by_relative_path(
@@ -171,6 +171,11 @@ beat_data_blob performance_data_table::get_beat_data(int64_t track_id)
         get_column<std::vector<std::byte>>(context_->db, track_id, "beatData"));
 }
 
+std::vector<std::byte> performance_data_table::get_beat_data_blob(int64_t track_id)
+{
+    return get_column<std::vector<std::byte>>(context_->db, track_id, "beatData");
+}
+
 void performance_data_table::set_beat_data(int64_t track_id, const beat_data_blob& beat_data)
 {
     set_column<std::vector<std::byte>>(
@@ -183,6 +188,11 @@ quick_cues_blob performance_data_table::get_quick_cues(int64_t track_id)
         get_column<std::vector<std::byte>>(context_->db, track_id, "quickCues"));
 }
 
+std::vector<std::byte> performance_data_table::get_quick_cues_blob(int64_t track_id)
+{
+    return get_column<std::vector<std::byte>>(context_->db, track_id, "quickCues");
+}
+
 void performance_data_table::set_quick_cues(int64_t track_id, const quick_cues_blob& quick_cues)
 {
     set_column<std::vector<std::byte>>(
@@ -195,6 +205,11 @@ loops_blob performance_data_table::get_loops(int64_t track_id)
         get_column<std::vector<std::byte>>(context_->db, track_id, "loops"));
 }
 
+std::vector<std::byte> performance_data_table::get_loops_blob(int64_t track_id)
+{
+    return get_column<std::vector<std::byte>>(context_->db, track_id, "loops");
+}
+
 void performance_data_table::set_loops(int64_t track_id, const loops_blob& loops)
 {
     set_column<std::vector<std::byte>>(
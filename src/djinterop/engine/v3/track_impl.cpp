@@ -293,8 +293,10 @@ void track_impl::set_average_loudness(std::optional<double> average_loudness)
 
 std::vector<beatgrid_marker> track_impl::beatgrid()
 {
-    auto beat_data = library_->performance_data().get_beat_data(id());
-    return convert::read::beatgrid_markers(beat_data.adjusted_beat_grid);
+    auto data = beat_data_view::uncompress(
+        library_->performance_data().get_beat_data_blob(id()));
+    beat_data_view beat_data{data};
+    return convert::read::beatgrid_markers(beat_data.adjusted_beat_grid());
 }
 
 void track_impl::set_beatgrid(std::vector<beatgrid_marker> beatgrid)
@@ -402,15 +404,18 @@ void track_impl::set_genre(std::optional<std::string> genre)
 
 std::optional<hot_cue> track_impl::hot_cue_at(int index)
 {
-    auto quick_cues = library_->performance_data().get_quick_cues(id());
-    if (index < 0 || (unsigned)index > quick_cues.quick_cues.size())
+    // Only the requested cue is decoded, via a view over the blob.
+    auto data = quick_cues_view::uncompress(
+        library_->performance_data().get_quick_cues_blob(id()));
+    quick_cues_view quick_cues{data};
+    if (index < 0 || (unsigned)index >= quick_cues.size())
     {
         throw std::out_of_range{
             "Request for hot cue at given index exceeds maximum number of cues "
             "on track"};
     }
 
-    return convert::read::hot_cue(quick_cues.quick_cues[index]);
+    return convert::read::hot_cue(quick_cues[index]);
 }
 
 void track_impl::set_hot_cue_at(int index, std::optional<hot_cue> cue)
@@ -473,15 +478,17 @@ void track_impl::set_last_played_at(
 
 std::optional<loop> track_impl::loop_at(int index)
 {
-    auto loops = library_->performance_data().get_loops(id());
-    if (index < 0 || (unsigned)index > loops.loops.size())
+    // Loops are stored uncompressed, so can be viewed in place.
+    auto data = library_->performance_data().get_loops_blob(id());
+    loops_view loops{data};
+    if (index < 0 || (unsigned)index >= loops.size())
     {
         throw std::out_of_range{
             "Request for loop at given index exceeds maximum number of loops "
             "on track"};
     }
 
-    return convert::read::loop(loops.loops[index]);
+    return convert::read::loop(loops[index]);
 }
 
 void track_impl::set_loop_at(int index, std::optional<loop> l)
@@ -18,13 +18,21 @@
 #pragma once
 
 #include <bitset>
+#include <cstddef>
 #include <cstdint>
 #include <initializer_list>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
 #include <djinterop/database.hpp>
+#include <djinterop/database_metrics.hpp>
+#include <djinterop/sql_observer.hpp>
+#include <djinterop/track_duplicates.hpp>
+#include <djinterop/track_feature_index.hpp>
+#include <djinterop/track_query.hpp>
+#include <djinterop/track_similarity_index.hpp>
 
 namespace djinterop
 {
@@ -57,7 +65,23 @@ public:
     virtual crate create_root_crate_after(
         const std::string& name, const crate& after) = 0;
     virtual track create_track(const track_snapshot& snapshot) = 0;
+    virtual std::vector<track> create_tracks(
+        const std::vector<track_snapshot>& snapshots) = 0;
     virtual std::string directory() = 0;
+    virtual database_metrics metrics() = 0;
+    virtual std::vector<int64_t> query_track_ids(
+        const track_query_criteria& criteria) = 0;
+    virtual std::vector<track_query_row> query_track_rows(
+        const track_query_criteria& criteria) = 0;
+    virtual std::vector<int64_t> search(
+        const std::string& text, std::size_t limit) = 0;
+    virtual std::shared_ptr<const track_feature_index> feature_index() = 0;
+    virtual std::shared_ptr<const track_similarity_index>
+    similarity_index() = 0;
+    virtual std::vector<duplicate_group> find_duplicates(
+        const duplicate_policy& policy) = 0;
+    virtual void merge_duplicates(
+        const std::vector<duplicate_group>& groups) = 0;
     virtual void verify() = 0;
     virtual void remove_crate(crate cr) = 0;
     virtual void remove_playlist(const playlist_impl& pl) = 0;
@@ -68,6 +92,8 @@ public:
     virtual std::vector<playlist> root_playlists() = 0;
     virtual std::optional<playlist> root_playlist_by_name(
         const std::string& name) = 0;
+    virtual void set_observer(std::shared_ptr<sql_observer> observer) = 0;
+    virtual void set_metrics_enabled(bool enabled) = 0;
     virtual std::optional<track> track_by_id(int64_t id) = 0;
     virtual std::vector<track> tracks() = 0;
     virtual std::vector<track> tracks_by_relative_path(
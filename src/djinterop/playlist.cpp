@@ -21,6 +21,7 @@
 #include <djinterop/playlist.hpp>
 
 #include "impl/playlist_impl.hpp"
+#include "util/sql_trace.hpp"
 
 namespace djinterop
 {
@@ -32,71 +33,85 @@ playlist& playlist::operator=(const playlist& other) noexcept = default;
 
 void playlist::add_track_back(const track& tr)
 {
+    util::api_operation operation{"playlist::add_track_back"};
     pimpl_->add_track_back(*tr.pimpl_);
 }
 
 void playlist::add_track_after(const track& tr, const track& after)
 {
+    util::api_operation operation{"playlist::add_track_after"};
     pimpl_->add_track_after(*tr.pimpl_, *after.pimpl_);
 }
 
 std::vector<playlist> playlist::children() const
 {
+    util::api_operation operation{"playlist::children"};
     return pimpl_->children();
 }
 
 void playlist::clear_tracks()
 {
+    util::api_operation operation{"playlist::clear_tracks"};
     pimpl_->clear_tracks();
 }
 
 playlist playlist::create_sub_playlist(const std::string& name)
 {
+    util::api_operation operation{"playlist::create_sub_playlist"};
     return pimpl_->create_sub_playlist(name);
 }
 
 playlist playlist::create_sub_playlist_after(const std::string& name, const playlist& after)
 {
+    util::api_operation operation{"playlist::create_sub_playlist_after"};
     return pimpl_-> create_sub_playlist_after(name, *after.pimpl_);
 }
 
 database playlist::db() const
 {
+    util::api_operation operation{"playlist::db"};
     return pimpl_->db();
 }
 
 std::string playlist::name() const
 {
+    util::api_operation operation{"playlist::name"};
     return pimpl_->name();
 }
 
 std::optional<playlist> playlist::parent() const
 {
+    util::api_operation operation{"playlist::parent"};
     return pimpl_->parent();
 }
 
 void playlist::remove_track(const track& tr)
 {
+    util::api_operation operation{"playlist::remove_track"};
     pimpl_->remove_track(*tr.pimpl_);
 }
 
 void playlist::set_name(const std::string& name)
 {
+    util::api_operation operation{"playlist::set_name"};
     pimpl_->set_name(name);
 }
 
 void playlist::set_parent(const std::optional<playlist>& parent) const
 {
+    util::api_operation operation{"playlist::set_parent"};
     pimpl_->set_parent(parent ? parent->pimpl_.get() : nullptr);
 }
 
 std::optional<playlist> playlist::sub_playlist_by_name(const std::string& name) const
 {
+    util::api_operation operation{"playlist::sub_playlist_by_name"};
     return pimpl_->sub_playlist_by_name(name);
 }
 
 std::vector<track> playlist::tracks() const
 {
+    util::api_operation operation{"playlist::tracks"};
     return pimpl_->tracks();
 }
 
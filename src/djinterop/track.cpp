@@ -27,6 +27,7 @@
 
 #include "impl/database_impl.hpp"
 #include "impl/track_impl.hpp"
+#include "util/sql_trace.hpp"
 
 using std::chrono::duration_cast;
 using std::chrono::milliseconds;
@@ -43,21 +44,25 @@ track& track::operator=(const track& other) noexcept = default;
 
 track_snapshot track::snapshot() const
 {
+    util::api_operation operation{"track::snapshot"};
     return pimpl_->snapshot();
 }
 
 void track::update(const track_snapshot& snapshot)
 {
+    util::api_operation operation{"track::update"};
     pimpl_->update(snapshot);
 }
 
 std::optional<std::string> track::album() const
 {
+    util::api_operation operation{"track::album"};
     return pimpl_->album();
 }
 
 void track::set_album(std::optional<std::string> album) const
 {
+    util::api_operation operation{"track::set_album"};
     pimpl_->set_album(album);
 }
 
@@ -68,11 +73,13 @@ void track::set_album(std::string album) const
 
 std::optional<std::string> track::artist() const
 {
+    util::api_operation operation{"track::artist"};
     return pimpl_->artist();
 }
 
 void track::set_artist(std::optional<std::string> artist) const
 {
+    util::api_operation operation{"track::set_artist"};
     pimpl_->set_artist(artist);
 }
 
@@ -83,11 +90,13 @@ void track::set_artist(std::string artist) const
 
 std::optional<double> track::average_loudness() const
 {
+    util::api_operation operation{"track::average_loudness"};
     return pimpl_->average_loudness();
 }
 
 void track::set_average_loudness(std::optional<double> average_loudness) const
 {
+    util::api_operation operation{"track::set_average_loudness"};
     pimpl_->set_average_loudness(average_loudness);
 }
 
@@ -98,21 +107,25 @@ void track::set_average_loudness(double average_loudness) const
 
 std::vector<beatgrid_marker> track::beatgrid() const
 {
+    util::api_operation operation{"track::beatgrid"};
     return pimpl_->beatgrid();
 }
 
 void track::set_beatgrid(std::vector<beatgrid_marker> beatgrid) const
 {
+    util::api_operation operation{"track::set_beatgrid"};
     pimpl_->set_beatgrid(std::move(beatgrid));
 }
 
 std::optional<int> track::bitrate() const
 {
+    util::api_operation operation{"track::bitrate"};
     return pimpl_->bitrate();
 }
 
 void track::set_bitrate(std::optional<int> bitrate) const
 {
+    util::api_operation operation{"track::set_bitrate"};
     pimpl_->set_bitrate(bitrate);
 }
 
@@ -123,11 +136,13 @@ void track::set_bitrate(int bitrate) const
 
 std::optional<double> track::bpm() const
 {
+    util::api_operation operation{"track::bpm"};
     return pimpl_->bpm();
 }
 
 void track::set_bpm(std::optional<double> bpm) const
 {
+    util::api_operation operation{"track::set_bpm"};
     pimpl_->set_bpm(bpm);
 }
 
@@ -138,11 +153,13 @@ void track::set_bpm(double bpm) const
 
 std::optional<std::string> track::comment() const
 {
+    util::api_operation operation{"track::comment"};
     return pimpl_->comment();
 }
 
 void track::set_comment(std::optional<std::string> comment) const
 {
+    util::api_operation operation{"track::set_comment"};
     pimpl_->set_comment(comment);
 }
 
@@ -153,11 +170,13 @@ void track::set_comment(std::string comment) const
 
 std::optional<std::string> track::composer() const
 {
+    util::api_operation operation{"track::composer"};
     return pimpl_->composer();
 }
 
 void track::set_composer(std::optional<std::string> composer) const
 {
+    util::api_operation operation{"track::set_composer"};
     pimpl_->set_composer(composer);
 }
 
@@ -168,21 +187,25 @@ void track::set_composer(std::string composer) const
 
 std::vector<crate> track::containing_crates() const
 {
+    util::api_operation operation{"track::containing_crates"};
     return pimpl_->containing_crates();
 }
 
 database track::db() const
 {
+    util::api_operation operation{"track::db"};
     return pimpl_->db();
 }
 
 std::optional<milliseconds> track::duration() const
 {
+    util::api_operation operation{"track::duration"};
     return pimpl_->duration();
 }
 
 void track::set_duration(std::optional<milliseconds> duration)
 {
+    util::api_operation operation{"track::set_duration"};
     pimpl_->set_duration(duration);
 }
 
@@ -193,21 +216,25 @@ void track::set_duration(milliseconds duration)
 
 std::string track::file_extension() const
 {
+    util::api_operation operation{"track::file_extension"};
     return pimpl_->file_extension();
 }
 
 std::string track::filename() const
 {
+    util::api_operation operation{"track::filename"};
     return pimpl_->filename();
 }
 
 std::optional<std::string> track::genre() const
 {
+    util::api_operation operation{"track::genre"};
     return pimpl_->genre();
 }
 
 void track::set_genre(std::optional<std::string> genre) const
 {
+    util::api_operation operation{"track::set_genre"};
     pimpl_->set_genre(genre);
 }
 
@@ -218,11 +245,13 @@ void track::set_genre(std::string genre) const
 
 std::optional<hot_cue> track::hot_cue_at(int index) const
 {
+    util::api_operation operation{"track::hot_cue_at"};
     return pimpl_->hot_cue_at(index);
 }
 
 void track::set_hot_cue_at(int index, std::optional<hot_cue> cue) const
 {
+    util::api_operation operation{"track::set_hot_cue_at"};
     pimpl_->set_hot_cue_at(index, cue);
 }
 
@@ -233,31 +262,37 @@ void track::set_hot_cue_at(int index, hot_cue cue) const
 
 std::vector<std::optional<hot_cue> > track::hot_cues() const
 {
+    util::api_operation operation{"track::hot_cues"};
     return pimpl_->hot_cues();
 }
 
 void track::set_hot_cues(std::vector<std::optional<hot_cue> > cues) const
 {
+    util::api_operation operation{"track::set_hot_cues"};
     pimpl_->set_hot_cues(std::move(cues));
 }
 
 int64_t track::id() const
 {
+    util::api_operation operation{"track::id"};
     return pimpl_->id();
 }
 
 bool track::is_valid() const
 {
+    util::api_operation operation{"track::is_valid"};
     return pimpl_->is_valid();
 }
 
 std::optional<musical_key> track::key() const
 {
+    util::api_operation operation{"track::key"};
     return pimpl_->key();
 }
 
 void track::set_key(std::optional<musical_key> key) const
 {
+    util::api_operation operation{"track::set_key"};
     pimpl_->set_key(key);
 }
 
@@ -268,12 +303,14 @@ void track::set_key(musical_key key) const
 
 std::optional<system_clock::time_point> track::last_played_at() const
 {
+    util::api_operation operation{"track::last_played_at"};
     return pimpl_->last_played_at();
 }
 
 void track::set_last_played_at(
     std::optional<system_clock::time_point> played_at) const
 {
+    util::api_operation operation{"track::set_last_played_at"};
     pimpl_->set_last_played_at(played_at);
 }
 
@@ -284,11 +321,13 @@ void track::set_last_played_at(system_clock::time_point played_at) const
 
 std::optional<loop> track::loop_at(int index) const
 {
+    util::api_operation operation{"track::loop_at"};
     return pimpl_->loop_at(index);
 }
 
 void track::set_loop_at(int index, std::optional<loop> l) const
 {
+    util::api_operation operation{"track::set_loop_at"};
     pimpl_->set_loop_at(index, l);
 }
 
@@ -299,31 +338,37 @@ void track::set_loop_at(int index, loop l) const
 
 std::vector<std::optional<loop> > track::loops() const
 {
+    util::api_operation operation{"track::loops"};
     return pimpl_->loops();
 }
 
 void track::set_loops(std::vector<std::optional<loop> > loops) const
 {
+    util::api_operation operation{"track::set_loops"};
     pimpl_->set_loops(std::move(loops));
 }
 
 std::optional<double> track::main_cue() const
 {
+    util::api_operation operation{"track::main_cue"};
     return pimpl_->main_cue();
 }
 
 void track::set_main_cue(std::optional<double> sample_offset) const
 {
+    util::api_operation operation{"track::set_main_cue"};
     pimpl_->set_main_cue(sample_offset);
 }
 
 std::optional<std::string> track::publisher() const
 {
+    util::api_operation operation{"track::publisher"};
     return pimpl_->publisher();
 }
 
 void track::set_publisher(std::optional<std::string> publisher) const
 {
+    util::api_operation operation{"track::set_publisher"};
     pimpl_->set_publisher(publisher);
 }
 
@@ -334,36 +379,43 @@ void track::set_publisher(std::string publisher) const
 
 std::optional<int> track::rating() const
 {
+    util::api_operation operation{"track::rating"};
     return pimpl_->rating();
 }
 
 void track::set_rating(std::optional<int> rating)
 {
+    util::api_operation operation{"track::set_rating"};
     pimpl_->set_rating(rating);
 }
 
 void track::set_rating(int32_t rating)
 {
+    util::api_operation operation{"track::set_rating"};
     pimpl_->set_rating(std::make_optional(rating));
 }
 
 std::string track::relative_path() const
 {
+    util::api_operation operation{"track::relative_path"};
     return pimpl_->relative_path();
 }
 
 void track::set_relative_path(std::string relative_path) const
 {
+    util::api_operation operation{"track::set_relative_path"};
     pimpl_->set_relative_path(relative_path);
 }
 
 std::optional<unsigned long long> track::sample_count() const
 {
+    util::api_operation operation{"track::sample_count"};
     return pimpl_->sample_count();
 }
 
 void track::set_sample_count(std::optional<unsigned long long> sample_count)
 {
+    util::api_operation operation{"track::set_sample_count"};
     pimpl_->set_sample_count(sample_count);
 }
 
@@ -374,11 +426,13 @@ void track::set_sample_count(unsigned long long sample_count)
 
 std::optional<double> track::sample_rate() const
 {
+    util::api_operation operation{"track::sample_rate"};
     return pimpl_->sample_rate();
 }
 
 void track::set_sample_rate(std::optional<double> sample_rate)
 {
+    util::api_operation operation{"track::set_sample_rate"};
     pimpl_->set_sample_rate(sample_rate);
 }
 
@@ -389,11 +443,13 @@ void track::set_sample_rate(double sample_rate)
 
 std::optional<std::string> track::title() const
 {
+    util::api_operation operation{"track::title"};
     return pimpl_->title();
 }
 
 void track::set_title(std::optional<std::string> title) const
 {
+    util::api_operation operation{"track::set_title"};
     pimpl_->set_title(title);
 }
 
@@ -404,11 +460,13 @@ void track::set_title(std::string title) const
 
 std::optional<int> track::track_number() const
 {
+    util::api_operation operation{"track::track_number"};
     return pimpl_->track_number();
 }
 
 void track::set_track_number(std::optional<int> track_number) const
 {
+    util::api_operation operation{"track::set_track_number"};
     pimpl_->set_track_number(track_number);
 }
 
@@ -419,21 +477,25 @@ void track::set_track_number(int track_number) const
 
 std::vector<waveform_entry> track::waveform() const
 {
+    util::api_operation operation{"track::waveform"};
     return pimpl_->waveform();
 }
 
 void track::set_waveform(std::vector<waveform_entry> waveform) const
 {
+    util::api_operation operation{"track::set_waveform"};
     pimpl_->set_waveform(waveform);
 }
 
 std::optional<int> track::year() const
 {
+    util::api_operation operation{"track::year"};
     return pimpl_->year();
 }
 
 void track::set_year(std::optional<int> year) const
 {
+    util::api_operation operation{"track::set_year"};
     pimpl_->set_year(year);
 }
 
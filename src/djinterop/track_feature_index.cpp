@@ -0,0 +1,633 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/track_feature_index.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include <djinterop/exceptions.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DJINTEROP_FEATURE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace djinterop
+{
+namespace
+{
+/// Number of rows evaluated together, being the number of bits in a word of a
+/// bitset.
+constexpr std::size_t block_rows = 64;
+
+/// Alignment of each column, being that of a cache line.  Blocks of rows are
+/// therefore aligned for the widest SIMD loads.
+constexpr std::size_t column_alignment = 64;
+
+constexpr float missing = std::numeric_limits<float>::quiet_NaN();
+
+template <typename T>
+struct aligned_allocator
+{
+    using value_type = T;
+
+    aligned_allocator() noexcept = default;
+
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(::operator new(
+            n * sizeof(T), std::align_val_t{column_alignment}));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t{column_alignment});
+    }
+
+    friend bool operator==(
+        const aligned_allocator&, const aligned_allocator&) noexcept
+    {
+        return true;
+    }
+};
+
+template <typename T>
+using column = std::vector<T, aligned_allocator<T>>;
+
+/// Number of rows of storage needed for a given number of tracks, such that
+/// the columns hold a whole number of blocks.  Rows beyond the last track are
+/// padded with values that satisfy no predicate.
+std::size_t padded_rows(std::size_t size) noexcept
+{
+    return (size + block_rows - 1) / block_rows * block_rows;
+}
+
+/// Mask of the rows of the last block that hold tracks.
+uint64_t tail_mask(std::size_t size) noexcept
+{
+    auto remainder = size % block_rows;
+    return remainder == 0 ? ~uint64_t{0} : (uint64_t{1} << remainder) - 1;
+}
+
+float to_bpm(const std::optional<double>& bpm) noexcept
+{
+    return bpm ? static_cast<float>(*bpm) : missing;
+}
+
+float to_decibels(double average_loudness) noexcept
+{
+    return static_cast<float>(20 * std::log10(average_loudness));
+}
+
+float to_loudness_db(const std::optional<double>& average_loudness) noexcept
+{
+    return average_loudness && *average_loudness > 0
+               ? to_decibels(*average_loudness)
+               : missing;
+}
+
+float to_seconds(std::chrono::milliseconds duration) noexcept
+{
+    return static_cast<float>(duration.count() / 1000.0);
+}
+
+float to_duration_s(
+    const std::optional<std::chrono::milliseconds>& duration) noexcept
+{
+    return duration ? to_seconds(*duration) : missing;
+}
+
+uint32_t to_key_bit(const std::optional<musical_key>& key) noexcept
+{
+    if (!key)
+        return 0;
+
+    auto value = static_cast<int>(*key);
+    return value >= 0 && value < 24 ? uint32_t{1} << value : 0;
+}
+
+/// Evaluate `lo <= value <= hi` for a block of rows.  Missing values, being
+/// NaN, never satisfy the predicate.
+uint64_t range_mask(const float* values, float lo, float hi) noexcept
+{
+    uint64_t result = 0;
+#if defined(__AVX2__)
+    auto lo8 = _mm256_set1_ps(lo);
+    auto hi8 = _mm256_set1_ps(hi);
+    for (std::size_t i = 0; i < block_rows; i += 8)
+    {
+        auto v = _mm256_load_ps(values + i);
+        auto in_range = _mm256_and_ps(
+            _mm256_cmp_ps(v, lo8, _CMP_GE_OQ),
+            _mm256_cmp_ps(v, hi8, _CMP_LE_OQ));
+        result |= static_cast<uint64_t>(_mm256_movemask_ps(in_range)) << i;
+    }
+#elif defined(DJINTEROP_FEATURE_SSE2)
+    auto lo4 = _mm_set1_ps(lo);
+    auto hi4 = _mm_set1_ps(hi);
+    for (std::size_t i = 0; i < block_rows; i += 4)
+    {
+        auto v = _mm_load_ps(values + i);
+        auto in_range = _mm_and_ps(_mm_cmpge_ps(v, lo4), _mm_cmple_ps(v, hi4));
+        result |= static_cast<uint64_t>(_mm_movemask_ps(in_range)) << i;
+    }
+#else
+    for (std::size_t i = 0; i < block_rows; ++i)
+    {
+        auto in_range = values[i] >= lo && values[i] <= hi;
+        result |= static_cast<uint64_t>(in_range) << i;
+    }
+#endif
+    return result;
+}
+
+/// Evaluate whether the key of each of a block of rows is in a set of keys.
+uint64_t key_mask(const uint32_t* key_bits, uint32_t permitted) noexcept
+{
+    uint64_t result = 0;
+#if defined(__AVX2__)
+    auto permitted8 = _mm256_set1_epi32(static_cast<int>(permitted));
+    auto zero = _mm256_setzero_si256();
+    for (std::size_t i = 0; i < block_rows; i += 8)
+    {
+        auto v = _mm256_load_si256(
+            reinterpret_cast<const __m256i*>(key_bits + i));
+        auto excluded =
+            _mm256_cmpeq_epi32(_mm256_and_si256(v, permitted8), zero);
+        auto bits = ~_mm256_movemask_ps(_mm256_castsi256_ps(excluded)) & 0xff;
+        result |= static_cast<uint64_t>(bits) << i;
+    }
+#elif defined(DJINTEROP_FEATURE_SSE2)
+    auto permitted4 = _mm_set1_epi32(static_cast<int>(permitted));
+    auto zero = _mm_setzero_si128();
+    for (std::size_t i = 0; i < block_rows; i += 4)
+    {
+        auto v = _mm_load_si128(reinterpret_cast<const __m128i*>(key_bits + i));
+        auto excluded = _mm_cmpeq_epi32(_mm_and_si128(v, permitted4), zero);
+        auto bits = ~_mm_movemask_ps(_mm_castsi128_ps(excluded)) & 0xf;
+        result |= static_cast<uint64_t>(bits) << i;
+    }
+#else
+    for (std::size_t i = 0; i < block_rows; ++i)
+    {
+        auto in_set = (key_bits[i] & permitted) != 0;
+        result |= static_cast<uint64_t>(in_set) << i;
+    }
+#endif
+    return result;
+}
+
+struct range_predicate
+{
+    const float* values;
+    float lo;
+    float hi;
+};
+
+std::optional<range_predicate> make_range_predicate(
+    const float* values, std::optional<float> lo, std::optional<float> hi)
+{
+    if (!lo && !hi)
+        return std::nullopt;
+
+    return range_predicate{
+        values, lo.value_or(-std::numeric_limits<float>::infinity()),
+        hi.value_or(std::numeric_limits<float>::infinity())};
+}
+
+template <typename T, typename F>
+std::optional<float> map_bound(const std::optional<T>& bound, F f)
+{
+    return bound ? std::make_optional(f(*bound)) : std::nullopt;
+}
+
+}  // anonymous namespace
+
+class track_feature_index::impl
+{
+public:
+    impl() = default;
+
+    explicit impl(const std::vector<track_features>& tracks) : rows_{tracks}
+    {
+        // Where an id occurs more than once, the last occurrence is kept.
+        std::stable_sort(
+            rows_.begin(), rows_.end(), [](const auto& lhs, const auto& rhs)
+            { return lhs.id < rhs.id; });
+        std::vector<track_features> unique;
+        unique.reserve(rows_.size());
+        for (auto&& row : rows_)
+        {
+            if (!unique.empty() && unique.back().id == row.id)
+                unique.back() = row;
+            else
+                unique.push_back(row);
+        }
+
+        rows_ = std::move(unique);
+        rebuild_columns();
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return rows_.size(); }
+
+    [[nodiscard]] const track_features& row(std::size_t row) const
+    {
+        if (row >= rows_.size())
+        {
+            throw std::out_of_range{"Row is beyond the end of the index"};
+        }
+
+        return rows_[row];
+    }
+
+    [[nodiscard]] std::optional<std::size_t> row_of(int64_t id) const noexcept
+    {
+        auto iter = lower_bound(id);
+        if (iter == rows_.end() || iter->id != id)
+            return std::nullopt;
+
+        return static_cast<std::size_t>(iter - rows_.begin());
+    }
+
+    void upsert(const track_features& features)
+    {
+        auto iter = lower_bound(features.id);
+        auto row = static_cast<std::size_t>(iter - rows_.begin());
+        if (iter != rows_.end() && iter->id == features.id)
+        {
+            *iter = features;
+            set_columns(row);
+            return;
+        }
+
+        rows_.insert(iter, features);
+        bpm_.insert(bpm_.begin() + row, missing);
+        loudness_db_.insert(loudness_db_.begin() + row, missing);
+        duration_s_.insert(duration_s_.begin() + row, missing);
+        key_bits_.insert(key_bits_.begin() + row, 0);
+        resize_columns();
+        set_columns(row);
+    }
+
+    void remove(int64_t id)
+    {
+        auto row = row_of(id);
+        if (!row)
+            return;
+
+        rows_.erase(rows_.begin() + *row);
+        bpm_.erase(bpm_.begin() + *row);
+        loudness_db_.erase(loudness_db_.begin() + *row);
+        duration_s_.erase(duration_s_.begin() + *row);
+        key_bits_.erase(key_bits_.begin() + *row);
+        resize_columns();
+    }
+
+    void retain_only(std::vector<int64_t> ids)
+    {
+        std::sort(ids.begin(), ids.end());
+        auto end = std::remove_if(
+            rows_.begin(), rows_.end(), [&](const auto& row)
+            { return !std::binary_search(ids.begin(), ids.end(), row.id); });
+        if (end == rows_.end())
+            return;
+
+        rows_.erase(end, rows_.end());
+        rebuild_columns();
+    }
+
+    [[nodiscard]] track_bitset match(const track_feature_filter& filter) const
+    {
+        track_bitset result{rows_.size()};
+
+        std::array<range_predicate, 3> ranges{};
+        std::size_t range_count = 0;
+        auto add_range = [&](std::optional<range_predicate> predicate)
+        {
+            if (predicate)
+                ranges[range_count++] = *predicate;
+        };
+
+        auto narrow = [](double value) { return static_cast<float>(value); };
+        add_range(make_range_predicate(
+            bpm_.data(), map_bound(filter.min_bpm, narrow),
+            map_bound(filter.max_bpm, narrow)));
+        add_range(make_range_predicate(
+            loudness_db_.data(), map_bound(filter.min_loudness_db, narrow),
+            map_bound(filter.max_loudness_db, narrow)));
+        add_range(make_range_predicate(
+            duration_s_.data(), map_bound(filter.min_duration, to_seconds),
+            map_bound(filter.max_duration, to_seconds)));
+
+        uint32_t permitted_keys = 0;
+        if (filter.keys)
+        {
+            for (auto&& key : *filter.keys)
+                permitted_keys |= to_key_bit(key);
+        }
+
+        auto& words = result.words_;
+        for (std::size_t word = 0; word < words.size(); ++word)
+        {
+            auto offset = word * block_rows;
+            auto mask = word + 1 == words.size() ? tail_mask(rows_.size())
+                                                 : ~uint64_t{0};
+
+            // Predicates are evaluated in turn, stopping as soon as no row of
+            // the block can match.
+            for (std::size_t i = 0; i < range_count && mask != 0; ++i)
+            {
+                mask &= range_mask(
+                    ranges[i].values + offset, ranges[i].lo, ranges[i].hi);
+            }
+
+            if (filter.keys && mask != 0)
+                mask &= key_mask(key_bits_.data() + offset, permitted_keys);
+
+            words[word] = mask;
+        }
+
+        return result;
+    }
+
+private:
+    [[nodiscard]] std::vector<track_features>::const_iterator lower_bound(
+        int64_t id) const noexcept
+    {
+        return std::lower_bound(
+            rows_.begin(), rows_.end(), id,
+            [](const auto& row, int64_t id) { return row.id < id; });
+    }
+
+    [[nodiscard]] std::vector<track_features>::iterator lower_bound(
+        int64_t id) noexcept
+    {
+        return std::lower_bound(
+            rows_.begin(), rows_.end(), id,
+            [](const auto& row, int64_t id) { return row.id < id; });
+    }
+
+    void set_columns(std::size_t row) noexcept
+    {
+        auto& features = rows_[row];
+        bpm_[row] = to_bpm(features.bpm);
+        loudness_db_[row] = to_loudness_db(features.average_loudness);
+        duration_s_[row] = to_duration_s(features.duration);
+        key_bits_[row] = to_key_bit(features.key);
+    }
+
+    /// Resize the columns to fit the tracks, padding as needed.  Rows beyond
+    /// the last track must already hold padding.
+    void resize_columns()
+    {
+        auto rows = padded_rows(rows_.size());
+        bpm_.resize(rows, missing);
+        loudness_db_.resize(rows, missing);
+        duration_s_.resize(rows, missing);
+        key_bits_.resize(rows, 0);
+    }
+
+    void rebuild_columns()
+    {
+        auto rows = padded_rows(rows_.size());
+        bpm_.assign(rows, missing);
+        loudness_db_.assign(rows, missing);
+        duration_s_.assign(rows, missing);
+        key_bits_.assign(rows, 0);
+        for (std::size_t row = 0; row < rows_.size(); ++row)
+            set_columns(row);
+    }
+
+    // Features of each track, in ascending order of id, as given.
+    std::vector<track_features> rows_;
+
+    // Columns evaluated by predicates.  Missing values are NaN, or no bits in
+    // the case of keys, so that they satisfy no predicate.
+    column<float> bpm_;
+    column<float> loudness_db_;
+    column<float> duration_s_;
+    column<uint32_t> key_bits_;
+};
+
+track_bitset::track_bitset(std::size_t size) :
+    size_{size}, words_((size + 63) / 64)
+{
+}
+
+std::size_t track_bitset::count() const noexcept
+{
+    std::size_t result = 0;
+    for (auto word : words_)
+        result += static_cast<std::size_t>(std::popcount(word));
+
+    return result;
+}
+
+bool track_bitset::any() const noexcept
+{
+    return std::any_of(
+        words_.begin(), words_.end(), [](uint64_t word) { return word != 0; });
+}
+
+track_bitset& track_bitset::operator&=(const track_bitset& other)
+{
+    if (size_ != other.size_)
+    {
+        throw std::invalid_argument{"Bitsets must be the same size"};
+    }
+
+    for (std::size_t i = 0; i < words_.size(); ++i)
+        words_[i] &= other.words_[i];
+
+    return *this;
+}
+
+track_bitset& track_bitset::operator|=(const track_bitset& other)
+{
+    if (size_ != other.size_)
+    {
+        throw std::invalid_argument{"Bitsets must be the same size"};
+    }
+
+    for (std::size_t i = 0; i < words_.size(); ++i)
+        words_[i] |= other.words_[i];
+
+    return *this;
+}
+
+track_feature_index::track_feature_index() : pimpl_{std::make_unique<impl>()}
+{
+}
+
+track_feature_index::track_feature_index(
+    const std::vector<track_features>& tracks) :
+    pimpl_{std::make_unique<impl>(tracks)}
+{
+}
+
+track_feature_index::track_feature_index(const track_feature_index& other) :
+    pimpl_{std::make_unique<impl>(*other.pimpl_)}
+{
+}
+
+track_feature_index::track_feature_index(
+    track_feature_index&& other) noexcept = default;
+
+track_feature_index::~track_feature_index() = default;
+
+track_feature_index& track_feature_index::operator=(
+    const track_feature_index& other)
+{
+    if (this != &other)
+        pimpl_ = std::make_unique<impl>(*other.pimpl_);
+
+    return *this;
+}
+
+track_feature_index& track_feature_index::operator=(
+    track_feature_index&& other) noexcept = default;
+
+std::size_t track_feature_index::size() const noexcept
+{
+    return pimpl_ ? pimpl_->size() : 0;
+}
+
+int64_t track_feature_index::id_at(std::size_t row) const
+{
+    return pimpl_->row(row).id;
+}
+
+std::optional<std::size_t> track_feature_index::row_of(
+    int64_t id) const noexcept
+{
+    return pimpl_->row_of(id);
+}
+
+const track_features& track_feature_index::features_at(std::size_t row) const
+{
+    return pimpl_->row(row);
+}
+
+void track_feature_index::upsert(const track_features& features)
+{
+    pimpl_->upsert(features);
+}
+
+void track_feature_index::remove(int64_t id)
+{
+    pimpl_->remove(id);
+}
+
+void track_feature_index::retain_only(std::vector<int64_t> ids)
+{
+    pimpl_->retain_only(std::move(ids));
+}
+
+track_bitset track_feature_index::match(
+    const track_feature_filter& filter) const
+{
+    return pimpl_->match(filter);
+}
+
+track_bitset track_feature_index::compatible_with(
+    int64_t id, double bpm_tolerance, double loudness_tolerance_db) const
+{
+    if (bpm_tolerance < 0 || loudness_tolerance_db < 0)
+    {
+        throw std::invalid_argument{"Tolerances must not be negative"};
+    }
+
+    auto row = pimpl_->row_of(id);
+    if (!row)
+    {
+        throw track_deleted{id};
+    }
+
+    auto& features = pimpl_->row(*row);
+    track_feature_filter filter;
+    if (features.bpm)
+    {
+        filter.min_bpm = *features.bpm * (1 - bpm_tolerance);
+        filter.max_bpm = *features.bpm * (1 + bpm_tolerance);
+    }
+
+    if (features.key)
+        filter.keys = harmonically_compatible_keys(*features.key);
+
+    if (features.average_loudness && *features.average_loudness > 0)
+    {
+        auto loudness_db = to_decibels(*features.average_loudness);
+        filter.min_loudness_db = loudness_db - loudness_tolerance_db;
+        filter.max_loudness_db = loudness_db + loudness_tolerance_db;
+    }
+
+    auto result = pimpl_->match(filter);
+    result.reset(*row);
+    return result;
+}
+
+std::vector<int64_t> track_feature_index::ids(const track_bitset& rows) const
+{
+    if (rows.size() != size())
+    {
+        throw std::invalid_argument{
+            "Bitset must have one bit for each row of the index"};
+    }
+
+    std::vector<int64_t> results;
+    results.reserve(rows.count());
+    auto& words = rows.words();
+    for (std::size_t word = 0; word < words.size(); ++word)
+    {
+        for (auto bits = words[word]; bits != 0; bits &= bits - 1)
+        {
+            auto row = word * 64 + std::countr_zero(bits);
+            results.push_back(pimpl_->row(row).id);
+        }
+    }
+
+    return results;
+}
+
+std::vector<musical_key> harmonically_compatible_keys(musical_key key)
+{
+    // Keys are enumerated in order around the Camelot wheel, alternating
+    // between each major key and its relative minor.  Moving two places
+    // around the enumeration is therefore moving one place around the wheel.
+    auto value = static_cast<int>(key);
+    return {
+        key, static_cast<musical_key>(value ^ 1),
+        static_cast<musical_key>((value + 2) % 24),
+        static_cast<musical_key>((value + 22) % 24)};
+}
+
+}  // namespace djinterop
@@ -0,0 +1,110 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <djinterop/track_query.hpp>
+
+#include "impl/database_impl.hpp"
+#include "util/sql_trace.hpp"
+
+namespace djinterop
+{
+track_query::track_query(std::shared_ptr<database_impl> db) :
+    db_{std::move(db)}
+{
+}
+
+track_query& track_query::bpm_between(double min_bpm, double max_bpm)
+{
+    if (min_bpm > max_bpm)
+    {
+        throw std::invalid_argument{
+            "Lower bound on BPM must not exceed the upper bound"};
+    }
+
+    criteria_.min_bpm = min_bpm;
+    criteria_.max_bpm = max_bpm;
+    return *this;
+}
+
+track_query& track_query::key_in(std::vector<musical_key> keys)
+{
+    criteria_.keys = std::move(keys);
+    return *this;
+}
+
+track_query& track_query::genre(std::string genre)
+{
+    criteria_.genre = std::move(genre);
+    return *this;
+}
+
+track_query& track_query::artist(std::string artist)
+{
+    criteria_.artist = std::move(artist);
+    return *this;
+}
+
+track_query& track_query::rating_at_least(int min_rating)
+{
+    criteria_.min_rating = min_rating;
+    return *this;
+}
+
+track_query& track_query::year_between(int min_year, int max_year)
+{
+    if (min_year > max_year)
+    {
+        throw std::invalid_argument{
+            "Lower bound on year must not exceed the upper bound"};
+    }
+
+    criteria_.min_year = min_year;
+    criteria_.max_year = max_year;
+    return *this;
+}
+
+track_query& track_query::order_by(track_order order, bool descending)
+{
+    criteria_.order = order;
+    criteria_.descending = descending;
+    return *this;
+}
+
+track_query& track_query::limit(std::size_t count)
+{
+    criteria_.limit = count;
+    return *this;
+}
+
+std::vector<int64_t> track_query::ids() const
+{
+    util::api_operation operation{"track_query::ids"};
+    return db_->query_track_ids(criteria_);
+}
+
+std::vector<track_query_row> track_query::rows() const
+{
+    util::api_operation operation{"track_query::rows"};
+    return db_->query_track_rows(criteria_);
+}
+
+}  // namespace djinterop
@@ -0,0 +1,569 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/track_similarity_index.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <djinterop/exceptions.hpp>
+
+#include "util/parallel_for.hpp"
+
+namespace djinterop
+{
+namespace
+{
+/// Number of coordinates of each point: tempo, two for the position of the
+/// key on the Camelot wheel, mode, loudness, and duration.
+constexpr std::size_t dimensions = 6;
+
+/// Largest number of points in a leaf of the tree.
+constexpr std::size_t leaf_size = 8;
+
+/// Smallest number of pending changes that triggers a rebuild of the tree.
+constexpr std::size_t min_rebuild_changes = 256;
+
+/// Ratio of tempos that is one unit apart.
+constexpr double tempo_unit = 1.06;
+
+/// Difference in loudness that is one unit apart, in decibels.
+constexpr double loudness_unit_db = 3;
+
+/// Weight of the logarithm, to base two, of duration.
+constexpr double duration_weight = 0.5;
+
+/// Distance between tracks of differing genres.
+constexpr float genre_distance = 1;
+
+/// Values assumed for tracks lacking a loudness or a duration.
+constexpr double typical_loudness_db = -9;
+constexpr double typical_duration_s = 240;
+
+using point = std::array<float, dimensions>;
+
+struct entry
+{
+    int64_t id;
+    point coordinates;
+
+    /// Interned genre, or zero for none.
+    uint32_t genre;
+};
+
+/// Place a key on a circle of keys, on which neighbouring positions on the
+/// Camelot wheel are one unit apart, along with its mode.
+std::array<float, 3> key_coordinates(const std::optional<musical_key>& key)
+{
+    auto value = key ? static_cast<int>(*key) : -1;
+    if (value < 0 || value >= 24)
+    {
+        // Equidistant from every key.
+        return {0, 0, 0.5f};
+    }
+
+    // Keys are enumerated around the wheel, alternating between major and
+    // relative minor.
+    auto radius = 1 / (2 * std::sin(std::numbers::pi / 12));
+    auto angle = 2 * std::numbers::pi * (value / 2) / 12;
+    return {
+        static_cast<float>(radius * std::cos(angle)),
+        static_cast<float>(radius * std::sin(angle)),
+        static_cast<float>(value % 2)};
+}
+
+float squared_distance(const entry& lhs, const entry& rhs) noexcept
+{
+    float result = 0;
+    for (std::size_t i = 0; i < dimensions; ++i)
+    {
+        auto d = lhs.coordinates[i] - rhs.coordinates[i];
+        result += d * d;
+    }
+
+    if (lhs.genre == 0 || lhs.genre != rhs.genre)
+        result += genre_distance * genre_distance;
+
+    return result;
+}
+
+/// Bounded set of the nearest entries found so far.
+class nearest_set
+{
+public:
+    explicit nearest_set(std::size_t k) : k_{k} { heap_.reserve(k + 1); }
+
+    /// Get the squared distance that an entry must not exceed in order to be
+    /// added.
+    [[nodiscard]] float bound() const noexcept
+    {
+        return heap_.size() < k_ ? std::numeric_limits<float>::infinity()
+                                 : heap_.front().first;
+    }
+
+    void offer(float squared_distance, int64_t id)
+    {
+        if (k_ == 0)
+            return;
+
+        std::pair<float, int64_t> candidate{squared_distance, id};
+        if (heap_.size() == k_)
+        {
+            // Ties are broken by id, so that results are deterministic.
+            if (!(candidate < heap_.front()))
+                return;
+
+            std::pop_heap(heap_.begin(), heap_.end());
+            heap_.pop_back();
+        }
+
+        heap_.push_back(candidate);
+        std::push_heap(heap_.begin(), heap_.end());
+    }
+
+    [[nodiscard]] std::vector<int64_t> ids()
+    {
+        std::sort_heap(heap_.begin(), heap_.end());
+        std::vector<int64_t> result;
+        result.reserve(heap_.size());
+        for (auto&& [distance, id] : heap_)
+            result.push_back(id);
+
+        return result;
+    }
+
+private:
+    std::size_t k_;
+    std::vector<std::pair<float, int64_t>> heap_;
+};
+
+}  // anonymous namespace
+
+class track_similarity_index::impl
+{
+public:
+    explicit impl(std::shared_ptr<const track_feature_index> features)
+    {
+        if (!features)
+        {
+            throw std::invalid_argument{"Track features must not be null"};
+        }
+
+        rebuild(std::move(features));
+    }
+
+    [[nodiscard]] const std::shared_ptr<const track_feature_index>& features()
+        const noexcept
+    {
+        return features_;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return slot_of_.size() + pending_slot_of_.size();
+    }
+
+    void update(std::shared_ptr<const track_feature_index> features)
+    {
+        if (!features)
+        {
+            throw std::invalid_argument{"Track features must not be null"};
+        }
+
+        if (features == features_)
+            return;
+
+        // Both snapshots are in order of id, so they are compared by merging.
+        auto& old_rows = *features_;
+        auto& new_rows = *features;
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < old_rows.size() || j < new_rows.size())
+        {
+            auto old_id = i < old_rows.size()
+                              ? old_rows.id_at(i)
+                              : std::numeric_limits<int64_t>::max();
+            auto new_id = j < new_rows.size()
+                              ? new_rows.id_at(j)
+                              : std::numeric_limits<int64_t>::max();
+            if (old_id < new_id)
+            {
+                erase(old_id);
+                ++i;
+            }
+            else if (new_id < old_id)
+            {
+                insert_pending(new_rows.features_at(j));
+                ++j;
+            }
+            else
+            {
+                auto& new_features = new_rows.features_at(j);
+                if (!(old_rows.features_at(i) == new_features))
+                {
+                    erase(new_id);
+                    insert_pending(new_features);
+                }
+
+                ++i;
+                ++j;
+            }
+        }
+
+        // Pending entries are searched exhaustively, and erased entries are
+        // still visited, so both slow searches down as they accumulate.
+        auto changes = pending_.size() + erased_count_;
+        if (changes > std::max(min_rebuild_changes, tree_.size() / 16))
+            rebuild(std::move(features));
+        else
+            features_ = std::move(features);
+    }
+
+    [[nodiscard]] double distance(int64_t lhs_id, int64_t rhs_id) const
+    {
+        auto lhs = find_indexed(lhs_id);
+        auto rhs = find_indexed(rhs_id);
+        if (!lhs || !rhs)
+            return std::numeric_limits<double>::infinity();
+
+        return std::sqrt(squared_distance(*lhs, *rhs));
+    }
+
+    [[nodiscard]] std::vector<int64_t> nearest(int64_t id, std::size_t k) const
+    {
+        auto query = find_indexed(id);
+        if (!query)
+            return {};
+
+        nearest_set result{k};
+        search(*query, 0, tree_.size(), result);
+        for (auto&& candidate : pending_)
+        {
+            if (candidate.id != query->id)
+                result.offer(squared_distance(*query, candidate), candidate.id);
+        }
+
+        return result.ids();
+    }
+
+private:
+    /// Find the entry for a track, if the track has a BPM.
+    ///
+    /// \throws track_deleted If the track is not in the snapshot.
+    [[nodiscard]] const entry* find_indexed(int64_t id) const
+    {
+        if (auto iter = slot_of_.find(id); iter != slot_of_.end())
+            return &tree_[iter->second];
+
+        if (auto iter = pending_slot_of_.find(id);
+            iter != pending_slot_of_.end())
+        {
+            return &pending_[iter->second];
+        }
+
+        if (!features_->row_of(id))
+        {
+            throw track_deleted{id};
+        }
+
+        return nullptr;
+    }
+
+    [[nodiscard]] std::optional<entry> make_entry(
+        const track_features& features)
+    {
+        if (!features.bpm || !(*features.bpm > 0))
+            return std::nullopt;
+
+        entry result{};
+        result.id = features.id;
+        auto key = key_coordinates(features.key);
+        auto loudness_db =
+            features.average_loudness && *features.average_loudness > 0
+                ? 20 * std::log10(*features.average_loudness)
+                : typical_loudness_db;
+        auto duration_s = features.duration && features.duration->count() > 0
+                              ? features.duration->count() / 1000.0
+                              : typical_duration_s;
+        result.coordinates = {
+            static_cast<float>(std::log(*features.bpm) / std::log(tempo_unit)),
+            key[0],
+            key[1],
+            key[2],
+            static_cast<float>(loudness_db / loudness_unit_db),
+            static_cast<float>(duration_weight * std::log2(duration_s))};
+        if (features.genre)
+        {
+            auto [iter, inserted] = genres_.try_emplace(
+                *features.genre, static_cast<uint32_t>(genres_.size() + 1));
+            result.genre = iter->second;
+        }
+
+        return result;
+    }
+
+    void insert_pending(const track_features& features)
+    {
+        auto new_entry = make_entry(features);
+        if (!new_entry)
+            return;
+
+        pending_slot_of_[new_entry->id] = pending_.size();
+        pending_.push_back(*new_entry);
+    }
+
+    void erase(int64_t id)
+    {
+        if (auto iter = slot_of_.find(id); iter != slot_of_.end())
+        {
+            erased_[iter->second] = 1;
+            ++erased_count_;
+            slot_of_.erase(iter);
+            return;
+        }
+
+        if (auto iter = pending_slot_of_.find(id);
+            iter != pending_slot_of_.end())
+        {
+            // Move the last pending entry into the vacated slot.
+            auto slot = iter->second;
+            pending_slot_of_.erase(iter);
+            if (slot + 1 != pending_.size())
+            {
+                pending_[slot] = pending_.back();
+                pending_slot_of_[pending_[slot].id] = slot;
+            }
+
+            pending_.pop_back();
+        }
+    }
+
+    void rebuild(std::shared_ptr<const track_feature_index> features)
+    {
+        features_ = std::move(features);
+        tree_.clear();
+        pending_.clear();
+        pending_slot_of_.clear();
+        slot_of_.clear();
+        genres_.clear();
+        erased_count_ = 0;
+
+        tree_.reserve(features_->size());
+        for (std::size_t row = 0; row < features_->size(); ++row)
+        {
+            if (auto new_entry = make_entry(features_->features_at(row)))
+                tree_.push_back(*new_entry);
+        }
+
+        split_dimension_.assign(tree_.size(), 0);
+        build(0, tree_.size());
+
+        erased_.assign(tree_.size(), 0);
+        slot_of_.reserve(tree_.size());
+        for (std::size_t slot = 0; slot < tree_.size(); ++slot)
+            slot_of_.emplace(tree_[slot].id, slot);
+    }
+
+    /// Arrange the entries in a range as a subtree, with the entry at the
+    /// midpoint of the range splitting the remainder along the dimension of
+    /// greatest spread.
+    void build(std::size_t lo, std::size_t hi)
+    {
+        if (hi - lo <= leaf_size)
+            return;
+
+        point min_coordinates = tree_[lo].coordinates;
+        point max_coordinates = tree_[lo].coordinates;
+        for (auto i = lo + 1; i < hi; ++i)
+        {
+            for (std::size_t d = 0; d < dimensions; ++d)
+            {
+                min_coordinates[d] =
+                    std::min(min_coordinates[d], tree_[i].coordinates[d]);
+                max_coordinates[d] =
+                    std::max(max_coordinates[d], tree_[i].coordinates[d]);
+            }
+        }
+
+        uint8_t dimension = 0;
+        for (uint8_t d = 1; d < dimensions; ++d)
+        {
+            if (max_coordinates[d] - min_coordinates[d] >
+                max_coordinates[dimension] - min_coordinates[dimension])
+            {
+                dimension = d;
+            }
+        }
+
+        auto mid = lo + (hi - lo) / 2;
+        std::nth_element(
+            tree_.begin() + lo, tree_.begin() + mid, tree_.begin() + hi,
+            [&](const entry& lhs, const entry& rhs) {
+                return lhs.coordinates[dimension] < rhs.coordinates[dimension];
+            });
+        split_dimension_[mid] = dimension;
+        build(lo, mid);
+        build(mid + 1, hi);
+    }
+
+    void search(
+        const entry& query, std::size_t lo, std::size_t hi,
+        nearest_set& result) const
+    {
+        auto offer = [&](std::size_t slot)
+        {
+            auto& candidate = tree_[slot];
+            if (!erased_[slot] && candidate.id != query.id)
+                result.offer(squared_distance(query, candidate), candidate.id);
+        };
+
+        if (hi - lo <= leaf_size)
+        {
+            for (auto slot = lo; slot < hi; ++slot)
+                offer(slot);
+
+            return;
+        }
+
+        auto mid = lo + (hi - lo) / 2;
+        auto dimension = split_dimension_[mid];
+        auto offset =
+            query.coordinates[dimension] - tree_[mid].coordinates[dimension];
+
+        // Entries on the far side of the splitting plane are at least as far
+        // away as the plane itself.
+        if (offset < 0)
+        {
+            search(query, lo, mid, result);
+            offer(mid);
+            if (offset * offset <= result.bound())
+                search(query, mid + 1, hi, result);
+        }
+        else
+        {
+            search(query, mid + 1, hi, result);
+            offer(mid);
+            if (offset * offset <= result.bound())
+                search(query, lo, mid, result);
+        }
+    }
+
+    std::shared_ptr<const track_feature_index> features_;
+
+    // Entries in the tree, arranged by `build()`, with the dimension along
+    // which each interior node splits its subtree.  Erased entries remain in
+    // place until the tree is next rebuilt.
+    std::vector<entry> tree_;
+    std::vector<uint8_t> split_dimension_;
+    std::vector<uint8_t> erased_;
+    std::size_t erased_count_ = 0;
+    std::unordered_map<int64_t, std::size_t> slot_of_;
+
+    // Entries added since the tree was last built.
+    std::vector<entry> pending_;
+    std::unordered_map<int64_t, std::size_t> pending_slot_of_;
+
+    std::unordered_map<std::string, uint32_t> genres_;
+};
+
+track_similarity_index::track_similarity_index(
+    std::shared_ptr<const track_feature_index> features) :
+    pimpl_{std::make_unique<impl>(std::move(features))}
+{
+}
+
+track_similarity_index::track_similarity_index(
+    const track_similarity_index& other) :
+    pimpl_{std::make_unique<impl>(*other.pimpl_)}
+{
+}
+
+track_similarity_index::track_similarity_index(
+    track_similarity_index&& other) noexcept = default;
+
+track_similarity_index::~track_similarity_index() = default;
+
+track_similarity_index& track_similarity_index::operator=(
+    const track_similarity_index& other)
+{
+    if (this != &other)
+        pimpl_ = std::make_unique<impl>(*other.pimpl_);
+
+    return *this;
+}
+
+track_similarity_index& track_similarity_index::operator=(
+    track_similarity_index&& other) noexcept = default;
+
+const std::shared_ptr<const track_feature_index>&
+track_similarity_index::features() const noexcept
+{
+    return pimpl_->features();
+}
+
+std::size_t track_similarity_index::size() const noexcept
+{
+    return pimpl_->size();
+}
+
+void track_similarity_index::update(
+    std::shared_ptr<const track_feature_index> features)
+{
+    pimpl_->update(std::move(features));
+}
+
+double track_similarity_index::distance(int64_t lhs_id, int64_t rhs_id) const
+{
+    return pimpl_->distance(lhs_id, rhs_id);
+}
+
+std::vector<int64_t> track_similarity_index::nearest(
+    int64_t id, std::size_t k) const
+{
+    return pimpl_->nearest(id, k);
+}
+
+std::vector<std::vector<int64_t>> track_similarity_index::nearest(
+    const std::vector<int64_t>& ids, std::size_t k,
+    std::size_t max_workers) const
+{
+    // Unknown tracks are reported before any work is started.
+    for (auto id : ids)
+    {
+        if (!pimpl_->features()->row_of(id))
+        {
+            throw track_deleted{id};
+        }
+    }
+
+    std::vector<std::vector<int64_t>> results(ids.size());
+    util::parallel_for(
+        ids.size(), max_workers,
+        [&](std::size_t i) { results[i] = pimpl_->nearest(ids[i], k); });
+
+    return results;
+}
+
+}  // namespace djinterop
@@ -0,0 +1,438 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "file_transfer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "filesystem.hpp"
+
+namespace djinterop::util
+{
+namespace
+{
+/// Maximum number of bytes to copy in one system call.
+constexpr int64_t copy_chunk_size = 8 * 1024 * 1024;
+
+const std::string part_file_suffix = ".part";
+
+std::runtime_error make_io_error(
+    const std::string& message, const std::string& path)
+{
+    return std::runtime_error{
+        message + " '" + path + "': " + std::strerror(errno)};
+}
+
+/// Check that the whole of a source file was copied, as a file truncated
+/// whilst being copied would otherwise yield a short copy without error.
+void check_copied_size(
+    int64_t copied, int64_t size, const std::string& source_path)
+{
+    if (copied != size)
+    {
+        errno = EIO;
+        throw make_io_error(
+            "Copied " + std::to_string(copied) + " of " +
+                std::to_string(size) + " bytes of source file",
+            source_path);
+    }
+}
+
+#if defined(__linux__)
+/// Closes a file descriptor upon destruction.
+class fd_guard
+{
+public:
+    explicit fd_guard(int fd) : fd_{fd} {}
+    fd_guard(const fd_guard&) = delete;
+    fd_guard& operator=(const fd_guard&) = delete;
+    ~fd_guard()
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+    }
+
+    [[nodiscard]] int get() const { return fd_; }
+
+    int release()
+    {
+        auto fd = fd_;
+        fd_ = -1;
+        return fd;
+    }
+
+private:
+    int fd_;
+};
+
+void copy_file_contents(
+    const std::string& source_path, const std::string& target_path,
+    const std::function<void(int64_t)>& on_bytes)
+{
+    fd_guard in{::open(source_path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (in.get() < 0)
+        throw make_io_error("Failed to open source file", source_path);
+
+    struct stat buf;
+    if (::fstat(in.get(), &buf) != 0)
+        throw make_io_error("Failed to stat source file", source_path);
+
+    fd_guard out{::open(
+        target_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+    if (out.get() < 0)
+        throw make_io_error("Failed to open target file", target_path);
+
+    // Prefer an in-kernel copy (which may even be offloaded to the filesystem
+    // or device), falling back to progressively more general mechanisms if a
+    // given one is unsupported for the pair of files involved.
+    enum class method
+    {
+        copy_file_range,
+        sendfile,
+        read_write,
+    };
+
+    auto current_method = method::copy_file_range;
+    std::vector<char> buffer;
+    const auto size = static_cast<int64_t>(buf.st_size);
+    int64_t copied = 0;
+    while (copied < size)
+    {
+        const auto chunk =
+            static_cast<size_t>(std::min(size - copied, copy_chunk_size));
+        ssize_t n = -1;
+        switch (current_method)
+        {
+            case method::copy_file_range:
+                n = ::copy_file_range(
+                    in.get(), nullptr, out.get(), nullptr, chunk, 0);
+                if (n < 0 && (errno == EXDEV || errno == ENOSYS ||
+                              errno == EINVAL || errno == EOPNOTSUPP))
+                {
+                    current_method = method::sendfile;
+                    continue;
+                }
+                break;
+
+            case method::sendfile:
+                n = ::sendfile(out.get(), in.get(), nullptr, chunk);
+                if (n < 0 && (errno == ENOSYS || errno == EINVAL))
+                {
+                    current_method = method::read_write;
+                    continue;
+                }
+                break;
+
+            case method::read_write:
+                buffer.resize(chunk);
+                n = ::read(in.get(), buffer.data(), chunk);
+                if (n > 0)
+                {
+                    ssize_t written = 0;
+                    while (written < n)
+                    {
+                        auto w = ::write(
+                            out.get(), buffer.data() + written, n - written);
+                        if (w < 0 && errno == EINTR)
+                            continue;
+
+                        if (w < 0)
+                        {
+                            throw make_io_error(
+                                "Failed to write target file", target_path);
+                        }
+
+                        written += w;
+                    }
+                }
+                break;
+        }
+
+        if (n < 0 && errno == EINTR)
+            continue;
+
+        if (n < 0)
+            throw make_io_error("Failed to copy to target file", target_path);
+
+        if (n == 0)
+            break;  // The source file was truncated whilst being copied.
+
+        copied += n;
+        on_bytes(n);
+    }
+
+    check_copied_size(copied, size, source_path);
+    if (::close(out.release()) != 0)
+        throw make_io_error("Failed to close target file", target_path);
+}
+#else
+void copy_file_contents(
+    const std::string& source_path, const std::string& target_path,
+    const std::function<void(int64_t)>& on_bytes)
+{
+    std::ifstream in{source_path, std::ios::binary | std::ios::ate};
+    if (!in)
+        throw make_io_error("Failed to open source file", source_path);
+
+    const auto size = static_cast<int64_t>(in.tellg());
+    in.seekg(0);
+    if (size < 0 || !in)
+        throw make_io_error("Failed to stat source file", source_path);
+
+    std::ofstream out{target_path, std::ios::binary | std::ios::trunc};
+    if (!out)
+        throw make_io_error("Failed to open target file", target_path);
+
+    std::vector<char> buffer(copy_chunk_size);
+    int64_t copied = 0;
+    while (in && copied < size)
+    {
+        in.read(
+            buffer.data(),
+            std::min<std::streamsize>(buffer.size(), size - copied));
+        auto n = in.gcount();
+        if (n <= 0)
+            break;
+
+        out.write(buffer.data(), n);
+        if (!out)
+            throw make_io_error("Failed to write target file", target_path);
+
+        copied += n;
+        on_bytes(n);
+    }
+
+    check_copied_size(copied, size, source_path);
+
+    out.close();
+    if (!out)
+        throw make_io_error("Failed to close target file", target_path);
+}
+#endif
+
+/// Read a manifest of completed copies, mapping target path to size.
+std::unordered_map<std::string, int64_t> read_manifest(const std::string& path)
+{
+    std::unordered_map<std::string, int64_t> results;
+    std::ifstream in{path};
+    int64_t size;
+    std::string target_path;
+    while (in >> size && in.get() == '\t' && std::getline(in, target_path))
+        results[target_path] = size;
+
+    return results;
+}
+
+class file_transferrer
+{
+public:
+    file_transferrer(
+        const std::vector<file_transfer_item>& items,
+        const engine::file_transfer_options& options) :
+        items_{items}, options_{options}
+    {
+        progress_.files_total = static_cast<int64_t>(items.size());
+        if (!options.manifest_path.empty())
+        {
+            completed_ = read_manifest(options.manifest_path);
+            manifest_.open(options.manifest_path, std::ios::app);
+            if (!manifest_)
+            {
+                throw make_io_error(
+                    "Failed to open manifest", options.manifest_path);
+            }
+        }
+    }
+
+    engine::file_transfer_report run()
+    {
+        auto worker_count = std::min<size_t>(
+            std::max(options_.max_workers, 1u), items_.size());
+        if (worker_count <= 1)
+        {
+            work();
+        }
+        else
+        {
+            std::vector<std::thread> workers;
+            workers.reserve(worker_count);
+            for (size_t i = 0; i < worker_count; ++i)
+                workers.emplace_back([this] { work(); });
+
+            for (auto&& worker : workers)
+                worker.join();
+        }
+
+        report_.bytes_copied = progress_.bytes_copied;
+        report_.elapsed = std::chrono::steady_clock::now() - start_;
+        report_.bytes_per_second = bytes_per_second(
+            report_.bytes_copied, report_.elapsed);
+        return std::move(report_);
+    }
+
+private:
+    static double bytes_per_second(
+        int64_t bytes, std::chrono::steady_clock::duration elapsed)
+    {
+        auto seconds = std::chrono::duration<double>(elapsed).count();
+        return seconds > 0 ? static_cast<double>(bytes) / seconds : 0;
+    }
+
+    void work()
+    {
+        for (;;)
+        {
+            auto index = next_item_++;
+            if (index >= items_.size())
+                return;
+
+            process(items_[index]);
+        }
+    }
+
+    bool is_already_present(const file_transfer_item& item)
+    {
+        auto target_size = get_file_size(item.target_path);
+        if (!target_size)
+            return false;
+
+        // Files recorded in the manifest are trusted without needing to
+        // touch the (possibly slow) source media again.
+        auto iter = completed_.find(item.target_path);
+        if (iter != completed_.end() && iter->second == *target_size)
+            return true;
+
+        auto expected_size = item.expected_size;
+        if (!expected_size)
+            expected_size = get_file_size(item.source_path);
+
+        return expected_size == target_size;
+    }
+
+    void process(const file_transfer_item& item)
+    {
+        try
+        {
+            if (is_already_present(item))
+            {
+                std::lock_guard lock{mutex_};
+                ++report_.files_skipped;
+                complete_file();
+                return;
+            }
+
+            auto part_path = item.target_path + part_file_suffix;
+            create_dirs(get_parent_dir(item.target_path));
+
+            int64_t file_bytes = 0;
+            copy_file_contents(
+                item.source_path, part_path,
+                [&](int64_t n)
+                {
+                    file_bytes += n;
+                    std::lock_guard lock{mutex_};
+                    progress_.bytes_copied += n;
+                    notify();
+                });
+
+            std::remove(item.target_path.c_str());
+            if (std::rename(part_path.c_str(), item.target_path.c_str()) != 0)
+            {
+                throw make_io_error(
+                    "Failed to rename target file", item.target_path);
+            }
+
+            std::lock_guard lock{mutex_};
+            ++report_.files_copied;
+            if (manifest_.is_open())
+            {
+                manifest_ << file_bytes << '\t' << item.target_path << '\n';
+                manifest_.flush();
+            }
+
+            complete_file();
+        }
+        catch (const std::exception& e)
+        {
+            std::remove((item.target_path + part_file_suffix).c_str());
+            std::lock_guard lock{mutex_};
+            report_.failures.emplace_back(item.source_path, e.what());
+            complete_file();
+        }
+    }
+
+    /// Record that a file has been processed.  Must be called with the mutex
+    /// held.
+    void complete_file()
+    {
+        ++progress_.files_done;
+        notify();
+    }
+
+    /// Report progress to the caller.  Must be called with the mutex held.
+    void notify()
+    {
+        if (!options_.on_progress)
+            return;
+
+        progress_.elapsed = std::chrono::steady_clock::now() - start_;
+        progress_.bytes_per_second =
+            bytes_per_second(progress_.bytes_copied, progress_.elapsed);
+        options_.on_progress(progress_);
+    }
+
+    const std::vector<file_transfer_item>& items_;
+    const engine::file_transfer_options& options_;
+    const std::chrono::steady_clock::time_point start_ =
+        std::chrono::steady_clock::now();
+    std::unordered_map<std::string, int64_t> completed_;
+    std::atomic<size_t> next_item_{0};
+    std::mutex mutex_;
+    std::ofstream manifest_;
+    engine::file_transfer_progress progress_;
+    engine::file_transfer_report report_;
+};
+
+}  // namespace
+
+engine::file_transfer_report transfer_files(
+    const std::vector<file_transfer_item>& items,
+    const engine::file_transfer_options& options)
+{
+    file_transferrer transferrer{items, options};
+    return transferrer.run();
+}
+
+}  // namespace djinterop::util
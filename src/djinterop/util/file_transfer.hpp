@@ -0,0 +1,51 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <djinterop/engine/library_export.hpp>
+
+namespace djinterop::util
+{
+/// A single file to be copied by `transfer_files`.
+struct file_transfer_item
+{
+    std::string source_path;
+    std::string target_path;
+
+    /// Expected size of the file, if known.  A file already present at the
+    /// target with this size is considered complete.  If not known, the size
+    /// of the source file is used instead.
+    std::optional<int64_t> expected_size;
+};
+
+/// Copy a set of files, using a bounded number of parallel workers.
+///
+/// Files already present at the target with the expected size, or which are
+/// recorded in the manifest (if any), are skipped.  Each file is first written
+/// to a temporary `.part` file and then renamed, so that an interrupted copy
+/// is never mistaken for a complete one.
+engine::file_transfer_report transfer_files(
+    const std::vector<file_transfer_item>& items,
+    const engine::file_transfer_options& options);
+
+}  // namespace djinterop::util
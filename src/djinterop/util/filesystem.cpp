@@ -38,6 +38,18 @@ void create_dir(const std::string& directory)
     }
 }
 
+void create_dirs(const std::string& directory)
+{
+    if (directory.empty() || path_exists(directory))
+        return;
+
+    auto parent = get_parent_dir(directory);
+    if (!parent.empty() && parent != directory)
+        create_dirs(parent);
+
+    create_dir(directory);
+}
+
 bool path_exists(const std::string& directory)
 {
     struct stat buf;
@@ -63,4 +75,25 @@ std::optional<std::string> get_file_extension(const std::string& file_path)
     return file_extension;
 }
 
+std::optional<int64_t> get_file_size(const std::string& file_path)
+{
+    struct stat buf;
+    if (stat(file_path.c_str(), &buf) != 0 ||
+        (buf.st_mode & S_IFMT) != S_IFREG)
+    {
+        return std::nullopt;
+    }
+
+    return static_cast<int64_t>(buf.st_size);
+}
+
+std::string get_parent_dir(const std::string& file_path)
+{
+    auto slash_pos = file_path.find_last_of('/');
+    if (slash_pos == std::string::npos)
+        return {};
+
+    return file_path.substr(0, slash_pos);
+}
+
 }  // namespace djinterop::util
@@ -17,14 +17,18 @@
 
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <string>
 
 namespace djinterop::util
 {
 void create_dir(const std::string& directory);
+void create_dirs(const std::string& directory);
 bool path_exists(const std::string& directory);
 std::string get_filename(const std::string& file_path);
 std::optional<std::string> get_file_extension(const std::string& file_path);
+std::optional<int64_t> get_file_size(const std::string& file_path);
+std::string get_parent_dir(const std::string& file_path);
 
 }  // namespace djinterop::util
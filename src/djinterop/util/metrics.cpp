@@ -0,0 +1,124 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metrics.hpp"
+
+#include <array>
+#include <utility>
+
+namespace djinterop::util
+{
+namespace
+{
+struct blob_counters
+{
+    std::atomic<uint64_t> encoded{0};
+    std::atomic<uint64_t> decoded{0};
+    std::atomic<uint64_t> compressed_bytes{0};
+    std::atomic<uint64_t> uncompressed_bytes{0};
+    std::atomic<uint64_t> encode_ns{0};
+    std::atomic<uint64_t> decode_ns{0};
+};
+
+struct codec_counters
+{
+    std::atomic<uint64_t> zlib_compress_ns{0};
+    std::atomic<uint64_t> zlib_uncompress_ns{0};
+    std::array<blob_counters, blob_type_count> blobs;
+};
+
+codec_counters& counters() noexcept
+{
+    static codec_counters instance;
+    return instance;
+}
+
+void record_blob_size(
+    blob_counters& target, const std::vector<std::byte>& blob,
+    bool compressed) noexcept
+{
+    add_to(target.compressed_bytes, blob.size());
+
+    // Compressed blobs are prefixed with their big-endian uncompressed size.
+    uint64_t uncompressed_size = blob.size();
+    if (compressed)
+    {
+        uncompressed_size = 0;
+        if (blob.size() >= 4)
+        {
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                uncompressed_size =
+                    (uncompressed_size << 8) | static_cast<uint8_t>(blob[i]);
+            }
+        }
+    }
+
+    add_to(target.uncompressed_bytes, uncompressed_size);
+}
+
+}  // anonymous namespace
+
+void record_zlib_compress(uint64_t elapsed_ns) noexcept
+{
+    add_to(counters().zlib_compress_ns, elapsed_ns);
+}
+
+void record_zlib_uncompress(uint64_t elapsed_ns) noexcept
+{
+    add_to(counters().zlib_uncompress_ns, elapsed_ns);
+}
+
+std::vector<std::byte> blob_encode_timer::record(
+    std::vector<std::byte> blob) const noexcept
+{
+    auto& target = counters().blobs[static_cast<std::size_t>(type_)];
+    add_to(target.encode_ns, stopwatch_.elapsed_ns());
+    add_to(target.encoded);
+    record_blob_size(target, blob, compressed_);
+    return blob;
+}
+
+blob_decode_timer::~blob_decode_timer()
+{
+    auto& target = counters().blobs[static_cast<std::size_t>(type_)];
+    add_to(target.decode_ns, stopwatch_.elapsed_ns());
+    add_to(target.decoded);
+    record_blob_size(target, blob_, compressed_);
+}
+
+void snapshot_codec_metrics(database_metrics& metrics) noexcept
+{
+    auto& source = counters();
+    metrics.zlib_compress_time =
+        std::chrono::nanoseconds{read(source.zlib_compress_ns)};
+    metrics.zlib_uncompress_time =
+        std::chrono::nanoseconds{read(source.zlib_uncompress_ns)};
+    for (std::size_t i = 0; i < blob_type_count; ++i)
+    {
+        auto& from = source.blobs[i];
+        auto& to = metrics.blobs[i];
+        to.encoded = read(from.encoded);
+        to.decoded = read(from.decoded);
+        to.compressed_bytes = read(from.compressed_bytes);
+        to.uncompressed_bytes = read(from.uncompressed_bytes);
+        to.encode_time = std::chrono::nanoseconds{read(from.encode_ns)};
+        to.decode_time = std::chrono::nanoseconds{read(from.decode_ns)};
+    }
+}
+
+}  // namespace djinterop::util
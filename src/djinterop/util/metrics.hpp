@@ -0,0 +1,127 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <djinterop/database_metrics.hpp>
+
+namespace djinterop::util
+{
+/// Add to a counter.  Counters are only ever read as a snapshot for reporting
+/// purposes, and so relaxed ordering is sufficient.
+inline void add_to(std::atomic<uint64_t>& counter, uint64_t value = 1) noexcept
+{
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+/// Read a counter.
+inline uint64_t read(const std::atomic<uint64_t>& counter) noexcept
+{
+    return counter.load(std::memory_order_relaxed);
+}
+
+/// Simple stopwatch measuring elapsed wall-clock time.
+class stopwatch
+{
+public:
+    stopwatch() noexcept : start_{std::chrono::steady_clock::now()} {}
+
+    /// Get the time elapsed since the stopwatch was started, in nanoseconds.
+    [[nodiscard]] uint64_t elapsed_ns() const noexcept
+    {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_)
+                .count());
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+/// Record time spent compressing data with zlib.
+void record_zlib_compress(uint64_t elapsed_ns) noexcept;
+
+/// Record time spent decompressing data with zlib.
+void record_zlib_uncompress(uint64_t elapsed_ns) noexcept;
+
+/// The `blob_encode_timer` class times the encoding of a blob.
+class blob_encode_timer
+{
+public:
+    /// Start timing the encoding of a blob.
+    ///
+    /// \param type Kind of blob being encoded.
+    /// \param compressed Whether the encoded blob is compressed.
+    explicit blob_encode_timer(blob_type type, bool compressed = true) noexcept :
+        type_{type}, compressed_{compressed}
+    {
+    }
+
+    /// Record the encoded blob.
+    ///
+    /// \param blob Encoded blob.
+    /// \return Returns the blob, unchanged.
+    std::vector<std::byte> record(std::vector<std::byte> blob) const noexcept;
+
+private:
+    stopwatch stopwatch_;
+    blob_type type_;
+    bool compressed_;
+};
+
+/// The `blob_decode_timer` class times the decoding of a blob, which is
+/// recorded when the timer goes out of scope.
+class blob_decode_timer
+{
+public:
+    /// Start timing the decoding of a blob.
+    ///
+    /// \param type Kind of blob being decoded.
+    /// \param blob Blob being decoded, which must outlive the timer.
+    /// \param compressed Whether the blob is compressed.
+    blob_decode_timer(
+        blob_type type, const std::vector<std::byte>& blob,
+        bool compressed = true) noexcept :
+        type_{type}, blob_{blob}, compressed_{compressed}
+    {
+    }
+
+    ~blob_decode_timer();
+
+    blob_decode_timer(const blob_decode_timer&) = delete;
+    blob_decode_timer& operator=(const blob_decode_timer&) = delete;
+
+private:
+    stopwatch stopwatch_;
+    blob_type type_;
+    const std::vector<std::byte>& blob_;
+    bool compressed_;
+};
+
+/// Populate the process-wide blob and zlib counters of a metrics snapshot.
+///
+/// \param metrics Snapshot to populate.
+void snapshot_codec_metrics(database_metrics& metrics) noexcept;
+
+}  // namespace djinterop::util
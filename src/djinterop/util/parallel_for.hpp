@@ -0,0 +1,103 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace djinterop::util
+{
+/// Call a function once for each index in `[0, count)`, spreading the calls
+/// across a number of worker threads.
+///
+/// Indices are handed out one at a time, so that workers stay busy when the
+/// calls take differing amounts of time.  If a call throws, no further calls
+/// are started, and the first exception thrown is rethrown once all workers
+/// have finished.
+///
+/// \param count Number of indices.
+/// \param max_workers Maximum number of worker threads, or zero to use one
+///                    per hardware thread.  The calling thread does the work
+///                    itself if only one worker would be used.
+/// \param fn Function to call with each index, which must be safe to call
+///           concurrently.
+template <typename Function>
+void parallel_for(std::size_t count, std::size_t max_workers, Function&& fn)
+{
+    if (max_workers == 0)
+    {
+        max_workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::atomic<std::size_t> next_index{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr first_error;
+    std::mutex error_mutex;
+    auto worker = [&]
+    {
+        for (auto i = next_index++; i < count && !failed; i = next_index++)
+        {
+            try
+            {
+                fn(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock{error_mutex};
+                if (!first_error)
+                {
+                    first_error = std::current_exception();
+                }
+
+                failed = true;
+            }
+        }
+    };
+
+    auto worker_count = std::min(max_workers, count);
+    if (worker_count <= 1)
+    {
+        worker();
+    }
+    else
+    {
+        std::vector<std::thread> workers;
+        workers.reserve(worker_count);
+        for (std::size_t i = 0; i < worker_count; ++i)
+        {
+            workers.emplace_back(worker);
+        }
+
+        for (auto&& t : workers)
+        {
+            t.join();
+        }
+    }
+
+    if (first_error)
+    {
+        std::rethrow_exception(first_error);
+    }
+}
+
+}  // namespace djinterop::util
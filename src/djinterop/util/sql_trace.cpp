@@ -0,0 +1,363 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sql_trace.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <utility>
+
+#include "metrics.hpp"
+
+namespace djinterop::util
+{
+namespace
+{
+bool is_identifier_char(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+}
+
+bool is_space(char c)
+{
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+bool is_digit(char c)
+{
+    return std::isdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+/// Skip over a quoted section starting at `pos`, returning the position of
+/// the character after the closing quote.  A doubled quote character is an
+/// escaped quote, and does not close the section.
+std::size_t skip_quoted(std::string_view sql, std::size_t pos, char close)
+{
+    ++pos;
+    while (pos < sql.size())
+    {
+        if (sql[pos] == close)
+        {
+            if (pos + 1 < sql.size() && sql[pos + 1] == close && close != ']')
+            {
+                pos += 2;
+                continue;
+            }
+
+            return pos + 1;
+        }
+
+        ++pos;
+    }
+
+    return pos;
+}
+
+/// Skip over a numeric literal starting at `pos`, returning the position of
+/// the character after it.
+std::size_t skip_number(std::string_view sql, std::size_t pos)
+{
+    if (sql[pos] == '0' && pos + 1 < sql.size() &&
+        (sql[pos + 1] == 'x' || sql[pos + 1] == 'X'))
+    {
+        pos += 2;
+        while (pos < sql.size() &&
+               std::isxdigit(static_cast<unsigned char>(sql[pos])))
+        {
+            ++pos;
+        }
+
+        return pos;
+    }
+
+    while (pos < sql.size() && (is_digit(sql[pos]) || sql[pos] == '.'))
+    {
+        ++pos;
+    }
+
+    if (pos < sql.size() && (sql[pos] == 'e' || sql[pos] == 'E'))
+    {
+        auto exponent = pos + 1;
+        if (exponent < sql.size() &&
+            (sql[exponent] == '+' || sql[exponent] == '-'))
+        {
+            ++exponent;
+        }
+
+        if (exponent < sql.size() && is_digit(sql[exponent]))
+        {
+            pos = exponent;
+            while (pos < sql.size() && is_digit(sql[pos]))
+            {
+                ++pos;
+            }
+        }
+    }
+
+    return pos;
+}
+
+}  // anonymous namespace
+
+std::string normalize_sql(std::string_view sql)
+{
+    std::string result;
+    result.reserve(sql.size());
+
+    bool pending_space = false;
+    auto emit = [&](std::string_view text) {
+        if (pending_space && !result.empty())
+        {
+            result += ' ';
+        }
+
+        pending_space = false;
+        result += text;
+    };
+
+    std::size_t pos = 0;
+    while (pos < sql.size())
+    {
+        auto c = sql[pos];
+        auto next = pos + 1 < sql.size() ? sql[pos + 1] : '\0';
+        auto after_identifier = pos > 0 && is_identifier_char(sql[pos - 1]);
+
+        if (is_space(c))
+        {
+            pending_space = true;
+            ++pos;
+        }
+        else if (c == '-' && next == '-')
+        {
+            pos = sql.find('\n', pos);
+            pos = pos == std::string_view::npos ? sql.size() : pos;
+            pending_space = true;
+        }
+        else if (c == '/' && next == '*')
+        {
+            pos = sql.find("*/", pos + 2);
+            pos = pos == std::string_view::npos ? sql.size() : pos + 2;
+            pending_space = true;
+        }
+        else if (c == '\'')
+        {
+            pos = skip_quoted(sql, pos, '\'');
+            emit("?");
+        }
+        else if ((c == 'x' || c == 'X') && next == '\'' && !after_identifier)
+        {
+            pos = skip_quoted(sql, pos + 1, '\'');
+            emit("?");
+        }
+        else if (c == '"' || c == '`' || c == '[')
+        {
+            auto end = skip_quoted(sql, pos, c == '[' ? ']' : c);
+            emit(sql.substr(pos, end - pos));
+            pos = end;
+        }
+        else if (
+            (is_digit(c) || (c == '.' && is_digit(next))) && !after_identifier)
+        {
+            pos = skip_number(sql, pos);
+            emit("?");
+        }
+        else
+        {
+            emit(sql.substr(pos, 1));
+            ++pos;
+        }
+    }
+
+    return result;
+}
+
+sql_tracer::sql_tracer(std::shared_ptr<sqlite3> connection) :
+    connection_{std::move(connection)},
+    initial_total_changes_{sqlite3_total_changes(connection_.get())}
+{
+}
+
+sql_tracer::~sql_tracer()
+{
+    if (metrics_enabled_)
+    {
+        sqlite3_commit_hook(connection_.get(), nullptr, nullptr);
+    }
+
+    if (metrics_enabled_ || observer_)
+    {
+        sqlite3_trace_v2(connection_.get(), 0, nullptr, nullptr);
+    }
+}
+
+void sql_tracer::set_observer(std::shared_ptr<sql_observer> observer)
+{
+    observer_ = std::move(observer);
+    rows_.clear();
+    register_trace();
+}
+
+void sql_tracer::set_metrics_enabled(bool enabled)
+{
+    if (enabled == metrics_enabled_)
+    {
+        return;
+    }
+
+    // The connection is opened by the library and never handed out, and the
+    // tracer is the only user of its commit hook.  Any other hook would be
+    // replaced here, and would not be restored when counting is disabled:
+    // SQLite does not report the function of a replaced hook.
+    if (enabled)
+    {
+        sqlite3_commit_hook(connection_.get(), &sql_tracer::on_commit, this);
+    }
+    else
+    {
+        sqlite3_commit_hook(connection_.get(), nullptr, nullptr);
+    }
+
+    metrics_enabled_ = enabled;
+    register_trace();
+}
+
+void sql_tracer::snapshot_metrics(database_metrics& metrics) const noexcept
+{
+    metrics.statements_prepared = read(statements_prepared_);
+    metrics.statements_executed = read(statements_executed_);
+    metrics.rows_read = read(rows_read_);
+    metrics.rows_written = static_cast<uint64_t>(
+        sqlite3_total_changes(connection_.get()) - initial_total_changes_);
+    metrics.transactions_committed = read(transactions_committed_);
+}
+
+void sql_tracer::register_trace()
+{
+    unsigned int mask = 0;
+    if (metrics_enabled_ || observer_)
+    {
+        mask |= SQLITE_TRACE_STMT | SQLITE_TRACE_ROW;
+    }
+
+    if (observer_)
+    {
+        mask |= SQLITE_TRACE_PROFILE;
+    }
+
+    if (mask == 0)
+    {
+        sqlite3_trace_v2(connection_.get(), 0, nullptr, nullptr);
+        return;
+    }
+
+    sqlite3_trace_v2(connection_.get(), mask, &sql_tracer::on_trace, this);
+}
+
+int sql_tracer::on_commit(void* context)
+{
+    auto* tracer = static_cast<sql_tracer*>(context);
+    add_to(tracer->transactions_committed_);
+
+    // Returning zero allows the commit to proceed.
+    return 0;
+}
+
+int sql_tracer::on_trace(unsigned int type, void* context, void* p, void* x)
+{
+    auto* tracer = static_cast<sql_tracer*>(context);
+    auto* stmt = static_cast<sqlite3_stmt*>(p);
+
+    switch (type)
+    {
+        case SQLITE_TRACE_STMT:
+        {
+            // Statements run by triggers are reported with their text given
+            // as an SQL comment, and are counted as part of their parent.
+            auto* text = static_cast<const char*>(x);
+            if (text != nullptr && text[0] == '-' && text[1] == '-')
+            {
+                break;
+            }
+
+            // A statement whose run counter is still zero is being executed
+            // for the first time since it was prepared.
+            if (tracer->metrics_enabled_)
+            {
+                add_to(tracer->statements_executed_);
+                if (sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_RUN, 0) == 0)
+                {
+                    add_to(tracer->statements_prepared_);
+                }
+            }
+
+            if (tracer->observer_)
+            {
+                tracer->rows_[stmt] = 0;
+            }
+
+            break;
+        }
+
+        case SQLITE_TRACE_ROW:
+        {
+            if (tracer->metrics_enabled_)
+            {
+                add_to(tracer->rows_read_);
+            }
+
+            if (tracer->observer_)
+            {
+                ++tracer->rows_[stmt];
+            }
+
+            break;
+        }
+
+        case SQLITE_TRACE_PROFILE:
+        {
+            int64_t rows = 0;
+            auto iter = tracer->rows_.find(stmt);
+            if (iter != tracer->rows_.end())
+            {
+                rows = iter->second;
+                tracer->rows_.erase(iter);
+            }
+
+            const auto* text = sqlite3_sql(stmt);
+            std::string_view prepared_sql = text != nullptr ? text : "";
+            auto sql = normalize_sql(prepared_sql);
+            sql_statement_event event{
+                sql, std::chrono::nanoseconds{*static_cast<sqlite3_int64*>(x)},
+                rows, api_operation::current(), prepared_sql};
+
+            // Hold a reference, in case the observer removes itself.
+            auto observer = tracer->observer_;
+            if (observer)
+            {
+                observer->on_statement(event);
+            }
+
+            break;
+        }
+
+        default: break;
+    }
+
+    return 0;
+}
+
+}  // namespace djinterop::util
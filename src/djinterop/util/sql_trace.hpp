@@ -0,0 +1,145 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <sqlite3.h>
+
+#include <djinterop/database_metrics.hpp>
+#include <djinterop/sql_observer.hpp>
+
+namespace djinterop::util
+{
+/// The `api_operation` class is an RAII scope that names the public API
+/// operation currently running on this thread.
+///
+/// Scopes may nest, in which case only the outermost name is reported, so that
+/// statements issued by one public call on behalf of another are attributed to
+/// the call made by the user.
+class api_operation
+{
+public:
+    explicit api_operation(const char* name) noexcept : previous_{current_}
+    {
+        if (current_ == nullptr)
+        {
+            current_ = name;
+        }
+    }
+
+    ~api_operation() { current_ = previous_; }
+
+    api_operation(const api_operation&) = delete;
+    api_operation& operator=(const api_operation&) = delete;
+
+    /// Get the name of the outermost operation running on this thread.
+    ///
+    /// \return Returns the operation name, or empty if there is none.
+    static std::string_view current() noexcept
+    {
+        return current_ != nullptr ? std::string_view{current_}
+                                   : std::string_view{};
+    }
+
+private:
+    static inline thread_local const char* current_ = nullptr;
+    const char* previous_;
+};
+
+/// Normalise the text of an SQL statement for reporting.
+///
+/// Runs of whitespace are collapsed to a single space, comments are removed,
+/// and string and numeric literals are replaced by `?`.
+///
+/// \param sql Statement text.
+/// \return Returns the normalised text.
+std::string normalize_sql(std::string_view sql);
+
+/// The `sql_tracer` class counts statements run on an SQLite connection, and
+/// forwards them to an `sql_observer` if one is set.
+///
+/// SQLite callbacks are only registered while they are needed.  Counting
+/// statements, rows and commits costs a relaxed atomic increment each, and is
+/// only done while metrics are enabled.  Statements are only timed,
+/// normalised and reported while an observer is set.  With neither, the
+/// connection runs without any callbacks at all.
+class sql_tracer
+{
+public:
+    explicit sql_tracer(std::shared_ptr<sqlite3> connection);
+    ~sql_tracer();
+
+    sql_tracer(const sql_tracer&) = delete;
+    sql_tracer& operator=(const sql_tracer&) = delete;
+
+    /// Set the observer to be notified of statements, or remove it.
+    ///
+    /// \param observer Observer to set, or `nullptr` to remove it.
+    void set_observer(std::shared_ptr<sql_observer> observer);
+
+    /// Get the currently-set observer.
+    ///
+    /// \return Returns the observer, or `nullptr` if none is set.
+    [[nodiscard]] std::shared_ptr<sql_observer> observer() const
+    {
+        return observer_;
+    }
+
+    /// Enable or disable the counting of statements, rows and commits.
+    ///
+    /// Commits are counted by a commit hook on the connection, which replaces
+    /// any other commit hook registered on it.
+    ///
+    /// \param enabled Whether counting is enabled.
+    void set_metrics_enabled(bool enabled);
+
+    /// Test whether the counting of statements, rows and commits is enabled.
+    [[nodiscard]] bool metrics_enabled() const noexcept
+    {
+        return metrics_enabled_;
+    }
+
+    /// Populate the SQL counters of a metrics snapshot.
+    ///
+    /// \param metrics Snapshot to populate.
+    void snapshot_metrics(database_metrics& metrics) const noexcept;
+
+private:
+    void register_trace();
+
+    static int on_trace(unsigned int type, void* context, void* p, void* x);
+    static int on_commit(void* context);
+
+    std::shared_ptr<sqlite3> connection_;
+    int initial_total_changes_;
+    std::atomic<uint64_t> statements_prepared_{0};
+    std::atomic<uint64_t> statements_executed_{0};
+    std::atomic<uint64_t> rows_read_{0};
+    std::atomic<uint64_t> transactions_committed_{0};
+    bool metrics_enabled_ = false;
+    std::shared_ptr<sql_observer> observer_;
+    std::unordered_map<sqlite3_stmt*, int64_t> rows_;
+};
+
+}  // namespace djinterop::util
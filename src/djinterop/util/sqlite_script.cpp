@@ -0,0 +1,327 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sqlite_script.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+#include <djinterop/exceptions.hpp>
+
+#include "filesystem.hpp"
+
+namespace djinterop::util
+{
+namespace
+{
+constexpr std::size_t chunk_size = 1 << 16;
+constexpr std::size_t max_statement_excerpt = 200;
+
+enum class statement_kind
+{
+    begin_transaction,
+    commit_transaction,
+    pragma,
+    other,
+};
+
+struct statement_deleter
+{
+    void operator()(sqlite3_stmt* stmt) const { sqlite3_finalize(stmt); }
+};
+
+using statement_ptr = std::unique_ptr<sqlite3_stmt, statement_deleter>;
+
+/// Skip whitespace and comments, returning a pointer to the start of the next
+/// statement, or `end` if there is none.  A comment that is not terminated
+/// within the buffer is not skipped, as it may continue in the next chunk.
+const char* skip_whitespace_and_comments(const char* iter, const char* end)
+{
+    while (iter != end)
+    {
+        if (std::isspace(static_cast<unsigned char>(*iter)))
+        {
+            ++iter;
+        }
+        else if (*iter == '-' && iter + 1 != end && iter[1] == '-')
+        {
+            auto comment_end = std::find(iter, end, '\n');
+            if (comment_end == end)
+                break;
+
+            iter = comment_end;
+        }
+        else if (*iter == '/' && iter + 1 != end && iter[1] == '*')
+        {
+            const char terminator[] = "*/";
+            auto comment_end =
+                std::search(iter + 2, end, terminator, terminator + 2);
+            if (comment_end == end)
+                break;
+
+            iter = comment_end + 2;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return iter;
+}
+
+statement_kind classify_statement(const char* iter, const char* end)
+{
+    std::string keyword;
+    while (iter != end && std::isalpha(static_cast<unsigned char>(*iter)))
+    {
+        keyword += static_cast<char>(
+            std::toupper(static_cast<unsigned char>(*iter)));
+        ++iter;
+    }
+
+    if (keyword == "BEGIN")
+        return statement_kind::begin_transaction;
+    if (keyword == "COMMIT" || keyword == "END")
+        return statement_kind::commit_transaction;
+    if (keyword == "PRAGMA")
+        return statement_kind::pragma;
+    return statement_kind::other;
+}
+
+class script_runner
+{
+public:
+    script_runner(
+        sqlite::database& db, const std::string& script_path,
+        const engine::script_options& options) :
+        db_{db},
+        connection_{db.connection()},
+        script_path_{script_path},
+        options_{options},
+        script_{script_path, std::ios::binary},
+        bytes_total_{static_cast<uint64_t>(
+            get_file_size(script_path).value_or(0))}
+    {
+        if (!script_)
+        {
+            throw std::runtime_error{"Failed to open script " + script_path};
+        }
+    }
+
+    void run()
+    {
+        for (;;)
+        {
+            auto* end = buffer_.data() + buffer_.size();
+            auto* start =
+                skip_whitespace_and_comments(buffer_.data() + pos_, end);
+            advance_to(start);
+            if (start == end)
+            {
+                if (eof_)
+                    break;
+
+                read_more();
+                continue;
+            }
+
+            sqlite3_stmt* raw_stmt = nullptr;
+            const char* tail = nullptr;
+            auto rc = sqlite3_prepare_v2(
+                connection_.get(), start, static_cast<int>(end - start),
+                &raw_stmt, &tail);
+            statement_ptr stmt{raw_stmt};
+
+            // A statement that fails to parse, or that runs to the end of the
+            // buffer, may simply be incomplete.  Only once the whole script
+            // has been read can it be known for sure.
+            if ((rc != SQLITE_OK || tail == end) && !eof_)
+            {
+                read_more();
+                continue;
+            }
+
+            if (rc != SQLITE_OK)
+            {
+                fail(start, end, sqlite3_errmsg(connection_.get()));
+            }
+
+            if (stmt)
+            {
+                execute(stmt.get(), start, tail);
+            }
+
+            advance_to(tail);
+        }
+
+        commit();
+        report_progress();
+    }
+
+private:
+    void execute(sqlite3_stmt* stmt, const char* start, const char* tail)
+    {
+        switch (classify_statement(start, tail))
+        {
+            case statement_kind::begin_transaction: begin(); break;
+            case statement_kind::commit_transaction: commit(); break;
+            case statement_kind::pragma:
+                commit();
+                step(stmt, start, tail);
+                break;
+            case statement_kind::other:
+                begin();
+                step(stmt, start, tail);
+                ++statements_in_transaction_;
+
+                // The statement may itself have ended the transaction, for
+                // example with a ROLLBACK.
+                in_transaction_ =
+                    sqlite3_get_autocommit(connection_.get()) == 0;
+                if (options_.statements_per_transaction != 0 &&
+                    statements_in_transaction_ >=
+                        options_.statements_per_transaction)
+                {
+                    commit();
+                }
+                break;
+        }
+
+        ++statements_executed_;
+    }
+
+    void step(sqlite3_stmt* stmt, const char* start, const char* tail)
+    {
+        int rc;
+        do
+        {
+            rc = sqlite3_step(stmt);
+        } while (rc == SQLITE_ROW);
+
+        if (rc != SQLITE_DONE)
+        {
+            fail(start, tail, sqlite3_errmsg(connection_.get()));
+        }
+    }
+
+    void begin()
+    {
+        if (!in_transaction_)
+        {
+            db_ << "BEGIN";
+            in_transaction_ = true;
+            statements_in_transaction_ = 0;
+        }
+    }
+
+    void commit()
+    {
+        if (in_transaction_)
+        {
+            db_ << "COMMIT";
+            in_transaction_ = false;
+        }
+    }
+
+    [[noreturn]] void fail(
+        const char* start, const char* end, const std::string& error)
+    {
+        auto offset = buffer_offset_ + pos_;
+        auto excerpt_end =
+            start + std::min<std::size_t>(end - start, max_statement_excerpt);
+        std::string excerpt{start, std::find(start, excerpt_end, '\n')};
+
+        if (in_transaction_)
+        {
+            sqlite3_exec(
+                connection_.get(), "ROLLBACK", nullptr, nullptr, nullptr);
+            in_transaction_ = false;
+        }
+
+        std::stringstream msg;
+        msg << "Error in script " << script_path_ << " at offset " << offset
+            << " (line " << line_ << ") whilst executing statement \""
+            << excerpt << "\": " << error;
+        throw script_error{msg.str(), script_path_, offset, line_};
+    }
+
+    void advance_to(const char* iter)
+    {
+        const char* from = buffer_.data() + pos_;
+        line_ += std::count(from, iter, '\n');
+        pos_ = iter - buffer_.data();
+    }
+
+    void read_more()
+    {
+        // Discard the part of the buffer that has already been executed.
+        buffer_.erase(0, pos_);
+        buffer_offset_ += pos_;
+        pos_ = 0;
+
+        auto size = buffer_.size();
+        buffer_.resize(size + chunk_size);
+        script_.read(buffer_.data() + size, chunk_size);
+        buffer_.resize(size + script_.gcount());
+        eof_ = !script_;
+
+        report_progress();
+    }
+
+    void report_progress() const
+    {
+        if (options_.on_progress)
+        {
+            options_.on_progress(engine::script_progress{
+                script_path_, buffer_offset_ + pos_, bytes_total_,
+                statements_executed_});
+        }
+    }
+
+    sqlite::database& db_;
+    std::shared_ptr<sqlite3> connection_;
+    std::string script_path_;
+    const engine::script_options& options_;
+    std::ifstream script_;
+    uint64_t bytes_total_;
+
+    std::string buffer_;
+    std::size_t pos_ = 0;
+    uint64_t buffer_offset_ = 0;
+    uint64_t line_ = 1;
+    bool eof_ = false;
+
+    bool in_transaction_ = false;
+    std::size_t statements_in_transaction_ = 0;
+    uint64_t statements_executed_ = 0;
+};
+}  // anonymous namespace
+
+void execute_sqlite_script(
+    sqlite::database& db, const std::string& script_path,
+    const engine::script_options& options)
+{
+    script_runner runner{db, script_path, options};
+    runner.run();
+}
+
+}  // namespace djinterop::util
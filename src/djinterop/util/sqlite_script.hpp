@@ -0,0 +1,46 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+
+#include <sqlite_modern_cpp.h>
+
+#include <djinterop/engine/engine.hpp>
+
+namespace djinterop::util
+{
+/// Execute an SQL script against a database.
+///
+/// The script is streamed from disk in fixed-size chunks and split into
+/// statements by the SQLite parser, so that statements may span lines.
+/// Statements are executed inside transactions issued by this function, of
+/// the size given in `options`.  Transaction control statements in the script
+/// begin or commit those transactions instead of being executed directly, and
+/// any open transaction is committed before a `PRAGMA` statement, since some
+/// pragmas have no effect inside a transaction.
+///
+/// \param db Database against which to execute the script.
+/// \param script_path Path to the script.
+/// \param options Execution options.
+/// \throws script_error If a statement cannot be parsed or executed.
+void execute_sqlite_script(
+    sqlite::database& db, const std::string& script_path,
+    const engine::script_options& options);
+
+}  // namespace djinterop::util
@@ -25,12 +25,21 @@
 
 namespace djinterop::util
 {
+/// RAII transaction on a SQLite database, rolled back unless committed.
+///
+/// If a transaction is already open on the database, a savepoint is used
+/// instead, so that operations can be composed into larger transactions.
 class sqlite_transaction
 {
 public:
-    explicit sqlite_transaction(sqlite::database db) : db_{std::move(db)}
+    explicit sqlite_transaction(sqlite::database db) :
+        db_{std::move(db)},
+        is_nested_{sqlite3_get_autocommit(db_.connection().get()) == 0}
     {
-        db_ << "BEGIN TRANSACTION";
+        if (is_nested_)
+            db_ << "SAVEPOINT djinterop_nested_transaction";
+        else
+            db_ << "BEGIN TRANSACTION";
     }
 
     ~sqlite_transaction()
@@ -39,7 +48,15 @@ public:
         {
             try
             {
-                db_ << "ROLLBACK TRANSACTION";
+                if (is_nested_)
+                {
+                    db_ << "ROLLBACK TO djinterop_nested_transaction";
+                    db_ << "RELEASE djinterop_nested_transaction";
+                }
+                else
+                {
+                    db_ << "ROLLBACK TRANSACTION";
+                }
             }
             catch ([[maybe_unused]] const sqlite::sqlite_exception& e)
             {
@@ -60,12 +77,17 @@ public:
 
     void commit()
     {
-        db_ << "COMMIT TRANSACTION";
+        if (is_nested_)
+            db_ << "RELEASE djinterop_nested_transaction";
+        else
+            db_ << "COMMIT TRANSACTION";
+
         committed_ = true;
     }
 
 private:
     sqlite::database db_;
+    bool is_nested_;
     bool committed_ = false;
 };
 
@@ -0,0 +1,280 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "waveform_pooling.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DJINTEROP_WAVEFORM_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define DJINTEROP_WAVEFORM_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace djinterop::util
+{
+namespace
+{
+// A waveform entry is laid out as six consecutive bytes: the value and opacity
+// of each of the low, mid, and high bands.  The kernels below treat a window
+// of entries as a flat byte array, and rely on each SIMD block being a
+// multiple of six bytes long, so that every byte lane always holds the same
+// field of an entry.
+constexpr std::size_t entry_size = 6;
+static_assert(sizeof(waveform_entry) == entry_size);
+static_assert(offsetof(waveform_entry, mid) == 2);
+static_assert(offsetof(waveform_entry, high) == 4);
+
+using entry_bytes = std::array<uint8_t, entry_size>;
+
+void merge_fields(const uint8_t* lanes, entry_bytes& result) noexcept
+{
+    for (std::size_t i = 0; i < entry_size; ++i)
+    {
+        result[i] = std::max(result[i], lanes[i]);
+    }
+}
+
+// Each 16-byte register of per-lane maxima is said to have a "phase", being
+// the field held in its first lane.  A 48-byte block of entries spans three
+// registers, of phases 0, 4, and 2 respectively.  The registers of phase 4
+// and 2 are brought into phase 0 by shifting them by whole bytes in both
+// directions, after which the lanes of the combined register are folded down
+// to a single entry.
+
+#if defined(__AVX2__) || defined(DJINTEROP_WAVEFORM_SSE2)
+void fold_phases(
+    __m128i phase0, __m128i phase4, __m128i phase2,
+    entry_bytes& result) noexcept
+{
+    auto m = _mm_max_epu8(
+        _mm_max_epu8(phase0, _mm_srli_si128(phase4, 2)),
+        _mm_max_epu8(_mm_slli_si128(phase4, 4), _mm_srli_si128(phase2, 4)));
+    m = _mm_max_epu8(m, _mm_slli_si128(phase2, 2));
+    m = _mm_max_epu8(
+        m, _mm_max_epu8(_mm_srli_si128(m, 6), _mm_srli_si128(m, 12)));
+
+    alignas(16) uint8_t lanes[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), m);
+    merge_fields(lanes, result);
+}
+#elif defined(DJINTEROP_WAVEFORM_NEON)
+void fold_phases(
+    uint8x16_t phase0, uint8x16_t phase4, uint8x16_t phase2,
+    entry_bytes& result) noexcept
+{
+    auto zero = vdupq_n_u8(0);
+    auto m = vmaxq_u8(
+        vmaxq_u8(phase0, vextq_u8(phase4, zero, 2)),
+        vmaxq_u8(vextq_u8(zero, phase4, 12), vextq_u8(phase2, zero, 4)));
+    m = vmaxq_u8(m, vextq_u8(zero, phase2, 14));
+    m = vmaxq_u8(m, vmaxq_u8(vextq_u8(m, zero, 6), vextq_u8(m, zero, 12)));
+
+    uint8_t lanes[16];
+    vst1q_u8(lanes, m);
+    merge_fields(lanes, result);
+}
+#endif
+
+/// Compute the maximum of each of the six fields over a run of entries,
+/// returning the number of bytes consumed.  Any remaining bytes, fewer than
+/// one SIMD block, must be handled by the caller.
+std::size_t max_fields_simd(
+    [[maybe_unused]] const uint8_t* data, [[maybe_unused]] std::size_t size,
+    [[maybe_unused]] entry_bytes& result) noexcept
+{
+#if defined(__AVX2__)
+    // Three 32-byte registers cover 96 bytes, i.e. 16 entries.  Their halves
+    // have phases 0, 4, 2, 0, 4, 2 in turn.
+    constexpr std::size_t block = 96;
+    if (size < block)
+        return 0;
+
+    auto acc0 = _mm256_setzero_si256();
+    auto acc1 = _mm256_setzero_si256();
+    auto acc2 = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + block <= size; i += block)
+    {
+        auto* p = reinterpret_cast<const __m256i*>(data + i);
+        acc0 = _mm256_max_epu8(acc0, _mm256_loadu_si256(p));
+        acc1 = _mm256_max_epu8(acc1, _mm256_loadu_si256(p + 1));
+        acc2 = _mm256_max_epu8(acc2, _mm256_loadu_si256(p + 2));
+    }
+
+    fold_phases(
+        _mm_max_epu8(
+            _mm256_castsi256_si128(acc0), _mm256_extracti128_si256(acc1, 1)),
+        _mm_max_epu8(
+            _mm256_extracti128_si256(acc0, 1), _mm256_castsi256_si128(acc2)),
+        _mm_max_epu8(
+            _mm256_castsi256_si128(acc1), _mm256_extracti128_si256(acc2, 1)),
+        result);
+    return i;
+#elif defined(DJINTEROP_WAVEFORM_SSE2)
+    // Three 16-byte registers cover 48 bytes, i.e. 8 entries.
+    constexpr std::size_t block = 48;
+    if (size < block)
+        return 0;
+
+    auto acc0 = _mm_setzero_si128();
+    auto acc1 = _mm_setzero_si128();
+    auto acc2 = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + block <= size; i += block)
+    {
+        auto* p = reinterpret_cast<const __m128i*>(data + i);
+        acc0 = _mm_max_epu8(acc0, _mm_loadu_si128(p));
+        acc1 = _mm_max_epu8(acc1, _mm_loadu_si128(p + 1));
+        acc2 = _mm_max_epu8(acc2, _mm_loadu_si128(p + 2));
+    }
+
+    fold_phases(acc0, acc1, acc2, result);
+    return i;
+#elif defined(DJINTEROP_WAVEFORM_NEON)
+    // Three 16-byte registers cover 48 bytes, i.e. 8 entries.
+    constexpr std::size_t block = 48;
+    if (size < block)
+        return 0;
+
+    auto acc0 = vdupq_n_u8(0);
+    auto acc1 = vdupq_n_u8(0);
+    auto acc2 = vdupq_n_u8(0);
+    std::size_t i = 0;
+    for (; i + block <= size; i += block)
+    {
+        acc0 = vmaxq_u8(acc0, vld1q_u8(data + i));
+        acc1 = vmaxq_u8(acc1, vld1q_u8(data + i + 16));
+        acc2 = vmaxq_u8(acc2, vld1q_u8(data + i + 32));
+    }
+
+    fold_phases(acc0, acc1, acc2, result);
+    return i;
+#else
+    return 0;
+#endif
+}
+
+waveform_entry make_entry(
+    uint8_t low, uint8_t mid, uint8_t high, const entry_bytes& fields) noexcept
+{
+    return waveform_entry{
+        waveform_point{low, fields[1]},
+        waveform_point{mid, fields[3]},
+        waveform_point{high, fields[5]},
+    };
+}
+
+uint8_t root_mean(uint64_t sum_of_squares, std::size_t count) noexcept
+{
+    auto rms = std::sqrt(static_cast<double>(sum_of_squares) / count);
+    return static_cast<uint8_t>(std::min(255.0, std::round(rms)));
+}
+}  // namespace
+
+waveform_entry max_pool_waveform(
+    const waveform_entry* entries, std::size_t count) noexcept
+{
+    entry_bytes fields{};
+    auto* data = reinterpret_cast<const uint8_t*>(entries);
+    auto size = count * entry_size;
+
+    // SIMD blocks are a whole number of entries, so the remainder is too.
+    auto i = max_fields_simd(data, size, fields);
+    for (; i < size; i += entry_size)
+    {
+        merge_fields(data + i, fields);
+    }
+
+    return make_entry(fields[0], fields[2], fields[4], fields);
+}
+
+waveform_entry rms_pool_waveform(
+    const waveform_entry* entries, std::size_t count) noexcept
+{
+    if (count == 0)
+    {
+        return make_entry(0, 0, 0, entry_bytes{});
+    }
+
+    // Squares of 8-bit values are summed in 64 bits, and so cannot overflow.
+    // The loop is simple enough to be auto-vectorised.
+    uint64_t low = 0;
+    uint64_t mid = 0;
+    uint64_t high = 0;
+    entry_bytes fields{};
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto& e = entries[i];
+        low += uint32_t{e.low.value} * e.low.value;
+        mid += uint32_t{e.mid.value} * e.mid.value;
+        high += uint32_t{e.high.value} * e.high.value;
+        fields[1] = std::max(fields[1], e.low.opacity);
+        fields[3] = std::max(fields[3], e.mid.opacity);
+        fields[5] = std::max(fields[5], e.high.opacity);
+    }
+
+    return make_entry(
+        root_mean(low, count), root_mean(mid, count), root_mean(high, count),
+        fields);
+}
+
+std::vector<waveform_entry> pool_waveform(
+    const std::vector<waveform_entry>& waveform, std::size_t size,
+    waveform_pooling pooling)
+{
+    std::vector<waveform_entry> result;
+    if (waveform.empty())
+    {
+        return result;
+    }
+
+    auto pool = pooling == waveform_pooling::max ? max_pool_waveform
+                                                 : rms_pool_waveform;
+
+    // Window boundaries are computed incrementally, to avoid a division per
+    // output entry.  The window for output entry `i` is the input range
+    // `[n * i / size, n * (i + 1) / size)`, widened to at least one entry.
+    auto n = waveform.size();
+    result.reserve(size);
+    std::size_t begin = 0;
+    std::size_t numerator = 0;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        numerator += n;
+        auto end = begin + numerator / size;
+        numerator %= size;
+
+        auto count = std::max<std::size_t>(end - begin, 1);
+        auto first = std::min(begin, n - 1);
+        result.push_back(pool(waveform.data() + first, count));
+        begin = end;
+    }
+
+    return result;
+}
+
+}  // namespace djinterop::util
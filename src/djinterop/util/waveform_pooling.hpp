@@ -0,0 +1,66 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <djinterop/performance_data.hpp>
+
+namespace djinterop::util
+{
+/// Method by which a window of waveform entries is reduced to a single entry.
+enum class waveform_pooling
+{
+    /// Per-band maximum, which preserves transients.
+    max,
+
+    /// Per-band root mean square, which reflects perceived loudness.
+    rms,
+};
+
+/// Reduce a contiguous window of waveform entries to their per-band maximum.
+///
+/// The opacity of each band is also reduced to its maximum.  An empty window
+/// yields a zero-valued, fully transparent entry.
+waveform_entry max_pool_waveform(
+    const waveform_entry* entries, std::size_t count) noexcept;
+
+/// Reduce a contiguous window of waveform entries to their per-band root mean
+/// square value.
+///
+/// The opacity of each band is reduced to its maximum.  An empty window yields
+/// a zero-valued, fully transparent entry.
+waveform_entry rms_pool_waveform(
+    const waveform_entry* entries, std::size_t count) noexcept;
+
+/// Resample a waveform to a given number of entries, by pooling each of the
+/// equally-sized windows of the input waveform that correspond to an output
+/// entry.
+///
+/// If the output is larger than the input, input entries are repeated.
+///
+/// \param waveform Input waveform.
+/// \param size Number of entries in the output waveform.
+/// \param pooling Pooling method.
+/// \return Returns the pooled waveform.
+std::vector<waveform_entry> pool_waveform(
+    const std::vector<waveform_entry>& waveform, std::size_t size,
+    waveform_pooling pooling = waveform_pooling::max);
+
+}  // namespace djinterop::util
@@ -0,0 +1,167 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/analysis/beatgrid_index.hpp>
+
+#define BOOST_TEST_MODULE beatgrid_index_test
+#include <boost/test/included/unit_test.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+#include <djinterop/engine/v2/beat_data_blob.hpp>
+#include <djinterop/performance_data.hpp>
+
+namespace a = djinterop::analysis;
+namespace ev2 = djinterop::engine::v2;
+namespace utf = boost::unit_test;
+
+namespace
+{
+// 120 BPM at 44.1 kHz for beats -4 to 8, then 100 BPM until beat 16.
+const std::vector<djinterop::beatgrid_marker> two_tempo_grid{
+    {-4, -88200}, {8, 176400}, {16, 388080}};
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(*utf::description("sample offsets map to beats"))
+BOOST_AUTO_TEST_CASE(beat_at__two_tempos__interpolated)
+{
+    // Arrange
+    a::beatgrid_index index{two_tempo_grid};
+
+    // Act/Assert
+    BOOST_CHECK_CLOSE(index.beat_at(0), 0, 1e-9);
+    BOOST_CHECK_CLOSE(index.beat_at(33075), 1.5, 1e-9);
+    BOOST_CHECK_CLOSE(index.beat_at(176400), 8, 1e-9);
+    BOOST_CHECK_CLOSE(index.beat_at(176400 + 26460 * 2.5), 10.5, 1e-9);
+    BOOST_CHECK_CLOSE(index.beat_at(-88200 - 22050), -5, 1e-9);
+    BOOST_CHECK_CLOSE(index.beat_at(388080 + 26460), 17, 1e-9);
+    BOOST_CHECK_CLOSE(index.samples_per_beat_at(100), 22050, 1e-9);
+    BOOST_CHECK_CLOSE(index.samples_per_beat_at(200000), 26460, 1e-9);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("beats map to sample offsets"))
+BOOST_AUTO_TEST_CASE(sample_offset_of__two_tempos__interpolated)
+{
+    // Arrange
+    a::beatgrid_index index{two_tempo_grid};
+
+    // Act/Assert
+    BOOST_CHECK_CLOSE(index.sample_offset_of(1.5), 33075, 1e-9);
+    BOOST_CHECK_CLOSE(index.sample_offset_of(10.5), 242550, 1e-9);
+    BOOST_CHECK_CLOSE(index.sample_offset_of(-5), -110250, 1e-9);
+    BOOST_CHECK_CLOSE(index.sample_offset_of(17), 414540, 1e-9);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("downbeats and grid lines are snapped"))
+BOOST_AUTO_TEST_CASE(nearest_downbeat_and_quantize__offsets__snapped)
+{
+    // Arrange
+    a::beatgrid_index index{two_tempo_grid};
+
+    // Act/Assert
+    BOOST_CHECK_SMALL(index.nearest_downbeat(22050 * 1.9), 1e-6);
+    BOOST_CHECK_CLOSE(index.nearest_downbeat(22050 * 2.1), 88200, 1e-9);
+    BOOST_CHECK_CLOSE(
+        index.nearest_downbeat(176400 + 26460 * 2.1), 282240, 1e-9);
+    BOOST_CHECK_CLOSE(index.quantize(22050 * 2.4), 44100, 1e-9);
+    BOOST_CHECK_CLOSE(index.quantize(22050 * 2.4, 4), 22050 * 2.5, 1e-9);
+    BOOST_CHECK_THROW((void)index.quantize(0, 0), std::invalid_argument);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("batch forms match single queries"))
+BOOST_AUTO_TEST_CASE(batch__unsorted_offsets__match_single)
+{
+    // Arrange
+    a::beatgrid_index index{two_tempo_grid};
+    std::vector<double> offsets;
+    for (int i = 0; i < 200; ++i)
+    {
+        offsets.push_back(((i * 7919) % 600000) - 120000.5);
+    }
+
+    std::vector<double> beats(offsets.size());
+    std::vector<double> round_trip(offsets.size());
+    std::vector<double> downbeats(offsets.size());
+    std::vector<double> quantized(offsets.size());
+
+    // Act
+    index.beats_at(offsets, beats);
+    index.sample_offsets_of(beats, round_trip);
+    index.nearest_downbeats(offsets, downbeats);
+    index.quantize(offsets, quantized, 2);
+
+    // Assert
+    for (std::size_t i = 0; i < offsets.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(index.beat_at(offsets[i]), beats[i]);
+        BOOST_CHECK_CLOSE(offsets[i], round_trip[i], 1e-9);
+        BOOST_CHECK_EQUAL(index.nearest_downbeat(offsets[i]), downbeats[i]);
+        BOOST_CHECK_EQUAL(index.quantize(offsets[i], 2), quantized[i]);
+    }
+
+    std::vector<double> too_small(1);
+    BOOST_CHECK_THROW(
+        index.beats_at(offsets, too_small), std::invalid_argument);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("index is built from a beat data blob"))
+BOOST_AUTO_TEST_CASE(ctor__beat_data_blob__matches_markers)
+{
+    // Arrange
+    ev2::beat_data_blob blob{
+        .sample_rate = 44100,
+        .samples = 388080,
+        .is_beatgrid_set = 1,
+        .default_beat_grid = {},
+        .adjusted_beat_grid =
+            {{-88200, -4, 12, 0}, {176400, 8, 8, 0}, {388080, 16, 0, 0}},
+        .extra_data = {},
+    };
+    auto data = ev2::beat_data_view::uncompress(blob.to_blob());
+    ev2::beat_data_view view{data};
+
+    // Act
+    a::beatgrid_index from_blob{blob.adjusted_beat_grid};
+    a::beatgrid_index from_view{view.adjusted_beat_grid()};
+    a::beatgrid_index from_markers{two_tempo_grid};
+
+    // Assert
+    for (double offset = -100000; offset < 400000; offset += 12345.6)
+    {
+        BOOST_CHECK_EQUAL(
+            from_markers.beat_at(offset), from_blob.beat_at(offset));
+        BOOST_CHECK_EQUAL(
+            from_markers.beat_at(offset), from_view.beat_at(offset));
+    }
+}
+
+BOOST_TEST_DECORATOR(*utf::description("invalid beatgrids are rejected"))
+BOOST_AUTO_TEST_CASE(ctor__invalid_beatgrid__throws)
+{
+    // Arrange
+    std::vector<djinterop::beatgrid_marker> single{{0, 0}};
+    std::vector<djinterop::beatgrid_marker> descending{{0, 100}, {4, 50}};
+    std::vector<djinterop::beatgrid_marker> repeated{{0, 0}, {0, 100}};
+
+    // Act/Assert
+    BOOST_CHECK_THROW(a::beatgrid_index{single}, std::invalid_argument);
+    BOOST_CHECK_THROW(a::beatgrid_index{descending}, std::invalid_argument);
+    BOOST_CHECK_THROW(a::beatgrid_index{repeated}, std::invalid_argument);
+    BOOST_CHECK_THROW(
+        (a::beatgrid_index{two_tempo_grid, 0}), std::invalid_argument);
+}
@@ -0,0 +1,215 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/analysis/waveform_builder.hpp>
+
+#define BOOST_TEST_MODULE waveform_builder_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+
+#include <djinterop/engine/engine.hpp>
+
+namespace a = djinterop::analysis;
+namespace e = djinterop::engine;
+namespace utf = boost::unit_test;
+
+namespace
+{
+constexpr double sample_rate = 44100;
+
+/// Generate interleaved stereo samples of a sine wave.
+std::vector<float> make_sine(
+    double frequency, std::size_t frame_count, float amplitude = 0.5f)
+{
+    std::vector<float> samples;
+    samples.reserve(frame_count * 2);
+    for (std::size_t i = 0; i < frame_count; ++i)
+    {
+        auto value = static_cast<float>(
+            amplitude *
+            std::sin(2 * std::numbers::pi * frequency * i / sample_rate));
+        samples.push_back(value);
+        samples.push_back(value);
+    }
+
+    return samples;
+}
+
+struct band_totals
+{
+    long low = 0;
+    long mid = 0;
+    long high = 0;
+};
+
+band_totals sum_bands(const std::vector<djinterop::waveform_entry>& waveform)
+{
+    band_totals totals;
+    for (auto&& entry : waveform)
+    {
+        totals.low += entry.low.value;
+        totals.mid += entry.mid.value;
+        totals.high += entry.high.value;
+    }
+
+    return totals;
+}
+
+std::vector<djinterop::waveform_entry> build_sine(double frequency)
+{
+    auto samples = make_sine(frequency, 44100);
+    a::waveform_builder builder{sample_rate, 2};
+    builder.append(samples.data(), samples.size() / 2);
+    return builder.finish();
+}
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(
+    *utf::description("finish() after uneven blocks, sized as per extents"))
+BOOST_AUTO_TEST_CASE(finish__uneven_blocks__expected_size)
+{
+    // Arrange
+    auto samples = make_sine(440, 100000);
+    a::waveform_builder builder{sample_rate, 2};
+    std::size_t frames_done = 0;
+    std::size_t block_size = 1;
+
+    // Act
+    while (frames_done < 100000)
+    {
+        auto frames = std::min<std::size_t>(block_size, 100000 - frames_done);
+        builder.append(samples.data() + frames_done * 2, frames);
+        frames_done += frames;
+        block_size = block_size * 3 + 1;
+    }
+
+    auto waveform = builder.finish();
+
+    // Assert
+    auto extents =
+        e::calculate_high_resolution_waveform_extents(100000, sample_rate);
+    BOOST_CHECK_EQUAL(builder.sample_count(), 0u);
+    BOOST_CHECK_EQUAL(builder.samples_per_entry(), extents.samples_per_entry);
+    BOOST_CHECK_EQUAL(waveform.size(), extents.size);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("append() with low and high tones, in expected bands"))
+BOOST_AUTO_TEST_CASE(append__tones__expected_bands)
+{
+    // Arrange/Act
+    auto low = sum_bands(build_sine(50));
+    auto high = sum_bands(build_sine(10000));
+
+    // Assert
+    BOOST_CHECK_GT(low.low, 4 * low.high);
+    BOOST_CHECK_GT(low.low, 2 * low.mid);
+    BOOST_CHECK_GT(high.high, 4 * high.low);
+    BOOST_CHECK_GT(high.high, 2 * high.mid);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("append() with int16 samples, same as float samples"))
+BOOST_AUTO_TEST_CASE(append__int16__same_as_float)
+{
+    // Arrange
+    auto float_samples = make_sine(1000, 20000);
+    std::vector<int16_t> int_samples;
+    for (auto&& s : float_samples)
+    {
+        int_samples.push_back(static_cast<int16_t>(std::lround(s * 32768)));
+    }
+
+    a::waveform_builder float_builder{sample_rate, 2};
+    a::waveform_builder int_builder{sample_rate, 2};
+
+    // Act
+    float_builder.append(float_samples.data(), 20000);
+    int_builder.append(int_samples.data(), 20000);
+    auto float_waveform = float_builder.finish();
+    auto int_waveform = int_builder.finish();
+
+    // Assert
+    BOOST_REQUIRE_EQUAL(float_waveform.size(), int_waveform.size());
+    for (std::size_t i = 0; i < float_waveform.size(); ++i)
+    {
+        BOOST_CHECK_LE(
+            std::abs(float_waveform[i].mid.value - int_waveform[i].mid.value),
+            1);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("waveform_builder() with invalid parameters"))
+BOOST_AUTO_TEST_CASE(ctor__invalid__throws)
+{
+    // Arrange/Act/Assert
+    BOOST_CHECK_THROW(a::waveform_builder(100, 2), std::invalid_argument);
+    BOOST_CHECK_THROW(
+        a::waveform_builder(sample_rate, 0), std::invalid_argument);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("build_waveforms() with several jobs, in job order"))
+BOOST_AUTO_TEST_CASE(build_waveforms__several_jobs__same_as_sequential)
+{
+    // Arrange
+    std::vector<double> frequencies{50, 440, 1000, 5000, 10000};
+    std::vector<a::waveform_job> jobs;
+    for (auto frequency : frequencies)
+    {
+        jobs.push_back(a::waveform_job{
+            sample_rate, 2, [frequency](a::waveform_builder& builder)
+            {
+                auto samples = make_sine(frequency, 44100);
+                builder.append(samples.data(), samples.size() / 2);
+            }});
+    }
+
+    // Act
+    auto results = a::build_waveforms(jobs, 3);
+
+    // Assert
+    BOOST_REQUIRE_EQUAL(results.size(), frequencies.size());
+    for (std::size_t i = 0; i < frequencies.size(); ++i)
+    {
+        auto expected = build_sine(frequencies[i]);
+        BOOST_CHECK(results[i] == expected);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("build_waveforms() with a failing job, rethrows"))
+BOOST_AUTO_TEST_CASE(build_waveforms__failing_job__throws)
+{
+    // Arrange
+    std::vector<a::waveform_job> jobs{
+        a::waveform_job{sample_rate, 2, [](a::waveform_builder&) {}},
+        a::waveform_job{
+            sample_rate, 2,
+            [](a::waveform_builder&)
+            { throw std::runtime_error{"Decoding failed"}; }}};
+
+    // Act/Assert
+    BOOST_CHECK_THROW(a::build_waveforms(jobs, 2), std::runtime_error);
+}
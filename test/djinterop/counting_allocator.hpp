@@ -0,0 +1,141 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Counting replacement for the global allocation functions.
+//
+// This header defines replacements for the global `operator new` and
+// `operator delete`, and so must be included by exactly one translation unit
+// of an executable.  Once included, every allocation made by the executable
+// and by the library is counted, which allows the allocation cost of an
+// operation to be measured.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace djinterop::test
+{
+/// Counts of allocations made.
+struct allocation_counts
+{
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+namespace detail
+{
+inline std::atomic<uint64_t> allocations{0};
+inline std::atomic<uint64_t> allocated_bytes{0};
+
+inline void* counted_allocate(std::size_t size) noexcept
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+}  // namespace detail
+
+/// Get the counts of all allocations made so far.
+inline allocation_counts current_allocation_counts() noexcept
+{
+    return {
+        detail::allocations.load(std::memory_order_relaxed),
+        detail::allocated_bytes.load(std::memory_order_relaxed)};
+}
+
+/// Count the allocations made while running a block of code.
+template <typename Func>
+allocation_counts count_allocations(Func&& block)
+{
+    auto before = current_allocation_counts();
+    block();
+    auto after = current_allocation_counts();
+    return {
+        after.allocations - before.allocations, after.bytes - before.bytes};
+}
+
+}  // namespace djinterop::test
+
+// Memory is obtained from `malloc()` and returned with `free()`, which GCC
+// would otherwise report as mismatched once these functions are inlined.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size)
+{
+    auto* ptr = djinterop::test::detail::counted_allocate(size);
+    if (ptr == nullptr)
+        throw std::bad_alloc{};
+
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return djinterop::test::detail::counted_allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return djinterop::test::detail::counted_allocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,125 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE allocation_budget_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include <djinterop/database.hpp>
+#include <djinterop/engine/engine.hpp>
+#include <djinterop/playlist.hpp>
+#include <djinterop/track.hpp>
+
+#include "../counting_allocator.hpp"
+#include "budget.hpp"
+#include "example_track_data.hpp"
+
+namespace e = djinterop::engine;
+namespace utf = boost::unit_test;
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "track::snapshot() allocation budget, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    snapshot__allocation_budget__within_budget, e::supported_schemas, schema)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+    auto tracks = create_budget_tracks(
+        db, schema, 1, example_track_data_variation::fully_analysed_1);
+    auto& track = tracks.front();
+    auto budget = budget_for(schema, {40, 0}, {29, 0}, {29, 0});
+
+    // Act
+    auto actual =
+        djinterop::test::count_allocations([&] { track.snapshot(); });
+
+    // Assert
+    DJINTEROP_CHECK_BUDGET("Allocations", actual.allocations, budget, 1);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "track::waveform() allocation budget, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    waveform__allocation_budget__within_budget, e::supported_schemas, schema)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+    auto tracks = create_budget_tracks(
+        db, schema, 1, example_track_data_variation::fully_analysed_1);
+    auto& track = tracks.front();
+    auto budget = budget_for(schema, {6, 0}, {8, 0}, {9, 0});
+
+    // Act
+    auto actual =
+        djinterop::test::count_allocations([&] { track.waveform(); });
+
+    // Assert
+    DJINTEROP_CHECK_BUDGET("Allocations", actual.allocations, budget, 1);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "track::hot_cues() allocation budget, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    hot_cues__allocation_budget__within_budget, e::supported_schemas, schema)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+    auto tracks = create_budget_tracks(
+        db, schema, 1, example_track_data_variation::fully_analysed_1);
+    auto& track = tracks.front();
+    auto budget = budget_for(schema, {9, 0}, {9, 0}, {10, 0});
+
+    // Act
+    auto actual =
+        djinterop::test::count_allocations([&] { track.hot_cues(); });
+
+    // Assert
+    DJINTEROP_CHECK_BUDGET("Allocations", actual.allocations, budget, 1);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "playlist::tracks() allocation budget, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    playlist_tracks__allocation_budget__within_budget,
+    e::supported_schemas * utf::data::make(budget_item_counts), schema,
+    item_count)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+    auto playlist = db.create_root_playlist("Example Playlist");
+    auto tracks = create_budget_tracks(
+        db, schema, item_count, example_track_data_variation::fully_analysed_1);
+    playlist.add_tracks_back(tracks.begin(), tracks.end());
+
+    // Each track handle currently costs a few allocations of its own.
+    auto budget = budget_for(schema, {0, 2}, {2, 5}, {2, 5});
+
+    // Act
+    auto actual =
+        djinterop::test::count_allocations([&] { playlist.tracks(); });
+
+    // Assert
+    DJINTEROP_CHECK_BUDGET(
+        "Allocations", actual.allocations, budget, item_count);
+}
@@ -0,0 +1,123 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <djinterop/database.hpp>
+#include <djinterop/engine/engine_schema.hpp>
+#include <djinterop/sql_observer.hpp>
+#include <djinterop/track.hpp>
+#include <djinterop/track_snapshot.hpp>
+
+#include "example_track_data.hpp"
+
+/// Observer that counts the SQL statements issued against a database.
+class statement_counter : public djinterop::sql_observer
+{
+public:
+    void on_statement(const djinterop::sql_statement_event&) override
+    {
+        ++count;
+    }
+
+    int64_t count = 0;
+};
+
+/// Count the SQL statements issued against a database while running a block
+/// of code.
+template <typename Func>
+int64_t count_statements(const djinterop::database& db, Func&& block)
+{
+    auto counter = std::make_shared<statement_counter>();
+    db.set_observer(counter);
+    block();
+    db.set_observer(nullptr);
+    return counter->count;
+}
+
+/// Budget of some measured cost of an operation over some number of items,
+/// such as the number of SQL statements issued or allocations made.
+///
+/// A budget with a non-zero `per_item` cost indicates a cost that grows with
+/// the number of items, such as a known N+1 pattern of statements.  Budgets
+/// are upper bounds, so that they need only be lowered when an operation is
+/// made cheaper.
+struct budget
+{
+    int64_t fixed;
+    int64_t per_item;
+
+    int64_t for_items(int64_t items) const { return fixed + per_item * items; }
+};
+
+/// Select a budget according to the major version of a schema.
+inline budget budget_for(
+    const djinterop::engine::engine_schema& schema, budget v1, budget v2,
+    budget v3)
+{
+    if (schema >= djinterop::engine::engine_schema::schema_3_0_0)
+        return v3;
+    if (schema >= djinterop::engine::engine_schema::schema_2_18_0)
+        return v2;
+    return v1;
+}
+
+/// Numbers of items with which to check budgets.  Checking more than one size
+/// means that both the fixed and per-item costs of a budget are enforced.
+const std::vector<int64_t> budget_item_counts{1, 4};
+
+/// Create a number of distinct tracks in a database.
+inline std::vector<djinterop::track> create_budget_tracks(
+    djinterop::database& db, const djinterop::engine::engine_schema& schema,
+    int64_t count,
+    example_track_data_variation variation =
+        example_track_data_variation::basic_metadata_only_1)
+{
+    std::vector<djinterop::track> tracks;
+    for (int64_t i = 0; i < count; ++i)
+    {
+        djinterop::track_snapshot snapshot{};
+        populate_track_snapshot(
+            snapshot, variation, example_track_data_usage::create, schema);
+        snapshot.relative_path =
+            "../01 - Budget Track " + std::to_string(i) + ".mp3";
+        tracks.push_back(db.create_track(snapshot));
+    }
+
+    return tracks;
+}
+
+/// Check a measured cost against a budget.
+///
+/// \param quantity Description of what was measured, for reporting.
+/// \param actual Measured cost.
+/// \param budget Budget of the operation.
+/// \param items Number of items over which the operation ran.
+#define DJINTEROP_CHECK_BUDGET(quantity, actual, budget, items)             \
+    do                                                                      \
+    {                                                                       \
+        BOOST_TEST_MESSAGE(                                                 \
+            quantity << " for " << (items) << " item(s): " << (actual)      \
+                     << ", budget: " << (budget).for_items(items));         \
+        BOOST_CHECK_LE((actual), (budget).for_items(items));                \
+    } while (0)
@@ -28,6 +28,7 @@
 #include <djinterop/track.hpp>
 #include <djinterop/track_snapshot.hpp>
 
+#include "budget.hpp"
 #include "example_track_data.hpp"
 
 namespace e = djinterop::engine;
@@ -503,3 +504,25 @@ BOOST_DATA_TEST_CASE(sub_crate_by_name__invalid__none, e::supported_schemas, sch
     // Assert
     BOOST_CHECK(!result);
 }
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "crate::tracks() statement budget for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    tracks__statement_budget__within_budget,
+    e::supported_schemas * utf::data::make(budget_item_counts), schema,
+    item_count)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+    auto crate = db.create_root_crate("Example Root Crate");
+    auto tracks = create_budget_tracks(db, schema, item_count);
+    crate.add_tracks(tracks.begin(), tracks.end());
+    auto budget = budget_for(schema, {1, 0}, {1, 0}, {1, 0});
+
+    // Act
+    auto actual = count_statements(db, [&] { crate.tracks(); });
+
+    // Assert
+    DJINTEROP_CHECK_BUDGET("Statements issued", actual, budget, item_count);
+}
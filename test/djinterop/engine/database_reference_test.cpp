@@ -20,10 +20,12 @@
 #include <boost/test/data/test_case.hpp>
 #include <boost/test/included/unit_test.hpp>
 
+#include <fstream>
 #include <string>
 #include <vector>
 
 #include <djinterop/engine/engine.hpp>
+#include <djinterop/exceptions.hpp>
 
 #include "../temporary_directory.hpp"
 
@@ -136,3 +138,74 @@ BOOST_DATA_TEST_CASE(
         BOOST_CHECK_EQUAL(db.directory(), tmp_loc.temp_dir);
     }
 }
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "create_database_from_scripts() in batches, with progress reporting"))
+BOOST_AUTO_TEST_CASE(create_database_from_scripts__batched__reports_progress)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto script_path = std::string{STRINGIFY(TESTDATA_DIR) "/"} +
+                           "/ref/engine/desktop/desktop-4.3.4";
+        std::vector<e::script_progress> progress;
+        e::script_options options;
+        options.statements_per_transaction = 7;
+        options.on_progress = [&](const e::script_progress& p)
+        { progress.push_back(p); };
+        e::engine_schema loaded_schema{};
+
+        // Act
+        auto db = e::create_database_from_scripts(
+            tmp_loc.temp_dir, script_path, loaded_schema, options);
+
+        // Assert
+        BOOST_CHECK_NO_THROW(db.verify());
+        BOOST_REQUIRE(!progress.empty());
+        BOOST_CHECK_GT(progress.back().bytes_total, 0u);
+        BOOST_CHECK_EQUAL(
+            progress.back().bytes_done, progress.back().bytes_total);
+        BOOST_CHECK_GT(progress.back().statements_executed, 0u);
+    }
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "create_database_from_scripts() with a failing multi-line statement"))
+BOOST_AUTO_TEST_CASE(create_database_from_scripts__bad_statement__throws)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto script_dir = tmp_loc.temp_dir + "/scripts";
+        auto db_dir = tmp_loc.temp_dir + "/db";
+        boost::filesystem::create_directories(script_dir + "/Database2");
+        boost::filesystem::create_directories(db_dir);
+        {
+            std::ofstream script{script_dir + "/Database2/m.db.sql"};
+            script << "BEGIN TRANSACTION;\n"
+                      "CREATE TABLE Example (\n"
+                      "  id INTEGER PRIMARY KEY, -- Comment; with semicolon\n"
+                      "  name TEXT);\n"
+                      "INSERT INTO Example VALUES (1, 'a;b');\n"
+                      "INSERT INTO Missing\n"
+                      "  VALUES (2);\n"
+                      "COMMIT;\n";
+        }
+
+        // Act/Assert
+        try
+        {
+            e::create_database_from_scripts(db_dir, script_dir);
+            BOOST_FAIL("Expected script_error to be thrown");
+        }
+        catch (const djinterop::script_error& ex)
+        {
+            BOOST_CHECK_EQUAL(ex.line(), 6u);
+            BOOST_CHECK_EQUAL(ex.offset(), 148u);
+        }
+    }
+}
@@ -20,11 +20,13 @@
 #include <boost/test/data/test_case.hpp>
 #include <boost/test/included/unit_test.hpp>
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <djinterop/crate.hpp>
 #include <djinterop/engine/engine.hpp>
+#include <djinterop/exceptions.hpp>
 #include <djinterop/track.hpp>
 #include <djinterop/track_snapshot.hpp>
 
@@ -36,6 +38,30 @@
 namespace utf = boost::unit_test;
 namespace e = djinterop::engine;
 
+namespace
+{
+struct recorded_statement
+{
+    std::string sql;
+    int64_t rows;
+    std::string operation;
+    std::string prepared_sql;
+};
+
+class recording_observer : public djinterop::sql_observer
+{
+public:
+    void on_statement(const djinterop::sql_statement_event& event) override
+    {
+        statements.push_back(recorded_statement{
+            std::string{event.sql}, event.rows,
+            std::string{event.operation}, std::string{event.prepared_sql}});
+    }
+
+    std::vector<recorded_statement> statements;
+};
+}  // anonymous namespace
+
 
 BOOST_TEST_DECORATOR(* utf::description(
     "database::create_root_crate() for all supported schema versions"))
@@ -105,6 +131,62 @@ BOOST_DATA_TEST_CASE(
     BOOST_CHECK_NE(track.id(), 0);
 }
 
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::create_tracks() for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    create_tracks__supported_version__creates_all, e::supported_schemas,
+    schema)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+
+    std::vector<djinterop::track_snapshot> snapshots(3);
+    for (size_t i = 0; i < snapshots.size(); ++i)
+    {
+        populate_track_snapshot(
+            snapshots[i], example_track_data_variation::minimal_1,
+            example_track_data_usage::create, schema);
+        snapshots[i].relative_path =
+            "../Music/Track " + std::to_string(i) + ".mp3";
+    }
+
+    // Act
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating tracks...");
+    auto tracks = db.create_tracks(snapshots);
+
+    // Assert
+    BOOST_REQUIRE_EQUAL(tracks.size(), snapshots.size());
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        BOOST_CHECK_NE(tracks[i].id(), 0);
+        BOOST_CHECK(tracks[i].relative_path() == snapshots[i].relative_path);
+    }
+
+    BOOST_CHECK_EQUAL(db.tracks().size(), snapshots.size());
+}
+
+BOOST_TEST_DECORATOR(* utf::description(
+    "database::create_tracks() with an invalid snapshot creates no tracks"))
+BOOST_DATA_TEST_CASE(
+    create_tracks__invalid_snapshot__creates_none, e::supported_schemas,
+    schema)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+
+    std::vector<djinterop::track_snapshot> snapshots(2);
+    populate_track_snapshot(
+        snapshots[0], example_track_data_variation::minimal_1,
+        example_track_data_usage::create, schema);
+
+    // Act/Assert
+    BOOST_CHECK_THROW(
+        db.create_tracks(snapshots), djinterop::invalid_track_snapshot);
+    BOOST_CHECK_EQUAL(db.tracks().size(), 0);
+}
+
 BOOST_TEST_DECORATOR(* utf::description(
     "database::remove_track() for all supported schema versions"))
 BOOST_DATA_TEST_CASE(
@@ -244,3 +326,137 @@ BOOST_DATA_TEST_CASE(track_by_id__invalid_id__no_ids, e::supported_schemas, sche
     // Assert
     BOOST_CHECK(!result);
 }
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::set_observer(), track snapshot, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    set_observer__snapshot__reports_statements, e::supported_schemas, schema)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        snapshot, example_track_data_variation::basic_metadata_only_1,
+        example_track_data_usage::create, schema);
+    auto track = db.create_track(snapshot);
+
+    auto observer = std::make_shared<recording_observer>();
+    db.set_observer(observer);
+
+    // Act
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Taking snapshot...");
+    track.snapshot();
+
+    // Assert
+    BOOST_REQUIRE(!observer->statements.empty());
+    int64_t total_rows = 0;
+    for (auto&& statement : observer->statements)
+    {
+        BOOST_CHECK_EQUAL(statement.operation, "track::snapshot");
+        BOOST_CHECK(!statement.sql.empty());
+        BOOST_CHECK_EQUAL(statement.sql.find('\''), std::string::npos);
+        BOOST_CHECK(!statement.prepared_sql.empty());
+        total_rows += statement.rows;
+    }
+
+    BOOST_CHECK_GT(total_rows, 0);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::set_observer(), observer removed, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    set_observer__removed__no_statements, e::supported_schemas, schema)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+    auto observer = std::make_shared<recording_observer>();
+    db.set_observer(observer);
+    db.tracks();
+    BOOST_REQUIRE(!observer->statements.empty());
+    observer->statements.clear();
+
+    // Act
+    db.set_observer(nullptr);
+    db.tracks();
+
+    // Assert
+    BOOST_CHECK(observer->statements.empty());
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::metrics(), create and read track, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    metrics__create_and_read_track__counters_increase, e::supported_schemas,
+    schema)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        snapshot, example_track_data_variation::fully_analysed_1,
+        example_track_data_usage::create, schema);
+    db.set_metrics_enabled(true);
+    auto before = db.metrics();
+
+    // Act
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating and reading track...");
+    auto track = db.create_track(snapshot);
+    track.snapshot();
+    auto after = db.metrics();
+
+    // Assert
+    BOOST_CHECK_GT(after.statements_executed, before.statements_executed);
+    BOOST_CHECK_GT(after.statements_prepared, before.statements_prepared);
+    BOOST_CHECK_LE(after.statements_prepared, after.statements_executed);
+    BOOST_CHECK_GT(after.rows_read, before.rows_read);
+    BOOST_CHECK_GT(after.rows_written, before.rows_written);
+    BOOST_CHECK_GT(
+        after.transactions_committed, before.transactions_committed);
+
+    auto& before_beats = before.blob(djinterop::blob_type::beat_data);
+    auto& after_beats = after.blob(djinterop::blob_type::beat_data);
+    BOOST_CHECK_GT(after_beats.encoded, before_beats.encoded);
+    BOOST_CHECK_GT(after_beats.decoded, before_beats.decoded);
+    BOOST_CHECK_GT(after_beats.compressed_bytes, before_beats.compressed_bytes);
+    BOOST_CHECK_GT(
+        after_beats.uncompressed_bytes, before_beats.uncompressed_bytes);
+    BOOST_CHECK(after.zlib_compress_time > before.zlib_compress_time);
+    BOOST_CHECK(after.zlib_uncompress_time > before.zlib_uncompress_time);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::metrics(), SQL metrics not enabled, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    metrics__not_enabled__sql_counters_unchanged, e::supported_schemas, schema)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        snapshot, example_track_data_variation::minimal_1,
+        example_track_data_usage::create, schema);
+    db.set_metrics_enabled(true);
+    db.set_metrics_enabled(false);
+    auto before = db.metrics();
+
+    // Act
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating and reading track...");
+    auto track = db.create_track(snapshot);
+    track.snapshot();
+    auto after = db.metrics();
+
+    // Assert
+    BOOST_CHECK_EQUAL(after.statements_executed, before.statements_executed);
+    BOOST_CHECK_EQUAL(after.statements_prepared, before.statements_prepared);
+    BOOST_CHECK_EQUAL(after.rows_read, before.rows_read);
+    BOOST_CHECK_EQUAL(
+        after.transactions_committed, before.transactions_committed);
+    BOOST_CHECK_GT(after.rows_written, before.rows_written);
+}
@@ -19,6 +19,8 @@
 #include <boost/test/data/test_case.hpp>
 #include <boost/test/included/unit_test.hpp>
 
+#include <fstream>
+#include <string>
 #include <vector>
 
 #include <djinterop/engine/engine.hpp>
@@ -26,6 +28,9 @@
 
 #include "../temporary_directory.hpp"
 
+#define STRINGIFY(x) STRINGIFY_(x)
+#define STRINGIFY_(x) #x
+
 namespace utf = boost::unit_test;
 namespace e = djinterop::engine;
 
@@ -48,6 +53,85 @@ BOOST_DATA_TEST_CASE(
     }
 }
 
+BOOST_TEST_DECORATOR(
+    *utf::description("create_database() creates a distinct identity for "
+                      "each library of the same schema"))
+BOOST_DATA_TEST_CASE(
+    create_database__same_version_twice__distinct_uuids, e::supported_schemas,
+    schema)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange/Act
+        auto db1 = e::create_database(tmp_loc.temp_dir + "/first", schema);
+        auto db2 = e::create_database(tmp_loc.temp_dir + "/second", schema);
+        auto db3 = e::create_temporary_database(schema);
+        e::engine_schema loaded_schema{};
+        auto reloaded =
+            e::load_database(tmp_loc.temp_dir + "/first", loaded_schema);
+
+        // Assert
+        BOOST_CHECK_NO_THROW(db2.verify());
+        BOOST_CHECK_NO_THROW(db3.verify());
+        BOOST_CHECK_NO_THROW(reloaded.verify());
+        BOOST_CHECK(loaded_schema == schema);
+        BOOST_CHECK_EQUAL(reloaded.uuid(), db1.uuid());
+        BOOST_CHECK_NE(db1.uuid(), db2.uuid());
+        BOOST_CHECK_NE(db1.uuid(), db3.uuid());
+        BOOST_CHECK_NE(db2.uuid(), db3.uuid());
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("verify_databases() with a mix of valid and invalid "
+                      "databases"))
+BOOST_AUTO_TEST_CASE(verify_databases__mixed__reports_each)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto ref_script_path =
+            std::string{STRINGIFY(TESTDATA_DIR)} +
+            "/ref/engine/desktop/desktop-4.3.4/Database2/m.db.sql";
+        auto script_dir = tmp_loc.temp_dir + "/scripts";
+        auto db_dir = tmp_loc.temp_dir + "/db";
+        boost::filesystem::create_directories(script_dir + "/Database2");
+        boost::filesystem::create_directories(db_dir);
+        {
+            // Omit all indices from an otherwise valid script.
+            std::ifstream ref_script{ref_script_path};
+            std::ofstream script{script_dir + "/Database2/m.db.sql"};
+            std::string line;
+            while (std::getline(ref_script, line))
+            {
+                if (line.rfind("CREATE INDEX", 0) != 0)
+                    script << line << "\n";
+            }
+        }
+
+        std::vector<djinterop::database> dbs{
+            e::create_temporary_database(e::latest_v1_schema),
+            e::create_database_from_scripts(db_dir, script_dir),
+            e::create_temporary_database(e::latest_v2_schema),
+            e::create_temporary_database(e::latest_v3_schema)};
+
+        // Act
+        auto results = e::verify_databases(dbs, 2);
+
+        // Assert
+        BOOST_REQUIRE_EQUAL(results.size(), dbs.size());
+        BOOST_CHECK(results[0].verified);
+        BOOST_CHECK(!results[1].verified);
+        BOOST_CHECK(!results[1].error.empty());
+        BOOST_CHECK(results[2].verified);
+        BOOST_CHECK(results[3].verified);
+    }
+}
+
 BOOST_TEST_DECORATOR(
     *utf::description("load_database() with a non-existent path"))
 BOOST_AUTO_TEST_CASE(load_database__fake_path__throw)
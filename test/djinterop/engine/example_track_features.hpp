@@ -0,0 +1,102 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <djinterop/engine/engine.hpp>
+#include <djinterop/musical_key.hpp>
+#include <djinterop/track_feature_index.hpp>
+#include <djinterop/track_snapshot.hpp>
+
+#include "example_track_data.hpp"
+
+/// Generate features for tracks, some of which lack some features.
+///
+/// The track with index `i` has id `id_step * i + 1`, so that ids between
+/// those generated are unused.
+inline std::vector<djinterop::track_features> make_random_features(
+    std::size_t count, uint32_t seed, int64_t id_step = 2)
+{
+    std::mt19937 rng{seed};
+    std::uniform_real_distribution<double> bpm(60, 180);
+    std::uniform_int_distribution<int> key(0, 23);
+    std::uniform_real_distribution<double> loudness(0.05, 1);
+    std::uniform_int_distribution<int> duration(30, 600);
+    std::uniform_int_distribution<int> genre(0, 3);
+    std::bernoulli_distribution present(0.9);
+
+    std::vector<djinterop::track_features> result;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        djinterop::track_features features;
+        features.id = id_step * static_cast<int64_t>(i) + 1;
+        if (present(rng))
+            features.bpm = bpm(rng);
+        if (present(rng))
+            features.key = static_cast<djinterop::musical_key>(key(rng));
+        if (present(rng))
+            features.average_loudness = loudness(rng);
+        if (present(rng))
+            features.duration = std::chrono::seconds{duration(rng)};
+        if (present(rng))
+            features.genre = "Genre " + std::to_string(genre(rng));
+
+        result.push_back(features);
+    }
+
+    return result;
+}
+
+/// Make a snapshot of an example track, whose file is named after its title.
+inline djinterop::track_snapshot make_titled_snapshot(
+    const djinterop::engine::engine_schema& schema,
+    example_track_data_variation variation, const std::string& title)
+{
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        snapshot, variation, example_track_data_usage::create, schema);
+    snapshot.relative_path = "../" + title + ".mp3";
+    snapshot.title = title;
+    return snapshot;
+}
+
+/// Make a snapshot of a track with basic metadata and the given features,
+/// whose file is named after its title.
+inline djinterop::track_snapshot make_feature_snapshot(
+    const djinterop::engine::engine_schema& schema, const std::string& title,
+    std::optional<double> bpm, std::optional<djinterop::musical_key> key,
+    std::optional<double> average_loudness = 0.5,
+    std::optional<std::string> genre = std::nullopt)
+{
+    auto snapshot = make_titled_snapshot(
+        schema, example_track_data_variation::basic_metadata_only_1, title);
+    snapshot.bpm = bpm;
+    snapshot.key = key;
+    snapshot.average_loudness = average_loudness;
+    snapshot.duration = std::chrono::seconds{200};
+    snapshot.genre = std::move(genre);
+    return snapshot;
+}
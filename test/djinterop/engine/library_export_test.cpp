@@ -0,0 +1,246 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE engine_library_export_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <djinterop/djinterop.hpp>
+#include <djinterop/engine/engine.hpp>
+#include <djinterop/engine/v2/engine_library.hpp>
+#include <djinterop/engine/v3/engine_library.hpp>
+
+#include "../boost_test_printable.hpp"
+#include "../boost_test_utils.hpp"
+#include "../temporary_directory.hpp"
+#include "example_track_data.hpp"
+
+namespace utf = boost::unit_test;
+namespace e = djinterop::engine;
+namespace ev2 = djinterop::engine::v2;
+namespace ev3 = djinterop::engine::v3;
+
+namespace
+{
+djinterop::track create_example_track(
+    djinterop::database& db, const std::string& relative_path,
+    e::engine_schema schema)
+{
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        snapshot, example_track_data_variation::fully_analysed_1,
+        example_track_data_usage::create, schema);
+    snapshot.relative_path = relative_path;
+    return db.create_track(snapshot);
+}
+
+const std::vector<std::byte> example_extra_data{
+    std::byte{0xDE}, std::byte{0xAD}, std::byte{0xBE}, std::byte{0xEF}};
+}  // namespace
+
+BOOST_TEST_DECORATOR(
+    *utf::description("export_to() copies playlists and tracks losslessly"))
+BOOST_DATA_TEST_CASE(
+    export_to__v2_playlist__copies_losslessly, e::supported_v2_schemas, schema)
+{
+    // Arrange
+    auto source = ev2::engine_library::create_temporary(schema);
+    auto target = ev2::engine_library::create_temporary(schema);
+    auto source_db = source.database();
+    auto t1 = create_example_track(source_db, "../a.mp3", schema);
+    auto t2 = create_example_track(source_db, "../b.mp3", schema);
+    auto beat_data = source.track().get_beat_data(t1.id());
+    beat_data.extra_data = example_extra_data;
+    source.track().set_beat_data(t1.id(), beat_data);
+    auto pl = source_db.create_root_playlist("Export");
+    pl.add_track_back(t2);
+    pl.add_track_back(t1);
+    auto sub_pl = pl.create_sub_playlist("Child");
+    sub_pl.add_track_back(t1);
+    source_db.create_root_playlist("Not exported");
+    auto pl_id = *source.playlist().find_root_id("Export");
+
+    // Act
+    auto result = source.export_to(target, {pl_id});
+
+    // Assert
+    BOOST_CHECK_EQUAL(result.tracks_added, 2);
+    BOOST_CHECK_EQUAL(result.playlists_added, 2);
+    BOOST_REQUIRE_EQUAL(result.track_ids.size(), 2u);
+    for (auto&& [source_id, target_id] : result.track_ids)
+    {
+        auto expected = source.track().get(source_id);
+        auto actual = target.track().get(target_id);
+        BOOST_REQUIRE(expected);
+        BOOST_REQUIRE(actual);
+        BOOST_CHECK_EQUAL(actual->path, expected->path);
+        BOOST_CHECK_EQUAL(actual->track_data, expected->track_data);
+        BOOST_CHECK_EQUAL(actual->beat_data, expected->beat_data);
+        BOOST_CHECK_EQUAL(actual->quick_cues, expected->quick_cues);
+        BOOST_CHECK_EQUAL(actual->loops, expected->loops);
+        BOOST_CHECK_EQUAL(
+            actual->overview_waveform_data, expected->overview_waveform_data);
+    }
+
+    BOOST_CHECK(
+        target.track().get_beat_data(result.track_ids[t1.id()]).extra_data ==
+        example_extra_data);
+
+    auto target_pl_id = target.playlist().find_root_id("Export");
+    BOOST_REQUIRE(target_pl_id);
+    BOOST_CHECK(!target.playlist().find_root_id("Not exported"));
+    auto target_track_ids = target.playlist_entity().track_ids(*target_pl_id);
+    BOOST_REQUIRE_EQUAL(target_track_ids.size(), 2u);
+    BOOST_CHECK_EQUAL(target_track_ids[0], result.track_ids[t2.id()]);
+    BOOST_CHECK_EQUAL(target_track_ids[1], result.track_ids[t1.id()]);
+
+    auto target_sub_pl_id = target.playlist().find_id(*target_pl_id, "Child");
+    BOOST_REQUIRE(target_sub_pl_id);
+    auto target_sub_track_ids =
+        target.playlist_entity().track_ids(*target_sub_pl_id);
+    BOOST_REQUIRE_EQUAL(target_sub_track_ids.size(), 1u);
+    BOOST_CHECK_EQUAL(target_sub_track_ids[0], result.track_ids[t1.id()]);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("export_to() copies performance data losslessly"))
+BOOST_DATA_TEST_CASE(
+    export_to__v3_track__copies_performance_data, e::supported_v3_schemas,
+    schema)
+{
+    // Arrange
+    auto source = ev3::engine_library::create_temporary(schema);
+    auto target = ev3::engine_library::create_temporary(schema);
+    auto source_db = source.database();
+    auto t1 = create_example_track(source_db, "../a.mp3", schema);
+    auto quick_cues = source.performance_data().get(t1.id())->quick_cues;
+    quick_cues.extra_data = example_extra_data;
+    source.performance_data().set_quick_cues(t1.id(), quick_cues);
+
+    // Act
+    auto result = source.export_to(target, {}, {t1.id()});
+
+    // Assert
+    BOOST_CHECK_EQUAL(result.tracks_added, 1);
+    auto target_id = result.track_ids[t1.id()];
+    auto expected = source.performance_data().get(t1.id());
+    auto actual = target.performance_data().get(target_id);
+    BOOST_REQUIRE(expected);
+    BOOST_REQUIRE(actual);
+    BOOST_CHECK_EQUAL(actual->track_data, expected->track_data);
+    BOOST_CHECK_EQUAL(actual->beat_data, expected->beat_data);
+    BOOST_CHECK_EQUAL(actual->quick_cues, expected->quick_cues);
+    BOOST_CHECK_EQUAL(actual->loops, expected->loops);
+    BOOST_CHECK_EQUAL(
+        actual->overview_waveform_data, expected->overview_waveform_data);
+    BOOST_CHECK(actual->quick_cues.extra_data == example_extra_data);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("export_to() twice re-uses existing tracks"))
+BOOST_DATA_TEST_CASE(
+    export_to__repeated__reuses_existing, e::supported_v2_schemas, schema)
+{
+    // Arrange
+    auto source = ev2::engine_library::create_temporary(schema);
+    auto target = ev2::engine_library::create_temporary(schema);
+    auto source_db = source.database();
+    auto t1 = create_example_track(source_db, "../a.mp3", schema);
+    auto pl = source_db.create_root_playlist("Export");
+    pl.add_track_back(t1);
+    auto pl_id = *source.playlist().find_root_id("Export");
+    auto first_result = source.export_to(target, {pl_id});
+
+    // Act
+    auto result = source.export_to(target, {pl_id});
+
+    // Assert
+    BOOST_CHECK_EQUAL(result.tracks_added, 0);
+    BOOST_CHECK_EQUAL(result.playlists_added, 0);
+    BOOST_CHECK_EQUAL(result.track_ids[t1.id()], first_result.track_ids[t1.id()]);
+    BOOST_CHECK_EQUAL(target.track().all_ids().size(), 1u);
+    BOOST_CHECK_EQUAL(
+        target.playlist_entity().track_ids(result.playlist_ids[pl_id]).size(),
+        1u);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("export_to() between incompatible schemas throws"))
+BOOST_AUTO_TEST_CASE(export_to__incompatible_schemas__throws)
+{
+    // Arrange
+    auto source = ev2::engine_library::create_temporary(e::latest_v2_schema);
+    auto target = ev3::engine_library::create_temporary(e::latest_v3_schema);
+
+    // Act/Assert
+    BOOST_CHECK_THROW(
+        source.export_to(target, {}), djinterop::unsupported_operation);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("export_files_to() copies files and then skips them"))
+BOOST_DATA_TEST_CASE(
+    export_files_to__valid__copies_then_skips, e::supported_v2_schemas, schema)
+{
+    // Arrange
+    temporary_directory source_dir;
+    temporary_directory target_dir;
+    auto source = ev2::engine_library::create(
+        source_dir.temp_dir + "/Engine Library", schema);
+    auto target = ev2::engine_library::create(
+        target_dir.temp_dir + "/Engine Library", schema);
+    auto source_db = source.database();
+    auto t1 = create_example_track(source_db, "../Music/a.mp3", schema);
+    auto t2 = create_example_track(source_db, "../Music/b.mp3", schema);
+    boost::filesystem::create_directories(source_dir.temp_dir_path / "Music");
+    for (auto&& name : {"a.mp3", "b.mp3"})
+    {
+        std::ofstream out{(source_dir.temp_dir_path / "Music" / name).string()};
+        out << std::string(1024, 'x');
+    }
+
+    auto export_result = source.export_to(target, {}, {t1.id(), t2.id()});
+    e::file_transfer_options options;
+    options.max_workers = 2;
+    options.manifest_path = target_dir.temp_dir + "/manifest.txt";
+    int64_t progress_calls = 0;
+    options.on_progress = [&](const e::file_transfer_progress&)
+    { ++progress_calls; };
+
+    // Act
+    auto first_report = source.export_files_to(target, export_result, options);
+    auto second_report =
+        source.export_files_to(target, export_result, options);
+
+    // Assert
+    BOOST_CHECK(first_report.failures.empty());
+    BOOST_CHECK_EQUAL(first_report.files_copied, 2);
+    BOOST_CHECK_EQUAL(first_report.bytes_copied, 2048);
+    BOOST_CHECK_GT(progress_calls, 0);
+    BOOST_CHECK_EQUAL(
+        boost::filesystem::file_size(
+            target_dir.temp_dir_path / "Music" / "a.mp3"),
+        1024u);
+    BOOST_CHECK_EQUAL(second_report.files_copied, 0);
+    BOOST_CHECK_EQUAL(second_report.files_skipped, 2);
+}
@@ -0,0 +1,145 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE engine_migration_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include <djinterop/djinterop.hpp>
+#include <djinterop/engine/engine.hpp>
+#include <djinterop/engine/migration.hpp>
+
+#include "../boost_test_printable.hpp"
+#include "../boost_test_utils.hpp"
+#include "../temporary_directory.hpp"
+#include "example_track_data.hpp"
+
+namespace utf = boost::unit_test;
+namespace e = djinterop::engine;
+
+namespace
+{
+constexpr std::array migration_target_schemas{
+    e::latest_v2_schema, e::latest_v3_schema};
+
+djinterop::track create_example_track(
+    djinterop::database& db, const std::string& relative_path,
+    e::engine_schema schema)
+{
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        snapshot, example_track_data_variation::fully_analysed_1,
+        example_track_data_usage::create, schema);
+    snapshot.relative_path = relative_path;
+    return db.create_track(snapshot);
+}
+}  // namespace
+
+BOOST_TEST_DECORATOR(
+    *utf::description("migrate_database() from v1 to later schemas"))
+BOOST_DATA_TEST_CASE(
+    migrate_database__v1_to_later__migrates,
+    e::supported_v1_schemas* migration_target_schemas, source_schema,
+    target_schema)
+{
+    // Arrange
+    temporary_directory tmp_loc;
+    auto source = e::create_temporary_database(source_schema);
+    auto t1 = create_example_track(source, "../a.flac", source_schema);
+    auto t2 = create_example_track(source, "../b.flac", source_schema);
+    auto cr = source.create_root_crate("Shared name");
+    cr.add_track(t1);
+    auto sub_cr = cr.create_sub_crate("Sub crate");
+    sub_cr.add_track(t2);
+    auto pl = source.create_root_playlist("Shared name");
+    pl.add_track_back(t2);
+    source.create_root_playlist("Empty");
+    int64_t progress_calls = 0;
+    e::migration_options options;
+    options.batch_size = 1;
+    options.on_progress = [&](const e::migration_progress&)
+    { ++progress_calls; };
+
+    // Act
+    auto report =
+        e::migrate_database(source, tmp_loc.temp_dir, target_schema, options);
+
+    // Assert
+    BOOST_CHECK_EQUAL(report.target_schema, target_schema);
+    BOOST_CHECK_EQUAL(report.tracks_migrated, 2);
+    BOOST_CHECK_EQUAL(report.tracks_verified, 2);
+    BOOST_CHECK(report.verification_failures.empty());
+    BOOST_CHECK_GT(progress_calls, 0);
+
+    e::engine_schema loaded_schema;
+    auto target = e::load_database(tmp_loc.temp_dir, loaded_schema);
+    BOOST_CHECK_EQUAL(loaded_schema, target_schema);
+    BOOST_REQUIRE_EQUAL(target.tracks().size(), 2u);
+    for (auto&& tr : target.tracks())
+    {
+        auto snapshot = tr.snapshot();
+        auto extents = e::calculate_overview_waveform_extents(
+            *snapshot.sample_count, *snapshot.sample_rate);
+        BOOST_CHECK_EQUAL(snapshot.waveform.size(), extents.size);
+    }
+
+    // Crates and playlists of the same name are merged in later schemas.
+    auto target_pl = target.root_playlist_by_name("Shared name");
+    BOOST_REQUIRE(target_pl);
+    BOOST_CHECK_EQUAL(target_pl->tracks().size(), 2u);
+    auto target_sub_pl = target_pl->sub_playlist_by_name("Sub crate");
+    BOOST_REQUIRE(target_sub_pl);
+    BOOST_CHECK_EQUAL(target_sub_pl->tracks().size(), 1u);
+    BOOST_CHECK(target.root_playlist_by_name("Empty"));
+}
+
+BOOST_TEST_DECORATOR(*utf::description("migrate_database() from v2 to v3"))
+BOOST_DATA_TEST_CASE(
+    migrate_database__v2_to_v3__migrates, e::supported_v2_schemas,
+    source_schema)
+{
+    // Arrange
+    temporary_directory tmp_loc;
+    auto source = e::create_temporary_database(source_schema);
+    auto t1 = create_example_track(source, "../a.flac", source_schema);
+    auto pl = source.create_root_playlist("Parent");
+    auto sub_pl = pl.create_sub_playlist("Child");
+    sub_pl.add_track_back(t1);
+
+    // Act
+    auto report = e::migrate_database(
+        source, tmp_loc.temp_dir, e::latest_v3_schema);
+
+    // Assert
+    BOOST_CHECK_EQUAL(report.tracks_migrated, 1);
+    BOOST_CHECK_EQUAL(report.playlists_migrated, 2);
+    BOOST_CHECK_EQUAL(report.list_entries_migrated, 1);
+    BOOST_CHECK(report.verification_failures.empty());
+
+    auto target = e::load_database(tmp_loc.temp_dir);
+    auto target_pl = target.root_playlist_by_name("Parent");
+    BOOST_REQUIRE(target_pl);
+    auto target_sub_pl = target_pl->sub_playlist_by_name("Child");
+    BOOST_REQUIRE(target_sub_pl);
+    BOOST_REQUIRE_EQUAL(target_sub_pl->tracks().size(), 1u);
+    BOOST_CHECK_EQUAL(
+        target_sub_pl->tracks()[0].relative_path(), "../a.flac");
+}
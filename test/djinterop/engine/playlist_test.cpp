@@ -29,6 +29,7 @@
 #include <djinterop/track_snapshot.hpp>
 
 #include "../boost_test_utils.hpp"
+#include "budget.hpp"
 #include "example_track_data.hpp"
 
 namespace e = djinterop::engine;
@@ -613,3 +614,64 @@ BOOST_DATA_TEST_CASE(sub_playlist_by_name__invalid__none, e::supported_schemas,
     // Assert
     BOOST_CHECK(!result);
 }
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "playlist::children() and name() statement budget for all supported "
+    "schema versions"))
+BOOST_DATA_TEST_CASE(
+    children_and_name__statement_budget__within_budget,
+    e::supported_schemas * utf::data::make(budget_item_counts), schema,
+    item_count)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+    auto nested = db.supports_feature(
+        djinterop::feature::supports_nested_playlists);
+    auto parent = db.create_root_playlist("Example Root Playlist");
+    for (int64_t i = 0; i < item_count; ++i)
+    {
+        auto name = "Example Playlist " + std::to_string(i);
+        if (nested)
+            parent.create_sub_playlist(name);
+        else
+            db.create_root_playlist(name);
+    }
+
+    // Schemas without nested playlists list root playlists instead, which
+    // include the parent itself.  Fetching the name of each playlist is a
+    // known N+1 pattern.
+    auto budget = budget_for(schema, {2, 1}, {1, 1}, {1, 1});
+
+    // Act
+    auto actual = count_statements(db, [&] {
+        auto children = nested ? parent.children() : db.root_playlists();
+        for (auto&& child : children)
+            child.name();
+    });
+
+    // Assert
+    DJINTEROP_CHECK_BUDGET("Statements issued", actual, budget, item_count);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "playlist::tracks() statement budget for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    tracks__statement_budget__within_budget,
+    e::supported_schemas * utf::data::make(budget_item_counts), schema,
+    item_count)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+    auto playlist = db.create_root_playlist("Example Root Playlist");
+    auto tracks = create_budget_tracks(db, schema, item_count);
+    playlist.add_tracks_back(tracks.begin(), tracks.end());
+    auto budget = budget_for(schema, {1, 0}, {1, 0}, {1, 0});
+
+    // Act
+    auto actual = count_statements(db, [&] { playlist.tracks(); });
+
+    // Assert
+    DJINTEROP_CHECK_BUDGET("Statements issued", actual, budget, item_count);
+}
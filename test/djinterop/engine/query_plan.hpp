@@ -0,0 +1,435 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include <djinterop/engine/engine_schema.hpp>
+#include <djinterop/sql_observer.hpp>
+
+/// Observer that collects the distinct statements issued against a database,
+/// along with the public operation that first issued each one.
+///
+/// Statements are collected as prepared rather than normalised, as replacing
+/// a literal value by a parameter can change the plan chosen for a query.
+class statement_collector : public djinterop::sql_observer
+{
+public:
+    void on_statement(const djinterop::sql_statement_event& event) override
+    {
+        statements.emplace(
+            std::string{event.prepared_sql}, std::string{event.operation});
+    }
+
+    std::map<std::string, std::string> statements;
+};
+
+/// A full scan of a table found in the query plan of a statement.
+struct table_scan
+{
+    std::string operation;
+    std::string sql;
+    std::string table;
+    std::string detail;
+    int64_t table_rows;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const table_scan& scan)
+{
+    return os << "SCAN of " << scan.table << " (" << scan.table_rows
+              << " rows) by " << scan.operation << ": " << scan.sql;
+}
+
+/// Result of inspecting the query plans of a set of statements.
+struct query_plan_report
+{
+    /// Number of statements whose query plans were inspected.
+    std::size_t statements_explained = 0;
+
+    /// Full scans of watched tables found in the query plans.
+    std::vector<table_scan> scans;
+};
+
+/// The `query_plan_inspector` class opens a second, independent connection to
+/// the files of an Engine library on disk, so that the query plans of the
+/// statements issued by the library can be inspected.
+class query_plan_inspector
+{
+public:
+    query_plan_inspector(
+        const std::string& directory,
+        const djinterop::engine::engine_schema& schema) :
+        db_{open(
+            schema >= djinterop::engine::engine_schema::schema_2_18_0
+                ? directory + "/Database2/m.db"
+                : ":memory:")},
+        schema_name_{
+            schema >= djinterop::engine::engine_schema::schema_2_18_0
+                ? "main"
+                : "music"}
+    {
+        if (schema < djinterop::engine::engine_schema::schema_2_18_0)
+        {
+            // Attach the legacy databases in the same way as the library, so
+            // that unqualified table names resolve identically.
+            exec("ATTACH '" + directory + "/m.db' AS 'music'");
+            exec("ATTACH '" + directory + "/p.db' AS 'perfdata'");
+        }
+
+        // Query plans of statements on views refer to tables by the aliases
+        // given in the definitions of the views.
+        auto sql = "SELECT sql FROM " + schema_name_ +
+                   ".sqlite_master WHERE type = 'view'";
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db_.get(), sql.c_str(), -1, &stmt, nullptr) ==
+            SQLITE_OK)
+        {
+            while (sqlite3_step(stmt) == SQLITE_ROW)
+            {
+                auto text = sqlite3_column_text(stmt, 0);
+                view_aliases_.merge(
+                    table_aliases(reinterpret_cast<const char*>(text)));
+            }
+        }
+
+        sqlite3_finalize(stmt);
+    }
+
+    /// Get the query plan of a statement.
+    ///
+    /// \param sql Statement text, in which any parameters are left unbound.
+    /// \return Returns the detail text of each step of the plan.
+    /// \throws std::runtime_error If the plan cannot be obtained, such as
+    ///         when the statement refers to a table that is not visible to
+    ///         the inspector's connection.
+    std::vector<std::string> explain(const std::string& sql) const
+    {
+        std::vector<std::string> details;
+        sqlite3_stmt* stmt = nullptr;
+        auto eqp = "EXPLAIN QUERY PLAN " + sql;
+        auto rc =
+            sqlite3_prepare_v2(db_.get(), eqp.c_str(), -1, &stmt, nullptr);
+        if (rc == SQLITE_OK)
+        {
+            while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+            {
+                // Columns are: id, parent, notused, detail.
+                auto text = sqlite3_column_text(stmt, 3);
+                details.emplace_back(reinterpret_cast<const char*>(text));
+            }
+        }
+
+        if (rc != SQLITE_DONE)
+        {
+            std::string message = sqlite3_errmsg(db_.get());
+            sqlite3_finalize(stmt);
+            throw std::runtime_error{
+                "Failed to explain query plan: " + message + ": " + sql};
+        }
+
+        sqlite3_finalize(stmt);
+        return details;
+    }
+
+    /// Test whether a library table exists, as opposed to a view or nothing.
+    ///
+    /// \param table Name of the table.
+    /// \return Returns `true` if the table exists.
+    bool has_table(const std::string& table) const
+    {
+        auto sql = "SELECT COUNT(*) FROM " + schema_name_ +
+                   ".sqlite_master WHERE type = 'table' AND name = ?";
+        sqlite3_stmt* stmt = nullptr;
+        auto found =
+            sqlite3_prepare_v2(db_.get(), sql.c_str(), -1, &stmt, nullptr) ==
+                SQLITE_OK &&
+            sqlite3_bind_text(stmt, 1, table.c_str(), -1, SQLITE_TRANSIENT) ==
+                SQLITE_OK &&
+            sqlite3_step(stmt) == SQLITE_ROW &&
+            sqlite3_column_int64(stmt, 0) != 0;
+        sqlite3_finalize(stmt);
+        return found;
+    }
+
+    /// Get the number of rows in a table.
+    ///
+    /// \param table Name of the table.
+    /// \return Returns the number of rows, or zero if there is no such table.
+    int64_t row_count(const std::string& table) const
+    {
+        int64_t count = 0;
+        sqlite3_stmt* stmt = nullptr;
+        auto sql = "SELECT COUNT(*) FROM " + table;
+        if (sqlite3_prepare_v2(db_.get(), sql.c_str(), -1, &stmt, nullptr) ==
+                SQLITE_OK &&
+            sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            count = sqlite3_column_int64(stmt, 0);
+        }
+
+        sqlite3_finalize(stmt);
+        return count;
+    }
+
+    /// Find full scans of watched tables in the query plans of statements.
+    ///
+    /// Only scans of tables are reported.  A scan of a view is of rows that
+    /// have already been found by the plan for the view itself.
+    ///
+    /// \param statements Map of statement text to issuing operation.
+    /// \param tables Names of the tables to watch.
+    /// \param min_rows Minimum number of rows in a table for a scan of it to
+    ///                 be reported.
+    /// \return Returns the scans found, and the number of statements whose
+    ///         plans were inspected.
+    /// \throws std::runtime_error If the plan of a statement cannot be
+    ///         obtained.
+    query_plan_report find_scans(
+        const std::map<std::string, std::string>& statements,
+        const std::vector<std::string>& tables, int64_t min_rows) const
+    {
+        std::map<std::string, int64_t> sizes;
+        for (auto&& table : tables)
+        {
+            if (has_table(table))
+                sizes[table] = row_count(table);
+        }
+
+        query_plan_report report;
+        for (auto&& [sql, operation] : statements)
+        {
+            if (!is_query(sql))
+                continue;
+
+            auto aliases = table_aliases(sql);
+            aliases.insert(view_aliases_.begin(), view_aliases_.end());
+            for (auto&& detail : explain(sql))
+            {
+                auto table = scanned_table(detail);
+                auto alias = aliases.find(table);
+                if (alias != aliases.end())
+                    table = alias->second;
+
+                auto size = sizes.find(table);
+                if (size != sizes.end() && size->second >= min_rows)
+                {
+                    report.scans.push_back(table_scan{
+                        operation, sql, table, detail, size->second});
+                }
+            }
+
+            ++report.statements_explained;
+        }
+
+        return report;
+    }
+
+    /// Determine whether a statement reads or writes table data, and so has a
+    /// query plan worth inspecting.
+    static bool is_query(std::string_view sql)
+    {
+        std::string first_word;
+        for (auto c : sql)
+        {
+            if (!std::isalpha(static_cast<unsigned char>(c)))
+                break;
+
+            first_word += static_cast<char>(
+                std::toupper(static_cast<unsigned char>(c)));
+        }
+
+        return first_word == "SELECT" || first_word == "INSERT" ||
+               first_word == "UPDATE" || first_word == "DELETE" ||
+               first_word == "WITH" || first_word == "REPLACE";
+    }
+
+private:
+    static std::shared_ptr<sqlite3> open(const std::string& path)
+    {
+        sqlite3* db = nullptr;
+        if (sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) !=
+            SQLITE_OK)
+        {
+            sqlite3_close(db);
+            throw std::runtime_error{"Failed to open " + path};
+        }
+
+        return std::shared_ptr<sqlite3>{db, sqlite3_close};
+    }
+
+    void exec(const std::string& sql) const
+    {
+        if (sqlite3_exec(db_.get(), sql.c_str(), nullptr, nullptr, nullptr) !=
+            SQLITE_OK)
+        {
+            throw std::runtime_error{sqlite3_errmsg(db_.get())};
+        }
+    }
+
+    /// Map the aliases given to tables in the `FROM` and `JOIN` clauses of a
+    /// statement, such as `t` in `FROM music.Track AS t`, to the names of the
+    /// tables.
+    ///
+    /// \param sql Statement text.
+    /// \return Returns a map of alias to table name.
+    static std::map<std::string, std::string> table_aliases(
+        std::string_view sql)
+    {
+        // Keywords that end a list of tables, or that may follow a table name
+        // in place of an alias.
+        static const std::set<std::string> keywords{
+            "AS", "CROSS", "EXCEPT", "FROM", "FULL", "GROUP", "HAVING",
+            "INDEXED", "INNER", "INTERSECT", "JOIN", "LEFT", "LIMIT",
+            "NATURAL", "NOT", "ON", "ORDER", "OUTER", "RETURNING", "RIGHT",
+            "SELECT", "SET", "UNION", "USING", "VALUES", "WHERE", "WINDOW"};
+
+        auto tokens = tokenize(sql);
+        auto is_name = [&](std::size_t i)
+        {
+            return i < tokens.size() && is_identifier_start(tokens[i][0]) &&
+                   keywords.count(upper(tokens[i])) == 0;
+        };
+
+        std::map<std::string, std::string> result;
+        bool in_table_list = false;
+        for (std::size_t i = 0; i < tokens.size(); ++i)
+        {
+            auto word = upper(tokens[i]);
+            if (word == "FROM" || word == "JOIN")
+            {
+                in_table_list = true;
+            }
+            else if (keywords.count(word) != 0 || word == "(")
+            {
+                in_table_list = false;
+                continue;
+            }
+            else if (word != ",")
+            {
+                continue;
+            }
+
+            if (!in_table_list || !is_name(i + 1))
+                continue;
+
+            // The table name may be qualified by the name of a database.
+            auto table = tokens[++i];
+            auto dot = table.rfind('.');
+            if (dot != std::string::npos)
+                table = table.substr(dot + 1);
+
+            if (i + 2 < tokens.size() && upper(tokens[i + 1]) == "AS")
+                ++i;
+
+            if (is_name(i + 1))
+                result[tokens[++i]] = table;
+        }
+
+        return result;
+    }
+
+    /// Get the name of the table scanned by a step of a query plan, such as
+    /// `SCAN Track` or `SCAN TABLE Track USING INDEX ...`, or empty if the
+    /// step is not a scan.  A table given an alias is named by its alias,
+    /// except by versions of SQLite prior to 3.36.0, which give both.
+    static std::string scanned_table(const std::string& detail)
+    {
+        std::istringstream words{detail};
+        std::string word;
+        words >> word;
+        if (word != "SCAN")
+            return {};
+
+        // Versions of SQLite prior to 3.36.0 include the word "TABLE".
+        words >> word;
+        if (word == "TABLE")
+            words >> word;
+
+        return word;
+    }
+
+    static bool is_identifier_start(char c)
+    {
+        return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    static std::string upper(std::string word)
+    {
+        for (auto& c : word)
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+
+        return word;
+    }
+
+    /// Split statement text into words, qualified names such as `music.Track`
+    /// being kept whole, and single punctuation characters.  String literals
+    /// are skipped.
+    static std::vector<std::string> tokenize(std::string_view sql)
+    {
+        std::vector<std::string> tokens;
+        std::size_t pos = 0;
+        while (pos < sql.size())
+        {
+            auto c = sql[pos];
+            if (std::isspace(static_cast<unsigned char>(c)))
+            {
+                ++pos;
+            }
+            else if (c == '\'')
+            {
+                auto end = sql.find('\'', pos + 1);
+                pos = end == std::string_view::npos ? sql.size() : end + 1;
+            }
+            else if (is_identifier_start(c))
+            {
+                auto end = pos;
+                while (end < sql.size() &&
+                       (std::isalnum(static_cast<unsigned char>(sql[end])) ||
+                        sql[end] == '_' || sql[end] == '.'))
+                {
+                    ++end;
+                }
+
+                tokens.emplace_back(sql.substr(pos, end - pos));
+                pos = end;
+            }
+            else
+            {
+                tokens.emplace_back(1, c);
+                ++pos;
+            }
+        }
+
+        return tokens;
+    }
+
+    std::shared_ptr<sqlite3> db_;
+    std::string schema_name_;
+    std::map<std::string, std::string> view_aliases_;
+};
@@ -0,0 +1,259 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE query_plan_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <djinterop/crate.hpp>
+#include <djinterop/database.hpp>
+#include <djinterop/engine/engine.hpp>
+#include <djinterop/engine/synthetic_library.hpp>
+#include <djinterop/playlist.hpp>
+#include <djinterop/track.hpp>
+#include <djinterop/track_query.hpp>
+
+#include "../temporary_directory.hpp"
+#include "query_plan.hpp"
+
+namespace e = djinterop::engine;
+namespace utf = boost::unit_test;
+
+namespace
+{
+/// Tables whose full scans indicate a missing index, as they grow with the
+/// size of the library.  Schemas prior to 1.9.1 keep playlists and crates in
+/// the `Crate` and `Playlist` tables, later 1.x schemas keep them in the
+/// `List` tables, and 2.x and later schemas keep playlist entries in
+/// `PlaylistEntity`.
+const std::vector<std::string> watched_tables{
+    "Track", "MetaData", "MetaDataInteger", "Crate", "CrateTrackList",
+    "CrateHierarchy", "CrateParentList", "Playlist", "PlaylistTrackList",
+    "List", "ListTrackList", "ListHierarchy", "ListParentList",
+    "PlaylistEntity"};
+
+/// Number of tracks in the library against which plans are inspected.
+constexpr std::size_t library_tracks = 200;
+
+/// Number of playlists, and of crates, in the library against which plans are
+/// inspected.  With the tracks, there are enough for a scan of any watched
+/// table to be reported.
+constexpr std::size_t library_containers = 120;
+
+/// Minimum number of rows in a watched table for a scan of it to be reported.
+constexpr int64_t min_table_rows = 100;
+
+/// Scans that are expected for all schemas, as pairs of issuing operation and
+/// scanned table.
+///
+/// Enumerating every track necessarily visits every row of the `Track` table,
+/// as does enumerating every playlist of the `Playlist` table of schemas in
+/// which playlists are not nested.  Root crates are those that are their own
+/// parent, which no index can find.  Any other scan of a watched table is
+/// reported as a failure, so that a missing index is noticed when a statement
+/// is added or changed.
+const std::set<std::pair<std::string, std::string>> expected_scans{
+    {"database::tracks", "Track"},
+    {"database::root_playlists", "Playlist"},
+    {"database::root_crates", "CrateParentList"}};
+
+/// Scans that are expected only for schemas prior to 1.9.1, which do not
+/// index the titles of playlists.
+const std::set<std::pair<std::string, std::string>> expected_scans_pre_1_9_1{
+    {"database::root_playlist_by_name", "Playlist"}};
+
+/// Scans that are expected only for schema 2.18.0, which does not index any
+/// of the metadata columns of the `Track` table.
+const std::set<std::pair<std::string, std::string>> expected_scans_2_18_0{
+    {"track_query::ids", "Track"}, {"track_query::rows", "Track"}};
+
+bool is_expected(const table_scan& scan, const e::engine_schema& schema)
+{
+    std::pair<std::string, std::string> key{scan.operation, scan.table};
+    return expected_scans.count(key) != 0 ||
+           (schema < e::engine_schema::schema_1_9_1 &&
+            expected_scans_pre_1_9_1.count(key) != 0) ||
+           (schema == e::engine_schema::schema_2_18_0 &&
+            expected_scans_2_18_0.count(key) != 0);
+}
+
+/// Run a representative workload of public operations against a library.
+void run_workload(djinterop::database& db, const e::engine_schema& schema)
+{
+    e::synthetic_library_options options;
+    options.schema = schema;
+    options.track_count = library_tracks;
+    options.performance_data = false;
+    options.playlist_count = library_containers;
+    options.crate_count = library_containers;
+    options.max_depth = 4;
+    options.mean_container_size = 10;
+    e::populate_synthetic_library(db, options);
+
+    auto tracks = db.tracks();
+    for (std::size_t i = 0; i < 3 && i < tracks.size(); ++i)
+    {
+        auto& tr = tracks[i];
+        db.track_by_id(tr.id());
+        auto snapshot = tr.snapshot();
+        if (snapshot.relative_path)
+            db.tracks_by_relative_path(*snapshot.relative_path);
+
+        tr.set_bpm(snapshot.bpm.value_or(120) + 1);
+    }
+
+    // A new track is in no playlist, and so can be added to any of them.
+    auto unlisted_snapshot = tracks.front().snapshot();
+    unlisted_snapshot.relative_path = "../Unlisted.mp3";
+    auto unlisted = db.create_track(unlisted_snapshot);
+    for (auto&& pl : db.root_playlists())
+    {
+        pl.tracks();
+        pl.add_track_back(unlisted);
+        pl.remove_track(unlisted);
+        if (db.supports_feature(djinterop::feature::supports_nested_playlists))
+        {
+            pl.children();
+            pl.sub_playlist_by_name("Missing");
+        }
+    }
+
+    for (auto&& cr : db.root_crates())
+    {
+        cr.tracks();
+        cr.add_track(tracks.back());
+        cr.remove_track(tracks.front());
+        cr.children();
+        cr.sub_crate_by_name("Missing");
+        db.crate_by_id(cr.id());
+    }
+
+    auto query = db.query()
+                     .bpm_between(120, 128)
+                     .genre("House")
+                     .order_by(djinterop::track_order::date_added, true)
+                     .limit(100);
+    BOOST_CHECK_EQUAL(query.ids().size(), query.rows().size());
+
+    db.root_playlist_by_name("Missing");
+    db.root_crate_by_name("Missing");
+
+    db.remove_track(tracks.back());
+}
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "Query plans of library statements for all supported schema versions"))
+BOOST_DATA_TEST_CASE(
+    explain_query_plan__workload__no_unexpected_scans, e::supported_schemas,
+    schema)
+{
+    // Arrange
+    temporary_directory tmp_loc;
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating database...");
+    auto db = e::create_database(tmp_loc.temp_dir, schema);
+    auto collector = std::make_shared<statement_collector>();
+    db.set_observer(collector);
+
+    // Act
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Running workload...");
+    run_workload(db, schema);
+    db.set_observer(nullptr);
+
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Inspecting query plans...");
+    query_plan_inspector inspector{tmp_loc.temp_dir, schema};
+    auto report = inspector.find_scans(
+        collector->statements, watched_tables, min_table_rows);
+
+    // Assert
+    std::size_t queries = 0;
+    for (auto&& [sql, operation] : collector->statements)
+    {
+        if (query_plan_inspector::is_query(sql))
+            ++queries;
+    }
+
+    BOOST_TEST_MESSAGE(
+        "(" << schema << ") Explained " << report.statements_explained
+            << " of " << collector->statements.size() << " statement(s)");
+    BOOST_CHECK_GT(report.statements_explained, 0u);
+    BOOST_CHECK_EQUAL(report.statements_explained, queries);
+    for (auto&& table : watched_tables)
+    {
+        if (inspector.has_table(table))
+        {
+            BOOST_TEST_INFO("(" << schema << ") Rows in " << table);
+            BOOST_CHECK_GE(inspector.row_count(table), min_table_rows);
+        }
+    }
+
+    for (auto&& scan : report.scans)
+    {
+        if (is_expected(scan, schema))
+        {
+            BOOST_TEST_MESSAGE("(" << schema << ") Expected " << scan);
+        }
+        else
+        {
+            BOOST_ERROR("(" << schema << ") Unexpected " << scan);
+        }
+    }
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "Scans of tables given an alias by a statement are reported"))
+BOOST_AUTO_TEST_CASE(find_scans__aliased_table__scan_reported)
+{
+    // Arrange
+    auto schema = e::latest_v1_schema;
+    temporary_directory tmp_loc;
+    auto db = e::create_database(tmp_loc.temp_dir, schema);
+    e::synthetic_library_options options;
+    options.schema = schema;
+    options.track_count = library_tracks;
+    options.performance_data = false;
+    options.playlist_count = 0;
+    options.crate_count = 0;
+    e::populate_synthetic_library(db, options);
+
+    // Schema 1.x keeps no index of BPM, and queries refer to `Track AS t`.
+    auto collector = std::make_shared<statement_collector>();
+    db.set_observer(collector);
+    static_cast<void>(db.query().bpm_between(120, 128).ids());
+    db.set_observer(nullptr);
+
+    // Act
+    query_plan_inspector inspector{tmp_loc.temp_dir, schema};
+    auto report =
+        inspector.find_scans(collector->statements, {"Track"}, min_table_rows);
+
+    // Assert
+    BOOST_REQUIRE_EQUAL(report.scans.size(), 1u);
+    auto& scan = report.scans.front();
+    BOOST_TEST_MESSAGE(scan.detail);
+    BOOST_CHECK_EQUAL(scan.operation, "track_query::ids");
+    BOOST_CHECK_EQUAL(scan.table, "Track");
+    BOOST_CHECK_EQUAL(scan.table_rows, static_cast<int64_t>(library_tracks));
+}
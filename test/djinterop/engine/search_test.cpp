@@ -0,0 +1,214 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE search_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <djinterop/database.hpp>
+#include <djinterop/engine/engine.hpp>
+#include <djinterop/track.hpp>
+#include <djinterop/track_snapshot.hpp>
+
+#include "../temporary_directory.hpp"
+#include "example_track_data.hpp"
+
+namespace e = djinterop::engine;
+namespace utf = boost::unit_test;
+
+namespace
+{
+struct search_track
+{
+    std::string title;
+    std::string artist;
+    std::string album;
+    std::string comment;
+};
+
+/// Tracks with which searches are checked, in order of creation.
+const std::vector<search_track> search_tracks{
+    {"Sunrise", "Artist A", "Morning", "Original mix"},
+    {"Midnight", "Artist B", "Evening", "Sunrise edit"},
+    {"Café del Mar", "Energy 52", "Ibiza", "Classic"},
+    {"Blue Monday", "New Order", "Power, Corruption & Lies", "Remastered"},
+};
+
+int64_t create_search_track(
+    djinterop::database& db, const e::engine_schema& schema,
+    const search_track& t)
+{
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        snapshot, example_track_data_variation::basic_metadata_only_1,
+        example_track_data_usage::create, schema);
+    snapshot.relative_path = "../" + t.title + ".mp3";
+    snapshot.title = t.title;
+    snapshot.artist = t.artist;
+    snapshot.album = t.album;
+    snapshot.comment = t.comment;
+    return db.create_track(snapshot).id();
+}
+
+/// Create the search tracks in a database.
+///
+/// \return Returns the ids of the created tracks, in order of creation.
+std::vector<int64_t> create_search_tracks(
+    djinterop::database& db, const e::engine_schema& schema)
+{
+    std::vector<int64_t> ids;
+    for (auto&& t : search_tracks)
+        ids.push_back(create_search_track(db, schema, t));
+
+    return ids;
+}
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(
+    *utf::description("database::search() ranks title matches first"))
+BOOST_DATA_TEST_CASE(search__word__ranked_matches, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto ids = create_search_tracks(db, schema);
+
+    // Act
+    auto results = db.search("sunrise");
+
+    // Assert
+    std::vector<int64_t> expected{ids[0], ids[1]};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        results.begin(), results.end(), expected.begin(), expected.end());
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::search() matches word prefixes, ignoring case and diacritics"))
+BOOST_DATA_TEST_CASE(
+    search__prefixes__matches_all_words, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto ids = create_search_tracks(db, schema);
+
+    // Act
+    auto cafe = db.search("CAFE m");
+    auto blue = db.search("new ord corrupt");
+    auto none = db.search("blue midnight");
+
+    // Assert
+    std::vector<int64_t> expected_cafe{ids[2]};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        cafe.begin(), cafe.end(), expected_cafe.begin(), expected_cafe.end());
+    std::vector<int64_t> expected_blue{ids[3]};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        blue.begin(), blue.end(), expected_blue.begin(), expected_blue.end());
+    BOOST_CHECK(none.empty());
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::search() treats query syntax as plain text, and honours limit"))
+BOOST_DATA_TEST_CASE(
+    search__syntax_and_limit__plain_text, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto ids = create_search_tracks(db, schema);
+
+    // Act
+    auto quoted = db.search("\"sunrise\" OR (");
+    auto limited = db.search("sunrise", 1);
+    auto empty = db.search(" & ");
+    auto zero = db.search("sunrise", 0);
+
+    // Assert
+    // "OR" is not an operator, but a word matching "Original".
+    std::vector<int64_t> expected{ids[0]};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        quoted.begin(), quoted.end(), expected.begin(), expected.end());
+    BOOST_REQUIRE_EQUAL(limited.size(), 1u);
+    BOOST_CHECK_EQUAL(limited[0], ids[0]);
+    BOOST_CHECK(empty.empty());
+    BOOST_CHECK(zero.empty());
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::search() reflects tracks created, edited, and removed"))
+BOOST_DATA_TEST_CASE(
+    search__after_changes__index_updated, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto ids = create_search_tracks(db, schema);
+    auto before = db.search("sunrise");
+
+    // Act
+    auto new_id = create_search_track(
+        db, schema, {"Sunrise Again", "Artist C", "Later", "Extended"});
+    db.track_by_id(ids[0])->set_title(std::string{"Daybreak"});
+    db.remove_track(*db.track_by_id(ids[1]));
+    auto after = db.search("sunrise");
+    auto renamed = db.search("daybreak");
+
+    // Assert
+    BOOST_CHECK_EQUAL(before.size(), 2u);
+    std::vector<int64_t> expected_after{new_id};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        after.begin(), after.end(), expected_after.begin(),
+        expected_after.end());
+    std::vector<int64_t> expected_renamed{ids[0]};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        renamed.begin(), renamed.end(), expected_renamed.begin(),
+        expected_renamed.end());
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::search() sees changes made through another connection"))
+BOOST_DATA_TEST_CASE(
+    search__other_connection__index_updated, e::supported_schemas, schema)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = e::create_database(tmp_loc.temp_dir, schema);
+        auto ids = create_search_tracks(db, schema);
+        auto before = db.search("sunrise");
+        auto other = e::load_database(tmp_loc.temp_dir);
+
+        // Act
+        other.track_by_id(ids[3])->set_title(std::string{"Sunrise Monday"});
+        auto after = db.search("sunrise");
+        auto reloaded = e::load_database(tmp_loc.temp_dir).search("sunrise");
+
+        // Assert
+        BOOST_CHECK_EQUAL(before.size(), 2u);
+        BOOST_CHECK_EQUAL(after.size(), 3u);
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            reloaded.begin(), reloaded.end(), after.begin(), after.end());
+        BOOST_CHECK_EQUAL(
+            boost::filesystem::exists(
+                tmp_loc.temp_dir + "/Database2/djinterop_search.db"),
+            schema >= e::engine_schema::schema_2_18_0);
+    }
+}
@@ -0,0 +1,192 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <djinterop/engine/synthetic_library.hpp>
+
+#define BOOST_TEST_MODULE synthetic_library_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+#include <djinterop/analysis/beatgrid_index.hpp>
+#include <djinterop/crate.hpp>
+#include <djinterop/engine/engine.hpp>
+#include <djinterop/playlist.hpp>
+#include <djinterop/track.hpp>
+
+namespace e = djinterop::engine;
+namespace utf = boost::unit_test;
+
+namespace
+{
+const std::vector<e::engine_schema> schemas{
+    e::latest_v1_schema, e::latest_v2_schema, e::latest_v3_schema};
+
+template <typename Container>
+void count_tree(
+    const std::vector<Container>& containers, bool nested, std::size_t depth,
+    std::size_t& count, std::size_t& max_depth)
+{
+    for (auto&& container : containers)
+    {
+        ++count;
+        max_depth = std::max(max_depth, depth);
+        if (nested)
+        {
+            count_tree(
+                container.children(), nested, depth + 1, count, max_depth);
+        }
+    }
+}
+
+/// Count crates, bearing in mind that `crate::children()` may return all
+/// descendants rather than only direct children.
+void count_crates(
+    const std::vector<djinterop::crate>& crates, bool nested,
+    std::set<int64_t>& ids, std::size_t& max_depth)
+{
+    for (auto&& cr : crates)
+    {
+        if (!ids.insert(cr.id()).second)
+            continue;
+
+        std::size_t depth = 1;
+        for (auto parent = cr.parent(); parent; parent = parent->parent())
+        {
+            ++depth;
+        }
+
+        max_depth = std::max(max_depth, depth);
+        if (nested)
+        {
+            count_crates(cr.children(), nested, ids, max_depth);
+        }
+    }
+}
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(
+    *utf::description("synthetic_track_generator is deterministic"))
+BOOST_DATA_TEST_CASE(next__same_seed__same_tracks, schemas, schema)
+{
+    // Arrange
+    e::synthetic_track_generator first{schema, 123, 1000};
+    e::synthetic_track_generator second{schema, 123, 1000};
+    e::synthetic_track_generator other{schema, 124, 1000};
+
+    // Act/Assert
+    for (int i = 0; i < 5; ++i)
+    {
+        auto snapshot = first.next();
+        BOOST_CHECK(snapshot == second.next());
+        BOOST_CHECK(snapshot != other.next());
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("synthetic_track_generator generates full analysis"))
+BOOST_DATA_TEST_CASE(next__performance_data__fully_analysed, schemas, schema)
+{
+    // Arrange
+    e::synthetic_track_generator generator{schema, 7, 1000};
+
+    for (int i = 0; i < 10; ++i)
+    {
+        // Act
+        auto s = generator.next();
+
+        // Assert
+        BOOST_REQUIRE(s.sample_count && s.sample_rate && s.bpm);
+        BOOST_CHECK(s.title && s.artist && s.relative_path);
+        BOOST_CHECK_EQUAL(s.hot_cues.size(), 8u);
+        BOOST_CHECK_EQUAL(s.loops.size(), 8u);
+        auto extents =
+            schema < e::engine_schema::schema_2_18_0
+                ? e::calculate_high_resolution_waveform_extents(
+                      *s.sample_count, *s.sample_rate)
+                : e::calculate_overview_waveform_extents(
+                      *s.sample_count, *s.sample_rate);
+        BOOST_CHECK_EQUAL(s.waveform.size(), extents.size);
+
+        djinterop::analysis::beatgrid_index grid{s.beatgrid};
+        BOOST_CHECK_CLOSE(
+            grid.samples_per_beat_at(0), *s.sample_rate * 60 / *s.bpm, 1e-6);
+        for (auto&& cue : s.hot_cues)
+        {
+            if (cue)
+            {
+                auto beat = grid.beat_at(cue->sample_offset);
+                BOOST_CHECK_SMALL(beat - 4 * std::round(beat / 4), 1e-6);
+            }
+        }
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("populate_synthetic_library() builds container trees"))
+BOOST_DATA_TEST_CASE(populate__small_library__populated, schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    e::synthetic_library_options options;
+    options.schema = schema;
+    options.track_count = 30;
+    options.playlist_count = 12;
+    options.crate_count = 6;
+    options.max_depth = 3;
+    options.mean_container_size = 5;
+    e::synthetic_library_progress last_progress;
+    options.on_progress = [&](const e::synthetic_library_progress& p)
+    { last_progress = p; };
+
+    // Act
+    e::populate_synthetic_library(db, options);
+
+    // Assert
+    BOOST_CHECK_EQUAL(db.tracks().size(), 30u);
+    std::size_t playlists = 0;
+    std::size_t playlist_depth = 0;
+    count_tree(
+        db.root_playlists(),
+        db.supports_feature(djinterop::feature::supports_nested_playlists), 1,
+        playlists, playlist_depth);
+    BOOST_CHECK_EQUAL(playlists, 12u);
+    BOOST_CHECK_LE(playlist_depth, 3u);
+    BOOST_CHECK_EQUAL(last_progress.tracks_done, 30u);
+    BOOST_CHECK_EQUAL(last_progress.playlists_done, 12u);
+    if (db.supports_feature(
+            djinterop::feature::playlists_and_crates_are_distinct))
+    {
+        std::set<int64_t> crate_ids;
+        std::size_t crate_depth = 0;
+        count_crates(
+            db.root_crates(),
+            db.supports_feature(djinterop::feature::supports_nested_crates),
+            crate_ids, crate_depth);
+        BOOST_CHECK_EQUAL(crate_ids.size(), 6u);
+        BOOST_CHECK_LE(crate_depth, 3u);
+        BOOST_CHECK_EQUAL(last_progress.crates_done, 6u);
+    }
+
+    BOOST_CHECK_NO_THROW(db.verify());
+}
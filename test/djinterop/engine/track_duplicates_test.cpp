@@ -0,0 +1,226 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE track_duplicates_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <djinterop/crate.hpp>
+#include <djinterop/database.hpp>
+#include <djinterop/engine/engine.hpp>
+#include <djinterop/exceptions.hpp>
+#include <djinterop/playlist.hpp>
+#include <djinterop/track.hpp>
+#include <djinterop/track_duplicates.hpp>
+#include <djinterop/track_snapshot.hpp>
+
+#include "example_track_features.hpp"
+
+namespace e = djinterop::engine;
+namespace utf = boost::unit_test;
+using namespace std::chrono_literals;
+
+namespace
+{
+/// Make a track with a given path, file size, and metadata.  Only analysed
+/// tracks have a BPM.
+djinterop::track_snapshot make_candidate(
+    const e::engine_schema& schema, const std::string& relative_path,
+    unsigned long long file_bytes, const std::string& artist,
+    const std::string& title, std::chrono::milliseconds duration,
+    bool analysed = false)
+{
+    auto snapshot = make_titled_snapshot(
+        schema,
+        analysed ? example_track_data_variation::fully_analysed_1
+                 : example_track_data_variation::basic_metadata_only_1,
+        title);
+    snapshot.relative_path = relative_path;
+    snapshot.artist = artist;
+    snapshot.duration = duration;
+    if (!analysed)
+        snapshot.bpm = std::nullopt;
+
+    snapshot.file_bytes = std::nullopt;
+    if (schema >= e::engine_schema::schema_1_15_0)
+        snapshot.file_bytes = file_bytes;
+
+    return snapshot;
+}
+
+std::vector<int64_t> ids_of(const std::vector<djinterop::track>& tracks)
+{
+    std::vector<int64_t> result;
+    for (auto&& tr : tracks)
+        result.push_back(tr.id());
+
+    return result;
+}
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::find_duplicates() groups tracks by path, file, and metadata, "
+    "and suggests an analysed survivor"))
+BOOST_DATA_TEST_CASE(
+    find_duplicates__library__grouped_by_policy, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto one = db.create_track(make_candidate(
+        schema, "../Music/One.mp3", 1000, "Artist", "One", 200s));
+    auto one_other_case = db.create_track(make_candidate(
+        schema, "../music/ONE.MP3", 2000, "Someone", "Two", 100s));
+    auto one_other_folder = db.create_track(make_candidate(
+        schema, "../Other/One.mp3", 1000, "Someone", "Three", 150s, true));
+    auto one_other_file = db.create_track(make_candidate(
+        schema, "../Other/Different.mp3", 3000, "ARTIST", "one!", 201s));
+    db.create_track(make_candidate(
+        schema, "../Other/Unrelated.mp3", 1000, "Artist", "One", 300s));
+    auto has_file_bytes = schema >= e::engine_schema::schema_1_15_0;
+
+    // Act
+    auto by_file = db.find_duplicates();
+    djinterop::duplicate_policy policy;
+    policy.match_metadata = true;
+    auto by_metadata = db.find_duplicates(policy);
+    policy.match_path = false;
+    policy.match_file_name_and_size = false;
+    policy.duration_tolerance = 0ms;
+    auto by_exact_duration = db.find_duplicates(policy);
+
+    // Assert
+    std::vector<int64_t> expected_by_file{one.id(), one_other_case.id()};
+    if (has_file_bytes)
+        expected_by_file.push_back(one_other_folder.id());
+
+    BOOST_REQUIRE_EQUAL(by_file.size(), 1u);
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        by_file[0].track_ids.begin(), by_file[0].track_ids.end(),
+        expected_by_file.begin(), expected_by_file.end());
+    BOOST_CHECK_EQUAL(
+        by_file[0].survivor_id,
+        has_file_bytes ? one_other_folder.id() : one.id());
+
+    auto expected_by_metadata = expected_by_file;
+    expected_by_metadata.push_back(one_other_file.id());
+    BOOST_REQUIRE_EQUAL(by_metadata.size(), 1u);
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        by_metadata[0].track_ids.begin(), by_metadata[0].track_ids.end(),
+        expected_by_metadata.begin(), expected_by_metadata.end());
+
+    BOOST_CHECK(by_exact_duration.empty());
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::merge_duplicates() moves playlist and crate memberships to "
+    "the survivor and removes the duplicates"))
+BOOST_DATA_TEST_CASE(
+    merge_duplicates__memberships__moved_to_survivor, e::supported_schemas,
+    schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto survivor = db.create_track(
+        make_candidate(schema, "../A.mp3", 1000, "Artist", "A", 200s));
+    auto first = db.create_track(
+        make_candidate(schema, "../a.mp3", 1000, "Artist", "A", 200s));
+    auto second = db.create_track(
+        make_candidate(schema, "../b/A.mp3", 1000, "Artist", "A", 200s));
+    auto other = db.create_track(
+        make_candidate(schema, "../Other.mp3", 2000, "Artist", "Other", 200s));
+    auto with_survivor = db.create_root_playlist("With Survivor");
+    with_survivor.add_track_back(other);
+    with_survivor.add_track_back(first);
+    with_survivor.add_track_back(survivor);
+    auto without_survivor = db.create_root_playlist("Without Survivor");
+    without_survivor.add_track_back(second);
+    without_survivor.add_track_back(other);
+    without_survivor.add_track_back(first);
+    auto crate = db.create_root_crate("Crate");
+    crate.add_track(first);
+    djinterop::duplicate_group group{
+        {survivor.id(), first.id(), second.id()}, survivor.id()};
+
+    // Act
+    db.merge_duplicates({group});
+
+    // Assert
+    auto with_survivor_ids = ids_of(with_survivor.tracks());
+    std::vector<int64_t> expected_with{other.id(), survivor.id()};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        with_survivor_ids.begin(), with_survivor_ids.end(),
+        expected_with.begin(), expected_with.end());
+    auto without_survivor_ids = ids_of(without_survivor.tracks());
+    std::vector<int64_t> expected_without{survivor.id(), other.id()};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        without_survivor_ids.begin(), without_survivor_ids.end(),
+        expected_without.begin(), expected_without.end());
+    auto crate_ids = ids_of(crate.tracks());
+    std::vector<int64_t> expected_crate{survivor.id()};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        crate_ids.begin(), crate_ids.end(), expected_crate.begin(),
+        expected_crate.end());
+    BOOST_CHECK(db.track_by_id(survivor.id()));
+    BOOST_CHECK(!db.track_by_id(first.id()));
+    BOOST_CHECK(!db.track_by_id(second.id()));
+    BOOST_CHECK(db.find_duplicates().empty());
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::merge_duplicates() with an invalid group throws, and changes "
+    "nothing"))
+BOOST_DATA_TEST_CASE(
+    merge_duplicates__invalid_group__throws, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto survivor = db.create_track(
+        make_candidate(schema, "../A.mp3", 1000, "Artist", "A", 200s));
+    auto duplicate = db.create_track(
+        make_candidate(schema, "../a.mp3", 1000, "Artist", "A", 200s));
+    auto playlist = db.create_root_playlist("Playlist");
+    playlist.add_track_back(duplicate);
+    auto missing_id = duplicate.id() + 100;
+
+    // Act/Assert
+    BOOST_CHECK_THROW(
+        db.merge_duplicates({{{survivor.id(), duplicate.id()}, missing_id}}),
+        std::invalid_argument);
+    BOOST_CHECK_THROW(
+        db.merge_duplicates(
+            {{{survivor.id(), duplicate.id()}, survivor.id()},
+             {{duplicate.id()}, duplicate.id()}}),
+        std::invalid_argument);
+    BOOST_CHECK_THROW(
+        db.merge_duplicates(
+            {{{survivor.id(), duplicate.id(), missing_id}, survivor.id()}}),
+        djinterop::track_deleted);
+    BOOST_CHECK(db.track_by_id(duplicate.id()));
+    auto playlist_ids = ids_of(playlist.tracks());
+    std::vector<int64_t> expected{duplicate.id()};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        playlist_ids.begin(), playlist_ids.end(), expected.begin(),
+        expected.end());
+    BOOST_CHECK_EQUAL(db.find_duplicates().size(), 1u);
+}
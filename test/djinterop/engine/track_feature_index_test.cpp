@@ -0,0 +1,350 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE track_feature_index_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <djinterop/database.hpp>
+#include <djinterop/engine/engine.hpp>
+#include <djinterop/exceptions.hpp>
+#include <djinterop/track.hpp>
+#include <djinterop/track_feature_index.hpp>
+#include <djinterop/track_snapshot.hpp>
+
+#include "../temporary_directory.hpp"
+#include "example_track_features.hpp"
+
+namespace e = djinterop::engine;
+namespace utf = boost::unit_test;
+using namespace std::chrono_literals;
+
+namespace
+{
+bool in_range(
+    std::optional<float> value, std::optional<double> lo,
+    std::optional<double> hi)
+{
+    if (!lo && !hi)
+        return true;
+
+    return value && (!lo || *value >= static_cast<float>(*lo)) &&
+           (!hi || *value <= static_cast<float>(*hi));
+}
+
+/// Evaluate a filter against each track in turn, in the same precision as
+/// the index.
+std::vector<int64_t> brute_force_match(
+    std::vector<djinterop::track_features> tracks,
+    const djinterop::track_feature_filter& filter)
+{
+    std::sort(
+        tracks.begin(), tracks.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.id < rhs.id; });
+
+    std::vector<int64_t> result;
+    for (auto&& t : tracks)
+    {
+        auto bpm = t.bpm ? std::make_optional(static_cast<float>(*t.bpm))
+                         : std::nullopt;
+        auto loudness_db = t.average_loudness
+                               ? std::make_optional(static_cast<float>(
+                                     20 * std::log10(*t.average_loudness)))
+                               : std::nullopt;
+        auto duration_s = t.duration
+                              ? std::make_optional(static_cast<float>(
+                                    t.duration->count() / 1000.0))
+                              : std::nullopt;
+        auto seconds = [](const std::optional<std::chrono::milliseconds>& d)
+        {
+            return d ? std::make_optional(d->count() / 1000.0) : std::nullopt;
+        };
+
+        if (!in_range(bpm, filter.min_bpm, filter.max_bpm) ||
+            !in_range(
+                loudness_db, filter.min_loudness_db, filter.max_loudness_db) ||
+            !in_range(
+                duration_s, seconds(filter.min_duration),
+                seconds(filter.max_duration)))
+        {
+            continue;
+        }
+
+        if (filter.keys &&
+            (!t.key || std::find(
+                           filter.keys->begin(), filter.keys->end(), *t.key) ==
+                           filter.keys->end()))
+        {
+            continue;
+        }
+
+        result.push_back(t.id);
+    }
+
+    return result;
+}
+
+std::vector<djinterop::track_feature_filter> make_filters()
+{
+    std::vector<djinterop::track_feature_filter> result;
+    result.push_back({});
+
+    djinterop::track_feature_filter bpm_only;
+    bpm_only.min_bpm = 120;
+    bpm_only.max_bpm = 128;
+    result.push_back(bpm_only);
+
+    djinterop::track_feature_filter open_ended;
+    open_ended.min_bpm = 150;
+    open_ended.max_duration = 240s;
+    result.push_back(open_ended);
+
+    djinterop::track_feature_filter harmonic;
+    harmonic.min_bpm = 118;
+    harmonic.max_bpm = 130;
+    harmonic.keys =
+        djinterop::harmonically_compatible_keys(djinterop::musical_key::a_minor);
+    harmonic.min_loudness_db = -8;
+    harmonic.max_loudness_db = -2;
+    result.push_back(harmonic);
+
+    djinterop::track_feature_filter no_keys;
+    no_keys.keys = std::vector<djinterop::musical_key>{};
+    result.push_back(no_keys);
+
+    return result;
+}
+
+void check_features_match_track(
+    const djinterop::track_feature_index& index, djinterop::database& db,
+    int64_t id)
+{
+    auto row = index.row_of(id);
+    BOOST_REQUIRE(row);
+    auto features = index.features_at(*row);
+    auto snapshot = db.track_by_id(id)->snapshot();
+    BOOST_CHECK(features.bpm == snapshot.bpm);
+    BOOST_CHECK(features.key == snapshot.key);
+    BOOST_CHECK(features.average_loudness == snapshot.average_loudness);
+    BOOST_CHECK(features.duration == snapshot.duration);
+    BOOST_CHECK(features.genre == snapshot.genre);
+}
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "track_feature_index::match() agrees with evaluating each track in turn"))
+BOOST_DATA_TEST_CASE(
+    match__random_tracks__equals_brute_force,
+    boost::unit_test::data::make({0, 1, 63, 64, 65, 1000}), count)
+{
+    // Arrange
+    auto tracks = make_random_features(static_cast<std::size_t>(count), 42, 3);
+    djinterop::track_feature_index index{tracks};
+
+    for (auto&& filter : make_filters())
+    {
+        // Act
+        auto matches = index.match(filter);
+        auto ids = index.ids(matches);
+
+        // Assert
+        auto expected = brute_force_match(tracks, filter);
+        BOOST_CHECK_EQUAL(matches.size(), index.size());
+        BOOST_CHECK_EQUAL(matches.count(), expected.size());
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            ids.begin(), ids.end(), expected.begin(), expected.end());
+    }
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "track_feature_index::match() is unaffected by the order of edits"))
+BOOST_AUTO_TEST_CASE(upsert_remove__edits__equals_rebuilt_index)
+{
+    // Arrange
+    auto tracks = make_random_features(200, 7, 3);
+    auto edits = make_random_features(100, 8, 3);
+    djinterop::track_feature_index index{
+        std::vector<djinterop::track_features>{
+            tracks.begin(), tracks.begin() + 100}};
+
+    // Act
+    for (auto i = tracks.size(); i-- > 100;)
+        index.upsert(tracks[i]);
+    for (auto&& edit : edits)
+    {
+        if (edit.id % 2 == 0)
+            index.upsert(edit);
+    }
+    for (std::size_t i = 0; i < tracks.size(); i += 5)
+        index.remove(tracks[i].id);
+
+    // Assert
+    for (auto&& edit : edits)
+    {
+        if (edit.id % 2 == 0)
+            tracks[static_cast<std::size_t>(edit.id - 1) / 3] = edit;
+    }
+    std::vector<djinterop::track_features> expected_tracks;
+    for (std::size_t i = 0; i < tracks.size(); ++i)
+    {
+        if (i % 5 != 0)
+            expected_tracks.push_back(tracks[i]);
+    }
+    BOOST_REQUIRE_EQUAL(index.size(), expected_tracks.size());
+    for (std::size_t i = 0; i < expected_tracks.size(); ++i)
+        BOOST_CHECK(index.features_at(i) == expected_tracks[i]);
+    for (auto&& filter : make_filters())
+    {
+        auto ids = index.ids(index.match(filter));
+        auto expected = brute_force_match(expected_tracks, filter);
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            ids.begin(), ids.end(), expected.begin(), expected.end());
+    }
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "track_feature_index::compatible_with() finds tracks that mix well"))
+BOOST_AUTO_TEST_CASE(compatible_with__reference_track__compatible_tracks)
+{
+    // Arrange
+    using djinterop::musical_key;
+    djinterop::track_feature_index index{{
+        {1, 124.0, musical_key::a_minor, 0.5, 200s},
+        {2, 126.0, musical_key::c_major, 0.45, 300s},
+        {3, 124.0, musical_key::e_minor, 0.6, std::nullopt},
+        {4, 124.0, musical_key::b_minor, 0.5, 200s},
+        {5, 131.0, musical_key::a_minor, 0.5, 200s},
+        {6, 124.0, musical_key::d_minor, 0.1, 200s},
+        {7, std::nullopt, musical_key::a_minor, 0.5, 200s},
+        {8, 120.5, musical_key::d_minor, 0.5, 200s},
+    }};
+
+    // Act
+    auto ids = index.ids(index.compatible_with(1));
+
+    // Assert
+    std::vector<int64_t> expected{2, 3, 8};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        ids.begin(), ids.end(), expected.begin(), expected.end());
+    BOOST_CHECK_THROW(
+        static_cast<void>(index.compatible_with(9)), djinterop::track_deleted);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::feature_index() holds the same features as track snapshots"))
+BOOST_DATA_TEST_CASE(
+    feature_index__tracks__features_match_snapshots, e::supported_schemas,
+    schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    std::vector<int64_t> ids{
+        db.create_track(
+              make_feature_snapshot(
+                  schema, "One", 124, djinterop::musical_key::a_minor, 0.5))
+            .id(),
+        db.create_track(
+              make_feature_snapshot(
+                  schema, "Two", 126.5, djinterop::musical_key::e_minor, 0.25))
+            .id()};
+
+    // Act
+    auto index = db.feature_index();
+
+    // Assert
+    BOOST_REQUIRE_EQUAL(index->size(), ids.size());
+    for (auto id : ids)
+        check_features_match_track(*index, db, id);
+    auto compatible = index->ids(index->compatible_with(ids[0], 0.03, 10));
+    std::vector<int64_t> expected{ids[1]};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        compatible.begin(), compatible.end(), expected.begin(),
+        expected.end());
+    BOOST_CHECK_EQUAL(db.feature_index(), index);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::feature_index() reflects tracks created, edited, and removed"))
+BOOST_DATA_TEST_CASE(
+    feature_index__after_changes__index_updated, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto first = db.create_track(make_feature_snapshot(
+        schema, "One", 124, djinterop::musical_key::a_minor, 0.5));
+    auto second = db.create_track(make_feature_snapshot(
+        schema, "Two", 126.5, djinterop::musical_key::e_minor, 0.25));
+    auto third = db.create_track(make_feature_snapshot(
+        schema, "Three", 128, djinterop::musical_key::g_major, 0.75));
+    auto before = db.feature_index();
+
+    // Act
+    auto fourth = db.create_track(make_feature_snapshot(
+        schema, "Four", 100, djinterop::musical_key::d_minor, 0.125));
+    second.set_average_loudness(0.375);
+    third.set_bpm(130.0);
+    third.set_key(djinterop::musical_key::b_flat_minor);
+    db.remove_track(db.track_by_id(first.id()).value());
+    auto after = db.feature_index();
+
+    // Assert
+    BOOST_CHECK_EQUAL(before->size(), 3u);
+    BOOST_CHECK(before->row_of(first.id()));
+    BOOST_CHECK(!before->row_of(fourth.id()));
+    BOOST_REQUIRE_EQUAL(after->size(), 3u);
+    BOOST_CHECK(!after->row_of(first.id()));
+    for (auto id : {second.id(), third.id(), fourth.id()})
+        check_features_match_track(*after, db, id);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::feature_index() sees changes made through another connection"))
+BOOST_DATA_TEST_CASE(
+    feature_index__other_connection__index_updated, e::supported_schemas,
+    schema)
+{
+    // Note separate scope to ensure no locks are held on the temporary dir.
+    temporary_directory tmp_loc;
+
+    {
+        // Arrange
+        auto db = e::create_database(tmp_loc.temp_dir, schema);
+        auto id =
+            db.create_track(
+                  make_feature_snapshot(
+                      schema, "One", 124, djinterop::musical_key::a_minor, 0.5))
+                .id();
+        auto before = db.feature_index();
+        auto other = e::load_database(tmp_loc.temp_dir);
+
+        // Act
+        other.track_by_id(id)->set_average_loudness(0.375);
+        auto after = db.feature_index();
+
+        // Assert
+        BOOST_CHECK_NE(before, after);
+        check_features_match_track(*after, db, id);
+    }
+}
@@ -0,0 +1,283 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE track_query_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <djinterop/database.hpp>
+#include <djinterop/engine/engine.hpp>
+#include <djinterop/musical_key.hpp>
+#include <djinterop/track.hpp>
+#include <djinterop/track_query.hpp>
+#include <djinterop/track_snapshot.hpp>
+
+#include "budget.hpp"
+#include "example_track_data.hpp"
+
+namespace e = djinterop::engine;
+namespace utf = boost::unit_test;
+
+namespace
+{
+struct query_track
+{
+    std::string title;
+    std::string artist;
+    std::string genre;
+    double bpm;
+    djinterop::musical_key key;
+    int rating;
+    int year;
+};
+
+/// Tracks with which queries are checked, in order of creation.
+const std::vector<query_track> query_tracks{
+    {"One", "Artist A", "House", 120, djinterop::musical_key::a_minor, 80,
+     2001},
+    {"Two", "Artist B", "Techno", 124, djinterop::musical_key::c_major, 40,
+     2005},
+    {"Three", "Artist A", "House", 126, djinterop::musical_key::e_minor, 100,
+     2010},
+    {"Four", "Artist C", "House", 128, djinterop::musical_key::a_minor, 20,
+     2015},
+    {"Five", "Artist B", "Drum & Bass", 174, djinterop::musical_key::g_major,
+     60, 2020},
+};
+
+/// Create the query tracks in a database.
+///
+/// \return Returns the ids of the created tracks, in order of creation.
+std::vector<int64_t> create_query_tracks(
+    djinterop::database& db, const e::engine_schema& schema)
+{
+    std::vector<int64_t> ids;
+    for (auto&& t : query_tracks)
+    {
+        djinterop::track_snapshot snapshot{};
+        populate_track_snapshot(
+            snapshot, example_track_data_variation::basic_metadata_only_1,
+            example_track_data_usage::create, schema);
+        snapshot.relative_path = "../" + t.title + ".mp3";
+        snapshot.title = t.title;
+        snapshot.artist = t.artist;
+        snapshot.genre = t.genre;
+        snapshot.bpm = t.bpm;
+        snapshot.key = t.key;
+        snapshot.rating = t.rating;
+        snapshot.year = t.year;
+        ids.push_back(db.create_track(snapshot).id());
+    }
+
+    return ids;
+}
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(
+    *utf::description("track_query::ids() with no filters returns all tracks"))
+BOOST_DATA_TEST_CASE(ids__no_filters__all_tracks, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto ids = create_query_tracks(db, schema);
+
+    // Act
+    auto results = db.query().ids();
+
+    // Assert
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        results.begin(), results.end(), ids.begin(), ids.end());
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("track_query::bpm_between() matches an inclusive range"))
+BOOST_DATA_TEST_CASE(
+    ids__bpm_between__matches_range, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto ids = create_query_tracks(db, schema);
+
+    // Act
+    auto results = db.query().bpm_between(124, 126).ids();
+
+    // Assert
+    std::vector<int64_t> expected{ids[1], ids[2]};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        results.begin(), results.end(), expected.begin(), expected.end());
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("track_query::key_in() matches any of a set of keys"))
+BOOST_DATA_TEST_CASE(ids__key_in__matches_keys, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto ids = create_query_tracks(db, schema);
+
+    // Act
+    auto results = db.query()
+                       .key_in(
+                           {djinterop::musical_key::a_minor,
+                            djinterop::musical_key::g_major})
+                       .ids();
+    auto none = db.query().key_in({}).ids();
+
+    // Assert
+    std::vector<int64_t> expected{ids[0], ids[3], ids[4]};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        results.begin(), results.end(), expected.begin(), expected.end());
+    BOOST_CHECK(none.empty());
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("track_query with several filters matches all of them"))
+BOOST_DATA_TEST_CASE(
+    ids__combined_filters__matches_all, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto ids = create_query_tracks(db, schema);
+
+    // Act
+    auto results = db.query()
+                       .genre("House")
+                       .artist("Artist A")
+                       .rating_at_least(50)
+                       .year_between(2000, 2012)
+                       .ids();
+
+    // Assert
+    std::vector<int64_t> expected{ids[0], ids[2]};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        results.begin(), results.end(), expected.begin(), expected.end());
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "track_query::order_by() and limit() return the newest tracks first"))
+BOOST_DATA_TEST_CASE(
+    ids__order_by_date_added_descending_limit__newest, e::supported_schemas,
+    schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto ids = create_query_tracks(db, schema);
+
+    // Act
+    auto results = db.query()
+                       .genre("House")
+                       .order_by(djinterop::track_order::date_added, true)
+                       .limit(2)
+                       .ids();
+
+    // Assert
+    std::vector<int64_t> expected{ids[3], ids[2]};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        results.begin(), results.end(), expected.begin(), expected.end());
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("track_query::order_by() orders by a metadata field"))
+BOOST_DATA_TEST_CASE(ids__order_by_title__ordered, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto ids = create_query_tracks(db, schema);
+
+    // Act
+    auto results = db.query().order_by(djinterop::track_order::title).ids();
+
+    // Assert
+    std::vector<int64_t> expected{ids[4], ids[3], ids[0], ids[2], ids[1]};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        results.begin(), results.end(), expected.begin(), expected.end());
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("track_query::rows() projects the fields of tracks"))
+BOOST_DATA_TEST_CASE(
+    rows__filtered__projects_fields, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto ids = create_query_tracks(db, schema);
+
+    // Act
+    auto rows = db.query().genre("Drum & Bass").rows();
+
+    // Assert
+    BOOST_REQUIRE_EQUAL(rows.size(), 1u);
+    auto tr = *db.track_by_id(ids[4]);
+    auto snapshot = tr.snapshot();
+    BOOST_CHECK_EQUAL(rows[0].id, ids[4]);
+    BOOST_CHECK(rows[0].title == snapshot.title);
+    BOOST_CHECK(rows[0].artist == snapshot.artist);
+    BOOST_CHECK(rows[0].genre == snapshot.genre);
+    BOOST_CHECK(rows[0].bpm == snapshot.bpm);
+    BOOST_CHECK(rows[0].key == snapshot.key);
+    BOOST_CHECK(rows[0].rating == tr.rating());
+    BOOST_CHECK(rows[0].year == snapshot.year);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("track_query is answered by a single statement"))
+BOOST_DATA_TEST_CASE(
+    ids_and_rows__any_filters__single_statement, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    create_query_tracks(db, schema);
+    auto query = db.query()
+                     .bpm_between(100, 130)
+                     .key_in({djinterop::musical_key::a_minor})
+                     .genre("House")
+                     .order_by(djinterop::track_order::rating)
+                     .limit(10);
+
+    std::vector<int64_t> ids;
+    std::vector<djinterop::track_query_row> rows;
+
+    // Act
+    auto id_statements = count_statements(db, [&] { ids = query.ids(); });
+    auto row_statements = count_statements(db, [&] { rows = query.rows(); });
+
+    // Assert
+    BOOST_CHECK_EQUAL(ids.size(), 2u);
+    BOOST_CHECK_EQUAL(rows.size(), 2u);
+    BOOST_CHECK_EQUAL(id_statements, 1);
+    BOOST_CHECK_EQUAL(row_statements, 1);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("track_query rejects inverted ranges"))
+BOOST_DATA_TEST_CASE(
+    bpm_between__inverted__throws, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+
+    // Act/Assert
+    BOOST_CHECK_THROW(
+        db.query().bpm_between(130, 120), std::invalid_argument);
+    BOOST_CHECK_THROW(
+        db.query().year_between(2020, 2010), std::invalid_argument);
+}
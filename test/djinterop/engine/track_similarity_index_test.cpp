@@ -0,0 +1,274 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE track_similarity_index_test
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <djinterop/database.hpp>
+#include <djinterop/engine/engine.hpp>
+#include <djinterop/exceptions.hpp>
+#include <djinterop/track.hpp>
+#include <djinterop/track_feature_index.hpp>
+#include <djinterop/track_similarity_index.hpp>
+#include <djinterop/track_snapshot.hpp>
+
+#include "example_track_features.hpp"
+
+namespace e = djinterop::engine;
+namespace utf = boost::unit_test;
+using namespace std::chrono_literals;
+
+namespace
+{
+/// Find the nearest tracks by measuring the distance to every track.
+std::vector<int64_t> brute_force_nearest(
+    const djinterop::track_similarity_index& index, int64_t id, std::size_t k)
+{
+    auto& features = *index.features();
+    if (!features.features_at(*features.row_of(id)).bpm)
+        return {};
+
+    std::vector<std::pair<double, int64_t>> candidates;
+    for (std::size_t row = 0; row < features.size(); ++row)
+    {
+        auto other_id = features.id_at(row);
+        auto distance = index.distance(id, other_id);
+        if (other_id != id && !std::isinf(distance))
+            candidates.emplace_back(distance, other_id);
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.resize(std::min(k, candidates.size()));
+
+    std::vector<int64_t> result;
+    for (auto&& [distance, other_id] : candidates)
+        result.push_back(other_id);
+
+    return result;
+}
+
+void check_nearest_equals_brute_force(
+    const djinterop::track_similarity_index& index, std::size_t k)
+{
+    auto& features = *index.features();
+    for (std::size_t row = 0; row < features.size(); ++row)
+    {
+        auto id = features.id_at(row);
+        auto actual = index.nearest(id, k);
+        auto expected = brute_force_nearest(index, id, k);
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            actual.begin(), actual.end(), expected.begin(), expected.end());
+    }
+}
+
+djinterop::track_features make_features(
+    int64_t id, double bpm, djinterop::musical_key key)
+{
+    djinterop::track_features features;
+    features.id = id;
+    features.bpm = bpm;
+    features.key = key;
+    features.average_loudness = 0.5;
+    features.duration = 200s;
+    features.genre = "House";
+    return features;
+}
+
+}  // anonymous namespace
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "nearest() on random features finds the same tracks as a brute force "
+    "search"))
+BOOST_DATA_TEST_CASE(
+    nearest__random_features__equals_brute_force,
+    boost::unit_test::data::make({0, 1, 2, 9, 100, 1000}), count)
+{
+    // Arrange
+    auto features = std::make_shared<djinterop::track_feature_index>(
+        make_random_features(count, 4321));
+
+    // Act
+    djinterop::track_similarity_index index{features};
+
+    // Assert
+    for (std::size_t k : {0, 1, 5, 20})
+        check_nearest_equals_brute_force(index, k);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "distance() treats keys as lying on a circle, and missing BPM as "
+    "infinitely distant"))
+BOOST_AUTO_TEST_CASE(distance__keys__circular)
+{
+    // Arrange
+    auto no_bpm = make_features(6, 120, djinterop::musical_key::c_major);
+    no_bpm.bpm = std::nullopt;
+    auto features = std::make_shared<djinterop::track_feature_index>(
+        std::vector<djinterop::track_features>{
+            make_features(1, 120, djinterop::musical_key::c_major),
+            make_features(2, 120, djinterop::musical_key::g_major),
+            make_features(3, 120, djinterop::musical_key::f_major),
+            make_features(4, 120, djinterop::musical_key::a_minor),
+            make_features(5, 120 * 1.06, djinterop::musical_key::c_major),
+            no_bpm});
+
+    // Act
+    djinterop::track_similarity_index index{features};
+
+    // Assert
+    BOOST_CHECK_EQUAL(index.size(), 5u);
+    BOOST_CHECK_CLOSE(index.distance(1, 2), 1.0, 0.01);
+    BOOST_CHECK_CLOSE(index.distance(1, 3), 1.0, 0.01);
+    BOOST_CHECK_CLOSE(index.distance(1, 4), 1.0, 0.01);
+    BOOST_CHECK_CLOSE(index.distance(1, 5), 1.0, 0.01);
+    BOOST_CHECK_SMALL(index.distance(2, 2), 1e-6);
+    BOOST_CHECK(std::isinf(index.distance(1, 6)));
+    BOOST_CHECK(index.nearest(6, 3).empty());
+    BOOST_CHECK_THROW(
+        static_cast<void>(index.distance(1, 7)), djinterop::track_deleted);
+    BOOST_CHECK_THROW(
+        static_cast<void>(index.nearest(7, 3)), djinterop::track_deleted);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "update() with a changed snapshot gives the same results as building a "
+    "new index from it"))
+BOOST_DATA_TEST_CASE(
+    update__changed_snapshot__equals_rebuilt_index,
+    boost::unit_test::data::make({10, 1000}), change_count)
+{
+    // Arrange
+    auto before = make_random_features(2000, 1234);
+    auto changes = make_random_features(change_count, 5678);
+    auto after = std::make_shared<djinterop::track_feature_index>(before);
+    djinterop::track_similarity_index index{
+        std::make_shared<djinterop::track_feature_index>(before)};
+    for (std::size_t i = 0; i < changes.size(); ++i)
+    {
+        // Alternately edit, remove, and add tracks.
+        auto& features = changes[i];
+        features.id = static_cast<int64_t>(4 * i + 1 + (i % 3 == 2));
+        if (i % 3 == 1)
+            after->remove(features.id);
+        else
+            after->upsert(features);
+    }
+
+    // Act
+    index.update(after);
+
+    // Assert
+    djinterop::track_similarity_index expected{after};
+    BOOST_CHECK_EQUAL(index.features(), after);
+    BOOST_CHECK_EQUAL(index.size(), expected.size());
+    for (std::size_t row = 0; row < after->size(); ++row)
+    {
+        auto id = after->id_at(row);
+        auto actual_ids = index.nearest(id, 10);
+        auto expected_ids = expected.nearest(id, 10);
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            actual_ids.begin(), actual_ids.end(), expected_ids.begin(),
+            expected_ids.end());
+    }
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "nearest() for a batch of tracks gives the same results as for each "
+    "track alone"))
+BOOST_AUTO_TEST_CASE(nearest__batch__equals_single_queries)
+{
+    // Arrange
+    auto features = std::make_shared<djinterop::track_feature_index>(
+        make_random_features(500, 8765));
+    djinterop::track_similarity_index index{features};
+    std::vector<int64_t> ids;
+    for (std::size_t row = 0; row < features->size(); ++row)
+        ids.push_back(features->id_at(row));
+
+    // Act
+    auto results = index.nearest(ids, 7, 4);
+
+    // Assert
+    BOOST_REQUIRE_EQUAL(results.size(), ids.size());
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+        auto expected = index.nearest(ids[i], 7);
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            results[i].begin(), results[i].end(), expected.begin(),
+            expected.end());
+    }
+
+    ids.push_back(2);
+    BOOST_CHECK_THROW(
+        static_cast<void>(index.nearest(ids, 7, 4)),
+        djinterop::track_deleted);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "database::similar_tracks() finds the most similar tracks, and reflects "
+    "later edits"))
+BOOST_DATA_TEST_CASE(
+    similar_tracks__library__nearest_first, e::supported_schemas, schema)
+{
+    // Arrange
+    auto db = e::create_temporary_database(schema);
+    auto reference = db.create_track(make_feature_snapshot(
+        schema, "Reference", 124, djinterop::musical_key::a_minor, 0.5,
+        "House"));
+    auto closest = db.create_track(make_feature_snapshot(
+        schema, "Closest", 125, djinterop::musical_key::a_minor, 0.5,
+        "House"));
+    auto close = db.create_track(make_feature_snapshot(
+        schema, "Close", 126, djinterop::musical_key::e_minor, 0.5, "House"));
+    auto far = db.create_track(make_feature_snapshot(
+        schema, "Far", 174, djinterop::musical_key::f_sharp_major, 0.5,
+        "Drum & Bass"));
+
+    // Act
+    auto before = db.similar_tracks(reference, 2);
+    far.set_bpm(124.0);
+    far.set_key(djinterop::musical_key::a_minor);
+    far.set_genre(std::string{"House"});
+    auto after = db.similar_tracks(reference);
+    auto batch = db.similar_tracks({reference, far}, 3);
+
+    // Assert
+    std::vector<int64_t> expected_before{closest.id(), close.id()};
+    std::vector<int64_t> expected_after{far.id(), closest.id(), close.id()};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        before.begin(), before.end(), expected_before.begin(),
+        expected_before.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        after.begin(), after.end(), expected_after.begin(),
+        expected_after.end());
+    BOOST_REQUIRE_EQUAL(batch.size(), 2u);
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        batch[0].begin(), batch[0].end(), expected_after.begin(),
+        expected_after.end());
+    BOOST_CHECK_EQUAL(batch[1].front(), reference.id());
+}
@@ -20,6 +20,7 @@
 #include <boost/test/data/test_case.hpp>
 #include <boost/test/included/unit_test.hpp>
 
+#include <algorithm>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -28,6 +29,7 @@
 #include <djinterop/engine/engine.hpp>
 #include <djinterop/track_snapshot.hpp>
 
+#include "budget.hpp"
 #include "example_track_data.hpp"
 
 #define STRINGIFY(x) STRINGIFY_(x)
@@ -234,3 +236,85 @@ BOOST_DATA_TEST_CASE(
     // Assert
     BOOST_CHECK(track.average_loudness() == std::nullopt);
 }
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "set waveform with transient, schema versions 2.x and 3.x"))
+BOOST_DATA_TEST_CASE(
+    set_waveform__transient__preserved,
+    utf::data::make(e::supported_v2_schemas) + e::supported_v3_schemas,
+    schema)
+{
+    // Schema 1.x reads back the high-resolution waveform as written, and so
+    // would pass regardless of how the overview waveform is pooled.
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+
+    djinterop::track_snapshot snapshot{};
+    populate_track_snapshot(
+        snapshot, example_track_data_variation::fully_analysed_1,
+        example_track_data_usage::create, schema);
+
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating track...");
+    auto track = db.create_track(snapshot);
+
+    // A single loud entry, placed between the points that would be picked by
+    // point sampling down to an overview waveform.
+    auto extents = e::calculate_high_resolution_waveform_extents(
+        *snapshot.sample_count, *snapshot.sample_rate);
+    std::vector<djinterop::waveform_entry> waveform(extents.size);
+    auto transient_index =
+        extents.size * 2 / e::calculate_overview_waveform_extents(
+                                *snapshot.sample_count, *snapshot.sample_rate)
+                                .size;
+    waveform[transient_index].low.value = 255;
+
+    // Act
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Setting waveform...");
+    track.set_waveform(waveform);
+
+    // Assert
+    auto actual = track.waveform();
+    auto max_low = std::max_element(
+        actual.begin(), actual.end(), [](const auto& a, const auto& b)
+        { return a.low.value < b.low.value; });
+    BOOST_REQUIRE(max_low != actual.end());
+    BOOST_CHECK_EQUAL(max_low->low.value, 255);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "track::set_sample_rate() statement budget, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    set_sample_rate__statement_budget__within_budget, e::supported_schemas,
+    schema)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+    auto track = create_budget_tracks(db, schema, 1).front();
+    auto budget = budget_for(schema, {11, 0}, {4, 0}, {4, 0});
+
+    // Act
+    auto actual = count_statements(db, [&] { track.set_sample_rate(48000); });
+
+    // Assert
+    DJINTEROP_CHECK_BUDGET("Statements issued", actual, budget, 1);
+}
+
+BOOST_TEST_DECORATOR(*utf::description(
+    "track::snapshot() statement budget, all schema versions"))
+BOOST_DATA_TEST_CASE(
+    snapshot__statement_budget__within_budget, e::supported_schemas, schema)
+{
+    // Arrange
+    BOOST_TEST_CHECKPOINT("(" << schema << ") Creating temporary database...");
+    auto db = e::create_temporary_database(schema);
+    auto track = create_budget_tracks(db, schema, 1).front();
+    auto budget = budget_for(schema, {4, 0}, {2, 0}, {3, 0});
+
+    // Act
+    auto actual = count_statements(db, [&] { track.snapshot(); });
+
+    // Assert
+    DJINTEROP_CHECK_BUDGET("Statements issued", actual, budget, 1);
+}
@@ -0,0 +1,310 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE engine_v2_performance_data_blob_test
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <djinterop/engine/v2/beat_data_blob.hpp>
+#include <djinterop/engine/v2/loops_blob.hpp>
+#include <djinterop/engine/v2/overview_waveform_data_blob.hpp>
+#include <djinterop/engine/v2/quick_cues_blob.hpp>
+#include <djinterop/engine/v2/track_data_blob.hpp>
+
+namespace utf = boost::unit_test;
+namespace ev2 = djinterop::engine::v2;
+
+BOOST_TEST_DECORATOR(*utf::description("beat data blob round trip"))
+BOOST_AUTO_TEST_CASE(beat_data_blob__round_trip__identical)
+{
+    // Arrange
+    ev2::beat_data_blob expected{
+        .sample_rate = 44100,
+        .samples = 16140600,
+        .is_beatgrid_set = 1,
+        .default_beat_grid = {{-4, -4, 812, 0}, {15921475.5, 808, 0, 0}},
+        .adjusted_beat_grid = {{-4, -4, 812, 0}, {15921475.5, 808, 0, 0}},
+        .extra_data = {std::byte{1}, std::byte{2}},
+    };
+
+    // Act
+    auto actual = ev2::beat_data_blob::from_blob(expected.to_blob());
+
+    // Assert
+    BOOST_CHECK_EQUAL(expected, actual);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("loops blob round trip"))
+BOOST_AUTO_TEST_CASE(loops_blob__round_trip__identical)
+{
+    // Arrange
+    ev2::loops_blob expected{
+        .loops =
+            {ev2::loop_blob{
+                 "Loop 1", 1000, 2000, 1, 1, djinterop::pad_color{1, 2, 3, 4}},
+             ev2::loop_blob::empty()},
+        .extra_data = {},
+    };
+
+    // Act
+    auto actual = ev2::loops_blob::from_blob(expected.to_blob());
+
+    // Assert
+    BOOST_CHECK_EQUAL(expected, actual);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("overview waveform blob round trip"))
+BOOST_AUTO_TEST_CASE(overview_waveform_data_blob__round_trip__identical)
+{
+    // Arrange
+    ev2::overview_waveform_data_blob expected{
+        .samples_per_waveform_point = 15762.3,
+        .waveform_points = {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}},
+        .maximum_point = {7, 8, 9},
+        .extra_data = {},
+    };
+
+    // Act
+    auto actual =
+        ev2::overview_waveform_data_blob::from_blob(expected.to_blob());
+
+    // Assert
+    BOOST_CHECK_EQUAL(expected, actual);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("large overview waveform blob round trip"))
+BOOST_AUTO_TEST_CASE(overview_waveform_data_blob__large__identical)
+{
+    // Arrange
+    ev2::overview_waveform_data_blob expected{
+        .samples_per_waveform_point = 1,
+        .waveform_points = {},
+        .maximum_point = {255, 255, 255},
+        .extra_data = std::vector<std::byte>(20000, std::byte{7}),
+    };
+    uint32_t state = 1;
+    for (auto i = 0; i < 100000; ++i)
+    {
+        state = state * 1664525 + 1013904223;
+        expected.waveform_points.push_back(
+            {static_cast<uint8_t>(state >> 24),
+             static_cast<uint8_t>(state >> 16),
+             static_cast<uint8_t>(i)});
+    }
+
+    // Act
+    auto actual =
+        ev2::overview_waveform_data_blob::from_blob(expected.to_blob());
+
+    // Assert
+    BOOST_CHECK(expected == actual);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("quick cues blob round trip"))
+BOOST_AUTO_TEST_CASE(quick_cues_blob__round_trip__identical)
+{
+    // Arrange
+    ev2::quick_cues_blob expected{
+        .quick_cues =
+            {ev2::quick_cue_blob{
+                 "Cue", 1234.5, djinterop::pad_color{1, 2, 3, 4}},
+             ev2::quick_cue_blob::empty()},
+        .adjusted_main_cue = 100,
+        .is_main_cue_adjusted = true,
+        .default_main_cue = 50,
+        .extra_data = {},
+    };
+
+    // Act
+    auto actual = ev2::quick_cues_blob::from_blob(expected.to_blob());
+
+    // Assert
+    BOOST_CHECK_EQUAL(expected, actual);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("track data blob round trip"))
+BOOST_AUTO_TEST_CASE(track_data_blob__round_trip__identical)
+{
+    // Arrange
+    ev2::track_data_blob expected{
+        .sample_rate = 44100,
+        .samples = 16140600,
+        .key = 3,
+        .average_loudness_low = 0.5,
+        .average_loudness_mid = 0.25,
+        .average_loudness_high = 0.125,
+        .extra_data = {},
+    };
+
+    // Act
+    auto actual = ev2::track_data_blob::from_blob(expected.to_blob());
+
+    // Assert
+    BOOST_CHECK_EQUAL(expected, actual);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("loops blob with count exceeding data is rejected"))
+BOOST_AUTO_TEST_CASE(loops_blob__excessive_count__throws)
+{
+    // Arrange
+    ev2::loops_blob blob{.loops = {ev2::loop_blob::empty()}, .extra_data = {}};
+    auto data = blob.to_blob();
+    data[0] = std::byte{0xFF};  // Little-endian count of 255.
+
+    // Act/Assert
+    BOOST_CHECK_THROW(ev2::loops_blob::from_blob(data), std::invalid_argument);
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("loops blob with truncated label is rejected"))
+BOOST_AUTO_TEST_CASE(loops_blob__truncated__throws)
+{
+    // Arrange
+    ev2::loops_blob blob{
+        .loops = {ev2::loop_blob{"Label", 1, 2, 1, 1, {}}}, .extra_data = {}};
+    auto data = blob.to_blob();
+    data.resize(12);
+
+    // Act/Assert
+    BOOST_CHECK_THROW(ev2::loops_blob::from_blob(data), std::invalid_argument);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("quick cues view matches blob"))
+BOOST_AUTO_TEST_CASE(quick_cues_view__encoded_blob__matches)
+{
+    // Arrange
+    ev2::quick_cues_blob blob{
+        .quick_cues =
+            {ev2::quick_cue_blob{
+                 "First", 1234.5, djinterop::pad_color{1, 2, 3, 4}},
+             ev2::quick_cue_blob::empty(),
+             ev2::quick_cue_blob{
+                 "Third cue", 99, djinterop::pad_color{5, 6, 7, 8}}},
+        .adjusted_main_cue = 100,
+        .is_main_cue_adjusted = true,
+        .default_main_cue = 50,
+        .extra_data = {},
+    };
+    auto data = ev2::quick_cues_view::uncompress(blob.to_blob());
+
+    // Act
+    ev2::quick_cues_view view{data};
+
+    // Assert
+    BOOST_REQUIRE_EQUAL(blob.quick_cues.size(), view.size());
+    for (std::size_t i = 0; i < view.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(blob.quick_cues[i].label, view[i].label);
+        BOOST_CHECK_EQUAL(
+            blob.quick_cues[i].sample_offset, view[i].sample_offset);
+        BOOST_CHECK_EQUAL(blob.quick_cues[i].color, view[i].color);
+    }
+
+    BOOST_CHECK_EQUAL(blob.adjusted_main_cue, view.adjusted_main_cue());
+    BOOST_CHECK_EQUAL(blob.is_main_cue_adjusted, view.is_main_cue_adjusted());
+    BOOST_CHECK_EQUAL(blob.default_main_cue, view.default_main_cue());
+    BOOST_CHECK_THROW((void)view.at(3), std::out_of_range);
+}
+
+BOOST_TEST_DECORATOR(*utf::description("loops view matches blob"))
+BOOST_AUTO_TEST_CASE(loops_view__encoded_blob__matches)
+{
+    // Arrange
+    ev2::loops_blob blob{.loops = {}, .extra_data = {}};
+    for (auto i = 0; i < 10; ++i)
+    {
+        blob.loops.push_back(ev2::loop_blob{
+            std::string(i, 'x'), i * 100.0, i * 200.0, 1, 0,
+            djinterop::pad_color{1, 2, 3, static_cast<uint8_t>(i)}});
+    }
+
+    auto data = blob.to_blob();
+
+    // Act
+    ev2::loops_view view{data};
+
+    // Assert
+    BOOST_REQUIRE_EQUAL(blob.loops.size(), view.size());
+    for (std::size_t i = 0; i < view.size(); ++i)
+    {
+        auto&& expected = blob.loops[i];
+        auto actual = view[i];
+        BOOST_CHECK_EQUAL(expected.label, actual.label);
+        BOOST_CHECK_EQUAL(
+            expected.start_sample_offset, actual.start_sample_offset);
+        BOOST_CHECK_EQUAL(expected.end_sample_offset, actual.end_sample_offset);
+        BOOST_CHECK_EQUAL(expected.is_start_set, actual.is_start_set);
+        BOOST_CHECK_EQUAL(expected.is_end_set, actual.is_end_set);
+        BOOST_CHECK_EQUAL(expected.color, actual.color);
+    }
+}
+
+BOOST_TEST_DECORATOR(*utf::description("beat data view matches blob"))
+BOOST_AUTO_TEST_CASE(beat_data_view__encoded_blob__matches)
+{
+    // Arrange
+    ev2::beat_data_blob blob{
+        .sample_rate = 44100,
+        .samples = 16140600,
+        .is_beatgrid_set = 1,
+        .default_beat_grid = {{-4, -4, 812, 0}, {15921475.5, 808, 0, 0}},
+        .adjusted_beat_grid =
+            {{-8, -4, 4, 0}, {100, 0, 804, 0}, {15921475.5, 804, 0, 0}},
+        .extra_data = {},
+    };
+    auto data = ev2::beat_data_view::uncompress(blob.to_blob());
+
+    // Act
+    ev2::beat_data_view view{data};
+
+    // Assert
+    BOOST_CHECK_EQUAL(blob.sample_rate, view.sample_rate());
+    BOOST_CHECK_EQUAL(blob.samples, view.samples());
+    BOOST_CHECK_EQUAL(blob.is_beatgrid_set, view.is_beatgrid_set());
+    auto default_grid = view.default_beat_grid();
+    auto adjusted_grid = view.adjusted_beat_grid();
+    BOOST_REQUIRE_EQUAL(blob.default_beat_grid.size(), default_grid.size());
+    BOOST_REQUIRE_EQUAL(blob.adjusted_beat_grid.size(), adjusted_grid.size());
+    for (std::size_t i = 0; i < default_grid.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(blob.default_beat_grid[i], default_grid[i]);
+    }
+    for (std::size_t i = 0; i < adjusted_grid.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(blob.adjusted_beat_grid[i], adjusted_grid[i]);
+    }
+}
+
+BOOST_TEST_DECORATOR(
+    *utf::description("loops view with count exceeding data is rejected"))
+BOOST_AUTO_TEST_CASE(loops_view__excessive_count__throws)
+{
+    // Arrange
+    ev2::loops_blob blob{.loops = {ev2::loop_blob::empty()}, .extra_data = {}};
+    auto data = blob.to_blob();
+    data[0] = std::byte{2};
+
+    // Act/Assert
+    BOOST_CHECK_THROW(ev2::loops_view{data}, std::invalid_argument);
+}
@@ -0,0 +1,201 @@
+/*
+    This file is part of libdjinterop.
+
+    libdjinterop is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    libdjinterop is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with libdjinterop.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE util_sqlite_transaction_test
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdint>
+
+#include <sqlite_modern_cpp.h>
+
+#include "djinterop/util/sqlite_transaction.hpp"
+
+namespace util = djinterop::util;
+
+namespace
+{
+sqlite::database make_database()
+{
+    sqlite::database db{":memory:"};
+    db << "CREATE TABLE item (value INTEGER NOT NULL)";
+    return db;
+}
+
+void insert(sqlite::database& db, int64_t value)
+{
+    db << "INSERT INTO item (value) VALUES (?)" << value;
+}
+
+int64_t count_items(sqlite::database& db)
+{
+    int64_t count = 0;
+    db << "SELECT COUNT(*) FROM item" >> count;
+    return count;
+}
+
+int64_t sum_items(sqlite::database& db)
+{
+    int64_t sum = 0;
+    db << "SELECT COALESCE(SUM(value), 0) FROM item" >> sum;
+    return sum;
+}
+
+bool is_autocommit(sqlite::database& db)
+{
+    return sqlite3_get_autocommit(db.connection().get()) != 0;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(commit__single__persisted)
+{
+    // Arrange
+    auto db = make_database();
+
+    // Act
+    {
+        util::sqlite_transaction trans{db};
+        insert(db, 1);
+        trans.commit();
+    }
+
+    // Assert
+    BOOST_CHECK_EQUAL(count_items(db), 1);
+    BOOST_CHECK(is_autocommit(db));
+}
+
+BOOST_AUTO_TEST_CASE(dtor__single_uncommitted__rolled_back)
+{
+    // Arrange
+    auto db = make_database();
+
+    // Act
+    {
+        util::sqlite_transaction trans{db};
+        insert(db, 1);
+    }
+
+    // Assert
+    BOOST_CHECK_EQUAL(count_items(db), 0);
+    BOOST_CHECK(is_autocommit(db));
+}
+
+BOOST_AUTO_TEST_CASE(commit__nested_inner_and_outer__all_persisted)
+{
+    // Arrange
+    auto db = make_database();
+
+    // Act
+    {
+        util::sqlite_transaction outer{db};
+        insert(db, 1);
+        {
+            util::sqlite_transaction inner{db};
+            insert(db, 2);
+            inner.commit();
+        }
+
+        BOOST_CHECK(!is_autocommit(db));
+        insert(db, 4);
+        outer.commit();
+    }
+
+    // Assert
+    BOOST_CHECK_EQUAL(count_items(db), 3);
+    BOOST_CHECK_EQUAL(sum_items(db), 7);
+    BOOST_CHECK(is_autocommit(db));
+}
+
+BOOST_AUTO_TEST_CASE(commit__nested_inner_rolled_back__outer_persisted)
+{
+    // Arrange
+    auto db = make_database();
+
+    // Act
+    {
+        util::sqlite_transaction outer{db};
+        insert(db, 1);
+        {
+            util::sqlite_transaction inner{db};
+            insert(db, 2);
+        }
+
+        BOOST_CHECK(!is_autocommit(db));
+        BOOST_CHECK_EQUAL(count_items(db), 1);
+        insert(db, 4);
+        outer.commit();
+    }
+
+    // Assert
+    BOOST_CHECK_EQUAL(count_items(db), 2);
+    BOOST_CHECK_EQUAL(sum_items(db), 5);
+    BOOST_CHECK(is_autocommit(db));
+}
+
+BOOST_AUTO_TEST_CASE(dtor__nested_inner_committed_outer_uncommitted__none)
+{
+    // Arrange
+    auto db = make_database();
+
+    // Act
+    {
+        util::sqlite_transaction outer{db};
+        insert(db, 1);
+        {
+            util::sqlite_transaction inner{db};
+            insert(db, 2);
+            inner.commit();
+        }
+    }
+
+    // Assert
+    BOOST_CHECK_EQUAL(count_items(db), 0);
+    BOOST_CHECK(is_autocommit(db));
+}
+
+BOOST_AUTO_TEST_CASE(commit__doubly_nested_middle_rolled_back__outer_only)
+{
+    // Arrange
+    auto db = make_database();
+
+    // Act
+    {
+        util::sqlite_transaction outer{db};
+        insert(db, 1);
+        {
+            util::sqlite_transaction middle{db};
+            insert(db, 2);
+            {
+                util::sqlite_transaction inner{db};
+                insert(db, 4);
+                inner.commit();
+            }
+        }
+
+        {
+            util::sqlite_transaction sibling{db};
+            insert(db, 8);
+            sibling.commit();
+        }
+
+        outer.commit();
+    }
+
+    // Assert
+    BOOST_CHECK_EQUAL(count_items(db), 2);
+    BOOST_CHECK_EQUAL(sum_items(db), 9);
+    BOOST_CHECK(is_autocommit(db));
+}